@@ -0,0 +1,420 @@
+#pragma once
+#include "ProcessUtils.h"
+#include "BuildCommand.h"
+#include "BuildConfigurationFile.h"
+#include "SystemInfo.h"
+#include "JsonUtils.h"
+#include "StringUtils.h"
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // One BuildConfiguration.xml entry; an empty Value removes the key (UBT default)
+    struct TuningSetting {
+        std::string Section;
+        std::string Key;
+        std::string Value;
+    };
+
+    struct TuningCandidate {
+        std::string Name;
+        std::vector<TuningSetting> Settings; // Nothing = the user's current configuration
+    };
+
+    struct TuningRun {
+        bool Success = false;
+        double WallSeconds = 0.0;
+        double CpuSeconds = 0.0;
+        double CpuUtilization = 0.0;    // 0..1 of all logical cores over the wall time
+        uint64_t PeakMemoryBytes = 0;
+    };
+
+    struct TuningResult {
+        TuningCandidate Candidate;
+        std::vector<TuningRun> Runs;
+        double MedianWall = 0.0;
+        double Spread = 0.0;            // (slowest - fastest) / median
+        uint64_t PeakMemoryBytes = 0;
+        bool Stable = false;            // Needs two runs or more: one run can't show its spread
+        std::string Rejected;           // Why it is not stable
+    };
+
+    struct TuningReport {
+        MachineProfile Machine;
+        std::string Target;
+        std::string Module;
+        std::string Timestamp;
+        std::vector<TuningResult> Results;
+        int Best = -1;                  // Index into Results, -1 if nothing was stable
+    };
+
+    // Finds the fastest stable UBT executor settings for this machine by building the same
+    // target (or one module) under each candidate BuildConfiguration.xml and measuring it.
+    //
+    // Candidates are run round-robin (every candidate once, then again) so thermal or
+    // background drift spreads evenly instead of favouring whichever went first.
+    class AutoTuner {
+    public:
+        static constexpr double MaxSpread = 0.10;         // Stable runs agree within 10%
+        static constexpr double MaxMemoryFraction = 0.90; // Of physical RAM, or the machine is swapping
+
+        static std::vector<TuningCandidate> DefaultCandidates(const MachineProfile& machine) {
+            int cores = (std::max)(1, machine.LogicalCores);
+            std::vector<TuningCandidate> candidates;
+            candidates.push_back({ "Current settings", {} });
+
+            auto addParallel = [&](int actions) {
+                actions = (std::max)(1, actions);
+                for (const auto& c : candidates) {
+                    if (!c.Settings.empty() && c.Settings[0].Key == "MaxParallelActions" &&
+                        c.Settings[0].Value == std::to_string(actions)) return;
+                }
+                candidates.push_back({ "MaxParallelActions=" + std::to_string(actions),
+                    { { "BuildConfiguration", "MaxParallelActions", std::to_string(actions) },
+                      { "ParallelExecutor", "ProcessorCountMultiplier", "" } } });
+            };
+            addParallel(cores / 2);
+            addParallel(cores * 3 / 4);
+            addParallel(cores);
+
+            // Let UBT size by its own memory heuristic, scaled past the physical core count
+            for (const char* multiplier : { "1.25", "1.5" }) {
+                candidates.push_back({ std::string("ProcessorCountMultiplier=") + multiplier,
+                    { { "BuildConfiguration", "MaxParallelActions", "" },
+                      { "ParallelExecutor", "ProcessorCountMultiplier", multiplier } } });
+            }
+            return candidates;
+        }
+
+        // Runs every candidate `repetitions` times. The user's BuildConfiguration.xml is
+        // restored afterwards; call Apply to keep the winner. UBT runs with environment, the
+        // same one builds get (null inherits ours).
+        //
+        // The original file is backed up next to it before the first trial and put back on the
+        // way out, exception or not; a series killed outright (Ctrl+C, crash) leaves the backup
+        // for RestoreInterrupted to put back on the next start.
+        static TuningReport Run(const std::wstring& ubtPath, const BuildRequest& request, const std::string& module,
+                                const std::vector<TuningCandidate>& candidates, int repetitions, LogCallback onLog,
+                                const EnvironmentBlock* environment = nullptr) {
+            TuningReport report;
+            report.Machine = SystemInfo::GetMachineProfile();
+            report.Target = StringUtils::ToUtf8(BuildCommand::GetBuildTarget(request));
+            report.Module = module;
+            report.Timestamp = Now();
+            for (const auto& candidate : candidates) {
+                TuningResult result;
+                result.Candidate = candidate;
+                report.Results.push_back(result);
+            }
+
+            fs::path configPath = BuildConfigurationFile::GetUserPath();
+            RestoreInterrupted(onLog);
+            BuildConfigurationFile original;
+            if (configPath.empty() || !original.Load(configPath)) {
+                if (onLog) onLog("[AutoTune] Cannot read BuildConfiguration.xml, aborting.\n");
+                return report;
+            }
+            if (!WriteBackup(configPath, original)) {
+                if (onLog) onLog("[AutoTune] Cannot back up BuildConfiguration.xml, aborting.\n");
+                return report;
+            }
+
+            // Leave the machine as we found it, however the series ends
+            struct RestoreOnExit {
+                fs::path Config;
+                ~RestoreOnExit() { RestoreBackup(Config); }
+            } restore{ configPath };
+
+            BuildRequest trialRequest = request;
+            if (!module.empty()) trialRequest.ExtraArgs.push_back(L"-Module=" + StringUtils::FromUtf8(module));
+            fs::path projectRoot = fs::path(request.ProjectPath).parent_path();
+
+            repetitions = (std::max)(1, repetitions);
+            for (int rep = 0; rep < repetitions; ++rep) {
+                for (size_t i = 0; i < report.Results.size(); ++i) {
+                    TuningResult& result = report.Results[i];
+                    if (onLog) {
+                        onLog("[AutoTune] Run " + std::to_string(rep + 1) + "/" + std::to_string(repetitions) +
+                              ": " + result.Candidate.Name + "\n");
+                    }
+
+                    BuildConfigurationFile trial = original;
+                    ApplySettings(trial, result.Candidate.Settings);
+                    trial.Save(configPath);
+
+                    // Force the same amount of work every time
+                    if (!module.empty()) {
+                        RemoveModuleObjects(projectRoot, module);
+                    }
+                    else {
+                        BuildRequest cleanRequest = request;
+                        cleanRequest.ExtraArgs.push_back(L"-Clean");
+                        RunOptions cleanOptions;
+                        cleanOptions.Environment = environment;
+                        ProcessUtils::RunProcess(ubtPath, BuildCommand::GetUBTArgs(cleanRequest), L"", nullptr, cleanOptions);
+                    }
+
+                    ProcessStats stats;
+                    RunOptions options;
+                    options.Stats = &stats;
+                    options.Environment = environment;
+                    bool success = ProcessUtils::RunProcess(ubtPath, BuildCommand::GetUBTArgs(trialRequest), L"", nullptr, options);
+
+                    TuningRun run;
+                    run.Success = success;
+                    run.WallSeconds = stats.WallSeconds;
+                    run.CpuSeconds = stats.CpuSeconds;
+                    run.PeakMemoryBytes = stats.PeakMemoryBytes;
+                    if (stats.WallSeconds > 0.0) {
+                        run.CpuUtilization = stats.CpuSeconds / (stats.WallSeconds * report.Machine.LogicalCores);
+                    }
+                    result.Runs.push_back(run);
+
+                    if (onLog) {
+                        char line[160];
+                        std::snprintf(line, sizeof(line), "[AutoTune]   %s in %.1f s, CPU %.0f%%, peak %.1f GB\n",
+                                      success ? "built" : "FAILED", run.WallSeconds, run.CpuUtilization * 100.0,
+                                      run.PeakMemoryBytes / 1073741824.0);
+                        onLog(line);
+                    }
+                }
+            }
+
+            Evaluate(report);
+            SaveProfile(report);
+            return report;
+        }
+
+        // Puts back a BuildConfiguration.xml left on trial settings by an auto-tune that never
+        // finished. Call before anything runs UBT; true if there was one.
+        static bool RestoreInterrupted(const LogCallback& onLog) {
+            fs::path configPath = BuildConfigurationFile::GetUserPath();
+            if (configPath.empty() || !RestoreBackup(configPath)) return false;
+            if (onLog) onLog("[AutoTune] Restored BuildConfiguration.xml left behind by an interrupted auto-tune.\n");
+            return true;
+        }
+
+        // Writes the winning settings into the user's BuildConfiguration.xml
+        static bool Apply(const TuningReport& report) {
+            if (report.Best < 0) return false;
+
+            fs::path configPath = BuildConfigurationFile::GetUserPath();
+            BuildConfigurationFile config;
+            if (configPath.empty() || !config.Load(configPath)) return false;
+
+            ApplySettings(config, report.Results[report.Best].Candidate.Settings);
+            return config.Save(configPath);
+        }
+
+        // Results live per machine profile, so identical agents can share them
+        static fs::path GetProfilePath(const MachineProfile& machine) {
+            return SystemInfo::GetUserDataDir() / "Tuning" / (machine.Id() + ".json");
+        }
+
+        static bool SaveProfile(const TuningReport& report) {
+            JsonValue machine = JsonValue::MakeObject();
+            machine.Set("Id", report.Machine.Id());
+            machine.Set("HostName", report.Machine.HostName);
+            machine.Set("Cpu", report.Machine.Cpu);
+            machine.Set("LogicalCores", report.Machine.LogicalCores);
+            machine.Set("MemoryBytes", report.Machine.MemoryBytes);
+
+            JsonValue results = JsonValue::MakeArray();
+            for (const auto& result : report.Results) {
+                JsonValue settings = JsonValue::MakeArray();
+                for (const auto& s : result.Candidate.Settings) {
+                    JsonValue setting = JsonValue::MakeObject();
+                    setting.Set("Section", s.Section);
+                    setting.Set("Key", s.Key);
+                    setting.Set("Value", s.Value);
+                    settings.Push(setting);
+                }
+
+                JsonValue runs = JsonValue::MakeArray();
+                for (const auto& r : result.Runs) {
+                    JsonValue run = JsonValue::MakeObject();
+                    run.Set("Success", r.Success);
+                    run.Set("WallSeconds", r.WallSeconds);
+                    run.Set("CpuSeconds", r.CpuSeconds);
+                    run.Set("CpuUtilization", r.CpuUtilization);
+                    run.Set("PeakMemoryBytes", r.PeakMemoryBytes);
+                    runs.Push(run);
+                }
+
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("Name", result.Candidate.Name);
+                item.Set("Settings", settings);
+                item.Set("Runs", runs);
+                item.Set("MedianWall", result.MedianWall);
+                item.Set("Spread", result.Spread);
+                item.Set("Stable", result.Stable);
+                item.Set("Rejected", result.Rejected);
+                results.Push(item);
+            }
+
+            JsonValue root = JsonValue::MakeObject();
+            root.Set("Machine", machine);
+            root.Set("Target", report.Target);
+            root.Set("Module", report.Module);
+            root.Set("Timestamp", report.Timestamp);
+            root.Set("Best", report.Best >= 0 ? JsonValue(report.Results[report.Best].Candidate.Name) : JsonValue());
+            root.Set("Results", results);
+
+            fs::path path = GetProfilePath(report.Machine);
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file << root.Dump(2);
+            return static_cast<bool>(file);
+        }
+
+        static std::string FormatReport(const TuningReport& report) {
+            std::string out;
+            char line[256];
+
+            out += "Build settings auto-tune\n";
+            std::snprintf(line, sizeof(line), "  Machine: %s (%s, %d threads, %.0f GB)\n",
+                          report.Machine.Id().c_str(), report.Machine.HostName.c_str(),
+                          report.Machine.LogicalCores, report.Machine.MemoryBytes / 1073741824.0);
+            out += line;
+            out += "  Target:  " + report.Target + (report.Module.empty() ? "" : " (module " + report.Module + ")") + "\n\n";
+
+            for (size_t i = 0; i < report.Results.size(); ++i) {
+                const auto& r = report.Results[i];
+                double cpu = 0.0;
+                for (const auto& run : r.Runs) cpu += run.CpuUtilization;
+                if (!r.Runs.empty()) cpu /= r.Runs.size();
+
+                std::snprintf(line, sizeof(line), "  %s %-32s %8.1f s  +/-%4.1f%%  CPU %3.0f%%  peak %5.1f GB  %s\n",
+                              static_cast<int>(i) == report.Best ? "*" : " ", r.Candidate.Name.c_str(),
+                              r.MedianWall, r.Spread * 100.0, cpu * 100.0, r.PeakMemoryBytes / 1073741824.0,
+                              r.Stable ? "" : ("(" + r.Rejected + ")").c_str());
+                out += line;
+            }
+
+            out += "\n";
+            bool singleRuns = !report.Results.empty() && report.Results[0].Runs.size() < 2;
+            if (report.Best < 0 && singleRuns) out += "One run per configuration can't show which are stable; use --repetitions 2 or more.\n";
+            else if (report.Best < 0) out += "No configuration built reliably; nothing to apply.\n";
+            else if (report.Results[report.Best].Candidate.Settings.empty()) out += "Current settings are already the fastest.\n";
+            else out += "Fastest stable: " + report.Results[report.Best].Candidate.Name + "\n";
+            out += "Results saved to " + StringUtils::PathToUtf8(GetProfilePath(report.Machine)) + "\n";
+            return out;
+        }
+
+    private:
+        // BuildConfiguration.xml.autotune-backup; empty when there was no file to begin with
+        static fs::path BackupPath(const fs::path& configPath) {
+            return fs::path(configPath).concat(".autotune-backup");
+        }
+
+        static bool WriteBackup(const fs::path& configPath, const BuildConfigurationFile& original) {
+            std::ofstream file(BackupPath(configPath), std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            if (original.Existed()) file << original.Text();
+            file.close();
+            return static_cast<bool>(file);
+        }
+
+        // The backup is only removed once the file is back
+        static bool RestoreBackup(const fs::path& configPath) {
+            fs::path backupPath = BackupPath(configPath);
+            std::ifstream backup(backupPath, std::ios::binary);
+            if (!backup.is_open()) return false;
+            std::string text((std::istreambuf_iterator<char>(backup)), std::istreambuf_iterator<char>());
+            backup.close();
+
+            std::error_code ec;
+            if (text.empty()) {
+                fs::remove(configPath, ec);
+                if (ec) return false;
+            }
+            else {
+                BuildConfigurationFile original;
+                original.SetText(text);
+                if (!original.Save(configPath)) return false;
+            }
+            fs::remove(backupPath, ec);
+            return true;
+        }
+
+        static void ApplySettings(BuildConfigurationFile& config, const std::vector<TuningSetting>& settings) {
+            for (const auto& s : settings) {
+                if (s.Value.empty()) config.Remove(s.Section, s.Key);
+                else config.Set(s.Section, s.Key, s.Value);
+            }
+        }
+
+        static void Evaluate(TuningReport& report) {
+            double bestWall = 0.0;
+            for (size_t i = 0; i < report.Results.size(); ++i) {
+                TuningResult& r = report.Results[i];
+                std::vector<double> walls;
+                bool allSucceeded = !r.Runs.empty();
+                for (const auto& run : r.Runs) {
+                    allSucceeded = allSucceeded && run.Success;
+                    walls.push_back(run.WallSeconds);
+                    r.PeakMemoryBytes = (std::max)(r.PeakMemoryBytes, run.PeakMemoryBytes);
+                }
+                if (walls.empty()) continue;
+
+                std::sort(walls.begin(), walls.end());
+                r.MedianWall = walls[walls.size() / 2];
+                if (walls.size() % 2 == 0) r.MedianWall = (r.MedianWall + walls[walls.size() / 2 - 1]) / 2.0;
+                r.Spread = r.MedianWall > 0.0 ? (walls.back() - walls.front()) / r.MedianWall : 0.0;
+
+                if (!allSucceeded) r.Rejected = "build failed";
+                else if (walls.size() < 2) r.Rejected = "one run, unverified";
+                else if (r.Spread > MaxSpread) r.Rejected = "inconsistent timings";
+                else if (report.Machine.MemoryBytes > 0 &&
+                         r.PeakMemoryBytes > report.Machine.MemoryBytes * MaxMemoryFraction) r.Rejected = "memory exhausted";
+                r.Stable = r.Rejected.empty();
+
+                if (r.Stable && (report.Best < 0 || r.MedianWall < bestWall)) {
+                    report.Best = static_cast<int>(i);
+                    bestWall = r.MedianWall;
+                }
+            }
+        }
+
+        // Deletes the module's object files under Intermediate/Build so it recompiles fully
+        static void RemoveModuleObjects(const fs::path& projectRoot, const std::string& module) {
+            std::error_code ec;
+            fs::path moduleName = StringUtils::PathFromUtf8(module);
+            std::vector<fs::path> objects;
+
+            for (fs::recursive_directory_iterator it(projectRoot / "Intermediate" / "Build", ec), end; it != end; it.increment(ec)) {
+                if (ec) break;
+                if (!it->is_regular_file(ec)) continue;
+
+                const fs::path& path = it->path();
+                std::wstring ext = path.extension().wstring();
+                if (ext != L".obj" && ext != L".o") continue;
+                if (path.parent_path().filename() == moduleName) objects.push_back(path);
+            }
+            for (const auto& path : objects) fs::remove(path, ec);
+        }
+
+        static std::string Now() {
+            std::time_t now = std::time(nullptr);
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &now);
+#else
+            localtime_r(&now, &local);
+#endif
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%S", &local);
+            return stamp;
+        }
+    };
+}
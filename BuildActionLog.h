@@ -0,0 +1,298 @@
+#pragma once
+#include "JsonUtils.h"
+#include <string>
+#include <vector>
+#include <queue>
+#include <functional>
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // Turns arbitrary pipe chunks into complete lines ('\n' or "\r\n" terminated).
+    // RunProcess hands us whatever ReadFile returned, which routinely splits lines.
+    class LineSplitter {
+    public:
+        template <typename Fn>
+        void Feed(const char* data, size_t len, Fn onLine) {
+            const char* p = data;
+            const char* end = data + len;
+
+            while (p < end) {
+                const char* nl = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+                if (!nl) {
+                    pending.append(p, static_cast<size_t>(end - p));
+                    break;
+                }
+
+                size_t lineLen = static_cast<size_t>(nl - p);
+                if (pending.empty()) {
+                    if (lineLen > 0 && p[lineLen - 1] == '\r') --lineLen;
+                    onLine(std::string(p, lineLen));
+                }
+                else {
+                    pending.append(p, lineLen);
+                    if (!pending.empty() && pending.back() == '\r') pending.pop_back();
+                    onLine(pending);
+                    pending.clear();
+                }
+                p = nl + 1;
+            }
+        }
+
+        // Emits a trailing line that never got its newline
+        template <typename Fn>
+        void Flush(Fn onLine) {
+            if (pending.empty()) return;
+            if (pending.back() == '\r') pending.pop_back();
+            onLine(pending);
+            pending.clear();
+        }
+
+    private:
+        std::string pending;
+    };
+
+    // One "[n/m] Verb [arch] Item" line from UBT's executor
+    struct BuildAction {
+        int Index = 0;
+        int Total = 0;
+        std::string Verb;          // Compile, Link, Resource, ...
+        std::string Item;          // Module.Foo.1.cpp, UnrealEditor-Foo.dll, ...
+        double StartSeconds = 0.0; // Estimated, see BuildActionLog::Finish
+        double EndSeconds = 0.0;   // When UBT reported the action, relative to build start
+        int Lane = -1;             // Executor slot the action was assigned to
+
+        double Duration() const { return EndSeconds - StartSeconds; }
+    };
+
+    // Records UBT's action lines with arrival timestamps and reconstructs per-action timings.
+    //
+    // UBT prints an action when it *finishes*, so start times are inferred: the executor
+    // runs a fixed number of processes, and each finished action frees a slot that the
+    // next action takes immediately. Replaying completions against a min-heap of slot
+    // free times gives a consistent start for every action, as soon as it is reported.
+    class BuildActionLog {
+    public:
+        using LineListener = std::function<void(const std::string& line, double seconds)>;
+        using ActionListener = std::function<void(const BuildAction& action)>;
+
+        BuildActionLog() : startTime(std::chrono::steady_clock::now()) {}
+
+        // Share a clock with other recorders of the same build (see BuildTrace)
+        explicit BuildActionLog(std::chrono::steady_clock::time_point start) : startTime(start) {}
+
+        // Called for every complete line, and for every action once its timing is known
+        void SetListeners(LineListener onLine, ActionListener onAction) {
+            lineListener = std::move(onLine);
+            actionListener = std::move(onAction);
+        }
+
+        // Feed raw process output (any chunking)
+        void Feed(const std::string& chunk) {
+            double now = Elapsed();
+            splitter.Feed(chunk.data(), chunk.size(), [this, now](const std::string& line) { OnLine(line, now); });
+        }
+
+        // Feed one complete line with an explicit timestamp (seconds since build start)
+        void OnLine(const std::string& line, double seconds) {
+            if (lineListener) lineListener(line, seconds);
+
+            if (executorStart < 0.0 && IsExecutorStartLine(line, parallelism)) {
+                executorStart = seconds;
+                return;
+            }
+
+            BuildAction action;
+            if (ParseActionLine(line, action)) {
+                action.EndSeconds = seconds;
+                AssignStartTime(action);
+                actions.push_back(action);
+                if (actionListener) actionListener(action);
+            }
+        }
+
+        // Call after the process exits
+        void Finish() {
+            splitter.Flush([this](const std::string& line) { OnLine(line, Elapsed()); });
+            totalSeconds = Elapsed();
+            if (!actions.empty()) totalSeconds = (std::max)(totalSeconds, actions.back().EndSeconds);
+        }
+
+        const std::vector<BuildAction>& Actions() const { return actions; }
+        int Parallelism() const { return parallelism; }
+        double ExecutorStart() const { return executorStart < 0.0 ? 0.0 : executorStart; }
+        double TotalSeconds() const { return totalSeconds; }
+
+        // Parses "[12/345] Compile [x64] Module.Foo.1.cpp" (UE5) or "[12/345] Module.Foo.1.cpp" (UE4)
+        static bool ParseActionLine(const std::string& rawLine, BuildAction& out) {
+            size_t p = rawLine.find_first_not_of(" \t");
+            if (p == std::string::npos || rawLine[p] != '[') return false;
+
+            char* afterIndex = nullptr;
+            long index = std::strtol(rawLine.c_str() + p + 1, &afterIndex, 10);
+            if (afterIndex == rawLine.c_str() + p + 1 || *afterIndex != '/') return false;
+
+            char* afterTotal = nullptr;
+            long total = std::strtol(afterIndex + 1, &afterTotal, 10);
+            if (afterTotal == afterIndex + 1 || *afterTotal != ']') return false;
+
+            std::string rest(afterTotal + 1);
+            size_t s = rest.find_first_not_of(' ');
+            if (s == std::string::npos) return false;
+            rest = rest.substr(s);
+
+            out.Index = static_cast<int>(index);
+            out.Total = static_cast<int>(total);
+
+            // "Verb [arch] Item"
+            size_t space = rest.find(' ');
+            if (space != std::string::npos && rest.compare(space, 2, " [") == 0) {
+                size_t close = rest.find("] ", space);
+                if (close != std::string::npos) {
+                    out.Verb = rest.substr(0, space);
+                    out.Item = rest.substr(close + 2);
+                    return true;
+                }
+            }
+
+            // "Verb Item" for the verbs UBT uses without an architecture tag
+            static const char* bareVerbs[] = { "Compile", "Link", "Resource", "Copy", "WriteMetadata", "Lib", "Archive" };
+            for (const char* verb : bareVerbs) {
+                size_t len = std::strlen(verb);
+                if (rest.compare(0, len, verb) == 0 && rest.size() > len && rest[len] == ' ') {
+                    out.Verb = verb;
+                    out.Item = rest.substr(len + 1);
+                    return true;
+                }
+            }
+
+            // UE4 style: just the item
+            out.Item = rest;
+            out.Verb = IsCompileItem(rest) ? "Compile" : "Action";
+            return true;
+        }
+
+        static bool IsCompileItem(const std::string& item) {
+            auto endsWith = [&](const char* ext) {
+                size_t len = std::strlen(ext);
+                return item.size() >= len && item.compare(item.size() - len, len, ext) == 0;
+            };
+            return endsWith(".cpp") || endsWith(".c") || endsWith(".cc") || endsWith(".ispc");
+        }
+
+        // --- Persistence (actions.json inside the build record folder) ---
+        bool Save(const fs::path& path) const {
+            JsonValue root = JsonValue::MakeObject();
+            root.Set("Parallelism", parallelism);
+            root.Set("ExecutorStart", ExecutorStart());
+            root.Set("TotalSeconds", totalSeconds);
+
+            JsonValue list = JsonValue::MakeArray();
+            for (const auto& a : actions) {
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("Index", a.Index);
+                item.Set("Total", a.Total);
+                item.Set("Verb", a.Verb);
+                item.Set("Item", a.Item);
+                item.Set("Start", a.StartSeconds);
+                item.Set("End", a.EndSeconds);
+                item.Set("Lane", a.Lane);
+                list.Push(item);
+            }
+            root.Set("Actions", list);
+
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file << root.Dump(1);
+            return static_cast<bool>(file);
+        }
+
+        bool Load(const fs::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) return false;
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            bool ok = false;
+            JsonValue root = JsonValue::Parse(text, &ok);
+            if (!ok) return false;
+
+            parallelism = static_cast<int>(root["Parallelism"].AsInt(1));
+            executorStart = root["ExecutorStart"].AsNumber();
+            totalSeconds = root["TotalSeconds"].AsNumber();
+            actions.clear();
+            for (const auto& item : root["Actions"].Items()) {
+                BuildAction a;
+                a.Index = static_cast<int>(item["Index"].AsInt());
+                a.Total = static_cast<int>(item["Total"].AsInt());
+                a.Verb = item["Verb"].AsString();
+                a.Item = item["Item"].AsString();
+                a.StartSeconds = item["Start"].AsNumber();
+                a.EndSeconds = item["End"].AsNumber();
+                a.Lane = static_cast<int>(item["Lane"].AsInt(-1));
+                actions.push_back(a);
+            }
+            return true;
+        }
+
+    private:
+        using Slot = std::pair<double, int>; // (free time, lane)
+
+        std::chrono::steady_clock::time_point startTime;
+        LineSplitter splitter;
+        std::vector<BuildAction> actions;
+        int parallelism = 0;
+        double executorStart = -1.0;
+        double totalSeconds = 0.0;
+        std::priority_queue<Slot, std::vector<Slot>, std::greater<Slot>> freeSlots;
+        LineListener lineListener;
+        ActionListener actionListener;
+
+        double Elapsed() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        // "Building 42 actions with 16 processes..." (UE4/early UE5)
+        // "Executing up to 16 processes, one per physical core" (UE5)
+        static bool IsExecutorStartLine(const std::string& line, int& processes) {
+            const char* patterns[] = { " with ", "Executing up to " };
+            for (const char* pattern : patterns) {
+                size_t at = line.find(pattern);
+                if (at == std::string::npos) continue;
+
+                const char* num = line.c_str() + at + std::strlen(pattern);
+                char* after = nullptr;
+                long n = std::strtol(num, &after, 10);
+                if (after != num && n > 0 && std::strncmp(after, " process", 8) == 0) {
+                    processes = static_cast<int>(n);
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void AssignStartTime(BuildAction& action) {
+            if (freeSlots.empty()) {
+                // No executor marker: assume the first finish is instant
+                double begin = executorStart >= 0.0 ? executorStart : action.EndSeconds;
+                if (parallelism <= 0) parallelism = 1;
+                for (int l = 0; l < parallelism; ++l) freeSlots.push({ begin, l });
+            }
+
+            Slot slot = freeSlots.top();
+            freeSlots.pop();
+
+            action.StartSeconds = (std::min)(slot.first, action.EndSeconds);
+            action.Lane = slot.second;
+            freeSlots.push({ action.EndSeconds, slot.second });
+        }
+    };
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <cwchar>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // Everything needed to build one target of a project
+    struct BuildRequest {
+        std::wstring ProjectPath;               // Full path to the .uproject
+        std::wstring Target = L"Editor";        // Game, Editor, Client, Server
+        std::wstring Config = L"Development";   // DebugGame, Development, Shipping
+        std::wstring Platform = HostPlatform(); // Win64, Linux, Mac
+        std::vector<std::wstring> ExtraArgs;    // Appended verbatim, e.g. L"-Clean"
+
+        // The platform this tool runs on, as UBT names it: what both front ends build by default
+        static std::wstring HostPlatform() {
+#ifdef _WIN32
+            return L"Win64";
+#elif defined(__APPLE__)
+            return L"Mac";
+#else
+            return L"Linux";
+#endif
+        }
+    };
+
+    // Single place that turns a BuildRequest into an UnrealBuildTool command line,
+    // shared by the CLI, the GUI and the analysis tools.
+    class BuildCommand {
+    public:
+        // Format: [ProjectName][TargetType]; a pure game target usually matches the project name
+        static std::wstring GetBuildTarget(const BuildRequest& request) {
+            std::wstring projectName = fs::path(request.ProjectPath).stem().wstring();
+            if (request.Target == L"Game") return projectName;
+            return projectName + request.Target;
+        }
+
+        // Format: UnrealBuildTool.exe [Target] [Platform] [Config] -project="Path" ...
+        static std::wstring GetUBTArgs(const BuildRequest& request) {
+            std::wstring args = GetBuildTarget(request) + L" " + request.Platform + L" " + request.Config +
+                L" -project=\"" + request.ProjectPath + L"\"" +
+                L" -waitmutex -progress";
+
+            for (const auto& extra : request.ExtraArgs) args += L" " + extra;
+            return args;
+        }
+
+        // Per-project folder for everything the tool writes (reports, build records)
+        static fs::path GetToolDataDir(const std::wstring& projectPath) {
+            return fs::path(projectPath).parent_path() / "Saved" / "UEBuilder";
+        }
+
+        // Fresh Saved/UEBuilder/Builds/<timestamp> folder for one build's records
+        static fs::path CreateBuildRecordDir(const std::wstring& projectPath) {
+            std::time_t now = std::time(nullptr);
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &now);
+#else
+            localtime_r(&now, &local);
+#endif
+            wchar_t stamp[32];
+            std::wcsftime(stamp, sizeof(stamp) / sizeof(stamp[0]), L"%Y%m%d-%H%M%S", &local);
+
+            fs::path dir = GetToolDataDir(projectPath) / "Builds" / stamp;
+            std::error_code ec;
+            fs::create_directories(dir, ec);
+            return dir;
+        }
+
+        // Most recent build record folder (optionally one that contains the given file),
+        // or empty if the project was never built with the tool
+        static fs::path FindLatestBuildRecordDir(const std::wstring& projectPath, const fs::path& containing = {}) {
+            fs::path buildsDir = GetToolDataDir(projectPath) / "Builds";
+            std::error_code ec;
+            if (!fs::is_directory(buildsDir, ec)) return {};
+
+            std::vector<fs::path> dirs;
+            for (const auto& entry : fs::directory_iterator(buildsDir, ec)) {
+                if (!entry.is_directory(ec)) continue;
+                if (!containing.empty() && !fs::exists(entry.path() / containing, ec)) continue;
+                dirs.push_back(entry.path());
+            }
+            if (dirs.empty()) return {};
+
+            // Timestamped names sort chronologically
+            return *std::max_element(dirs.begin(), dirs.end());
+        }
+    };
+}
@@ -0,0 +1,144 @@
+#pragma once
+#ifdef _WIN32
+#include "ProcessUtils.h"
+#endif
+
+#include <string>
+#include <filesystem>
+#include <fstream>
+#include <cstdlib>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // Reads and edits UnrealBuildTool's BuildConfiguration.xml.
+    //
+    // Only <Section><Key>Value</Key></Section> pairs are touched; everything else in the
+    // file (comments, other sections, formatting) is kept as the user wrote it.
+    class BuildConfigurationFile {
+    public:
+        // Per-user file UBT reads on every build:
+        // %APPDATA%\Unreal Engine\UnrealBuildTool\BuildConfiguration.xml (~/.config/... on Linux/Mac)
+        static fs::path GetUserPath() {
+#ifdef _WIN32
+            fs::path base = ProcessUtils::GetEnvVar(L"APPDATA");
+#else
+            const char* home = std::getenv("HOME");
+            fs::path base = home ? fs::path(home) / ".config" : fs::path();
+#endif
+            if (base.empty()) return {};
+            return base / "Unreal Engine" / "UnrealBuildTool" / "BuildConfiguration.xml";
+        }
+
+        // A missing file is not an error: it starts out as an empty configuration
+        bool Load(const fs::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) {
+                text = EmptyDocument();
+                existed = false;
+                return true;
+            }
+            text.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            existed = true;
+            if (text.find("</Configuration>") == std::string::npos) return false;
+            return true;
+        }
+
+        bool Save(const fs::path& path) const {
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file << text;
+            return static_cast<bool>(file);
+        }
+
+        bool Existed() const { return existed; }
+        const std::string& Text() const { return text; }
+        void SetText(const std::string& newText) { text = newText; }
+
+        // Empty when the key is not set
+        std::string Get(const std::string& section, const std::string& key) const {
+            size_t begin, end;
+            if (!FindSection(section, begin, end)) return "";
+
+            size_t valueBegin, valueEnd;
+            if (!FindKey(key, begin, end, valueBegin, valueEnd)) return "";
+            return text.substr(valueBegin, valueEnd - valueBegin);
+        }
+
+        void Set(const std::string& section, const std::string& key, const std::string& value) {
+            size_t begin, end;
+            if (!FindSection(section, begin, end)) {
+                // New section just before </Configuration>
+                size_t close = text.rfind("</Configuration>");
+                if (close == std::string::npos) return;
+                text.insert(close, "  <" + section + ">\n  </" + section + ">\n");
+                FindSection(section, begin, end);
+            }
+
+            size_t valueBegin, valueEnd;
+            if (FindKey(key, begin, end, valueBegin, valueEnd)) {
+                text.replace(valueBegin, valueEnd - valueBegin, value);
+                return;
+            }
+
+            // end points at "</Section>"; indent to match the closing tag's line
+            size_t lineStart = text.rfind('\n', end);
+            lineStart = (lineStart == std::string::npos) ? 0 : lineStart + 1;
+            std::string indent = text.substr(lineStart, end - lineStart);
+            if (indent.find_first_not_of(" \t") != std::string::npos) indent.clear();
+
+            text.insert(end, "  <" + key + ">" + value + "</" + key + ">\n" + indent);
+        }
+
+        void Remove(const std::string& section, const std::string& key) {
+            size_t begin, end;
+            if (!FindSection(section, begin, end)) return;
+
+            size_t valueBegin, valueEnd;
+            if (!FindKey(key, begin, end, valueBegin, valueEnd)) return;
+
+            size_t elementBegin = text.rfind("<" + key, valueBegin);
+            size_t elementEnd = valueEnd + key.size() + 3; // "</Key>"
+
+            // Take the whole line when the element is alone on it
+            size_t lineStart = text.rfind('\n', elementBegin);
+            lineStart = (lineStart == std::string::npos) ? 0 : lineStart + 1;
+            if (text.find_first_not_of(" \t", lineStart) == elementBegin && elementEnd < text.size() && text[elementEnd] == '\n') {
+                elementBegin = lineStart;
+                ++elementEnd;
+            }
+            text.erase(elementBegin, elementEnd - elementBegin);
+        }
+
+    private:
+        std::string text;
+        bool existed = false;
+
+        static std::string EmptyDocument() {
+            return "<?xml version=\"1.0\" encoding=\"utf-8\" ?>\n"
+                   "<Configuration xmlns=\"https://www.unrealengine.com/BuildConfiguration\">\n"
+                   "</Configuration>\n";
+        }
+
+        // [begin, end) is the section's content between <Section> and </Section>
+        bool FindSection(const std::string& section, size_t& begin, size_t& end) const {
+            size_t open = text.find("<" + section + ">");
+            if (open == std::string::npos) return false;
+            begin = open + section.size() + 2;
+            end = text.find("</" + section + ">", begin);
+            return end != std::string::npos;
+        }
+
+        bool FindKey(const std::string& key, size_t begin, size_t end, size_t& valueBegin, size_t& valueEnd) const {
+            std::string open = "<" + key + ">";
+            size_t at = text.find(open, begin);
+            if (at == std::string::npos || at >= end) return false;
+            valueBegin = at + open.size();
+            valueEnd = text.find("</" + key + ">", valueBegin);
+            return valueEnd != std::string::npos && valueEnd <= end;
+        }
+    };
+}
@@ -0,0 +1,240 @@
+#pragma once
+#include "JsonUtils.h"
+#include "LogClassifier.h"
+#include "BuildActionLog.h"
+#include <string>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+
+namespace UEBuilder {
+
+    // Fields of one event, appended straight into the event's line
+    class EventFields {
+    public:
+        explicit EventFields(std::string& line) : line(line) {}
+
+        EventFields& Str(const char* name, const std::string& value) {
+            Name(name);
+            JsonValue::AppendEscaped(line, value);
+            return *this;
+        }
+
+        EventFields& Num(const char* name, double value) {
+            Name(name);
+            JsonValue::AppendNumber(line, value);
+            return *this;
+        }
+
+        EventFields& Int(const char* name, long long value) {
+            Name(name);
+            char digits[24];
+            int n = std::snprintf(digits, sizeof(digits), "%lld", value);
+            line.append(digits, static_cast<size_t>(n));
+            return *this;
+        }
+
+        EventFields& Bool(const char* name, bool value) {
+            Name(name);
+            line += value ? "true" : "false";
+            return *this;
+        }
+
+        // Seconds with millisecond precision; keeps timestamps short
+        EventFields& Seconds(const char* name, double seconds) {
+            Name(name);
+            char digits[32];
+            int n = std::snprintf(digits, sizeof(digits), "%.3f", seconds);
+            line.append(digits, static_cast<size_t>(n));
+            return *this;
+        }
+
+    private:
+        std::string& line;
+
+        void Name(const char* name) {
+            line += ",\"";
+            line += name;
+            line += "\":";
+        }
+    };
+
+    // Newline-delimited JSON: one compact object per line, each starting with
+    //   {"t":<seconds since start>,"event":"<type>", ...
+    // Lines are built in a reused per-thread buffer and collected into one output buffer that
+    // goes out in large writes (when 16 KB have built up, when the oldest unwritten event is
+    // 100 ms old, or when an event asks for it), so a noisy build costs a few syscalls per second
+    // rather than one per line. A small flusher thread handles the age limit, so events still go
+    // out while the build is quiet (a long link). Safe to emit from any thread. Does nothing
+    // until opened.
+    class EventStream {
+    public:
+        EventStream() : startTime(std::chrono::steady_clock::now()), pendingSince(startTime) {}
+
+        ~EventStream() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopping = true;
+            }
+            wake.notify_one();
+            if (flusher.joinable()) flusher.join();
+            Flush();
+        }
+
+        EventStream(const EventStream&) = delete;
+        EventStream& operator=(const EventStream&) = delete;
+
+        void Open(std::FILE* destination) {
+            std::lock_guard<std::mutex> lock(mutex);
+            out = destination;
+            pending.reserve(FlushBytes * 2);
+            if (!flusher.joinable()) flusher = std::thread([this]() { FlushLoop(); });
+        }
+
+        bool Enabled() const { return out != nullptr; }
+
+        double Now() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        // fill(EventFields&) adds the event's fields
+        template <typename Fn>
+        void Emit(const char* type, Fn&& fill, bool flushNow = false) {
+            if (!out) return;
+
+            thread_local std::string line;
+            line.clear();
+            char head[48];
+            int n = std::snprintf(head, sizeof(head), "{\"t\":%.3f,\"event\":\"", Now());
+            line.append(head, static_cast<size_t>(n));
+            line += type;
+            line += '"';
+            EventFields fields(line);
+            fill(fields);
+            line += "}\n";
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = std::chrono::steady_clock::now();
+            bool first = pending.empty();
+            if (first) pendingSince = now;
+            pending += line;
+            if (flushNow || pending.size() >= FlushBytes || now - pendingSince >= FlushInterval) WriteLocked();
+            else if (first) wake.notify_one();  // The flusher starts timing this one
+        }
+
+        void Emit(const char* type, bool flushNow = false) {
+            Emit(type, [](EventFields&) {}, flushNow);
+        }
+
+        void Flush() {
+            std::lock_guard<std::mutex> lock(mutex);
+            WriteLocked();
+        }
+
+    private:
+        static constexpr size_t FlushBytes = 16 * 1024;
+        static constexpr std::chrono::milliseconds FlushInterval{ 100 };
+
+        std::FILE* out = nullptr;
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::string pending;
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point pendingSince;    // When the oldest unwritten event came in
+        bool stopping = false;
+        std::thread flusher;
+
+        // Writes whatever has waited FlushInterval, however long the build stays quiet
+        void FlushLoop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopping) {
+                if (pending.empty()) wake.wait(lock);
+                else if (std::chrono::steady_clock::now() - pendingSince >= FlushInterval) WriteLocked();
+                else wake.wait_until(lock, pendingSince + FlushInterval);
+            }
+        }
+
+        void WriteLocked() {
+            if (!out || pending.empty()) return;
+            std::fwrite(pending.data(), 1, pending.size(), out);
+            std::fflush(out);
+            pending.clear();
+        }
+    };
+
+    // Turns one build's output into events: every compiler/linker diagnostic, every action
+    // with its reconstructed timing, and progress whenever the completed percentage moves.
+    // Feed it from a BuildActionLog's listeners.
+    class BuildEventReporter {
+    public:
+        explicit BuildEventReporter(EventStream& events) : events(events) {}
+
+        void OnLine(const std::string& line, double /*seconds*/) {
+            if (!events.Enabled()) return;
+
+            // UBT -progress markers: "@progress 'Generating code...' 40%"
+            if (line.compare(0, 10, "@progress ") == 0) {
+                size_t percent = line.rfind('%');
+                size_t quote = line.find('\'');
+                if (percent != std::string::npos && quote != std::string::npos) {
+                    size_t close = line.find('\'', quote + 1);
+                    size_t digits = line.find_last_not_of("0123456789", percent - 1);
+                    if (close != std::string::npos && digits != std::string::npos && digits + 1 < percent) {
+                        std::string phase = line.substr(quote + 1, close - quote - 1);
+                        long long value = std::atoll(line.c_str() + digits + 1);
+                        events.Emit("progress", [&](EventFields& f) { f.Str("phase", phase).Int("percent", value); });
+                    }
+                }
+                return;
+            }
+
+            LogDiagnostic diagnostic;
+            if (!LogClassifier::ParseDiagnostic(line, diagnostic)) return;
+            if (diagnostic.Severity == "error") ++errors;
+            else ++warnings;
+
+            events.Emit("diagnostic", [&](EventFields& f) {
+                f.Str("severity", diagnostic.Severity).Str("file", diagnostic.File);
+                if (diagnostic.Line > 0) f.Int("line", diagnostic.Line);
+                if (diagnostic.Column > 0) f.Int("column", diagnostic.Column);
+                if (!diagnostic.Code.empty()) f.Str("code", diagnostic.Code);
+                f.Str("message", diagnostic.Message);
+            }, diagnostic.Severity == "error");
+        }
+
+        void OnAction(const BuildAction& action) {
+            ++actions;
+            if (!events.Enabled()) return;
+
+            events.Emit("action", [&](EventFields& f) {
+                f.Int("index", action.Index).Int("total", action.Total).Str("verb", action.Verb).Str("item", action.Item)
+                 .Seconds("start", action.StartSeconds).Seconds("end", action.EndSeconds).Int("lane", action.Lane);
+            });
+
+            if (action.Total > 0) {
+                int percent = static_cast<int>(static_cast<int64_t>(action.Index) * 100 / action.Total);
+                if (percent != lastPercent) {
+                    lastPercent = percent;
+                    events.Emit("progress", [&](EventFields& f) {
+                        f.Str("phase", "Executor").Int("percent", percent).Int("completed", action.Index).Int("total", action.Total);
+                    });
+                }
+            }
+        }
+
+        int Actions() const { return actions; }
+        int Errors() const { return errors; }
+        int Warnings() const { return warnings; }
+
+    private:
+        EventStream& events;
+        int actions = 0;
+        int errors = 0;
+        int warnings = 0;
+        int lastPercent = -1;
+    };
+}
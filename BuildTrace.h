@@ -0,0 +1,309 @@
+#pragma once
+#include "BuildActionLog.h"
+#include "JsonUtils.h"
+#include "Profiler.h"
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <cstdio>
+#include <chrono>
+#include <mutex>
+#include <functional>
+#include <fstream>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // Streams Chrome trace_event JSON (the "JSON Array Format") to disk.
+    //
+    // Events are appended as they happen and flushed every few lines; the closing ']' is
+    // optional in this format, so a trace of a crashed or killed build still loads in
+    // chrome://tracing and ui.perfetto.dev.
+    class TraceWriter {
+    public:
+        TraceWriter() = default;
+        ~TraceWriter() { Close(); }
+
+        TraceWriter(const TraceWriter&) = delete;
+        TraceWriter& operator=(const TraceWriter&) = delete;
+
+        bool Open(const fs::path& path) {
+            Close();
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+#ifdef _WIN32
+            if (_wfopen_s(&file, path.c_str(), L"wb") != 0) file = nullptr;
+#else
+            file = std::fopen(path.c_str(), "wb");
+#endif
+            if (!file) return false;
+            std::fputs("[\n", file);
+            first = true;
+            return true;
+        }
+
+        bool IsOpen() const { return file != nullptr; }
+
+        void Close() {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!file) return;
+            std::fputs("\n]\n", file);
+            std::fclose(file);
+            file = nullptr;
+        }
+
+        // "X" event: a span whose start and duration are both known
+        void Complete(const std::string& name, const std::string& category, double startSeconds, double durationSeconds,
+                      int pid, int tid, const JsonValue& args = JsonValue()) {
+            std::string event = Header(name, category, 'X', startSeconds, pid, tid);
+            event += ",\"dur\":";
+            JsonValue::AppendNumber(event, Micros(durationSeconds));
+            Finish(event, args);
+        }
+
+        // "i" event: a point in time, e.g. an error line
+        void Instant(const std::string& name, const std::string& category, double seconds, int pid, int tid,
+                     const JsonValue& args = JsonValue()) {
+            std::string event = Header(name, category, 'i', seconds, pid, tid);
+            event += ",\"s\":\"t\"";
+            Finish(event, args);
+        }
+
+        // "C" event: one or more values plotted as a counter track
+        void Counter(const std::string& name, double seconds, int pid, const JsonValue& values) {
+            std::string event = Header(name, "counter", 'C', seconds, pid, 0);
+            Finish(event, values);
+        }
+
+        // Names shown for process and thread tracks
+        void ProcessName(int pid, const std::string& name) { Metadata("process_name", pid, 0, name); }
+        void ThreadName(int pid, int tid, const std::string& name) { Metadata("thread_name", pid, tid, name); }
+
+    private:
+        std::FILE* file = nullptr;
+        std::mutex mutex;
+        bool first = true;
+        int pending = 0;
+
+        static double Micros(double seconds) { return seconds < 0.0 ? 0.0 : static_cast<double>(static_cast<int64_t>(seconds * 1e6)); }
+
+        static std::string Header(const std::string& name, const std::string& category, char phase, double seconds, int pid, int tid) {
+            std::string event = "{\"name\":";
+            JsonValue::AppendEscaped(event, name);
+            event += ",\"cat\":";
+            JsonValue::AppendEscaped(event, category);
+            event += ",\"ph\":\"";
+            event += phase;
+            event += "\",\"ts\":";
+            JsonValue::AppendNumber(event, Micros(seconds));
+            event += ",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid);
+            return event;
+        }
+
+        void Metadata(const char* kind, int pid, int tid, const std::string& name) {
+            std::string event = "{\"name\":\"";
+            event += kind;
+            event += "\",\"ph\":\"M\",\"pid\":" + std::to_string(pid) + ",\"tid\":" + std::to_string(tid);
+            JsonValue args = JsonValue::MakeObject();
+            args.Set("name", name);
+            Finish(event, args);
+        }
+
+        void Finish(std::string& event, const JsonValue& args) {
+            if (args.IsObject() && args.Size() > 0) {
+                event += ",\"args\":";
+                event += args.Dump();
+            }
+            event += '}';
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!file) return;
+            if (!first) std::fputs(",\n", file);
+            first = false;
+            std::fwrite(event.data(), 1, event.size(), file);
+
+            // Keep the file current for anyone watching, without a syscall per action
+            if (++pending >= 32) {
+                std::fflush(file);
+                pending = 0;
+            }
+        }
+    };
+
+    // Timeline of one build as a Chrome/Perfetto trace:
+    //   "UnrealBuildTool" process - UBT phases on the first track, one track per executor slot
+    //                               with every compile/link action placed where it ran
+    //   "UEBuilder" process       - the tool's own stages (prebuilt check, UBT run, records)
+    //
+    // Idle executor slots and serialized link steps show up as gaps and lone bars.
+    class BuildTrace {
+    public:
+        static constexpr int UbtPid = 1;
+        static constexpr int ToolPid = 2;
+
+        // Marks a tool stage for as long as it lives
+        class ScopedStage {
+        public:
+            ScopedStage(BuildTrace& trace, std::string name) : trace(&trace), name(std::move(name)), start(trace.Now()) {
+                if (trace.stageListener) trace.stageListener(this->name, true, start);
+            }
+            ScopedStage(ScopedStage&& other) noexcept : trace(other.trace), name(std::move(other.name)), start(other.start) { other.trace = nullptr; }
+            ~ScopedStage() {
+                if (!trace) return;
+                double end = trace->Now();
+                trace->writer.Complete(name, "tool", start, end - start, ToolPid, 1);
+                if (trace->stageListener) trace->stageListener(name, false, end);
+            }
+
+            ScopedStage(const ScopedStage&) = delete;
+            ScopedStage& operator=(const ScopedStage&) = delete;
+            ScopedStage& operator=(ScopedStage&&) = delete;
+
+        private:
+            BuildTrace* trace;
+            std::string name;
+            double start;
+        };
+
+        // Told when a stage starts (started = true) and ends, with the trace's timestamp
+        using StageListener = std::function<void(const std::string& name, bool started, double seconds)>;
+
+        BuildTrace() : startTime(std::chrono::steady_clock::now()) {}
+        ~BuildTrace() { Close(); }
+
+        bool Open(const fs::path& path) {
+            if (!writer.Open(path)) return false;
+            writer.ProcessName(UbtPid, "UnrealBuildTool");
+            writer.ThreadName(UbtPid, 0, "Phases");
+            writer.ProcessName(ToolPid, "UEBuilder");
+            writer.ThreadName(ToolPid, 1, "Stages");
+            return true;
+        }
+
+        // Same clock as the trace; pass to BuildActionLog so both agree on timestamps
+        std::chrono::steady_clock::time_point StartTime() const { return startTime; }
+
+        double Now() const {
+            return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        }
+
+        ScopedStage Stage(const std::string& name) { return ScopedStage(*this, name); }
+
+        void SetStageListener(StageListener listener) { stageListener = std::move(listener); }
+
+        // Routes a BuildActionLog's lines and actions into the trace
+        void Attach(BuildActionLog& log) {
+            log.SetListeners(
+                [this](const std::string& line, double seconds) { OnLine(line, seconds); },
+                [this](const BuildAction& action) { OnAction(action); });
+        }
+
+        void OnLine(const std::string& line, double seconds) {
+            if (!writer.IsOpen()) return;
+
+            const char* phase = MatchPhase(line);
+            if (phase) {
+                EndPhase(seconds);
+                if (*phase) {
+                    phaseName = phase;
+                    phaseStart = seconds;
+                }
+            }
+
+            if (line.find(": error") != std::string::npos || line.find(": fatal error") != std::string::npos) {
+                JsonValue args = JsonValue::MakeObject();
+                args.Set("line", line);
+                writer.Instant("error", "diagnostic", seconds, UbtPid, 0, args);
+            }
+        }
+
+        void OnAction(const BuildAction& action) {
+            if (!writer.IsOpen()) return;
+
+            int tid = action.Lane + 1;
+            if (tid > lanesNamed) {
+                for (int l = lanesNamed + 1; l <= tid; ++l) writer.ThreadName(UbtPid, l, "Executor slot " + std::to_string(l));
+                lanesNamed = tid;
+            }
+
+            JsonValue args = JsonValue::MakeObject();
+            args.Set("index", action.Index);
+            args.Set("total", action.Total);
+            writer.Complete(action.Item.empty() ? action.Verb : action.Item, action.Verb,
+                            action.StartSeconds, action.Duration(), UbtPid, tid, args);
+
+            ++completed;
+            JsonValue progress = JsonValue::MakeObject();
+            progress.Set("completed", completed);
+            writer.Counter("Actions", action.EndSeconds, UbtPid, progress);
+        }
+
+        void Close() {
+            if (!writer.IsOpen()) return;
+            EndPhase(Now());
+            writer.Close();
+        }
+
+        // The tool's own timings (Profiler.h) since sinceNs, next to the build's trace:
+        // profile.json with one track per thread, and Profile.txt with the total per span
+        static bool SaveProfile(const fs::path& recordDir, int64_t sinceNs) {
+            ProfileSnapshot snapshot = Profiler::Collect(sinceNs);
+
+            TraceWriter profile;
+            if (!profile.Open(recordDir / "profile.json")) return false;
+            profile.ProcessName(ToolPid, "UEBuilder");
+            for (size_t t = 0; t < snapshot.Threads.size(); ++t) {
+                profile.ThreadName(ToolPid, static_cast<int>(t) + 1, snapshot.Threads[t]);
+            }
+            for (const auto& span : snapshot.Spans) {
+                profile.Complete(span.Name, "tool", (span.StartNs - sinceNs) / 1e9, span.Seconds(), ToolPid,
+                                 static_cast<int>(span.Thread) + 1);
+            }
+            profile.Close();
+
+            std::ofstream file(recordDir / "Profile.txt", std::ios::binary | std::ios::trunc);
+            file << snapshot.FormatBreakdown();
+            return file.good();
+        }
+
+    private:
+        TraceWriter writer;
+        StageListener stageListener;
+        std::chrono::steady_clock::time_point startTime;
+        std::string phaseName;
+        double phaseStart = 0.0;
+        int lanesNamed = 0;
+        int completed = 0;
+
+        void EndPhase(double seconds) {
+            if (phaseName.empty()) return;
+            writer.Complete(phaseName, "phase", phaseStart, seconds - phaseStart, UbtPid, 0);
+            phaseName.clear();
+        }
+
+        // Lines that start a UBT phase; "" ends the current one without starting another
+        static const char* MatchPhase(const std::string& line) {
+            static const struct { const char* Marker; const char* Phase; } markers[] = {
+                { "Log file:", "Setup" },
+                { "Creating makefile for", "Makefile" },
+                { "Parsing headers for", "Header scan (UHT)" },
+                { "Determining max actions", "Executor setup" },
+                { "Building ", "Executor" },          // "Building 42 actions with 16 processes..."
+                { "Executing up to ", "Executor" },
+                { "Total time in ", "Finalize" },      // "Total time in Parallel executor: ..."
+                { "Total execution time", "" },
+            };
+
+            for (const auto& m : markers) {
+                size_t at = line.find(m.Marker);
+                if (at == std::string::npos) continue;
+
+                // "Building X..." also names targets; only the executor line counts
+                if (std::string(m.Marker) == "Building " && line.find(" actions with ", at) == std::string::npos) continue;
+                return m.Phase;
+            }
+            return nullptr;
+        }
+    };
+}
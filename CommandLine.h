@@ -0,0 +1,296 @@
+#pragma once
+#include "StringUtils.h"
+#include "BuildCommand.h"
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cwchar>
+#include <cstdlib>
+
+namespace UEBuilder {
+
+    // Process exit codes of the CLI; stable so scripts and orchestrators can branch on them
+    enum class ExitCode : int {
+        Success = 0,
+        BuildFailed = 1,        // UBT ran and failed (or the clean before it did)
+        UsageError = 2,         // Bad or missing arguments
+        ProjectNotFound = 3,    // No .uproject at --project
+        EngineNotFound = 4,     // No usable engine for the project's EngineAssociation
+        ToolchainMissing = 5,   // No compiler and --install-toolchain not given
+        OperationFailed = 6,    // publish / unity-advice / auto-tune could not complete
+    };
+
+    enum class CliCommand {
+        Build,
+        Publish,
+        IncludeReport,
+        UnityAdvice,
+        AutoTune,
+        Pipeline,
+        CriticalPath,
+        Projects,
+        Download,
+        Help,
+    };
+
+    // Machine-readable progress on stdout (human-readable output moves to stderr)
+    enum class EventFormat {
+        None,
+        Ndjson,     // One JSON object per line, see BuildEvents.h
+    };
+
+    struct CliOptions {
+        CliCommand Command = CliCommand::Build;
+        std::wstring Project;                   // Folder or .uproject
+        std::wstring Target = L"Editor";
+        std::wstring Config = L"Development";
+        std::wstring Platform = BuildRequest::HostPlatform();
+        std::wstring EngineRoot;                // Skips engine detection when set
+        int Jobs = 0;                           // 0 = let UBT decide
+        bool Clean = false;                     // UBT -Clean before building
+        bool InstallToolchain = false;          // Allowed to install MSVC Build Tools if missing
+        bool CriticalPath = false;              // build: export UBT's action graph and analyse it afterwards
+        std::wstring PublishTo;                 // publish: shared folder (else UEBUILDER_PREBUILT_SOURCE)
+        std::string Module;                     // auto-tune: module to rebuild per trial
+        int Repetitions = 2;                    // auto-tune
+        bool Apply = false;                     // auto-tune: write the winner to BuildConfiguration.xml
+        std::wstring PipelineFile;              // pipeline: stages as JSON, see Pipeline.h
+        bool Force = false;                     // pipeline: rerun stages whose inputs are unchanged; projects: rescan everything
+        std::vector<std::wstring> Workspace;    // projects: roots to add to the index (repeatable)
+        std::string Url;                        // download: what to fetch
+        std::wstring DownloadTo;                // download: destination file
+        std::string Sha256;                     // download: expected digest, verified before the file appears
+        int Connections = 4;                    // download: parallel range requests
+        EventFormat Events = EventFormat::None;
+        std::string Metrics;                    // "[address:]port" to serve Prometheus metrics on [UEBUILDER_METRICS]
+        std::vector<std::wstring> UBTArgs;      // Everything after "--", passed to UBT verbatim
+    };
+
+    // Parses the CLI's arguments. There is no interactive fallback anywhere: whatever is
+    // missing either has a default or is a usage error.
+    //
+    //   UEBuilder [build|publish|include-report|unity-advice|auto-tune|pipeline|critical-path] --project <path> [options] [-- <UBT args>]
+    //   UEBuilder download --url <url> --to <file> [--sha256 <hex>] [--connections <n>]
+    //   UEBuilder projects [--workspace <folder>]... [--force]
+    //
+    // Values can be given as "--name value" or "--name=value".
+    class CommandLine {
+    public:
+        static bool Parse(const std::vector<std::wstring>& args, CliOptions& options, std::wstring& error) {
+            size_t i = 0;
+            if (!args.empty() && !args[0].empty() && args[0][0] != L'-') {
+                if (!ParseCommand(args[0], options.Command)) {
+                    error = L"Unknown command '" + args[0] + L"'";
+                    return false;
+                }
+                ++i;
+            }
+
+            for (; i < args.size(); ++i) {
+                std::wstring name = args[i];
+                std::wstring value;
+                bool hasValue = false;
+
+                if (name == L"--") {
+                    options.UBTArgs.assign(args.begin() + static_cast<std::ptrdiff_t>(i) + 1, args.end());
+                    break;
+                }
+
+                size_t eq = name.find(L'=');
+                if (name.compare(0, 2, L"--") == 0 && eq != std::wstring::npos) {
+                    value = name.substr(eq + 1);
+                    name = name.substr(0, eq);
+                    hasValue = true;
+                }
+
+                // Takes the value from "=value" or the next argument
+                auto take = [&](std::wstring& out) {
+                    if (!hasValue) {
+                        if (i + 1 >= args.size()) {
+                            error = name + L" needs a value";
+                            return false;
+                        }
+                        value = args[++i];
+                    }
+                    out = value;
+                    return true;
+                };
+                auto takeInt = [&](int& out, int minimum) {
+                    std::wstring text;
+                    if (!take(text)) return false;
+                    wchar_t* end = nullptr;
+                    long n = std::wcstol(text.c_str(), &end, 10);
+                    if (text.empty() || *end != L'\0' || n < minimum || n > 100000) {
+                        error = name + L" expects a whole number >= " + std::to_wstring(minimum);
+                        return false;
+                    }
+                    out = static_cast<int>(n);
+                    return true;
+                };
+                auto flag = [&](bool& out) {
+                    if (hasValue) {
+                        error = name + L" takes no value";
+                        return false;
+                    }
+                    out = true;
+                    return true;
+                };
+
+                bool ok = true;
+                bool ignored = false;
+                std::wstring module;
+                std::wstring text;
+                if (name == L"--help" || name == L"-h" || name == L"/?") options.Command = CliCommand::Help;
+                else if (name == L"--project") ok = take(options.Project);
+                else if (name == L"--target") ok = take(options.Target) && OneOf(name, options.Target, { L"Editor", L"Game", L"Client", L"Server" }, error);
+                else if (name == L"--config") ok = take(options.Config) && OneOf(name, options.Config, { L"Debug", L"DebugGame", L"Development", L"Test", L"Shipping" }, error);
+                else if (name == L"--platform") ok = take(options.Platform);
+                else if (name == L"--engine-root") ok = take(options.EngineRoot);
+                else if (name == L"--jobs") ok = takeInt(options.Jobs, 1);
+                else if (name == L"--clean") ok = flag(options.Clean);
+                else if (name == L"--no-prompt") ok = flag(ignored); // Never prompts; accepted for scripts that pass it
+                else if (name == L"--install-toolchain") ok = flag(options.InstallToolchain);
+                else if (name == L"--critical-path") ok = flag(options.CriticalPath);
+                else if (name == L"--publish-to") ok = take(options.PublishTo);
+                else if (name == L"--module") { ok = take(module); options.Module = StringUtils::ToUtf8(module); }
+                else if (name == L"--repetitions") ok = takeInt(options.Repetitions, 1);
+                else if (name == L"--apply") ok = flag(options.Apply);
+                else if (name == L"--pipeline") ok = take(options.PipelineFile);
+                else if (name == L"--force") ok = flag(options.Force);
+                else if (name == L"--workspace") { ok = take(text); options.Workspace.push_back(text); }
+                else if (name == L"--url") { ok = take(text); options.Url = StringUtils::ToUtf8(text); }
+                else if (name == L"--to") ok = take(options.DownloadTo);
+                else if (name == L"--sha256") { ok = take(text); options.Sha256 = StringUtils::ToUtf8(text); }
+                else if (name == L"--connections") ok = takeInt(options.Connections, 1);
+                else if (name == L"--metrics") { ok = take(text); options.Metrics = StringUtils::ToUtf8(text); }
+                else if (name == L"--events") {
+                    std::wstring format;
+                    ok = take(format) && OneOf(name, format, { L"ndjson" }, error);
+                    if (ok) options.Events = EventFormat::Ndjson;
+                }
+                else {
+                    error = L"Unknown option '" + args[i] + L"'";
+                    return false;
+                }
+                if (!ok) return false;
+            }
+
+            if (options.Command == CliCommand::Download) {
+                if (options.Url.empty() || options.DownloadTo.empty()) {
+                    error = L"download needs --url <url> and --to <file>";
+                    return false;
+                }
+                return true;
+            }
+            if (options.Command != CliCommand::Help && options.Command != CliCommand::Projects && options.Project.empty()) {
+                error = L"--project is required";
+                return false;
+            }
+            if (options.Command == CliCommand::Pipeline && options.PipelineFile.empty()) {
+                error = L"pipeline needs --pipeline <file.json>";
+                return false;
+            }
+            return true;
+        }
+
+        static const char* Usage() {
+            return
+                "Usage: UEBuilder [command] --project <folder|.uproject> [options] [-- <extra UBT args>]\n"
+                "\n"
+                "Commands:\n"
+                "  build            Build the target (default)\n"
+                "  publish          Publish Binaries/ as prebuilts for this revision\n"
+                "  include-report   Rank headers by rebuild cost\n"
+                "  unity-advice     Suggest unity groupings from the last recorded build\n"
+                "  auto-tune        Find the fastest stable executor settings for this machine\n"
+                "  pipeline         Run the stages of a pipeline file, in parallel where possible\n"
+                "  critical-path    Critical path of the last build made with --critical-path\n"
+                "  projects         Index every project under the workspace roots and list them (no --project)\n"
+                "  download         Fetch --url to --to over parallel, resumable range requests (no --project)\n"
+                "\n"
+                "Options:\n"
+                "  --project <path>       Project folder or .uproject, or an indexed project's name (required)\n"
+                "  --target <name>        Editor, Game, Client, Server          [Editor]\n"
+                "  --config <name>        Debug, DebugGame, Development, Test, Shipping [Development]\n"
+                "  --platform <name>      UBT platform                          [host]\n"
+                "  --engine-root <path>   Engine to use instead of detecting it\n"
+                "  --jobs <n>             Parallel actions (UBT -MaxParallelActions)\n"
+                "  --clean                Clean the target before building\n"
+                "  --install-toolchain    Install MSVC Build Tools if missing\n"
+                "  --critical-path        Export UBT's action graph and report the critical path\n"
+                "  --no-prompt            Accepted for compatibility; the CLI never prompts\n"
+                "  --publish-to <path>    publish: shared folder [UEBUILDER_PREBUILT_SOURCE]\n"
+                "  --module <name>        auto-tune: module rebuilt per trial [whole target]\n"
+                "  --repetitions <n>      auto-tune: runs per configuration   [2]\n"
+                "  --apply                auto-tune: write the winner to BuildConfiguration.xml\n"
+                "  --pipeline <file>      pipeline: the stages, as JSON\n"
+                "  --force                pipeline: also run stages whose inputs are unchanged;\n"
+                "                         projects: list every folder and read every project again\n"
+                "  --workspace <folder>   projects: add a workspace root (repeatable) [UEBUILDER_WORKSPACE]\n"
+                "  --url <url>            download: http:// (https:// on Windows, else via curl)\n"
+                "  --to <file>            download: destination; <file>.part holds a partial download\n"
+                "  --sha256 <hex>         download: expected SHA-256 of the file\n"
+                "  --connections <n>      download: parallel connections       [4]\n"
+                "  --events=ndjson        JSON events on stdout, one per line; other output to stderr\n"
+                "  --metrics <addr:port>  Serve Prometheus metrics while running (port alone = localhost)\n"
+                "  --help                 Show this text\n"
+                "\n"
+                "Exit codes: 0 success, 1 build failed, 2 usage error, 3 project not found,\n"
+                "            4 engine not found, 5 toolchain missing, 6 operation failed\n";
+        }
+
+        static const char* CommandName(CliCommand command) {
+            switch (command) {
+            case CliCommand::Build: return "build";
+            case CliCommand::Publish: return "publish";
+            case CliCommand::IncludeReport: return "include-report";
+            case CliCommand::UnityAdvice: return "unity-advice";
+            case CliCommand::AutoTune: return "auto-tune";
+            case CliCommand::Pipeline: return "pipeline";
+            case CliCommand::CriticalPath: return "critical-path";
+            case CliCommand::Projects: return "projects";
+            case CliCommand::Download: return "download";
+            default: return "help";
+            }
+        }
+
+        static const char* ExitCodeName(ExitCode code) {
+            switch (code) {
+            case ExitCode::Success: return "success";
+            case ExitCode::BuildFailed: return "build_failed";
+            case ExitCode::UsageError: return "usage_error";
+            case ExitCode::ProjectNotFound: return "project_not_found";
+            case ExitCode::EngineNotFound: return "engine_not_found";
+            case ExitCode::ToolchainMissing: return "toolchain_missing";
+            case ExitCode::OperationFailed: return "operation_failed";
+            }
+            return "unknown";
+        }
+
+    private:
+        static bool ParseCommand(const std::wstring& word, CliCommand& command) {
+            if (word == L"build") command = CliCommand::Build;
+            else if (word == L"publish") command = CliCommand::Publish;
+            else if (word == L"include-report") command = CliCommand::IncludeReport;
+            else if (word == L"unity-advice") command = CliCommand::UnityAdvice;
+            else if (word == L"auto-tune") command = CliCommand::AutoTune;
+            else if (word == L"pipeline") command = CliCommand::Pipeline;
+            else if (word == L"critical-path") command = CliCommand::CriticalPath;
+            else if (word == L"projects") command = CliCommand::Projects;
+            else if (word == L"download") command = CliCommand::Download;
+            else if (word == L"help") command = CliCommand::Help;
+            else return false;
+            return true;
+        }
+
+        static bool OneOf(const std::wstring& name, const std::wstring& value, std::initializer_list<const wchar_t*> allowed,
+                          std::wstring& error) {
+            for (const wchar_t* a : allowed) {
+                if (value == a) return true;
+            }
+            error = name + L" must be one of:";
+            for (const wchar_t* a : allowed) error += std::wstring(L" ") + a;
+            return false;
+        }
+    };
+}
@@ -0,0 +1,401 @@
+#pragma once
+#include "BuildActionLog.h"
+#include "JsonUtils.h"
+#include "StringUtils.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <deque>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <algorithm>
+#include <sstream>
+#include <cctype>
+#include <cstdio>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // One action from UBT's exported action graph
+    struct ActionGraphNode {
+        int Id = 0;
+        std::string Type;                       // Compile, Link, ...
+        std::string Description;                // What UBT prints after "[n/m] Verb [arch] "
+        std::vector<std::string> ProducedItems;
+        std::vector<std::string> PrerequisiteItems;
+        std::vector<size_t> Dependencies;       // Indices of the actions it waits for
+        double Duration = 0.0;                  // Measured; 0 for actions that weren't seen
+        bool Measured = false;
+    };
+
+    // The action graph UBT writes with -WriteOutdatedActions=<file>: every action it would run,
+    // with the files each one consumes and produces. UBT exports and stops without executing,
+    // so the export is a separate (cheap, makefile-cached) UBT run just before the build.
+    class ActionGraph {
+    public:
+        static constexpr const char* FileName = "actiongraph.json";
+
+        static std::wstring ExportArg(const fs::path& file) {
+            return L"-WriteOutdatedActions=\"" + file.wstring() + L"\"";
+        }
+
+        bool Load(const fs::path& path) {
+            nodes.clear();
+            std::ifstream in(path, std::ios::binary);
+            if (!in.is_open()) return false;
+            std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            bool ok = false;
+            JsonValue root = JsonValue::Parse(text, &ok);
+            if (!ok) return false;
+
+            std::map<int64_t, size_t> byId;
+            std::vector<std::vector<int64_t>> explicitDeps;
+            for (const auto& a : root["Actions"].Items()) {
+                ActionGraphNode node;
+                node.Id = static_cast<int>(a["Id"].AsInt(static_cast<int64_t>(nodes.size())));
+                node.Type = a["Type"].AsString();
+                node.Description = a["StatusDescription"].AsString(a["CommandDescription"].AsString());
+                for (const auto& i : a["ProducedItems"].Items()) node.ProducedItems.push_back(i.AsString());
+                for (const auto& i : a["PrerequisiteItems"].Items()) node.PrerequisiteItems.push_back(i.AsString());
+
+                // Newer engines list the actions directly; older ones only the files
+                std::vector<int64_t> deps;
+                const JsonValue& listed = a.Has("PrerequisiteActions") ? a["PrerequisiteActions"] : a["Dependencies"];
+                for (const auto& d : listed.Items()) deps.push_back(d.AsInt(-1));
+
+                byId[node.Id] = nodes.size();
+                explicitDeps.push_back(std::move(deps));
+                nodes.push_back(std::move(node));
+            }
+
+            std::unordered_map<std::string, size_t> producer;
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                for (const auto& item : nodes[i].ProducedItems) producer[item] = i;
+            }
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                auto& deps = nodes[i].Dependencies;
+                for (int64_t id : explicitDeps[i]) {
+                    auto it = byId.find(id);
+                    if (it != byId.end() && it->second != i) deps.push_back(it->second);
+                }
+                for (const auto& item : nodes[i].PrerequisiteItems) {
+                    auto it = producer.find(item);
+                    if (it != producer.end() && it->second != i) deps.push_back(it->second);
+                }
+                std::sort(deps.begin(), deps.end());
+                deps.erase(std::unique(deps.begin(), deps.end()), deps.end());
+            }
+            return !nodes.empty();
+        }
+
+        // Gives every action the duration measured for it in the build. Matched on the name UBT
+        // prints for it, falling back to the file name of what it produces ("Foo.cpp.obj" ->
+        // "Foo.cpp"). Returns how many actions were matched.
+        size_t JoinDurations(const std::vector<BuildAction>& measured) {
+            std::unordered_map<std::string, std::deque<size_t>> byName;
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                nodes[i].Duration = 0.0;
+                nodes[i].Measured = false;
+                for (const auto& key : Keys(nodes[i])) byName[key].push_back(i);
+            }
+
+            size_t matched = 0;
+            for (const auto& action : measured) {
+                auto it = byName.find(Lower(action.Item));
+                if (it == byName.end()) continue;
+                auto& queue = it->second;
+                while (!queue.empty() && nodes[queue.front()].Measured) queue.pop_front();
+                if (queue.empty()) continue;
+
+                auto& node = nodes[queue.front()];
+                queue.pop_front();
+                node.Duration = (std::max)(0.0, action.Duration());
+                node.Measured = true;
+                if (node.Description.empty()) node.Description = action.Item;
+                if (node.Type.empty()) node.Type = action.Verb;
+                ++matched;
+            }
+            return matched;
+        }
+
+        const std::vector<ActionGraphNode>& Nodes() const { return nodes; }
+
+    private:
+        std::vector<ActionGraphNode> nodes;
+
+        static std::string Lower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return s;
+        }
+
+        static std::vector<std::string> Keys(const ActionGraphNode& node) {
+            std::vector<std::string> keys;
+            if (!node.Description.empty()) keys.push_back(Lower(node.Description));
+            for (const auto& item : node.ProducedItems) {
+                fs::path name = StringUtils::PathFromUtf8(item).filename();
+                keys.push_back(Lower(StringUtils::PathToUtf8(name)));
+                if (name.has_extension()) keys.push_back(Lower(StringUtils::PathToUtf8(name.stem())));
+            }
+            return keys;
+        }
+    };
+
+    struct CriticalPathStep {
+        std::string Type;
+        std::string Description;
+        double Start = 0.0;         // On the critical path, from the start of the executor
+        double Duration = 0.0;
+    };
+
+    struct CriticalPathReport {
+        bool Valid = false;
+        std::string Error;
+        size_t Actions = 0;
+        size_t Measured = 0;
+        int Slots = 1;                      // Executor processes the build ran with
+        double MeasuredSeconds = 0.0;       // Executor wall time of the real build
+        double WorkSeconds = 0.0;           // Sum of all action durations
+        double CriticalSeconds = 0.0;       // Longest dependency chain: the build can't be faster
+        double IdealSeconds = 0.0;          // max(chain, work / slots): best case on these slots
+        double Parallelism = 0.0;           // work / chain: slots the graph can keep busy on average
+        double Slack = 0.0;                 // measured - chain, never negative
+        bool Estimated = true;              // Action times come from the order UBT printed them in (BuildActionLog), not timestamps
+        bool Clamped = false;               // The estimated chain came out longer than the build; it and WorkSeconds were scaled down by the same factor
+        double UnclampedSeconds = 0.0;      // The chain before that
+        size_t ZeroSlackActions = 0;        // Actions that would delay the end if they were slower
+        std::vector<CriticalPathStep> Path; // First to last
+        std::vector<CriticalPathStep> Gating;   // Path steps, longest first
+        std::vector<std::string> Findings;
+    };
+
+    // Longest path through the action graph weighted by measured durations, and what it says
+    // about the build: chain-bound (splitting the gating module or .cpp helps, more cores
+    // don't), core-bound (more cores or distribution help), or losing time elsewhere.
+    class CriticalPathAnalyzer {
+    public:
+        static CriticalPathReport Analyze(const ActionGraph& graph, const BuildActionLog& log) {
+            CriticalPathReport report;
+            const auto& nodes = graph.Nodes();
+            const size_t n = nodes.size();
+            report.Actions = n;
+            report.Slots = (std::max)(1, log.Parallelism());
+            for (const auto& node : nodes) {
+                if (node.Measured) ++report.Measured;
+                report.WorkSeconds += node.Duration;
+            }
+            if (!log.Actions().empty()) report.MeasuredSeconds = log.TotalSeconds() - log.ExecutorStart();
+            if (report.Measured == 0) {
+                report.Error = "no action in the graph matches an action of the build";
+                return report;
+            }
+
+            // Topological order
+            std::vector<std::vector<size_t>> dependents(n);
+            std::vector<size_t> waiting(n, 0);
+            for (size_t i = 0; i < n; ++i) {
+                for (size_t d : nodes[i].Dependencies) dependents[d].push_back(i);
+                waiting[i] = nodes[i].Dependencies.size();
+            }
+            std::vector<size_t> order;
+            order.reserve(n);
+            for (size_t i = 0; i < n; ++i) {
+                if (waiting[i] == 0) order.push_back(i);
+            }
+            for (size_t k = 0; k < order.size(); ++k) {
+                for (size_t s : dependents[order[k]]) {
+                    if (--waiting[s] == 0) order.push_back(s);
+                }
+            }
+            if (order.size() != n) {
+                report.Error = "the action graph has a cycle";
+                return report;
+            }
+
+            // Earliest finish, forwards
+            std::vector<double> finish(n, 0.0);
+            std::vector<size_t> via(n, n);
+            for (size_t i : order) {
+                double start = 0.0;
+                for (size_t d : nodes[i].Dependencies) {
+                    if (via[i] == n || finish[d] > start) {
+                        start = finish[d];
+                        via[i] = d;
+                    }
+                }
+                finish[i] = start + nodes[i].Duration;
+            }
+            size_t last = static_cast<size_t>(std::max_element(finish.begin(), finish.end()) - finish.begin());
+            report.CriticalSeconds = finish[last];
+            report.UnclampedSeconds = report.CriticalSeconds;
+
+            // Latest finish, backwards; slack = how much an action could slip
+            std::vector<double> latest(n, report.CriticalSeconds);
+            for (auto it = order.rbegin(); it != order.rend(); ++it) {
+                for (size_t s : dependents[*it]) latest[*it] = (std::min)(latest[*it], latest[s] - nodes[s].Duration);
+            }
+            for (size_t i = 0; i < n; ++i) {
+                if (latest[i] - finish[i] < 1e-6 && nodes[i].Duration > 0.0) ++report.ZeroSlackActions;
+            }
+
+            for (size_t i = last; i < n; i = via[i]) {
+                report.Path.push_back({ nodes[i].Type, nodes[i].Description, finish[i] - nodes[i].Duration, nodes[i].Duration });
+            }
+            std::reverse(report.Path.begin(), report.Path.end());
+
+            // Estimated durations can overlap where the real actions didn't, but no chain of the
+            // build can take longer than the build did: scale the path down to the measured time.
+            // The total action time comes from the same overlapping estimates, so it scales too,
+            // which keeps parallelism (work / chain) and the best case consistent with the chain.
+            if (report.MeasuredSeconds > 0.0 && report.CriticalSeconds > report.MeasuredSeconds) {
+                double scale = report.MeasuredSeconds / report.CriticalSeconds;
+                for (auto& step : report.Path) {
+                    step.Start *= scale;
+                    step.Duration *= scale;
+                }
+                report.WorkSeconds *= scale;
+                report.CriticalSeconds = report.MeasuredSeconds;
+                report.Clamped = true;
+            }
+            report.Gating = report.Path;
+            std::sort(report.Gating.begin(), report.Gating.end(), [](const CriticalPathStep& a, const CriticalPathStep& b) {
+                return a.Duration > b.Duration;
+            });
+            if (report.Gating.size() > 10) report.Gating.resize(10);
+
+            report.IdealSeconds = (std::max)(report.CriticalSeconds, report.WorkSeconds / report.Slots);
+            if (report.MeasuredSeconds > 0.0) report.IdealSeconds = (std::min)(report.IdealSeconds, report.MeasuredSeconds);
+            report.Parallelism = report.CriticalSeconds > 0.0 ? report.WorkSeconds / report.CriticalSeconds : 0.0;
+            report.Slack = (std::max)(0.0, report.MeasuredSeconds - report.CriticalSeconds);
+            report.Valid = true;
+            AddFindings(report);
+            return report;
+        }
+
+        static std::string FormatReport(const CriticalPathReport& report) {
+            std::ostringstream out;
+            char line[512];
+            out << "Critical path\n";
+            if (!report.Valid) {
+                out << "  Not available: " << report.Error << "\n";
+                return out.str();
+            }
+
+            std::snprintf(line, sizeof(line),
+                          "  Actions:                %zu (%zu with measured times)\n"
+                          "  Measured executor time: %.1f s on %d slots\n"
+                          "  Total action time:      ~%.1f s\n"
+                          "  Critical path:          ~%.1f s (%zu steps, %zu actions without slack)\n"
+                          "  Best case on %3d slots: ~%.1f s\n"
+                          "  Average parallelism:    ~%.1f slots\n"
+                          "  Parallel slack:         ~%.1f s beyond the critical path\n",
+                          report.Actions, report.Measured, report.MeasuredSeconds, report.Slots, report.WorkSeconds,
+                          report.CriticalSeconds, report.Path.size(), report.ZeroSlackActions, report.Slots, report.IdealSeconds,
+                          report.Parallelism, report.Slack);
+            out << line;
+            if (report.Estimated) {
+                out << "  (~ estimates: UBT prints when an action ends, so start times are inferred from the order it\n"
+                       "  reported them in";
+                if (report.Clamped) {
+                    std::snprintf(line, sizeof(line), "; the chain came out at %.1f s, longer than the build, and was\n"
+                                  "  scaled down to the measured time, the total action time with it", report.UnclampedSeconds);
+                    out << line;
+                }
+                out << ")\n";
+            }
+            out << "\n";
+
+            out << "Actions gating the end of the build (longest first):\n";
+            for (const auto& step : report.Gating) {
+                std::snprintf(line, sizeof(line), "  %8.1f s  %5.1f%%  %s %s\n", step.Duration,
+                              report.CriticalSeconds > 0.0 ? 100.0 * step.Duration / report.CriticalSeconds : 0.0,
+                              step.Type.c_str(), step.Description.c_str());
+                out << line;
+            }
+
+            out << "\nFindings:\n";
+            for (const auto& f : report.Findings) out << "  - " << f << "\n";
+            return out.str();
+        }
+
+        static bool Save(const CriticalPathReport& report, const fs::path& path) {
+            JsonValue root = JsonValue::MakeObject();
+            root.Set("Valid", report.Valid);
+            root.Set("Actions", static_cast<uint64_t>(report.Actions));
+            root.Set("Measured", static_cast<uint64_t>(report.Measured));
+            root.Set("Slots", report.Slots);
+            root.Set("MeasuredSeconds", report.MeasuredSeconds);
+            root.Set("WorkSeconds", report.WorkSeconds);
+            root.Set("CriticalSeconds", report.CriticalSeconds);
+            root.Set("IdealSeconds", report.IdealSeconds);
+            root.Set("Parallelism", report.Parallelism);
+            root.Set("Slack", report.Slack);
+            root.Set("Estimated", report.Estimated);
+            root.Set("Clamped", report.Clamped);
+            root.Set("UnclampedSeconds", report.UnclampedSeconds);
+            root.Set("ZeroSlackActions", static_cast<uint64_t>(report.ZeroSlackActions));
+
+            JsonValue steps = JsonValue::MakeArray();
+            for (const auto& step : report.Path) {
+                JsonValue s = JsonValue::MakeObject();
+                s.Set("Type", step.Type);
+                s.Set("Description", step.Description);
+                s.Set("Start", step.Start);
+                s.Set("Duration", step.Duration);
+                steps.Push(s);
+            }
+            root.Set("Path", steps);
+
+            JsonValue findings = JsonValue::MakeArray();
+            for (const auto& f : report.Findings) findings.Push(f);
+            root.Set("Findings", findings);
+
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file << root.Dump(1);
+            return static_cast<bool>(file);
+        }
+
+    private:
+        static void AddFindings(CriticalPathReport& report) {
+            char text[512];
+            if (report.Parallelism < report.Slots * 0.75) {
+                std::snprintf(text, sizeof(text),
+                              "Chain-bound: the graph only keeps %.1f of %d slots busy on average, so more cores would not "
+                              "help. Shorten the critical path instead (split the modules or files below).",
+                              report.Parallelism, report.Slots);
+            }
+            else {
+                std::snprintf(text, sizeof(text),
+                              "Core-bound: the graph could keep about %.0f slots busy and the build had %d. More cores or "
+                              "distributed compilation would shorten it, down to the %.1f s critical path.",
+                              report.Parallelism, report.Slots, report.CriticalSeconds);
+            }
+            report.Findings.push_back(text);
+
+            for (const auto& step : report.Gating) {
+                if (step.Duration < report.CriticalSeconds * 0.2) break;
+                std::snprintf(text, sizeof(text), "%s %s alone is %.0f%% of the critical path; %s.", step.Type.c_str(),
+                              step.Description.c_str(), 100.0 * step.Duration / report.CriticalSeconds,
+                              step.Type == "Link" ? "consider splitting the module so less has to link last"
+                                                  : "consider splitting this file or its unity blob");
+                report.Findings.push_back(text);
+            }
+
+            if (report.MeasuredSeconds > report.IdealSeconds * 1.3 && report.MeasuredSeconds - report.IdealSeconds > 5.0) {
+                std::snprintf(text, sizeof(text),
+                              "The build took %.1f s longer than the graph allows on %d slots: time went to something "
+                              "else (memory pauses, I/O, a slow scheduler or actions outside the graph).",
+                              report.MeasuredSeconds - report.IdealSeconds, report.Slots);
+                report.Findings.push_back(text);
+            }
+            if (report.Measured * 10 < report.Actions * 9) {
+                std::snprintf(text, sizeof(text), "Only %zu of %zu graph actions were matched to measured times; the path "
+                              "may be shorter than reality.", report.Measured, report.Actions);
+                report.Findings.push_back(text);
+            }
+        }
+    };
+}
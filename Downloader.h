@@ -0,0 +1,402 @@
+#pragma once
+#include "HttpClient.h"
+#include "HashUtils.h"
+#include "JsonUtils.h"
+#include "ProcessUtils.h"
+#include "StringUtils.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <filesystem>
+#include <functional>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstdlib>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    struct DownloadProgress {
+        uint64_t Bytes = 0;             // Done so far, including what an earlier run left
+        uint64_t Total = 0;             // 0 when the server doesn't say
+        uint64_t ResumedBytes = 0;      // Already there when this run started
+        double BytesPerSecond = 0.0;    // Over this run
+        int Connections = 0;
+        bool Finished = false;
+    };
+
+    struct DownloadOptions {
+        int Connections = 4;
+        uint64_t ChunkBytes = 8u << 20;
+        std::string Sha256;             // Expected digest (hex); empty skips the check
+        int Retries = 5;                // Per chunk, with growing pauses in between
+        std::function<void(const DownloadProgress&)> OnProgress; // ~4 times a second from a helper thread, and once at the end
+    };
+
+    // Downloads one file over several connections with HTTP range requests.
+    //
+    // Data goes into <dest>.part, with <dest>.part.json listing the chunks that are complete,
+    // so an interrupted download carries on where it stopped - in this run after a retry, or
+    // in the next one as long as the server still has the same file (same size and ETag /
+    // Last-Modified; from a server that sends neither, the next run starts over). <dest> itself only appears once every byte is there and the checksum,
+    // when given, matches. Servers without range support get a single plain GET.
+    //
+    // http:// everywhere and https:// on Windows go through HttpClient; https elsewhere is
+    // handed to curl, which resumes the .part file on its own.
+    class Downloader {
+    public:
+        static bool Download(const std::string& url, const fs::path& dest, const DownloadOptions& options, std::string& error) {
+            fs::path part = PartPath(dest);
+            std::error_code ec;
+            if (!dest.parent_path().empty()) fs::create_directories(dest.parent_path(), ec);
+
+            bool ok = HttpClient::IsSupportedUrl(url) ? DownloadHttp(url, part, options, error) : DownloadWithCurl(url, part, options, error);
+            if (!ok) return false;
+
+            if (!options.Sha256.empty()) {
+                std::string actual = Sha256::HashFile(part);
+                if (!EqualHex(actual, options.Sha256)) {
+                    // Corrupt or replaced upstream; resuming it would only repeat the mismatch
+                    fs::remove(part, ec);
+                    fs::remove(StatePath(part), ec);
+                    error = "SHA-256 mismatch: expected " + options.Sha256 + ", got " + actual;
+                    return false;
+                }
+            }
+
+            fs::remove(dest, ec);
+            fs::rename(part, dest, ec);
+            if (ec) {
+                error = "Cannot move the download into place: " + ec.message();
+                return false;
+            }
+            fs::remove(StatePath(part), ec);
+            return true;
+        }
+
+        // "12.3 / 45.6 MB at 8.1 MB/s"
+        static std::string FormatProgress(const DownloadProgress& progress) {
+            char text[128];
+            const double mb = 1024.0 * 1024.0;
+            if (progress.Total > 0) {
+                std::snprintf(text, sizeof(text), "%.1f / %.1f MB at %.1f MB/s", progress.Bytes / mb, progress.Total / mb, progress.BytesPerSecond / mb);
+            }
+            else {
+                std::snprintf(text, sizeof(text), "%.1f MB at %.1f MB/s", progress.Bytes / mb, progress.BytesPerSecond / mb);
+            }
+            return text;
+        }
+
+        static fs::path PartPath(const fs::path& dest) { return fs::path(dest.native() + fs::path(".part").native()); }
+
+    private:
+        static fs::path StatePath(const fs::path& part) { return fs::path(part.native() + fs::path(".json").native()); }
+
+        static bool EqualHex(const std::string& a, const std::string& b) {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); ++i) {
+                if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) return false;
+            }
+            return true;
+        }
+
+        // What the server says about the file
+        struct RemoteFile {
+            uint64_t Size = 0;
+            bool Ranges = false;
+            std::string Validator;      // ETag, else Last-Modified
+        };
+
+        static bool Probe(const std::string& url, RemoteFile& remote, std::string& error) {
+            HttpResponse response;
+            if (!HttpClient::Head(url, response)) {
+                error = "Cannot connect to " + url;
+                return false;
+            }
+            if (response.Status != 200) {
+                error = "HTTP " + std::to_string(response.Status) + " for " + url;
+                return false;
+            }
+            remote.Size = response.ContentLength > 0 ? static_cast<uint64_t>(response.ContentLength) : 0;
+            remote.Ranges = response.Header("accept-ranges").find("bytes") != std::string::npos;
+            remote.Validator = response.Header("etag");
+            if (remote.Validator.empty()) remote.Validator = response.Header("last-modified");
+            return true;
+        }
+
+        // Progress reporting and the chunk queue shared by the connections
+        struct Transfer {
+            const DownloadOptions& Options;
+            std::string Url;
+            fs::path Part;
+            RemoteFile Remote;
+            std::vector<bool> Done;
+            std::deque<size_t> Pending;
+            std::atomic<uint64_t> Bytes{ 0 };
+            uint64_t ResumedBytes = 0;
+            int Connections = 0;
+            bool Failed = false;
+            bool Finished = false;
+            std::string Error;
+            std::mutex Mutex;
+            std::condition_variable Changed;
+            std::chrono::steady_clock::time_point Start = std::chrono::steady_clock::now();
+
+            explicit Transfer(const DownloadOptions& options) : Options(options) {}
+
+            DownloadProgress Snapshot() const {
+                DownloadProgress progress;
+                progress.Bytes = Bytes.load();
+                progress.Total = Remote.Size;
+                progress.ResumedBytes = ResumedBytes;
+                progress.Connections = Connections;
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - Start).count();
+                if (seconds > 0.0) progress.BytesPerSecond = (progress.Bytes - ResumedBytes) / seconds;
+                return progress;
+            }
+        };
+
+        static bool DownloadHttp(const std::string& url, const fs::path& part, const DownloadOptions& options, std::string& error) {
+            RemoteFile remote;
+            if (!Probe(url, remote, error)) return false;
+            if (!remote.Ranges || remote.Size == 0) return DownloadSingle(url, part, options, remote, error);
+
+            Transfer transfer(options);
+            transfer.Url = url;
+            transfer.Part = part;
+            transfer.Remote = remote;
+
+            const uint64_t chunkBytes = (std::max)(options.ChunkBytes, static_cast<uint64_t>(64 * 1024));
+            const size_t chunkCount = static_cast<size_t>((remote.Size + chunkBytes - 1) / chunkBytes);
+            if (!LoadState(part, remote, chunkBytes, transfer.Done) || transfer.Done.size() != chunkCount) {
+                transfer.Done.assign(chunkCount, false);
+                std::error_code ec;
+                fs::remove(part, ec);
+                std::ofstream create(part, std::ios::binary | std::ios::trunc);
+                if (!create.is_open()) {
+                    error = "Cannot create " + StringUtils::PathToUtf8(part);
+                    return false;
+                }
+                create.close();
+                fs::resize_file(part, remote.Size, ec);
+                if (ec) {
+                    error = "Cannot allocate " + StringUtils::PathToUtf8(part) + ": " + ec.message();
+                    return false;
+                }
+                SaveState(part, remote, chunkBytes, transfer.Done);
+            }
+
+            for (size_t i = 0; i < chunkCount; ++i) {
+                if (transfer.Done[i]) transfer.ResumedBytes += ChunkLength(remote.Size, chunkBytes, i);
+                else transfer.Pending.push_back(i);
+            }
+            transfer.Bytes = transfer.ResumedBytes;
+            transfer.Connections = static_cast<int>((std::min)(static_cast<size_t>((std::max)(options.Connections, 1)), transfer.Pending.size()));
+
+            std::thread reporter([&transfer]() { Report(transfer); });
+            std::vector<std::thread> workers;
+            for (int i = 0; i < transfer.Connections; ++i) {
+                workers.emplace_back([&transfer, chunkBytes]() { Work(transfer, chunkBytes); });
+            }
+            for (auto& w : workers) w.join();
+
+            {
+                std::lock_guard<std::mutex> lock(transfer.Mutex);
+                transfer.Finished = true;
+            }
+            transfer.Changed.notify_all();
+            reporter.join();
+
+            if (transfer.Failed) {
+                error = transfer.Error;
+                return false;
+            }
+            return true;
+        }
+
+        static uint64_t ChunkLength(uint64_t size, uint64_t chunkBytes, size_t index) {
+            uint64_t offset = static_cast<uint64_t>(index) * chunkBytes;
+            return (std::min)(chunkBytes, size - offset);
+        }
+
+        // One connection: takes chunks until none are left or another one gave up
+        static void Work(Transfer& transfer, uint64_t chunkBytes) {
+            std::fstream file(transfer.Part, std::ios::binary | std::ios::in | std::ios::out);
+            while (true) {
+                size_t index;
+                {
+                    std::lock_guard<std::mutex> lock(transfer.Mutex);
+                    if (transfer.Failed || transfer.Pending.empty()) return;
+                    index = transfer.Pending.front();
+                    transfer.Pending.pop_front();
+                }
+
+                uint64_t offset = static_cast<uint64_t>(index) * chunkBytes;
+                uint64_t length = ChunkLength(transfer.Remote.Size, chunkBytes, index);
+                std::string failure;
+                bool ok = file.is_open();
+                if (!ok) failure = "Cannot open " + StringUtils::PathToUtf8(transfer.Part);
+
+                for (int attempt = 0; ok; ++attempt) {
+                    if (FetchChunk(transfer, file, offset, length, failure)) break;
+                    if (attempt >= transfer.Options.Retries || failure.compare(0, 6, "Server") == 0) {
+                        ok = false;
+                        break;
+                    }
+                    // 0.5 s, 1 s, 2 s ... up to 8 s
+                    std::this_thread::sleep_for(std::chrono::milliseconds(500 << (std::min)(attempt, 4)));
+                }
+
+                std::lock_guard<std::mutex> lock(transfer.Mutex);
+                if (!ok) {
+                    if (!transfer.Failed) transfer.Error = failure;
+                    transfer.Failed = true;
+                    return;
+                }
+                transfer.Done[index] = true;
+                SaveState(transfer.Part, transfer.Remote, chunkBytes, transfer.Done);
+            }
+        }
+
+        static bool FetchChunk(Transfer& transfer, std::fstream& file, uint64_t offset, uint64_t length, std::string& failure) {
+            file.clear();
+            file.seekp(static_cast<std::streamoff>(offset));
+
+            uint64_t written = 0;
+            HttpResponse response;
+            bool ok = HttpClient::GetRange(transfer.Url, offset, length, response, [&](const char* data, size_t len) {
+                if (response.Status != 206 || written + len > length) return false;
+                file.write(data, static_cast<std::streamsize>(len));
+                written += len;
+                transfer.Bytes += len;
+                return static_cast<bool>(file);
+            });
+            file.flush();
+
+            if (ok && response.Status == 206 && written == length && file) return true;
+
+            transfer.Bytes -= written; // Fetched again from the start
+            if (response.Status == 200) failure = "Server ignored the range request";
+            else if (response.Status != 0 && response.Status != 206) failure = "HTTP " + std::to_string(response.Status) + " for " + transfer.Url;
+            else if (!file) failure = "Cannot write " + StringUtils::PathToUtf8(transfer.Part);
+            else failure = "Connection lost after " + std::to_string(offset + written) + " bytes";
+            return false;
+        }
+
+        static void Report(Transfer& transfer) {
+            if (!transfer.Options.OnProgress) return;
+            std::unique_lock<std::mutex> lock(transfer.Mutex);
+            while (!transfer.Finished) {
+                transfer.Changed.wait_for(lock, std::chrono::milliseconds(250));
+                DownloadProgress progress = transfer.Snapshot();
+                progress.Finished = transfer.Finished && !transfer.Failed;
+                lock.unlock();
+                transfer.Options.OnProgress(progress);
+                lock.lock();
+            }
+        }
+
+        // No ranges (or no size): one stream from the start, nothing to resume
+        static bool DownloadSingle(const std::string& url, const fs::path& part, const DownloadOptions& options, const RemoteFile& remote,
+                                   std::string& error) {
+            std::ofstream file(part, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) {
+                error = "Cannot create " + StringUtils::PathToUtf8(part);
+                return false;
+            }
+
+            Transfer transfer(options);
+            transfer.Remote = remote;
+            transfer.Connections = 1;
+            std::thread reporter([&transfer]() { Report(transfer); });
+
+            HttpResponse response;
+            bool ok = HttpClient::Get(url, response, [&](const char* data, size_t len) {
+                file.write(data, static_cast<std::streamsize>(len));
+                transfer.Bytes += len;
+                return static_cast<bool>(file);
+            });
+            file.close();
+
+            {
+                std::lock_guard<std::mutex> lock(transfer.Mutex);
+                transfer.Finished = true;
+                transfer.Failed = !ok || response.Status != 200 || !file;
+            }
+            transfer.Changed.notify_all();
+            reporter.join();
+
+            if (!ok) error = "Connection lost after " + std::to_string(transfer.Bytes.load()) + " bytes";
+            else if (response.Status != 200) error = "HTTP " + std::to_string(response.Status) + " for " + url;
+            else if (!file) error = "Cannot write " + StringUtils::PathToUtf8(part);
+            return !transfer.Failed;
+        }
+
+        static bool DownloadWithCurl(const std::string& url, const fs::path& part, const DownloadOptions& options, std::string& error) {
+            std::wstring args = L"-fsSL --retry " + std::to_wstring(options.Retries) + L" -C - -o \"" + part.wstring() + L"\" \"" +
+                                StringUtils::FromUtf8(url) + L"\"";
+            std::string output;
+            if (!ProcessUtils::RunProcess(L"curl", args, L"", [&output](const std::string& chunk) { output += chunk; })) {
+                error = "curl failed" + (output.empty() ? std::string() : ": " + output);
+                return false;
+            }
+            if (options.OnProgress) {
+                DownloadProgress progress;
+                std::error_code ec;
+                progress.Bytes = progress.Total = fs::file_size(part, ec);
+                progress.Connections = 1;
+                progress.Finished = true;
+                options.OnProgress(progress);
+            }
+            return true;
+        }
+
+        // Only trusted while the server's file is unchanged and the chunking is the same. Without
+        // a validator a replaced file of the same size can't be told apart, so that starts over.
+        static bool LoadState(const fs::path& part, const RemoteFile& remote, uint64_t chunkBytes, std::vector<bool>& done) {
+            if (remote.Validator.empty()) return false;
+            std::error_code ec;
+            if (fs::file_size(part, ec) != remote.Size || ec) return false;
+
+            std::ifstream file(StatePath(part), std::ios::binary);
+            if (!file.is_open()) return false;
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            bool ok = false;
+            JsonValue state = JsonValue::Parse(text, &ok);
+            if (!ok || static_cast<uint64_t>(state["Size"].AsInt()) != remote.Size ||
+                static_cast<uint64_t>(state["ChunkBytes"].AsInt()) != chunkBytes || state["Validator"].AsString() != remote.Validator) {
+                return false;
+            }
+
+            std::string bits = state["Done"].AsString();
+            done.assign(bits.size(), false);
+            for (size_t i = 0; i < bits.size(); ++i) done[i] = bits[i] == '1';
+            return true;
+        }
+
+        static void SaveState(const fs::path& part, const RemoteFile& remote, uint64_t chunkBytes, const std::vector<bool>& done) {
+            std::string bits(done.size(), '0');
+            for (size_t i = 0; i < done.size(); ++i) {
+                if (done[i]) bits[i] = '1';
+            }
+
+            JsonValue state = JsonValue::MakeObject();
+            state.Set("Size", remote.Size);
+            state.Set("ChunkBytes", chunkBytes);
+            state.Set("Validator", remote.Validator);
+            state.Set("Done", bits);
+
+            std::ofstream file(StatePath(part), std::ios::binary | std::ios::trunc);
+            file << state.Dump();
+        }
+    };
+}
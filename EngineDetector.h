@@ -1,10 +1,11 @@
 #pragma once
-#include "processutils.h"
+#include "ProcessUtils.h"
+#include "Profiler.h"
+#include "Log.h"
 #include <string>
 #include <fstream>
 #include <sstream>
 #include <filesystem>
-#include <iostream>
 #include <algorithm> 
 #include <vector> 
 
@@ -16,15 +17,22 @@ namespace UEBuilder {
         std::wstring Version;
         std::wstring RootPath;
         std::wstring UBTPath;
-        std::wstring UATPath; // RunUAT.bat
+        std::wstring UATPath; // RunUAT.bat / RunUAT.sh
         bool IsValid = false;
     };
 
     class EngineDetector {
     public:
+        // Full path of an executable to run instead of the engine's UnrealBuildTool, e.g. the
+        // UnrealBuildToolSim load-test stand-in; engine lookup is skipped entirely when set
+        static constexpr const wchar_t* UBTOverrideEnvVar = L"UEBUILDER_UBT_PATH";
+
+        static std::wstring GetUBTOverride() { return ProcessUtils::GetEnvVar(UBTOverrideEnvVar); }
+
         // Simple JSON-like parser to get "EngineAssociation"
         static std::wstring GetEngineAssociation(const std::wstring& projectPath) {
-            std::ifstream file(projectPath);
+            UEBUILDER_PROFILE_SCOPE("EngineDetector::GetEngineAssociation");
+            std::ifstream file{ fs::path(projectPath) };
             if (!file.is_open()) return L"";
 
             std::string line;
@@ -43,17 +51,67 @@ namespace UEBuilder {
             return L"";
         }
 
-        static EngineInfo FindEngine(const std::wstring& association) {
+        // Locates the engine for a project's EngineAssociation. engineRoot, when given, is used
+        // as-is instead of searching. Never asks the user; check IsValid.
+        static EngineInfo FindEngine(const std::wstring& association, const std::wstring& engineRoot = L"") {
+            UEBUILDER_PROFILE_SCOPE("EngineDetector::FindEngine");
             EngineInfo info;
             info.Version = association;
 
-            // FIX for C2362: Declare registry key variables early to prevent 'goto' from skipping initialization
+            std::wstring ubtOverride = GetUBTOverride();
+            if (!ubtOverride.empty()) {
+                Log::Info("EngineDetector", "Using a stand-in UnrealBuildTool", { { "variable", UBTOverrideEnvVar }, { "path", ubtOverride } });
+                info.UBTPath = ubtOverride;
+                info.RootPath = fs::path(ubtOverride).parent_path().wstring();
+                info.IsValid = fs::exists(fs::path(ubtOverride));
+                return info;
+            }
+
+            info.RootPath = engineRoot.empty() ? SearchInstalledEngine(association) : engineRoot;
+            std::replace(info.RootPath.begin(), info.RootPath.end(), L'\\', L'/');
+
+            if (info.RootPath.empty()) {
+                Log::Debug("EngineDetector", "No installed engine found; pass the engine root explicitly", { { "association", association } });
+            }
+
+            // Validation
+            if (!info.RootPath.empty()) {
+                UEBUILDER_PROFILE_SCOPE("EngineDetector: validate engine root");
+                Log::Debug("EngineDetector", "Using engine root", { { "root", info.RootPath } });
+
+                fs::path root(info.RootPath);
+#ifdef _WIN32
+                fs::path ubt = root / "Engine" / "Binaries" / "DotNET" / "UnrealBuildTool" / "UnrealBuildTool.exe";
+                fs::path uat = root / "Engine" / "Build" / "BatchFiles" / "RunUAT.bat";
+#else
+                fs::path ubt = root / "Engine" / "Binaries" / "DotNET" / "UnrealBuildTool" / "UnrealBuildTool";
+                fs::path uat = root / "Engine" / "Build" / "BatchFiles" / "RunUAT.sh";
+#endif
+
+                if (fs::exists(ubt)) {
+                    info.UBTPath = ubt.wstring();
+                    info.UATPath = uat.wstring();
+                    info.IsValid = true;
+                }
+                else {
+                    Log::Debug("EngineDetector", "Engine root found, but UnrealBuildTool is missing", { { "expected", ubt } });
+                }
+            }
+
+            return info;
+        }
+
+    private:
+        // Install folder for an engine version: Program Files first, then the registry
+        static std::wstring SearchInstalledEngine(const std::wstring& association) {
+            UEBUILDER_PROFILE_SCOPE("EngineDetector::SearchInstalledEngine");
+            std::wstring rootPath;
             std::wstring regKeyCU;
             std::wstring regKeyLM;
             std::wstring regKeyLM_Space;
             std::wstring regKeyWow;
 
-            std::wcout << L"[Debug] Looking for Engine Version: " << association << L"..." << std::endl;
+            Log::Debug("EngineDetector", "Looking for installed engine", { { "association", association } });
 
             // --- STEP 1: DIRECT FILE SYSTEM SCAN (Program Files) ---
 
@@ -66,91 +124,56 @@ namespace UEBuilder {
             // The required engine folder name, e.g., "UE_5.5"
             std::wstring requiredFolderName = L"UE_" + association;
 
-            std::wcout << L"[Debug] Attempting direct file system scan for folder: " << requiredFolderName << L"..." << std::endl;
-
-            for (const auto& root : installRoots) {
-                fs::path potentialPath = root / requiredFolderName;
-                if (fs::exists(potentialPath) && fs::is_directory(potentialPath)) {
-                    // Check if UnrealBuildTool exists here to confirm validity
-                    fs::path ubtCheck = potentialPath / "Engine" / "Binaries" / "DotNET" / "UnrealBuildTool" / "UnrealBuildTool.exe";
-                    if (fs::exists(ubtCheck)) {
-                        info.RootPath = potentialPath.wstring();
-                        std::wcout << L"[Info] Found engine via direct scan: " << info.RootPath << std::endl;
-                        goto EngineFound; // Skip registry checks if found here
+            Log::Debug("EngineDetector", "Scanning install folders", { { "folder", requiredFolderName } });
+
+            {
+                UEBUILDER_PROFILE_SCOPE("EngineDetector: Program Files scan");
+                for (const auto& root : installRoots) {
+                    fs::path potentialPath = root / requiredFolderName;
+                    if (fs::exists(potentialPath) && fs::is_directory(potentialPath)) {
+                        // Check if UnrealBuildTool exists here to confirm validity
+                        fs::path ubtCheck = potentialPath / "Engine" / "Binaries" / "DotNET" / "UnrealBuildTool" / "UnrealBuildTool.exe";
+                        if (fs::exists(ubtCheck)) {
+                            rootPath = potentialPath.wstring();
+                            Log::Info("EngineDetector", "Found engine via direct scan", { { "root", rootPath } });
+                            return rootPath; // Skip registry checks if found here
+                        }
                     }
                 }
             }
 
             // --- STEP 2: REGISTRY CHECKS (only if direct scan fails) ---
+#ifdef _WIN32
+            UEBUILDER_PROFILE_SCOPE("EngineDetector: registry lookup");
 
             // 2. Check Registry: Current User (Source Builds / Custom Registrations)
-            regKeyCU = L"Software\\Epic Games\\Unreal Engine\\Builds"; // Now only assignment
-            info.RootPath = ProcessUtils::ReadRegistryString(HKEY_CURRENT_USER, regKeyCU, association);
+            regKeyCU = L"Software\\Epic Games\\Unreal Engine\\Builds";
+            rootPath = ProcessUtils::ReadRegistryString(HKEY_CURRENT_USER, regKeyCU, association);
 
-            if (info.RootPath.empty()) {
-                std::wcout << L"[Debug] Not found in HKCU\\" << regKeyCU << std::endl;
+            if (rootPath.empty()) {
+                Log::Debug("EngineDetector", "Not in the registry", { { "hive", "HKCU" }, { "key", regKeyCU }, { "value", association } });
 
                 // 2a. Check Registry: Local Machine (Standard Launcher Installs - No Space)
-                regKeyLM = L"SOFTWARE\\EpicGames\\Unreal Engine\\" + association; // Now only assignment
-                info.RootPath = ProcessUtils::ReadRegistryString(HKEY_LOCAL_MACHINE, regKeyLM, L"InstalledDirectory");
+                regKeyLM = L"SOFTWARE\\EpicGames\\Unreal Engine\\" + association;
+                rootPath = ProcessUtils::ReadRegistryString(HKEY_LOCAL_MACHINE, regKeyLM, L"InstalledDirectory");
             }
 
-            if (info.RootPath.empty()) {
+            if (rootPath.empty()) {
                 // 2b. Check Registry: Local Machine (Alternative - With Space)
-                regKeyLM_Space = L"SOFTWARE\\Epic Games\\Unreal Engine\\" + association; // Now only assignment
-                info.RootPath = ProcessUtils::ReadRegistryString(HKEY_LOCAL_MACHINE, regKeyLM_Space, L"InstalledDirectory");
+                regKeyLM_Space = L"SOFTWARE\\Epic Games\\Unreal Engine\\" + association;
+                rootPath = ProcessUtils::ReadRegistryString(HKEY_LOCAL_MACHINE, regKeyLM_Space, L"InstalledDirectory");
             }
 
-            if (info.RootPath.empty()) {
-                std::wcout << L"[Debug] Not found in HKLM\\" << L"SOFTWARE\\Epic( )Games\\Unreal Engine\\" + association << std::endl;
+            if (rootPath.empty()) {
+                Log::Debug("EngineDetector", "Not in the registry", { { "hive", "HKLM" }, { "key", regKeyLM }, { "or", regKeyLM_Space } });
 
                 // 3. Check Registry: WOW6432Node (Common fallback for Launcher on x64 Windows)
-                regKeyWow = L"SOFTWARE\\WOW6432Node\\EpicGames\\Unreal Engine\\" + association; // Now only assignment
-                info.RootPath = ProcessUtils::ReadRegistryString(HKEY_LOCAL_MACHINE, regKeyWow, L"InstalledDirectory");
-            }
-
-        EngineFound:; // Label for jump
-
-            // --- STEP 3: FALLBACK (MANUAL INPUT) ---
-            if (info.RootPath.empty()) {
-                std::wcout << L"[Debug] Failed to find any registry key for " << association << L" either." << std::endl;
-                std::wcout << L"\n[Action Required] Could not auto-detect Unreal Engine " << association << L"." << std::endl;
-                std::wcout << L"Please manually enter the path to your Unreal Engine folder." << std::endl;
-                std::wcout << L"(Example: C:\\Program Files\\Epic Games\\UE_5.5)" << std::endl;
-                std::wcout << L"> ";
-
-                std::getline(std::wcin, info.RootPath);
-
-                // Sanitize input (quotes and whitespace)
-                if (!info.RootPath.empty()) {
-                    info.RootPath.erase(0, info.RootPath.find_first_not_of(L" \t\n\r"));
-                    info.RootPath.erase(info.RootPath.find_last_not_of(L" \t\n\r") + 1);
-                    if (info.RootPath.front() == L'"') info.RootPath.erase(0, 1);
-                    if (info.RootPath.back() == L'"') info.RootPath.pop_back();
-                    // Normalize slashes
-                    std::replace(info.RootPath.begin(), info.RootPath.end(), L'\\', L'/');
-                }
-            }
-
-            // Validation
-            if (!info.RootPath.empty()) {
-                std::wcout << L"[Debug] Using Path: " << info.RootPath << std::endl;
-
-                fs::path root(info.RootPath);
-                fs::path ubt = root / "Engine" / "Binaries" / "DotNET" / "UnrealBuildTool" / "UnrealBuildTool.exe";
-                fs::path uat = root / "Engine" / "Build" / "BatchFiles" / "RunUAT.bat";
-
-                if (fs::exists(ubt)) {
-                    info.UBTPath = ubt.wstring();
-                    info.UATPath = uat.wstring();
-                    info.IsValid = true;
-                }
-                else {
-                    std::wcout << L"[Debug] Path found, but UnrealBuildTool.exe is missing at: " << ubt.wstring() << std::endl;
-                }
+                regKeyWow = L"SOFTWARE\\WOW6432Node\\EpicGames\\Unreal Engine\\" + association;
+                rootPath = ProcessUtils::ReadRegistryString(HKEY_LOCAL_MACHINE, regKeyWow, L"InstalledDirectory");
             }
+#endif
 
-            return info;
+            return rootPath;
         }
     };
 }
\ No newline at end of file
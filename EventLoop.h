@@ -0,0 +1,354 @@
+#pragma once
+#include "WorkerPool.h"
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <stdexcept>
+#include <functional>
+#include <future>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <type_traits>
+#include <utility>
+#include <tuple>
+
+namespace UEBuilder {
+
+    template <typename T = void>
+    class Task;
+
+    namespace Detail {
+
+        // Hands control to whoever awaited the task, or back to the resumer when nobody did
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) const noexcept {
+                std::coroutine_handle<> continuation = handle.promise().Continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+            void await_resume() const noexcept {}
+        };
+
+        struct PromiseBase {
+            std::coroutine_handle<> Continuation;
+            std::exception_ptr Error;
+
+            std::suspend_always initial_suspend() const noexcept { return {}; }
+            FinalAwaiter final_suspend() const noexcept { return {}; }
+            void unhandled_exception() { Error = std::current_exception(); }
+
+            void Rethrow() const {
+                if (Error) std::rethrow_exception(Error);
+            }
+        };
+
+        template <typename T>
+        struct TaskPromise : PromiseBase {
+            std::optional<T> Value;
+
+            Task<T> get_return_object();
+            void return_value(T value) { Value.emplace(std::move(value)); }
+            T Take() {
+                Rethrow();
+                return std::move(*Value);
+            }
+        };
+
+        template <>
+        struct TaskPromise<void> : PromiseBase {
+            Task<void> get_return_object();
+            void return_void() const noexcept {}
+            void Take() const { Rethrow(); }
+        };
+
+        // Fire-and-forget coroutine: runs at once and frees itself when it ends
+        struct Detached {
+            struct promise_type {
+                Detached get_return_object() const noexcept { return {}; }
+                std::suspend_never initial_suspend() const noexcept { return {}; }
+                std::suspend_never final_suspend() const noexcept { return {}; }
+                void return_void() const noexcept {}
+                void unhandled_exception() const noexcept { std::terminate(); }
+            };
+        };
+    }
+
+    // Lazy coroutine: nothing runs until it is awaited (or handed to EventLoop::Spawn), and the
+    // awaiting coroutine continues right where the task finishes, on that thread. Exceptions
+    // reach the awaiter.
+    template <typename T>
+    class Task {
+    public:
+        using promise_type = Detail::TaskPromise<T>;
+
+        Task() = default;
+        explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+        Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+        Task& operator=(Task&& other) noexcept {
+            if (this != &other) {
+                if (handle) handle.destroy();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+        ~Task() {
+            if (handle) handle.destroy();
+        }
+
+        Task(const Task&) = delete;
+        Task& operator=(const Task&) = delete;
+
+        auto operator co_await() && noexcept {
+            struct Awaiter {
+                std::coroutine_handle<promise_type> handle;
+
+                bool await_ready() const noexcept { return !handle || handle.done(); }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) const noexcept {
+                    handle.promise().Continuation = awaiting;
+                    return handle;
+                }
+                T await_resume() const { return handle.promise().Take(); }
+            };
+            return Awaiter{ handle };
+        }
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    namespace Detail {
+        template <typename T>
+        Task<T> TaskPromise<T>::get_return_object() { return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this)); }
+        inline Task<void> TaskPromise<void>::get_return_object() { return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this)); }
+    }
+
+    // One thread that resumes coroutines. Code between two co_awaits runs here and never blocks:
+    // anything that waits on the disk, the registry or a child process goes through Offload, so
+    // the loop is free to advance every other stage meanwhile, and a stage waiting for another
+    // one holds no thread at all - only its coroutine frame.
+    class EventLoop {
+    public:
+        EventLoop() : thread([this]() { Loop(); }) {}
+        ~EventLoop() { Stop(); }
+
+        EventLoop(const EventLoop&) = delete;
+        EventLoop& operator=(const EventLoop&) = delete;
+
+        // Safe from any thread. Work posted after Stop is dropped.
+        void Post(std::function<void()> work) {
+            // Notified under the lock: the work may be the last resume of a Run, after which the
+            // caller is free to destroy the loop while a later notify would still be in progress
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) return;
+            queue.push_back(std::move(work));
+            wake.notify_one();
+        }
+
+        bool IsLoopThread() const { return std::this_thread::get_id() == thread.get_id(); }
+
+        // co_await loop.Schedule() continues on the loop thread
+        auto Schedule() {
+            struct Awaiter {
+                EventLoop& loop;
+                bool await_ready() const noexcept { return loop.IsLoopThread(); }
+                void await_suspend(std::coroutine_handle<> handle) const { loop.Post([handle]() { handle.resume(); }); }
+                void await_resume() const noexcept {}
+            };
+            return Awaiter{ *this };
+        }
+
+        // Runs fn() on the pool and continues on the loop with its result (or exception). If the
+        // pool drops the job unrun (it is shutting down) the coroutine still continues, and
+        // co_await throws std::runtime_error.
+        template <typename Fn>
+        auto Offload(WorkerPool& pool, Fn fn) {
+            using Result = std::invoke_result_t<Fn&>;
+            using Stored = std::conditional_t<std::is_void_v<Result>, bool, Result>;
+
+            struct Awaiter {
+                EventLoop& loop;
+                WorkerPool& pool;
+                Fn fn;
+                std::optional<Stored> value;
+                std::exception_ptr error;
+
+                // Travels with the job and resumes the coroutine exactly once: when the job has
+                // run, or when the pool destroys it without running it
+                struct Resumer {
+                    Awaiter* awaiter;
+                    std::coroutine_handle<> handle;
+
+                    Resumer(Awaiter* a, std::coroutine_handle<> h) : awaiter(a), handle(h) {}
+                    Resumer(Resumer&& other) noexcept : awaiter(std::exchange(other.awaiter, nullptr)), handle(other.handle) {}
+                    Resumer(const Resumer&) = delete;
+                    Resumer& operator=(const Resumer&) = delete;
+                    ~Resumer() {
+                        if (!awaiter) return;
+                        awaiter->error = std::make_exception_ptr(std::runtime_error("The worker pool stopped before the job ran"));
+                        Resume();
+                    }
+
+                    // The awaiter may be gone as soon as the loop runs this, so it is not touched after
+                    void Resume() {
+                        std::coroutine_handle<> h = handle;
+                        EventLoop& loop = std::exchange(awaiter, nullptr)->loop;
+                        loop.Post([h]() { h.resume(); });
+                    }
+                };
+
+                bool await_ready() const noexcept { return false; }
+                void await_suspend(std::coroutine_handle<> handle) {
+                    pool.Submit([this, resumer = Resumer(this, handle)](const CancellationToken&) mutable {
+                        try {
+                            if constexpr (std::is_void_v<Result>) {
+                                fn();
+                                value.emplace(true);
+                            }
+                            else {
+                                value.emplace(fn());
+                            }
+                        }
+                        catch (...) {
+                            error = std::current_exception();
+                        }
+                        resumer.Resume();
+                    }, JobPriority::High);
+                }
+                Result await_resume() {
+                    if (error) std::rethrow_exception(error);
+                    if constexpr (!std::is_void_v<Result>) return std::move(*value);
+                }
+            };
+            return Awaiter{ *this, pool, std::move(fn), std::nullopt, nullptr };
+        }
+
+        // Starts task on the loop; onDone(result) runs on the loop when it finishes. The task
+        // must not throw - there is nobody left to catch it.
+        template <typename T, typename Fn>
+        void Spawn(Task<T> task, Fn onDone) {
+            Drive(*this, std::move(task), std::move(onDone));
+        }
+
+        // Starts task on the loop and blocks the caller until it finishes. Not on the loop thread.
+        template <typename T>
+        T Run(Task<T> task) {
+            auto result = std::make_shared<std::promise<T>>();
+            std::future<T> future = result->get_future();
+            Capture(*this, std::move(task), result);
+            return future.get();
+        }
+
+        // Ends the loop thread once the work already posted has run
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) return;
+                stopping = true;
+            }
+            wake.notify_one();
+            if (thread.joinable()) thread.join();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable wake;
+        std::deque<std::function<void()>> queue;
+        bool stopping = false;
+        std::thread thread;     // Last: starts once everything above exists
+
+        void Loop() {
+            UEBUILDER_PROFILE_THREAD("Event loop");
+            while (true) {
+                std::function<void()> work;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [&]() { return stopping || !queue.empty(); });
+                    if (queue.empty()) return;
+                    work = std::move(queue.front());
+                    queue.pop_front();
+                }
+                work();
+            }
+        }
+
+        template <typename T, typename Fn>
+        static Detail::Detached Drive(EventLoop& loop, Task<T> task, Fn onDone) {
+            co_await loop.Schedule();
+            if constexpr (std::is_void_v<T>) {
+                co_await std::move(task);
+                onDone();
+            }
+            else {
+                onDone(co_await std::move(task));
+            }
+        }
+
+        template <typename T>
+        static Detail::Detached Capture(EventLoop& loop, Task<T> task, std::shared_ptr<std::promise<T>> result) {
+            co_await loop.Schedule();
+            try {
+                if constexpr (std::is_void_v<T>) {
+                    co_await std::move(task);
+                    result->set_value();
+                }
+                else {
+                    result->set_value(co_await std::move(task));
+                }
+            }
+            catch (...) {
+                result->set_exception(std::current_exception());
+            }
+        }
+    };
+
+    namespace Detail {
+        struct WhenAllState {
+            size_t Remaining = 0;
+            std::coroutine_handle<> Parent;
+            std::exception_ptr Error;
+        };
+
+        // Children resume on the loop thread, so the count needs no atomics
+        inline Detached RunChild(Task<>& task, WhenAllState& state) {
+            try {
+                co_await std::move(task);
+            }
+            catch (...) {
+                if (!state.Error) state.Error = std::current_exception();
+            }
+            if (--state.Remaining == 0) state.Parent.resume();
+        }
+    }
+
+    // co_await WhenAll(a, b) runs the tasks concurrently and continues once all of them have
+    // finished; the first exception is rethrown after that. Results travel through state the
+    // tasks share with the caller.
+    //
+    // The tasks are named locals, not temporaries: GCC 12 copies temporaries of a co_await
+    // expression into the coroutine frame bitwise and then destroys both copies.
+    template <typename... Tasks>
+    auto WhenAll(Tasks&... tasks) {
+        static_assert((std::is_same_v<Tasks, Task<>> && ...), "WhenAll takes Task<void>");
+
+        struct Awaiter {
+            std::tuple<Tasks&...> tasks;
+            Detail::WhenAllState state;
+
+            bool await_ready() const noexcept { return sizeof...(Tasks) == 0; }
+            bool await_suspend(std::coroutine_handle<> parent) {
+                state.Parent = parent;
+                state.Remaining = sizeof...(Tasks) + 1;   // +1 until every child has started
+                std::apply([this](auto&... task) { (Detail::RunChild(task, state), ...); }, tasks);
+                return --state.Remaining != 0;            // All done already: carry on without suspending
+            }
+            void await_resume() const {
+                if (state.Error) std::rethrow_exception(state.Error);
+            }
+        };
+        return Awaiter{ std::tie(tasks...), {} };
+    }
+}
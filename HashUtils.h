@@ -0,0 +1,219 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    class HashUtils {
+    public:
+        static std::string ToHex(const uint8_t* bytes, size_t len) {
+            static const char* digits = "0123456789abcdef";
+            std::string out;
+            out.reserve(len * 2);
+            for (size_t i = 0; i < len; ++i) {
+                out.push_back(digits[bytes[i] >> 4]);
+                out.push_back(digits[bytes[i] & 0xF]);
+            }
+            return out;
+        }
+
+        // 64-bit FNV-1a, for cheap in-memory keys (not for integrity checks)
+        static uint64_t Fnv1a64(const void* data, size_t len, uint64_t seed = 14695981039346656037ull) {
+            const uint8_t* p = static_cast<const uint8_t*>(data);
+            uint64_t h = seed;
+            for (size_t i = 0; i < len; ++i) {
+                h ^= p[i];
+                h *= 1099511628211ull;
+            }
+            return h;
+        }
+
+        static uint64_t Fnv1a64(const std::string& s) { return Fnv1a64(s.data(), s.size()); }
+    };
+
+    // Plain SHA-256 (FIPS 180-4). Used for manifests and download verification,
+    // so we don't have to pull in CNG/OpenSSL just for hashing files.
+    class Sha256 {
+    public:
+        Sha256() { Reset(); }
+
+        void Reset() {
+            static const uint32_t init[8] = {
+                0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+                0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+            };
+            std::memcpy(state, init, sizeof(state));
+            totalBytes = 0;
+            bufferLen = 0;
+        }
+
+        void Update(const void* data, size_t len) {
+            const uint8_t* p = static_cast<const uint8_t*>(data);
+            totalBytes += len;
+
+            if (bufferLen > 0) {
+                size_t take = (std::min)(len, size_t(64) - bufferLen);
+                std::memcpy(buffer + bufferLen, p, take);
+                bufferLen += take;
+                p += take;
+                len -= take;
+                if (bufferLen == 64) {
+                    Transform(buffer);
+                    bufferLen = 0;
+                }
+            }
+            while (len >= 64) {
+                Transform(p);
+                p += 64;
+                len -= 64;
+            }
+            if (len > 0) {
+                std::memcpy(buffer, p, len);
+                bufferLen = len;
+            }
+        }
+
+        void Update(const std::string& s) { Update(s.data(), s.size()); }
+
+        // Returns the 32 byte digest; the hasher must be Reset() before reuse
+        std::vector<uint8_t> Final() {
+            uint64_t bitLen = totalBytes * 8;
+            uint8_t pad = 0x80;
+            Update(&pad, 1);
+            uint8_t zero = 0;
+            while (bufferLen != 56) Update(&zero, 1);
+
+            uint8_t lenBytes[8];
+            for (int i = 0; i < 8; ++i) lenBytes[i] = static_cast<uint8_t>(bitLen >> (56 - 8 * i));
+            Update(lenBytes, 8);
+
+            std::vector<uint8_t> digest(32);
+            for (int i = 0; i < 8; ++i) {
+                digest[i * 4 + 0] = static_cast<uint8_t>(state[i] >> 24);
+                digest[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+                digest[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+                digest[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+            }
+            return digest;
+        }
+
+        std::string FinalHex() {
+            std::vector<uint8_t> digest = Final();
+            return HashUtils::ToHex(digest.data(), digest.size());
+        }
+
+        static std::string HashString(const std::string& s) {
+            Sha256 h;
+            h.Update(s);
+            return h.FinalHex();
+        }
+
+        // Returns empty string if the file can't be read
+        static std::string HashFile(const fs::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) return "";
+
+            Sha256 hasher;
+            std::vector<char> chunk(1 << 20);
+            while (file) {
+                file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                std::streamsize got = file.gcount();
+                if (got > 0) hasher.Update(chunk.data(), static_cast<size_t>(got));
+            }
+            return hasher.FinalHex();
+        }
+
+    private:
+        uint32_t state[8];
+        uint64_t totalBytes = 0;
+        uint8_t buffer[64];
+        size_t bufferLen = 0;
+
+        static uint32_t Rotr(uint32_t x, int n) { return (x >> n) | (x << (32 - n)); }
+
+        void Transform(const uint8_t* block) {
+            static const uint32_t k[64] = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+            };
+
+            uint32_t w[64];
+            for (int i = 0; i < 16; ++i) {
+                w[i] = (uint32_t(block[i * 4]) << 24) | (uint32_t(block[i * 4 + 1]) << 16) |
+                       (uint32_t(block[i * 4 + 2]) << 8) | uint32_t(block[i * 4 + 3]);
+            }
+            for (int i = 16; i < 64; ++i) {
+                uint32_t s0 = Rotr(w[i - 15], 7) ^ Rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                uint32_t s1 = Rotr(w[i - 2], 17) ^ Rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+            }
+
+            uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+            uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+
+            for (int i = 0; i < 64; ++i) {
+                uint32_t S1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+                uint32_t ch = (e & f) ^ (~e & g);
+                uint32_t t1 = h + S1 + ch + k[i] + w[i];
+                uint32_t S0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+                uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+                uint32_t t2 = S0 + maj;
+
+                h = g; g = f; f = e; e = d + t1;
+                d = c; c = b; b = a; a = t1 + t2;
+            }
+
+            state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+            state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+        }
+    };
+
+    // rsync-style weak rolling checksum. Cheap to slide one byte at a time,
+    // so we can find matching blocks at any offset in an old file.
+    class RollingChecksum {
+    public:
+        void Init(const uint8_t* data, size_t len) {
+            a = 0;
+            b = 0;
+            window = len;
+            for (size_t i = 0; i < len; ++i) {
+                a += data[i];
+                b += static_cast<uint32_t>(len - i) * data[i];
+            }
+            a &= 0xFFFF;
+            b &= 0xFFFF;
+        }
+
+        // Slide the window one byte: drop 'out', append 'in'
+        void Roll(uint8_t out, uint8_t in) {
+            a = (a - out + in) & 0xFFFF;
+            b = (b - static_cast<uint32_t>(window) * out + a) & 0xFFFF;
+        }
+
+        uint32_t Value() const { return a | (b << 16); }
+
+        static uint32_t Compute(const uint8_t* data, size_t len) {
+            RollingChecksum r;
+            r.Init(data, len);
+            return r.Value();
+        }
+
+    private:
+        uint32_t a = 0;
+        uint32_t b = 0;
+        size_t window = 0;
+    };
+}
@@ -0,0 +1,371 @@
+#pragma once
+#include "Sockets.h"
+#include "StringUtils.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+
+#ifdef _WIN32
+#include <winhttp.h>
+#pragma comment(lib, "winhttp.lib")
+#endif
+
+namespace UEBuilder {
+
+    struct HttpResponse {
+        int Status = 0;
+        int64_t ContentLength = -1;      // -1 when the server didn't say
+        std::vector<std::pair<std::string, std::string>> Headers; // Names lower-cased
+        std::string Body;                // Empty when a body sink was used
+
+        std::string Header(const std::string& lowerName) const {
+            for (const auto& h : Headers) {
+                if (h.first == lowerName) return h.second;
+            }
+            return "";
+        }
+    };
+
+    // Receives body bytes as they arrive; return false to abort the transfer
+    using HttpBodySink = std::function<bool(const char* data, size_t len)>;
+
+    // Minimal HTTP/1.1 client for plain http:// file servers (shared build caches,
+    // "python -m http.server" on localhost, etc). One request per connection.
+    // On Windows https:// goes through WinHTTP instead, which brings TLS and the system proxy.
+    class HttpClient {
+    public:
+        struct Url {
+            std::string Host;
+            std::string Port = "80";
+            std::string Path = "/";
+        };
+
+        static bool IsHttpUrl(const std::string& s) {
+            return s.compare(0, 7, "http://") == 0;
+        }
+
+        static bool IsHttpsUrl(const std::string& s) {
+            return s.compare(0, 8, "https://") == 0;
+        }
+
+        // What Request can fetch on this platform
+        static bool IsSupportedUrl(const std::string& s) {
+#ifdef _WIN32
+            return IsHttpUrl(s) || IsHttpsUrl(s);
+#else
+            return IsHttpUrl(s);
+#endif
+        }
+
+        static bool ParseUrl(const std::string& url, Url& out) {
+            if (!IsHttpUrl(url)) return false;
+
+            std::string rest = url.substr(7);
+            size_t slash = rest.find('/');
+            std::string hostPort = rest.substr(0, slash);
+            out.Path = slash == std::string::npos ? "/" : rest.substr(slash);
+
+            size_t colon = hostPort.rfind(':');
+            if (colon != std::string::npos && hostPort.find(']') == std::string::npos) {
+                out.Host = hostPort.substr(0, colon);
+                out.Port = hostPort.substr(colon + 1);
+            }
+            else {
+                out.Host = hostPort;
+            }
+            return !out.Host.empty();
+        }
+
+        // Percent-encodes a relative path (keeps '/' separators)
+        static std::string EncodePath(const std::string& path) {
+            static const char* hex = "0123456789ABCDEF";
+            std::string out;
+            for (unsigned char c : path) {
+                if (isalnum(c) || c == '/' || c == '-' || c == '_' || c == '.' || c == '~') {
+                    out.push_back(static_cast<char>(c));
+                }
+                else {
+                    out.push_back('%');
+                    out.push_back(hex[c >> 4]);
+                    out.push_back(hex[c & 0xF]);
+                }
+            }
+            return out;
+        }
+
+        static bool Get(const std::string& url, HttpResponse& response, HttpBodySink sink = nullptr) {
+            return Request("GET", url, {}, response, sink);
+        }
+
+        static bool Head(const std::string& url, HttpResponse& response) {
+            return Request("HEAD", url, {}, response, nullptr);
+        }
+
+        // Inclusive byte range [offset, offset + length - 1]; expects 206 Partial Content
+        static bool GetRange(const std::string& url, uint64_t offset, uint64_t length, HttpResponse& response, HttpBodySink sink = nullptr) {
+            std::string range = "bytes=" + std::to_string(offset) + "-" + std::to_string(offset + length - 1);
+            return Request("GET", url, { { "Range", range } }, response, sink);
+        }
+
+        // Sends a request and reads the response. Follows a few redirects.
+        // Returns false only on transport errors; check response.Status for HTTP errors.
+        static bool Request(const std::string& method, const std::string& url,
+                            const std::vector<std::pair<std::string, std::string>>& headers,
+                            HttpResponse& response, HttpBodySink sink) {
+            if (IsHttpsUrl(url)) {
+#ifdef _WIN32
+                response = HttpResponse();
+                return WinHttpSend(method, url, headers, response, sink);
+#else
+                return false;
+#endif
+            }
+
+            std::string currentUrl = url;
+
+            for (int redirects = 0; redirects < 5; ++redirects) {
+                Url parsed;
+                if (!ParseUrl(currentUrl, parsed)) return false;
+
+                response = HttpResponse();
+                if (!SendOnce(method, parsed, headers, response, sink)) return false;
+
+                bool isRedirect = response.Status == 301 || response.Status == 302 ||
+                                  response.Status == 303 || response.Status == 307 || response.Status == 308;
+                std::string location = response.Header("location");
+                if (!isRedirect || location.empty()) return true;
+
+                if (location[0] == '/') {
+                    currentUrl = "http://" + parsed.Host + ":" + parsed.Port + location;
+                }
+                else {
+                    currentUrl = location;
+                }
+            }
+            return false;
+        }
+
+    private:
+#ifdef _WIN32
+        // WinHTTP follows redirects itself, including http -> https
+        static bool WinHttpSend(const std::string& method, const std::string& url,
+                                const std::vector<std::pair<std::string, std::string>>& headers,
+                                HttpResponse& response, const HttpBodySink& sink) {
+            std::wstring wideUrl = StringUtils::FromUtf8(url);
+            URL_COMPONENTS parts;
+            ZeroMemory(&parts, sizeof(parts));
+            parts.dwStructSize = sizeof(parts);
+            parts.dwHostNameLength = static_cast<DWORD>(-1);
+            parts.dwUrlPathLength = static_cast<DWORD>(-1);
+            parts.dwExtraInfoLength = static_cast<DWORD>(-1);
+            if (!WinHttpCrackUrl(wideUrl.c_str(), 0, 0, &parts)) return false;
+
+            std::wstring host(parts.lpszHostName, parts.dwHostNameLength);
+            std::wstring path(parts.lpszUrlPath, parts.dwUrlPathLength);
+            if (parts.lpszExtraInfo) path.append(parts.lpszExtraInfo, parts.dwExtraInfoLength);
+            if (path.empty()) path = L"/";
+
+            std::wstring extraHeaders;
+            for (const auto& h : headers) extraHeaders += StringUtils::FromUtf8(h.first + ": " + h.second + "\r\n");
+
+            HINTERNET session = WinHttpOpen(L"UEBuilder", WINHTTP_ACCESS_TYPE_DEFAULT_PROXY, WINHTTP_NO_PROXY_NAME, WINHTTP_NO_PROXY_BYPASS, 0);
+            HINTERNET connection = session ? WinHttpConnect(session, host.c_str(), parts.nPort, 0) : NULL;
+            HINTERNET request = connection ? WinHttpOpenRequest(connection, StringUtils::FromUtf8(method).c_str(), path.c_str(), NULL,
+                                                                WINHTTP_NO_REFERER, WINHTTP_DEFAULT_ACCEPT_TYPES,
+                                                                parts.nScheme == INTERNET_SCHEME_HTTPS ? WINHTTP_FLAG_SECURE : 0)
+                                           : NULL;
+
+            bool ok = request &&
+                      WinHttpSendRequest(request, extraHeaders.empty() ? WINHTTP_NO_ADDITIONAL_HEADERS : extraHeaders.c_str(),
+                                         extraHeaders.empty() ? 0 : static_cast<DWORD>(-1L), WINHTTP_NO_REQUEST_DATA, 0, 0, 0) &&
+                      WinHttpReceiveResponse(request, NULL);
+
+            // The raw block starts with the status line, so it parses like our own responses
+            if (ok) {
+                DWORD size = 0;
+                WinHttpQueryHeaders(request, WINHTTP_QUERY_RAW_HEADERS_CRLF, WINHTTP_HEADER_NAME_BY_INDEX, NULL, &size, WINHTTP_NO_HEADER_INDEX);
+                std::wstring raw(size / sizeof(wchar_t) + 1, L'\0');
+                ok = WinHttpQueryHeaders(request, WINHTTP_QUERY_RAW_HEADERS_CRLF, WINHTTP_HEADER_NAME_BY_INDEX, &raw[0], &size, WINHTTP_NO_HEADER_INDEX) &&
+                     ParseHeaders(StringUtils::ToUtf8(raw.c_str()), response);
+            }
+
+            if (ok && method != "HEAD") {
+                char chunk[65536];
+                DWORD got = 0;
+                while (true) {
+                    if (!WinHttpReadData(request, chunk, sizeof(chunk), &got)) { ok = false; break; }
+                    if (got == 0) break;
+                    if (!Deliver(chunk, got, response, sink)) { ok = false; break; }
+                }
+            }
+
+            if (request) WinHttpCloseHandle(request);
+            if (connection) WinHttpCloseHandle(connection);
+            if (session) WinHttpCloseHandle(session);
+            return ok;
+        }
+#endif
+
+        static bool SendOnce(const std::string& method, const Url& url,
+                             const std::vector<std::pair<std::string, std::string>>& headers,
+                             HttpResponse& response, const HttpBodySink& sink) {
+            SocketHandle s = Sockets::Connect(url.Host, url.Port);
+            if (s == InvalidSocket) return false;
+
+            std::string req = method + " " + url.Path + " HTTP/1.1\r\n";
+            req += "Host: " + url.Host + (url.Port == "80" ? "" : ":" + url.Port) + "\r\n";
+            req += "User-Agent: UEBuilder\r\n";
+            req += "Connection: close\r\n";
+            for (const auto& h : headers) req += h.first + ": " + h.second + "\r\n";
+            req += "\r\n";
+
+            if (!Sockets::SendAll(s, req)) {
+                Sockets::Close(s);
+                return false;
+            }
+
+            // --- Read headers ---
+            std::string buffer;
+            char chunk[16384];
+            size_t headerEnd = std::string::npos;
+
+            while (headerEnd == std::string::npos) {
+                int got = Sockets::Recv(s, chunk, sizeof(chunk));
+                if (got <= 0) {
+                    Sockets::Close(s);
+                    return false;
+                }
+                buffer.append(chunk, static_cast<size_t>(got));
+                headerEnd = buffer.find("\r\n\r\n");
+            }
+
+            if (!ParseHeaders(buffer.substr(0, headerEnd), response)) {
+                Sockets::Close(s);
+                return false;
+            }
+
+            std::string body = buffer.substr(headerEnd + 4);
+            bool chunked = response.Header("transfer-encoding").find("chunked") != std::string::npos;
+            bool hasBody = method != "HEAD" && response.Status != 204 && response.Status != 304;
+
+            bool ok = true;
+            if (!hasBody) {
+                // Nothing to read
+            }
+            else if (chunked) {
+                ok = ReadChunked(s, body, response, sink);
+            }
+            else {
+                ok = ReadPlain(s, body, response, sink);
+            }
+
+            Sockets::Close(s);
+            return ok;
+        }
+
+        static bool Deliver(const char* data, size_t len, HttpResponse& response, const HttpBodySink& sink) {
+            if (len == 0) return true;
+            // Error pages and redirect bodies never reach the sink
+            if (sink && response.Status >= 200 && response.Status < 300) return sink(data, len);
+            response.Body.append(data, len);
+            return true;
+        }
+
+        static bool ReadPlain(SocketHandle s, std::string& pending, HttpResponse& response, const HttpBodySink& sink) {
+            uint64_t received = 0;
+            bool limited = response.ContentLength >= 0;
+            uint64_t expected = limited ? static_cast<uint64_t>(response.ContentLength) : 0;
+
+            if (!pending.empty()) {
+                size_t take = limited ? static_cast<size_t>((std::min)(static_cast<uint64_t>(pending.size()), expected)) : pending.size();
+                if (!Deliver(pending.data(), take, response, sink)) return false;
+                received += take;
+            }
+
+            char chunk[65536];
+            while (!limited || received < expected) {
+                int got = Sockets::Recv(s, chunk, sizeof(chunk));
+                if (got < 0) return false;
+                if (got == 0) break;
+
+                size_t take = static_cast<size_t>(got);
+                if (limited) take = static_cast<size_t>((std::min)(static_cast<uint64_t>(got), expected - received));
+                if (!Deliver(chunk, take, response, sink)) return false;
+                received += take;
+            }
+            return !limited || received == expected;
+        }
+
+        static bool ReadChunked(SocketHandle s, std::string& data, HttpResponse& response, const HttpBodySink& sink) {
+            char chunk[65536];
+            size_t pos = 0;
+
+            // Make sure at least 'need' bytes are buffered after pos
+            auto fill = [&](size_t need) {
+                while (data.size() - pos < need) {
+                    int got = Sockets::Recv(s, chunk, sizeof(chunk));
+                    if (got <= 0) return false;
+                    data.append(chunk, static_cast<size_t>(got));
+                }
+                return true;
+            };
+
+            while (true) {
+                size_t lineEnd;
+                while ((lineEnd = data.find("\r\n", pos)) == std::string::npos) {
+                    if (!fill(data.size() - pos + 1)) return false;
+                }
+
+                uint64_t size = std::strtoull(data.substr(pos, lineEnd - pos).c_str(), nullptr, 16);
+                pos = lineEnd + 2;
+                if (size == 0) return true; // Trailers are ignored
+
+                if (!fill(static_cast<size_t>(size) + 2)) return false;
+                if (!Deliver(data.data() + pos, static_cast<size_t>(size), response, sink)) return false;
+                pos += static_cast<size_t>(size) + 2;
+
+                // Don't let the buffer grow without bound on long transfers
+                if (pos > (1 << 20)) {
+                    data.erase(0, pos);
+                    pos = 0;
+                }
+            }
+        }
+
+        static bool ParseHeaders(const std::string& head, HttpResponse& response) {
+            size_t lineEnd = head.find("\r\n");
+            std::string statusLine = head.substr(0, lineEnd);
+
+            // "HTTP/1.1 206 Partial Content"
+            size_t sp = statusLine.find(' ');
+            if (sp == std::string::npos || statusLine.compare(0, 5, "HTTP/") != 0) return false;
+            response.Status = std::atoi(statusLine.c_str() + sp + 1);
+
+            size_t pos = lineEnd == std::string::npos ? head.size() : lineEnd + 2;
+            while (pos < head.size()) {
+                size_t end = head.find("\r\n", pos);
+                if (end == std::string::npos) end = head.size();
+
+                std::string line = head.substr(pos, end - pos);
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) {
+                    std::string name = line.substr(0, colon);
+                    std::transform(name.begin(), name.end(), name.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+
+                    size_t valueStart = line.find_first_not_of(" \t", colon + 1);
+                    std::string value = valueStart == std::string::npos ? "" : line.substr(valueStart);
+                    response.Headers.emplace_back(name, value);
+                }
+                pos = end + 2;
+            }
+
+            std::string len = response.Header("content-length");
+            if (!len.empty()) response.ContentLength = std::strtoll(len.c_str(), nullptr, 10);
+            return true;
+        }
+    };
+}
@@ -0,0 +1,428 @@
+#pragma once
+#include "MappedFile.h"
+#include "StringUtils.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <cstring>
+#include <cstdint>
+#include <cctype>
+#include <cwctype>
+#include <cstdio>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define UEBUILDER_HAS_SSE2 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    struct HeaderCost {
+        std::string Path;               // Relative to the project root
+        uint64_t Size = 0;
+        uint32_t DirectIncluders = 0;
+        uint32_t TranslationUnits = 0;  // .cpp files that include it, directly or transitively
+        double Score = 0.0;             // TranslationUnits * Size
+    };
+
+    struct IncludeScanResult {
+        std::vector<HeaderCost> Ranked; // Highest score first
+        size_t FilesScanned = 0;
+        size_t TranslationUnits = 0;
+        size_t Modules = 0;
+        size_t IncludesResolved = 0;
+        size_t IncludesExternal = 0;    // Engine/system headers we don't own
+        double Seconds = 0.0;
+    };
+
+    // Preprocessor-lite #include graph of a project's Source/ and Plugins/**/Source/ trees.
+    // Conditionals and macros are ignored on purpose: a header that is included under
+    // any #if still costs rebuilds when it changes, which is what we're ranking.
+    class IncludeScanner {
+    public:
+        static IncludeScanResult Scan(const fs::path& projectRoot, unsigned threadCount = 0) {
+            auto startTime = std::chrono::steady_clock::now();
+            IncludeScanResult result;
+
+            // --- STEP 1: Collect source files and modules ---
+            std::vector<fs::path> sourceRoots;
+            CollectSourceRoots(projectRoot, sourceRoots);
+
+            std::vector<Node> nodes;
+            std::vector<fs::path> moduleDirs;
+            for (const auto& root : sourceRoots) CollectFiles(root, nodes, moduleDirs);
+
+            result.FilesScanned = nodes.size();
+            result.Modules = moduleDirs.size();
+            if (nodes.empty()) return result;
+
+            AssignModules(nodes, moduleDirs);
+
+            // --- STEP 2: Scan every file for #include lines in parallel ---
+            ParallelFor(nodes.size(), threadCount, [&](size_t i) {
+                MappedFile file;
+                if (!file.Open(nodes[i].Path)) return;
+                nodes[i].Size = file.Size();
+                ExtractIncludes(file.Data(), file.Size(), nodes[i].RawIncludes);
+            });
+
+            // --- STEP 3: Resolve includes against module include roots ---
+            ResolveIncludes(nodes, moduleDirs, sourceRoots, result);
+
+            // --- STEP 4: Transitive fan-in per header ---
+            std::vector<uint32_t> translationUnits(nodes.size(), 0);
+            std::vector<uint32_t> directIncluders(nodes.size(), 0);
+            CountFanIn(nodes, threadCount, translationUnits, directIncluders, result);
+
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (!nodes[i].IsHeader || translationUnits[i] == 0) continue;
+
+                HeaderCost cost;
+                cost.Path = StringUtils::GenericRelative(nodes[i].Path, projectRoot);
+                cost.Size = nodes[i].Size;
+                cost.DirectIncluders = directIncluders[i];
+                cost.TranslationUnits = translationUnits[i];
+                cost.Score = static_cast<double>(cost.TranslationUnits) * static_cast<double>(cost.Size);
+                result.Ranked.push_back(cost);
+            }
+
+            std::sort(result.Ranked.begin(), result.Ranked.end(), [](const HeaderCost& a, const HeaderCost& b) {
+                return a.Score > b.Score;
+            });
+
+            result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            return result;
+        }
+
+        static std::string FormatReport(const IncludeScanResult& result, size_t topN = 50) {
+            std::ostringstream out;
+            out << "Include graph report\n";
+            out << "  Files scanned:      " << result.FilesScanned << "\n";
+            out << "  Translation units:  " << result.TranslationUnits << "\n";
+            out << "  Modules:            " << result.Modules << "\n";
+            out << "  Includes resolved:  " << result.IncludesResolved << "\n";
+            out << "  Includes external:  " << result.IncludesExternal << " (engine/system, not ranked)\n";
+            out << "  Scan time:          " << result.Seconds << " s\n\n";
+            out << "Headers most likely to cause mass rebuilds (score = TUs x size):\n\n";
+
+            char line[128];
+            std::snprintf(line, sizeof(line), "%4s  %12s  %6s  %7s  %9s  %s\n", "#", "Score(KB)", "TUs", "Direct", "Size(KB)", "Header");
+            out << line;
+
+            size_t count = (std::min)(topN, result.Ranked.size());
+            for (size_t i = 0; i < count; ++i) {
+                const HeaderCost& h = result.Ranked[i];
+                std::snprintf(line, sizeof(line), "%4zu  %12.0f  %6u  %7u  %9.1f  ",
+                              i + 1, h.Score / 1024.0, h.TranslationUnits, h.DirectIncluders, h.Size / 1024.0);
+                out << line << h.Path << "\n";
+            }
+            return out.str();
+        }
+
+        static bool WriteReport(const fs::path& reportPath, const std::string& report) {
+            std::error_code ec;
+            fs::create_directories(reportPath.parent_path(), ec);
+            std::ofstream file(reportPath, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file << report;
+            return static_cast<bool>(file);
+        }
+
+        // Finds every `#include "x"` / `#include <x>` that starts a line.
+        // Public so benchmarks can drive it over in-memory buffers.
+        static void ExtractIncludes(const char* data, size_t size, std::vector<std::string>& out) {
+            const char* begin = data;
+            const char* end = data + size;
+            const char* p = begin;
+
+            while (p < end) {
+                const char* hash = FindNextHash(p, end);
+                if (!hash) break;
+                p = hash + 1;
+
+                // Only directives: nothing but whitespace between the line start and '#'
+                const char* back = hash;
+                while (back > begin && (back[-1] == ' ' || back[-1] == '\t')) --back;
+                if (back > begin && back[-1] != '\n' && back[-1] != '\r') continue;
+
+                const char* q = p;
+                while (q < end && (*q == ' ' || *q == '\t')) ++q;
+                if (end - q < 7 || std::memcmp(q, "include", 7) != 0) continue;
+                q += 7;
+                while (q < end && (*q == ' ' || *q == '\t')) ++q;
+                if (q >= end || (*q != '"' && *q != '<')) continue;
+
+                char close = (*q == '"') ? '"' : '>';
+                const char* nameStart = ++q;
+                while (q < end && *q != close && *q != '\n') ++q;
+                if (q >= end || *q != close) continue;
+
+                out.emplace_back(nameStart, static_cast<size_t>(q - nameStart));
+                p = q + 1;
+            }
+        }
+
+    private:
+        struct Node {
+            fs::path Path;
+            uint64_t Size = 0;
+            bool IsHeader = false;
+            int Module = -1;
+            std::vector<std::string> RawIncludes;
+            std::vector<uint32_t> Includes;
+        };
+
+        static const char* FindNextHash(const char* p, const char* end) {
+#ifdef UEBUILDER_HAS_SSE2
+            const __m128i needle = _mm_set1_epi8('#');
+            while (end - p >= 16) {
+                __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+                int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+                if (mask != 0) return p + CountTrailingZeros(static_cast<unsigned>(mask));
+                p += 16;
+            }
+#endif
+            const void* found = std::memchr(p, '#', static_cast<size_t>(end - p));
+            return static_cast<const char*>(found);
+        }
+
+        static unsigned CountTrailingZeros(unsigned mask) {
+#if defined(_MSC_VER)
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return static_cast<unsigned>(index);
+#else
+            return static_cast<unsigned>(__builtin_ctz(mask));
+#endif
+        }
+
+        template <typename Fn>
+        static void ParallelFor(size_t count, unsigned threadCount, Fn fn) {
+            if (threadCount == 0) threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+            threadCount = static_cast<unsigned>((std::min)(static_cast<size_t>(threadCount), count));
+
+            std::atomic<size_t> next{ 0 };
+            auto worker = [&]() {
+                for (size_t i = next.fetch_add(1); i < count; i = next.fetch_add(1)) fn(i);
+            };
+
+            std::vector<std::thread> threads;
+            for (unsigned t = 1; t < threadCount; ++t) threads.emplace_back(worker);
+            worker();
+            for (auto& t : threads) t.join();
+        }
+
+        static std::string LowerKey(std::string s) {
+            std::replace(s.begin(), s.end(), '\\', '/');
+            std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(tolower(c)); });
+            return s;
+        }
+
+        static std::string PathKey(const fs::path& p) {
+            return LowerKey(StringUtils::ToUtf8(p.lexically_normal().generic_wstring()));
+        }
+
+        static bool IsHeaderExt(const std::wstring& ext) {
+            return ext == L".h" || ext == L".hpp" || ext == L".inl" || ext == L".hh";
+        }
+
+        static bool IsSourceExt(const std::wstring& ext) {
+            return ext == L".cpp" || ext == L".cc" || ext == L".c" || ext == L".cxx";
+        }
+
+        static void CollectSourceRoots(const fs::path& projectRoot, std::vector<fs::path>& out) {
+            std::error_code ec;
+            if (fs::is_directory(projectRoot / "Source", ec)) out.push_back(projectRoot / "Source");
+
+            fs::path plugins = projectRoot / "Plugins";
+            if (!fs::is_directory(plugins, ec)) return;
+
+            for (auto it = fs::recursive_directory_iterator(plugins, fs::directory_options::skip_permission_denied, ec);
+                 it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                if (!it->is_directory(ec)) continue;
+
+                std::wstring name = it->path().filename().wstring();
+                if (name == L"Source") {
+                    out.push_back(it->path());
+                    it.disable_recursion_pending();
+                }
+                else if (name == L"Binaries" || name == L"Intermediate" || name == L"Content" || name == L"Saved") {
+                    it.disable_recursion_pending();
+                }
+            }
+        }
+
+        static void CollectFiles(const fs::path& root, std::vector<Node>& nodes, std::vector<fs::path>& moduleDirs) {
+            std::error_code ec;
+            for (auto it = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, ec);
+                 it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                if (!it->is_regular_file(ec)) continue;
+
+                const fs::path& path = it->path();
+                std::wstring filename = path.filename().wstring();
+                if (filename.size() > 9 && filename.compare(filename.size() - 9, 9, L".Build.cs") == 0) {
+                    moduleDirs.push_back(path.parent_path());
+                    continue;
+                }
+
+                std::wstring ext = path.extension().wstring();
+                std::transform(ext.begin(), ext.end(), ext.begin(), [](wchar_t c) { return static_cast<wchar_t>(towlower(c)); });
+                bool header = IsHeaderExt(ext);
+                if (!header && !IsSourceExt(ext)) continue;
+
+                Node node;
+                node.Path = path;
+                node.IsHeader = header;
+                nodes.push_back(std::move(node));
+            }
+        }
+
+        // A file belongs to the deepest module directory above it
+        static void AssignModules(std::vector<Node>& nodes, const std::vector<fs::path>& moduleDirs) {
+            std::vector<std::string> moduleKeys;
+            for (const auto& dir : moduleDirs) moduleKeys.push_back(PathKey(dir) + "/");
+
+            for (auto& node : nodes) {
+                std::string key = PathKey(node.Path);
+                size_t best = 0;
+                for (size_t m = 0; m < moduleKeys.size(); ++m) {
+                    if (key.compare(0, moduleKeys[m].size(), moduleKeys[m]) == 0 && moduleKeys[m].size() > best) {
+                        best = moduleKeys[m].size();
+                        node.Module = static_cast<int>(m);
+                    }
+                }
+            }
+        }
+
+        static void ResolveIncludes(std::vector<Node>& nodes, const std::vector<fs::path>& moduleDirs,
+                                    const std::vector<fs::path>& sourceRoots, IncludeScanResult& result) {
+            // Absolute path -> node, and "include spelling" -> candidate nodes.
+            // Spellings are the file's path relative to each include root UBT would add:
+            // <Module>/Public, /Classes, /Private, the module dir itself and the Source root.
+            std::unordered_map<std::string, uint32_t> byPath;
+            std::unordered_map<std::string, std::vector<uint32_t>> bySpelling;
+
+            std::vector<std::vector<std::string>> moduleRoots(moduleDirs.size());
+            for (size_t m = 0; m < moduleDirs.size(); ++m) {
+                for (const char* sub : { "Public", "Classes", "Private", "" }) {
+                    fs::path dir = *sub ? moduleDirs[m] / sub : moduleDirs[m];
+                    moduleRoots[m].push_back(PathKey(dir) + "/");
+                }
+            }
+            std::vector<std::string> sourceRootKeys;
+            for (const auto& root : sourceRoots) sourceRootKeys.push_back(PathKey(root) + "/");
+
+            for (uint32_t i = 0; i < nodes.size(); ++i) {
+                std::string key = PathKey(nodes[i].Path);
+                byPath[key] = i;
+                if (!nodes[i].IsHeader) continue;
+
+                auto addSpelling = [&](const std::string& rootKey) {
+                    if (key.compare(0, rootKey.size(), rootKey) == 0) bySpelling[key.substr(rootKey.size())].push_back(i);
+                };
+                if (nodes[i].Module >= 0) {
+                    for (const auto& rootKey : moduleRoots[nodes[i].Module]) addSpelling(rootKey);
+                }
+                for (const auto& rootKey : sourceRootKeys) addSpelling(rootKey);
+            }
+
+            for (auto& node : nodes) {
+                std::string dirKey = PathKey(node.Path.parent_path());
+
+                for (const auto& raw : node.RawIncludes) {
+                    std::string spelling = LowerKey(raw);
+
+                    // 1. Relative to the including file
+                    auto direct = byPath.find(PathKey(fs::path(StringUtils::FromUtf8(dirKey + "/" + spelling))));
+                    if (direct != byPath.end()) {
+                        node.Includes.push_back(direct->second);
+                        result.IncludesResolved++;
+                        continue;
+                    }
+
+                    // 2. Module include roots, preferring the includer's own module
+                    auto candidates = bySpelling.find(spelling);
+                    if (candidates == bySpelling.end()) {
+                        result.IncludesExternal++;
+                        continue;
+                    }
+
+                    uint32_t chosen = candidates->second.front();
+                    for (uint32_t c : candidates->second) {
+                        if (nodes[c].Module == node.Module) { chosen = c; break; }
+                    }
+                    node.Includes.push_back(chosen);
+                    result.IncludesResolved++;
+                }
+
+                std::sort(node.Includes.begin(), node.Includes.end());
+                node.Includes.erase(std::unique(node.Includes.begin(), node.Includes.end()), node.Includes.end());
+            }
+        }
+
+        static void CountFanIn(const std::vector<Node>& nodes, unsigned threadCount,
+                               std::vector<uint32_t>& translationUnits, std::vector<uint32_t>& directIncluders,
+                               IncludeScanResult& result) {
+            std::vector<uint32_t> units;
+            for (uint32_t i = 0; i < nodes.size(); ++i) {
+                if (!nodes[i].IsHeader) units.push_back(i);
+                for (uint32_t inc : nodes[i].Includes) directIncluders[inc]++;
+            }
+            result.TranslationUnits = units.size();
+            if (units.empty()) return;
+
+            // Each worker walks whole TUs with its own visited stamps and counters; merged at the end
+            if (threadCount == 0) threadCount = (std::max)(1u, std::thread::hardware_concurrency());
+            threadCount = static_cast<unsigned>((std::min)(static_cast<size_t>(threadCount), units.size()));
+
+            std::vector<std::vector<uint32_t>> partial(threadCount, std::vector<uint32_t>(nodes.size(), 0));
+            std::atomic<size_t> next{ 0 };
+
+            auto worker = [&](unsigned t) {
+                std::vector<uint32_t> visited(nodes.size(), 0);
+                std::vector<uint32_t> stack;
+                uint32_t stamp = 0;
+
+                for (size_t u = next.fetch_add(1); u < units.size(); u = next.fetch_add(1)) {
+                    ++stamp;
+                    stack.assign(1, units[u]);
+                    visited[units[u]] = stamp;
+
+                    while (!stack.empty()) {
+                        uint32_t n = stack.back();
+                        stack.pop_back();
+                        for (uint32_t inc : nodes[n].Includes) {
+                            if (visited[inc] == stamp) continue;
+                            visited[inc] = stamp;
+                            partial[t][inc]++;
+                            stack.push_back(inc);
+                        }
+                    }
+                }
+            };
+
+            std::vector<std::thread> threads;
+            for (unsigned t = 1; t < threadCount; ++t) threads.emplace_back(worker, t);
+            worker(0);
+            for (auto& t : threads) t.join();
+
+            for (const auto& counts : partial) {
+                for (size_t i = 0; i < counts.size(); ++i) translationUnits[i] += counts[i];
+            }
+        }
+    };
+}
@@ -0,0 +1,339 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+namespace UEBuilder {
+
+    // Small JSON value + parser + writer.
+    // Good enough for our own manifests/configs and for UBT's exports; not a general purpose library.
+    // Objects keep insertion order so files we write stay diff-friendly.
+    class JsonValue {
+    public:
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        JsonValue() = default;
+        JsonValue(bool b) : type(Type::Bool), boolValue(b) {}
+        JsonValue(int n) : type(Type::Number), numberValue(n) {}
+        JsonValue(int64_t n) : type(Type::Number), numberValue(static_cast<double>(n)) {}
+        JsonValue(uint64_t n) : type(Type::Number), numberValue(static_cast<double>(n)) {}
+        JsonValue(double n) : type(Type::Number), numberValue(n) {}
+        JsonValue(const char* s) : type(Type::String), stringValue(s) {}
+        JsonValue(const std::string& s) : type(Type::String), stringValue(s) {}
+
+        static JsonValue MakeArray() { JsonValue v; v.type = Type::Array; return v; }
+        static JsonValue MakeObject() { JsonValue v; v.type = Type::Object; return v; }
+
+        Type GetType() const { return type; }
+        bool IsNull() const { return type == Type::Null; }
+        bool IsArray() const { return type == Type::Array; }
+        bool IsObject() const { return type == Type::Object; }
+        bool IsString() const { return type == Type::String; }
+        bool IsNumber() const { return type == Type::Number; }
+
+        // Lenient accessors: wrong type returns the fallback instead of throwing
+        bool AsBool(bool fallback = false) const { return type == Type::Bool ? boolValue : fallback; }
+        double AsNumber(double fallback = 0.0) const { return type == Type::Number ? numberValue : fallback; }
+        int64_t AsInt(int64_t fallback = 0) const { return type == Type::Number ? static_cast<int64_t>(numberValue) : fallback; }
+        std::string AsString(const std::string& fallback = "") const { return type == Type::String ? stringValue : fallback; }
+
+        // --- Array access ---
+        size_t Size() const { return type == Type::Array ? items.size() : (type == Type::Object ? members.size() : 0); }
+        const JsonValue& operator[](size_t index) const { return index < items.size() ? items[index] : Null(); }
+        const std::vector<JsonValue>& Items() const { return items; }
+        void Push(JsonValue value) {
+            if (type != Type::Array) { type = Type::Array; items.clear(); }
+            items.push_back(std::move(value));
+        }
+
+        // --- Object access ---
+        const std::vector<std::pair<std::string, JsonValue>>& Members() const { return members; }
+        bool Has(const std::string& key) const { return Find(key) != nullptr; }
+
+        const JsonValue& operator[](const std::string& key) const {
+            const JsonValue* v = Find(key);
+            return v ? *v : Null();
+        }
+        const JsonValue& operator[](const char* key) const { return (*this)[std::string(key)]; }
+
+        const JsonValue* Find(const std::string& key) const {
+            if (type != Type::Object) return nullptr;
+            for (const auto& m : members) {
+                if (m.first == key) return &m.second;
+            }
+            return nullptr;
+        }
+
+        // Insert or overwrite a member
+        JsonValue& Set(const std::string& key, JsonValue value) {
+            if (type != Type::Object) { type = Type::Object; members.clear(); }
+            for (auto& m : members) {
+                if (m.first == key) { m.second = std::move(value); return m.second; }
+            }
+            members.emplace_back(key, std::move(value));
+            return members.back().second;
+        }
+
+        // --- Parsing ---
+        static JsonValue Parse(const std::string& text, bool* ok = nullptr) {
+            size_t pos = 0;
+            JsonValue result;
+            bool success = ParseValue(text, pos, result, 0);
+            if (success) {
+                SkipWhitespace(text, pos);
+                success = pos == text.size();
+            }
+            if (ok) *ok = success;
+            return success ? result : JsonValue();
+        }
+
+        // --- Writing ---
+        // indent < 0 writes compact JSON on a single line
+        std::string Dump(int indent = -1) const {
+            std::string out;
+            DumpTo(out, indent, 0);
+            return out;
+        }
+
+        static void AppendEscaped(std::string& out, const std::string& s) {
+            out.push_back('"');
+            for (unsigned char c : s) {
+                switch (c) {
+                case '"': out += "\\\""; break;
+                case '\\': out += "\\\\"; break;
+                case '\n': out += "\\n"; break;
+                case '\r': out += "\\r"; break;
+                case '\t': out += "\\t"; break;
+                case '\b': out += "\\b"; break;
+                case '\f': out += "\\f"; break;
+                default:
+                    if (c < 0x20) {
+                        char buf[8];
+                        std::snprintf(buf, sizeof(buf), "\\u%04x", c);
+                        out += buf;
+                    }
+                    else {
+                        out.push_back(static_cast<char>(c));
+                    }
+                }
+            }
+            out.push_back('"');
+        }
+
+        static void AppendNumber(std::string& out, double n) {
+            char buf[32];
+            if (n == static_cast<double>(static_cast<int64_t>(n)) && n > -9.0e15 && n < 9.0e15) {
+                std::snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(n));
+            }
+            else {
+                std::snprintf(buf, sizeof(buf), "%.17g", n);
+            }
+            out += buf;
+        }
+
+    private:
+        Type type = Type::Null;
+        bool boolValue = false;
+        double numberValue = 0.0;
+        std::string stringValue;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string, JsonValue>> members;
+
+        static const JsonValue& Null() {
+            static const JsonValue nullValue;
+            return nullValue;
+        }
+
+        void DumpTo(std::string& out, int indent, int depth) const {
+            auto newline = [&](int d) {
+                if (indent < 0) return;
+                out.push_back('\n');
+                out.append(static_cast<size_t>(indent * d), ' ');
+            };
+
+            switch (type) {
+            case Type::Null: out += "null"; break;
+            case Type::Bool: out += boolValue ? "true" : "false"; break;
+            case Type::Number: AppendNumber(out, numberValue); break;
+            case Type::String: AppendEscaped(out, stringValue); break;
+            case Type::Array:
+                out.push_back('[');
+                for (size_t i = 0; i < items.size(); ++i) {
+                    if (i) out.push_back(',');
+                    newline(depth + 1);
+                    items[i].DumpTo(out, indent, depth + 1);
+                }
+                if (!items.empty()) newline(depth);
+                out.push_back(']');
+                break;
+            case Type::Object:
+                out.push_back('{');
+                for (size_t i = 0; i < members.size(); ++i) {
+                    if (i) out.push_back(',');
+                    newline(depth + 1);
+                    AppendEscaped(out, members[i].first);
+                    out += indent < 0 ? ":" : ": ";
+                    members[i].second.DumpTo(out, indent, depth + 1);
+                }
+                if (!members.empty()) newline(depth);
+                out.push_back('}');
+                break;
+            }
+        }
+
+        static void SkipWhitespace(const std::string& s, size_t& pos) {
+            while (pos < s.size() && (s[pos] == ' ' || s[pos] == '\t' || s[pos] == '\n' || s[pos] == '\r')) ++pos;
+        }
+
+        static bool ParseValue(const std::string& s, size_t& pos, JsonValue& out, int depth) {
+            if (depth > 256) return false; // Guard against absurd nesting
+
+            SkipWhitespace(s, pos);
+            if (pos >= s.size()) return false;
+
+            char c = s[pos];
+            if (c == '{') {
+                out = MakeObject();
+                ++pos;
+                SkipWhitespace(s, pos);
+                if (pos < s.size() && s[pos] == '}') { ++pos; return true; }
+
+                while (true) {
+                    SkipWhitespace(s, pos);
+                    std::string key;
+                    if (!ParseString(s, pos, key)) return false;
+                    SkipWhitespace(s, pos);
+                    if (pos >= s.size() || s[pos] != ':') return false;
+                    ++pos;
+
+                    JsonValue value;
+                    if (!ParseValue(s, pos, value, depth + 1)) return false;
+                    out.members.emplace_back(std::move(key), std::move(value));
+
+                    SkipWhitespace(s, pos);
+                    if (pos >= s.size()) return false;
+                    if (s[pos] == ',') { ++pos; continue; }
+                    if (s[pos] == '}') { ++pos; return true; }
+                    return false;
+                }
+            }
+            if (c == '[') {
+                out = MakeArray();
+                ++pos;
+                SkipWhitespace(s, pos);
+                if (pos < s.size() && s[pos] == ']') { ++pos; return true; }
+
+                while (true) {
+                    JsonValue value;
+                    if (!ParseValue(s, pos, value, depth + 1)) return false;
+                    out.items.push_back(std::move(value));
+
+                    SkipWhitespace(s, pos);
+                    if (pos >= s.size()) return false;
+                    if (s[pos] == ',') { ++pos; continue; }
+                    if (s[pos] == ']') { ++pos; return true; }
+                    return false;
+                }
+            }
+            if (c == '"') {
+                out.type = Type::String;
+                return ParseString(s, pos, out.stringValue);
+            }
+            if (s.compare(pos, 4, "true") == 0) { out = JsonValue(true); pos += 4; return true; }
+            if (s.compare(pos, 5, "false") == 0) { out = JsonValue(false); pos += 5; return true; }
+            if (s.compare(pos, 4, "null") == 0) { out = JsonValue(); pos += 4; return true; }
+
+            // Number
+            const char* begin = s.c_str() + pos;
+            char* end = nullptr;
+            double n = std::strtod(begin, &end);
+            if (end == begin) return false;
+            pos += static_cast<size_t>(end - begin);
+            out = JsonValue(n);
+            return true;
+        }
+
+        static bool ParseHex4(const std::string& s, size_t pos, uint32_t& out) {
+            if (pos + 4 > s.size()) return false;
+            out = 0;
+            for (size_t i = 0; i < 4; ++i) {
+                char h = s[pos + i];
+                out <<= 4;
+                if (h >= '0' && h <= '9') out |= static_cast<uint32_t>(h - '0');
+                else if (h >= 'a' && h <= 'f') out |= static_cast<uint32_t>(h - 'a' + 10);
+                else if (h >= 'A' && h <= 'F') out |= static_cast<uint32_t>(h - 'A' + 10);
+                else return false;
+            }
+            return true;
+        }
+
+        static bool ParseString(const std::string& s, size_t& pos, std::string& out) {
+            if (pos >= s.size() || s[pos] != '"') return false;
+            ++pos;
+            out.clear();
+
+            while (pos < s.size()) {
+                char c = s[pos++];
+                if (c == '"') return true;
+                if (c != '\\') { out.push_back(c); continue; }
+                if (pos >= s.size()) return false;
+
+                char e = s[pos++];
+                switch (e) {
+                case '"': out.push_back('"'); break;
+                case '\\': out.push_back('\\'); break;
+                case '/': out.push_back('/'); break;
+                case 'b': out.push_back('\b'); break;
+                case 'f': out.push_back('\f'); break;
+                case 'n': out.push_back('\n'); break;
+                case 'r': out.push_back('\r'); break;
+                case 't': out.push_back('\t'); break;
+                case 'u': {
+                    uint32_t cp = 0;
+                    if (!ParseHex4(s, pos, cp)) return false;
+                    pos += 4;
+                    // Surrogate pair
+                    if (cp >= 0xD800 && cp <= 0xDBFF && pos + 6 <= s.size() && s[pos] == '\\' && s[pos + 1] == 'u') {
+                        uint32_t low = 0;
+                        if (ParseHex4(s, pos + 2, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            pos += 6;
+                        }
+                    }
+                    if (cp < 0x80) out.push_back(static_cast<char>(cp));
+                    else if (cp < 0x800) {
+                        out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    else if (cp < 0x10000) {
+                        out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    else {
+                        out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    break;
+                }
+                default: return false;
+                }
+            }
+            return false;
+        }
+    };
+
+    class JsonUtils {
+    public:
+        static std::string Escape(const std::string& s) {
+            std::string out;
+            JsonValue::AppendEscaped(out, s);
+            return out;
+        }
+    };
+}
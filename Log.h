@@ -0,0 +1,518 @@
+#pragma once
+#include "ProcessUtils.h"
+#include "SystemInfo.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include <initializer_list>
+#include <algorithm>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <cwctype>
+#ifdef _WIN32
+#include <share.h>
+#endif
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    enum class LogLevel : int { Debug, Info, Warning, Error, Off };
+
+    // A field value, borrowed for the duration of the Log call - it is formatted straight into
+    // the queued record, so nothing is copied to the heap
+    class LogValue {
+    public:
+        LogValue(const char* text) : kind(Kind::Text), text(text ? text : "") {}
+        LogValue(std::string_view text) : kind(Kind::Text), text(text) {}
+        LogValue(const std::string& text) : kind(Kind::Text), text(text) {}
+        LogValue(const wchar_t* text) : kind(Kind::Wide), wide(text ? text : L"") {}
+        LogValue(std::wstring_view text) : kind(Kind::Wide), wide(text) {}
+        LogValue(const std::wstring& text) : kind(Kind::Wide), wide(text) {}
+        LogValue(const fs::path& path) : LogValue(path.native()) {}
+        LogValue(bool value) : kind(Kind::Bool), integer(value ? 1 : 0) {}
+        LogValue(double value) : kind(Kind::Real), real(value) {}
+
+        template <typename T, std::enable_if_t<std::is_integral_v<T> && !std::is_same_v<T, bool>, int> = 0>
+        LogValue(T value) : kind(std::is_signed_v<T> ? Kind::Signed : Kind::Unsigned), integer(static_cast<uint64_t>(value)) {}
+
+    private:
+        friend class Log;
+
+        enum class Kind { Text, Wide, Bool, Signed, Unsigned, Real };
+
+        Kind kind;
+        std::string_view text;
+        std::wstring_view wide;
+        uint64_t integer = 0;
+        double real = 0.0;
+    };
+
+    struct LogField {
+        const char* Key;
+        LogValue Value;
+    };
+
+    // One queued message: "message key=value key="quoted value"" (logfmt), already formatted
+    struct LogRecord {
+        static constexpr size_t TextSize = 1000;    // Longer records are cut, ending in "..."
+
+        LogLevel Level = LogLevel::Info;
+        const char* Category = "";                  // String literal: "EngineDetector"
+        int64_t TimeNs = 0;                         // system_clock, since the epoch
+        uint32_t Thread = 0;                        // Small per-process number, 1 = first thread that logged
+        uint16_t Length = 0;
+        uint16_t MessageLength = 0;                 // Fields, if any, start after this and a space
+        char Text[TextSize];
+
+        std::string_view View() const { return std::string_view(Text, Length); }
+        std::string_view Message() const { return std::string_view(Text, MessageLength); }
+    };
+
+    // Called on the writer thread only, one record at a time
+    using LogSink = std::function<void(const LogRecord&)>;
+
+    // The tool's own diagnostics (engine lookup, toolchain discovery...), as opposed to build
+    // output. Log calls below every sink's level cost one relaxed load; the others format into
+    // a slot of a fixed lock-free ring on the calling thread - no allocation, no lock, no I/O -
+    // and a background thread hands the records to the sinks (console, file, the GUI's log).
+    // When the ring is full, records are dropped and counted rather than blocking the caller.
+    class Log {
+    public:
+        // Console/GUI level: debug, info (default), warning, error or off. The file always gets debug.
+        static constexpr const wchar_t* LevelEnvVar = L"UEBUILDER_LOG_LEVEL";
+        // Log file instead of <user data>/Logs/<name>.log; "off" writes none
+        static constexpr const wchar_t* FileEnvVar = L"UEBUILDER_LOG_FILE";
+
+        static constexpr size_t QueueSize = 1024;   // Records; power of two
+
+        static void Debug(const char* category, std::string_view message, std::initializer_list<LogField> fields = {}) { Write(LogLevel::Debug, category, message, fields); }
+        static void Info(const char* category, std::string_view message, std::initializer_list<LogField> fields = {}) { Write(LogLevel::Info, category, message, fields); }
+        static void Warning(const char* category, std::string_view message, std::initializer_list<LogField> fields = {}) { Write(LogLevel::Warning, category, message, fields); }
+        static void Error(const char* category, std::string_view message, std::initializer_list<LogField> fields = {}) { Write(LogLevel::Error, category, message, fields); }
+
+        static bool Enabled(LogLevel level) { return static_cast<int>(level) >= Get().threshold.load(std::memory_order_relaxed); }
+
+        static void Write(LogLevel level, const char* category, std::string_view message, std::initializer_list<LogField> fields = {}) {
+            if (!Enabled(level)) return;
+            Get().Push(level, category, message, fields);
+        }
+
+        // Starts the writer thread with the first sink. Returns an id for RemoveSink.
+        static int AddSink(LogLevel level, LogSink sink) {
+            Log& log = Get();
+            std::lock_guard<std::mutex> lock(log.sinkMutex);
+            int id = ++log.lastSinkId;
+            log.sinks.push_back({ id, level, std::move(sink) });
+            log.UpdateThreshold();
+            if (!log.writer.joinable()) log.writer = std::thread([&log]() { log.Run(); });
+            return id;
+        }
+
+        // Once this returns the sink is never called again
+        static void RemoveSink(int id) {
+            Log& log = Get();
+            std::lock_guard<std::mutex> lock(log.sinkMutex);
+            log.sinks.erase(std::remove_if(log.sinks.begin(), log.sinks.end(), [id](const Sink& s) { return s.Id == id; }), log.sinks.end());
+            log.UpdateThreshold();
+        }
+
+        // Waits until everything logged before the call has reached the sinks
+        static void Flush() {
+            Log& log = Get();
+            if (!log.writer.joinable()) return;
+            size_t target = log.enqueueAt.load(std::memory_order_acquire);
+            log.Wake();
+            std::unique_lock<std::mutex> lock(log.flushMutex);
+            log.flushed.wait(lock, [&]() { return log.dequeueAt.load(std::memory_order_acquire) >= target || log.stopping; });
+        }
+
+        // Records that did not fit into the ring
+        static uint64_t Dropped() { return Get().droppedTotal.load(std::memory_order_relaxed); }
+
+        static const char* LevelName(LogLevel level) {
+            switch (level) {
+            case LogLevel::Debug: return "Debug";
+            case LogLevel::Info: return "Info";
+            case LogLevel::Warning: return "Warning";
+            case LogLevel::Error: return "Error";
+            default: return "Off";
+            }
+        }
+
+        // "debug", "Warning", ...; fallback when empty or unknown
+        static LogLevel ParseLevel(const std::wstring& text, LogLevel fallback) {
+            std::wstring lower = text;
+            std::transform(lower.begin(), lower.end(), lower.begin(), [](wchar_t c) { return static_cast<wchar_t>(std::towlower(c)); });
+            if (lower == L"debug" || lower == L"verbose") return LogLevel::Debug;
+            if (lower == L"info") return LogLevel::Info;
+            if (lower == L"warning" || lower == L"warn") return LogLevel::Warning;
+            if (lower == L"error") return LogLevel::Error;
+            if (lower == L"off" || lower == L"none") return LogLevel::Off;
+            return fallback;
+        }
+
+        // For the console and the GUI, from UEBUILDER_LOG_LEVEL
+        static LogLevel ConfiguredLevel() { return ParseLevel(ProcessUtils::GetEnvVar(LevelEnvVar), LogLevel::Info); }
+
+        // "[Debug] message key=value"
+        static std::string FormatLine(const LogRecord& record) {
+            std::string line = "[";
+            line += LevelName(record.Level);
+            line += "] ";
+            line += record.View();
+            line += '\n';
+            return line;
+        }
+
+        // "2026-01-31 14:05:09.123 Debug   #1 EngineDetector: message key=value"
+        static std::string FormatFileLine(const LogRecord& record) {
+            std::time_t seconds = static_cast<std::time_t>(record.TimeNs / 1000000000);
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &seconds);
+#else
+            localtime_r(&seconds, &local);
+#endif
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+            char prefix[96];
+            std::snprintf(prefix, sizeof(prefix), "%s.%03d %-7s #%u ", stamp, static_cast<int>(record.TimeNs / 1000000 % 1000),
+                          LevelName(record.Level), record.Thread);
+            std::string line = prefix;
+            line += record.Category;
+            line += ": ";
+            line += record.View();
+            line += '\n';
+            return line;
+        }
+
+        // Writes FormatLine to a stdio stream (stderr keeps it out of the CLI's stdout)
+        static LogSink ConsoleSink(FILE* stream) {
+            return [stream](const LogRecord& record) {
+                std::string line = FormatLine(record);
+                std::fwrite(line.data(), 1, line.size(), stream);
+                std::fflush(stream);
+            };
+        }
+
+        // Appends FormatFileLine to path; a file over 8 MB is moved to <path>.old first.
+        // Empty when the file cannot be opened.
+        static LogSink FileSink(const fs::path& path) {
+            std::error_code ec;
+            if (path.has_parent_path()) fs::create_directories(path.parent_path(), ec);
+            if (fs::file_size(path, ec) > 8u * 1024 * 1024 && !ec) {
+                fs::path old = path;
+                old += ".old";
+                fs::rename(path, old, ec);
+            }
+#ifdef _WIN32
+            FILE* raw = _wfsopen(path.c_str(), L"ab", _SH_DENYNO); // Other instances append too
+#else
+            FILE* raw = std::fopen(path.c_str(), "ab");
+#endif
+            if (!raw) return nullptr;
+            std::shared_ptr<FILE> file(raw, [](FILE* f) { std::fclose(f); });
+            return [file](const LogRecord& record) {
+                std::string line = FormatFileLine(record);
+                std::fwrite(line.data(), 1, line.size(), file.get());
+                std::fflush(file.get());
+            };
+        }
+
+        // Where the file sink goes: UEBUILDER_LOG_FILE, else <user data>/Logs/<name>.log; empty for "off"
+        static fs::path FilePath(const char* name) {
+            std::wstring configured = ProcessUtils::GetEnvVar(FileEnvVar);
+            if (configured == L"off" || configured == L"0") return fs::path();
+            if (!configured.empty()) return fs::path(configured);
+            return SystemInfo::GetUserDataDir() / "Logs" / (std::string(name) + ".log");
+        }
+
+        // The file sink every front end starts with, at Debug. Returns the sink id, or 0.
+        static int AddFileSink(const char* name) {
+            fs::path path = FilePath(name);
+            if (path.empty()) return 0;
+            LogSink sink = FileSink(path);
+            return sink ? AddSink(LogLevel::Debug, std::move(sink)) : 0;
+        }
+
+        Log(const Log&) = delete;
+        Log& operator=(const Log&) = delete;
+
+    private:
+        struct Slot {
+            std::atomic<size_t> Sequence{ 0 };
+            LogRecord Record;
+        };
+
+        struct Sink {
+            int Id = 0;
+            LogLevel Level = LogLevel::Info;
+            LogSink Write;
+        };
+
+        // Bounded multi-producer queue (Vyukov): a slot's sequence says whose turn it is, so
+        // producers only contend on the enqueue index. The writer is the only consumer.
+        std::unique_ptr<Slot[]> ring;
+        alignas(64) std::atomic<size_t> enqueueAt{ 0 };
+        alignas(64) std::atomic<size_t> dequeueAt{ 0 };
+        alignas(64) std::atomic<uint64_t> dropped{ 0 };     // Since the writer last reported it
+        std::atomic<uint64_t> droppedTotal{ 0 };
+        std::atomic<int> threshold{ static_cast<int>(LogLevel::Off) };
+        std::atomic<uint32_t> lastThread{ 0 };
+
+        std::mutex sinkMutex;
+        std::vector<Sink> sinks;
+        int lastSinkId = 0;
+
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+        std::atomic<bool> writerIdle{ false };
+        std::atomic<bool> stopping{ false };
+
+        std::mutex flushMutex;
+        std::condition_variable flushed;
+        std::thread writer;
+
+        Log() : ring(new Slot[QueueSize]) {
+            for (size_t i = 0; i < QueueSize; ++i) ring[i].Sequence.store(i, std::memory_order_relaxed);
+        }
+
+        ~Log() {
+            {
+                std::lock_guard<std::mutex> lock(wakeMutex);
+                stopping = true;
+                wake.notify_one();
+            }
+            if (writer.joinable()) writer.join();
+        }
+
+        static Log& Get() {
+            static Log log;
+            return log;
+        }
+
+        // Under sinkMutex
+        void UpdateThreshold() {
+            int lowest = static_cast<int>(LogLevel::Off);
+            for (const auto& sink : sinks) lowest = (std::min)(lowest, static_cast<int>(sink.Level));
+            threshold.store(lowest, std::memory_order_relaxed);
+        }
+
+        static int64_t Now() {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+
+        static uint32_t ThreadNumber() {
+            thread_local uint32_t number = Get().lastThread.fetch_add(1, std::memory_order_relaxed) + 1;
+            return number;
+        }
+
+        void Push(LogLevel level, const char* category, std::string_view message, std::initializer_list<LogField> fields) {
+            size_t at = enqueueAt.load(std::memory_order_relaxed);
+            Slot* slot;
+            for (;;) {
+                slot = &ring[at & (QueueSize - 1)];
+                size_t sequence = slot->Sequence.load(std::memory_order_acquire);
+                intptr_t diff = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(at);
+                if (diff == 0) {
+                    if (enqueueAt.compare_exchange_weak(at, at + 1, std::memory_order_relaxed)) break;
+                }
+                else if (diff < 0) {
+                    // Full: the writer is a whole ring behind
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    droppedTotal.fetch_add(1, std::memory_order_relaxed);
+                    return;
+                }
+                else {
+                    at = enqueueAt.load(std::memory_order_relaxed);
+                }
+            }
+
+            LogRecord& record = slot->Record;
+            record.Level = level;
+            record.Category = category;
+            record.TimeNs = Now();
+            record.Thread = ThreadNumber();
+            Formatter out{ record.Text };
+            out.Text(message, false);
+            record.MessageLength = static_cast<uint16_t>(out.Size);
+            for (const auto& field : fields) {
+                out.Char(' ');
+                out.Text(field.Key, false);
+                out.Char('=');
+                out.Value(field.Value);
+            }
+            record.Length = static_cast<uint16_t>(out.Finish());
+            slot->Sequence.store(at + 1, std::memory_order_release);
+
+            // Only an idle writer needs waking; taking the lock means it is already waiting
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (writerIdle.load(std::memory_order_relaxed)) Wake();
+        }
+
+        void Wake() {
+            std::lock_guard<std::mutex> lock(wakeMutex);
+            wake.notify_one();
+        }
+
+        bool HasRecord() const {
+            size_t at = dequeueAt.load(std::memory_order_relaxed);
+            return ring[at & (QueueSize - 1)].Sequence.load(std::memory_order_acquire) == at + 1;
+        }
+
+        void Run() {
+            for (;;) {
+                Drain();
+                {
+                    std::unique_lock<std::mutex> lock(wakeMutex);
+                    writerIdle.store(true, std::memory_order_relaxed);
+                    std::atomic_thread_fence(std::memory_order_seq_cst);
+                    if (!stopping && !HasRecord()) wake.wait_for(lock, std::chrono::milliseconds(250));
+                    writerIdle.store(false, std::memory_order_relaxed);
+                    if (stopping) break;
+                }
+            }
+            Drain();
+            std::lock_guard<std::mutex> lock(flushMutex);
+            flushed.notify_all();
+        }
+
+        // Hands every published record to the sinks, oldest first
+        void Drain() {
+            std::lock_guard<std::mutex> lock(sinkMutex);
+            size_t at = dequeueAt.load(std::memory_order_relaxed);
+            for (;;) {
+                Slot& slot = ring[at & (QueueSize - 1)];
+                if (slot.Sequence.load(std::memory_order_acquire) != at + 1) break;
+                Dispatch(slot.Record);
+                slot.Sequence.store(at + QueueSize, std::memory_order_release);
+                dequeueAt.store(++at, std::memory_order_release);
+            }
+
+            uint64_t lost = dropped.exchange(0, std::memory_order_relaxed);
+            if (lost > 0) {
+                LogRecord record;
+                record.Level = LogLevel::Warning;
+                record.Category = "Log";
+                record.TimeNs = Now();
+                Formatter out{ record.Text };
+                out.Text("Log queue full; records dropped", false);
+                record.MessageLength = static_cast<uint16_t>(out.Size);
+                out.Text(" count=", false);
+                out.Value(LogValue(lost));
+                record.Length = static_cast<uint16_t>(out.Finish());
+                Dispatch(record);
+            }
+
+            std::lock_guard<std::mutex> flushLock(flushMutex);
+            flushed.notify_all();
+        }
+
+        void Dispatch(const LogRecord& record) {
+            for (const auto& sink : sinks) {
+                if (record.Level >= sink.Level) sink.Write(record);
+            }
+        }
+
+        // Appends into a record's fixed buffer, cutting at the end
+        struct Formatter {
+            char* Out;
+            size_t Size = 0;
+            bool Full = false;
+
+            static constexpr size_t Limit = LogRecord::TextSize - 3;  // Room for "..."
+
+            void Char(char c) {
+                if (Size < Limit) Out[Size++] = c;
+                else Full = true;
+            }
+
+            // Quoted when it would otherwise not read back as one value
+            void Text(std::string_view text, bool asValue = true) {
+                bool quote = asValue && (text.empty() || text.find_first_of(" =\"\\\t\r\n") != std::string_view::npos);
+                if (quote) Char('"');
+                for (char c : text) {
+                    if (!quote) Char(c);
+                    else if (c == '"' || c == '\\') { Char('\\'); Char(c); }
+                    else if (c == '\n') { Char('\\'); Char('n'); }
+                    else if (c == '\r') { Char('\\'); Char('r'); }
+                    else if (c == '\t') { Char('\\'); Char('t'); }
+                    else Char(c);
+                }
+                if (quote) Char('"');
+            }
+
+            // UTF-16 (Windows) or UTF-32 to UTF-8, a code point at a time
+            void Wide(std::wstring_view text) {
+                bool quote = text.empty() || text.find_first_of(L" =\"\\\t\r\n") != std::wstring_view::npos;
+                if (quote) Char('"');
+                for (size_t i = 0; i < text.size(); ++i) {
+                    uint32_t cp = static_cast<uint32_t>(text[i]);
+                    if (cp >= 0xD800 && cp <= 0xDBFF && i + 1 < text.size()) {
+                        uint32_t low = static_cast<uint32_t>(text[i + 1]);
+                        if (low >= 0xDC00 && low <= 0xDFFF) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                            ++i;
+                        }
+                    }
+                    if (quote && (cp == '"' || cp == '\\')) { Char('\\'); Char(static_cast<char>(cp)); }
+                    else if (quote && cp == '\n') { Char('\\'); Char('n'); }
+                    else if (cp < 0x80) Char(static_cast<char>(cp));
+                    else if (cp < 0x800) {
+                        Char(static_cast<char>(0xC0 | (cp >> 6)));
+                        Char(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    else if (cp < 0x10000) {
+                        Char(static_cast<char>(0xE0 | (cp >> 12)));
+                        Char(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        Char(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                    else {
+                        Char(static_cast<char>(0xF0 | (cp >> 18)));
+                        Char(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                        Char(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                        Char(static_cast<char>(0x80 | (cp & 0x3F)));
+                    }
+                }
+                if (quote) Char('"');
+            }
+
+            void Value(const LogValue& value) {
+                char number[32];
+                switch (value.kind) {
+                case LogValue::Kind::Text: Text(value.text); return;
+                case LogValue::Kind::Wide: Wide(value.wide); return;
+                case LogValue::Kind::Bool: Text(value.integer ? "true" : "false"); return;
+                case LogValue::Kind::Signed: std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(value.integer)); break;
+                case LogValue::Kind::Unsigned: std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(value.integer)); break;
+                case LogValue::Kind::Real: std::snprintf(number, sizeof(number), "%g", value.real); break;
+                }
+                Text(number);
+            }
+
+            // Length of the finished text
+            size_t Finish() {
+                if (Full) {
+                    // Don't leave half a UTF-8 sequence before the dots
+                    while (Size > 0 && (static_cast<unsigned char>(Out[Size - 1]) & 0xC0) == 0x80) --Size;
+                    if (Size > 0 && (static_cast<unsigned char>(Out[Size - 1]) & 0x80)) --Size;
+                    std::memcpy(Out + Size, "...", 3);
+                    Size += 3;
+                }
+                return Size;
+            }
+        };
+    };
+}
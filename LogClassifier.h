@@ -0,0 +1,157 @@
+#pragma once
+#include <string>
+#include <cstring>
+#include <cstdlib>
+
+namespace UEBuilder {
+
+    struct LogClassification {
+        bool IsError = false;        // Show highlighted
+        bool SuggestsClean = false;  // Stale Intermediate/ is a likely cause; offer a clean
+    };
+
+    // A compiler/linker message split into its parts
+    struct LogDiagnostic {
+        std::string Severity;   // "error" or "warning" ("fatal error" counts as error)
+        std::string File;       // As printed; may be an .obj/.lib for linker messages
+        int Line = 0;           // 0 when not given
+        int Column = 0;
+        std::string Code;       // C2065, LNK2019, ... (MSVC); empty for clang
+        std::string Message;
+    };
+
+    // Decides how a build output line is presented. Matching is case-insensitive and
+    // runs on every line UBT prints, so it works on bytes without allocating per call.
+    class LogClassifier {
+    public:
+        static LogClassification Classify(const std::string& line) { return Classify(line.data(), line.size()); }
+
+        static LogClassification Classify(const char* data, size_t len) {
+            // Lower-case once into a reused buffer, then plain substring checks
+            thread_local std::string lower;
+            lower.resize(len);
+            for (size_t i = 0; i < len; ++i) {
+                char c = data[i];
+                lower[i] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : c;
+            }
+
+            LogClassification result;
+            result.SuggestsClean =
+                Contains(lower, "intermediate") ||
+                Contains(lower, "msb3073") ||
+                Contains(lower, "ubt error") ||
+                Contains(lower, "action failed") ||
+                Contains(lower, "build failed") ||
+                Contains(lower, "could not find") ||
+                Contains(lower, "cannot open include file");
+
+            result.IsError =
+                Contains(lower, "error:") ||
+                Contains(lower, "error ") ||
+                Contains(lower, "failed") ||
+                Contains(lower, "unresolved external") ||
+                Contains(lower, "fatal error");
+            return result;
+        }
+
+        // MSVC "file(line[,col]): error C1234: text", "x.obj : error LNK2019: text" and
+        // clang "file:line:col: error: text". False for anything else.
+        static bool ParseDiagnostic(const std::string& line, LogDiagnostic& out) {
+            static const struct { const char* Marker; const char* Severity; } markers[] = {
+                { ": fatal error", "error" }, { ": error", "error" }, { ": warning", "warning" },
+            };
+
+            size_t at = std::string::npos;
+            size_t after = 0;
+            const char* severity = nullptr;
+            for (const auto& m : markers) {
+                size_t len = std::strlen(m.Marker);
+                for (size_t p = line.find(m.Marker); p != std::string::npos; p = line.find(m.Marker, p + 1)) {
+                    char next = p + len < line.size() ? line[p + len] : '\0';
+                    if (next != ' ' && next != ':') continue;   // ": errors were found" is not one
+                    if (p < at) {
+                        at = p;
+                        after = p + len;
+                        severity = m.Severity;
+                    }
+                    break;
+                }
+            }
+            if (!severity || at == 0) return false;
+
+            out = LogDiagnostic();
+            out.Severity = severity;
+
+            // Location, parsed from the end so drive letters ("C:\") don't confuse it
+            std::string location = line.substr(0, at);
+            while (!location.empty() && location.back() == ' ') location.pop_back();
+            size_t start = location.find_first_not_of(' ');
+            location.erase(0, start == std::string::npos ? location.size() : start);
+
+            if (!location.empty() && location.back() == ')') {
+                size_t open = location.rfind('(');
+                if (open != std::string::npos) {
+                    ParseLineColumn(location.substr(open + 1, location.size() - open - 2), ',', out);
+                    location.erase(open);
+                }
+            }
+            else {
+                // file:line:col or file:line
+                size_t c1 = location.rfind(':');
+                if (c1 != std::string::npos && IsNumber(location, c1 + 1, location.size())) {
+                    size_t c2 = location.rfind(':', c1 - 1);
+                    if (c2 != std::string::npos && c2 > 1 && IsNumber(location, c2 + 1, c1)) {
+                        ParseLineColumn(location.substr(c2 + 1), ':', out);
+                        location.erase(c2);
+                    }
+                    else if (c1 > 1) {
+                        ParseLineColumn(location.substr(c1 + 1), ':', out);
+                        location.erase(c1);
+                    }
+                }
+            }
+            // Without a line number only a file name is believable ("Module.obj : error LNK..."),
+            // not a log category ("LogInit: Display: error count: 0")
+            if (out.Line == 0 && (location.find('.') == std::string::npos || location.find(": ") != std::string::npos)) return false;
+            out.File = location;
+
+            // " C2065: text" (MSVC code) or ": text"
+            size_t pos = after;
+            if (pos < line.size() && line[pos] == ' ') {
+                size_t colon = line.find(':', pos + 1);
+                size_t space = line.find(' ', pos + 1);
+                if (colon != std::string::npos && (space == std::string::npos || colon < space)) {
+                    out.Code = line.substr(pos + 1, colon - pos - 1);
+                    pos = colon + 1;
+                }
+            }
+            else if (pos < line.size() && line[pos] == ':') {
+                ++pos;
+            }
+            while (pos < line.size() && line[pos] == ' ') ++pos;
+            out.Message = line.substr(pos);
+            while (!out.Message.empty() && (out.Message.back() == '\r' || out.Message.back() == '\n')) out.Message.pop_back();
+            return true;
+        }
+
+    private:
+        static bool IsNumber(const std::string& s, size_t begin, size_t end) {
+            if (begin >= end) return false;
+            for (size_t i = begin; i < end; ++i) {
+                if (s[i] < '0' || s[i] > '9') return false;
+            }
+            return true;
+        }
+
+        static void ParseLineColumn(const std::string& text, char separator, LogDiagnostic& out) {
+            out.Line = std::atoi(text.c_str());
+            size_t sep = text.find(separator);
+            if (sep != std::string::npos) out.Column = std::atoi(text.c_str() + sep + 1);
+        }
+
+        template <size_t N>
+        static bool Contains(const std::string& haystack, const char (&needle)[N]) {
+            return haystack.find(needle, 0, N - 1) != std::string::npos;
+        }
+    };
+}
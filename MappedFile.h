@@ -0,0 +1,106 @@
+#pragma once
+#ifdef _WIN32
+#include <winsock2.h> // Must precede windows.h (HttpClient/Sockets use Winsock 2)
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <filesystem>
+#include <cstddef>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // Read-only memory mapping of a whole file.
+    // Saves a copy per file when scanning thousands of sources; empty files map to (nullptr, 0).
+    class MappedFile {
+    public:
+        MappedFile() = default;
+        ~MappedFile() { Close(); }
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        bool Open(const fs::path& path) {
+            Close();
+#ifdef _WIN32
+            fileHandle = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                     NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (fileHandle == INVALID_HANDLE_VALUE) return false;
+
+            LARGE_INTEGER fileSize;
+            if (!GetFileSizeEx(fileHandle, &fileSize)) {
+                Close();
+                return false;
+            }
+            size = static_cast<size_t>(fileSize.QuadPart);
+            if (size == 0) return true;
+
+            mappingHandle = CreateFileMappingW(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mappingHandle == NULL) {
+                Close();
+                return false;
+            }
+
+            data = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+            if (data == nullptr) {
+                Close();
+                return false;
+            }
+#else
+            fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) return false;
+
+            struct stat st;
+            if (fstat(fd, &st) != 0) {
+                Close();
+                return false;
+            }
+            size = static_cast<size_t>(st.st_size);
+            if (size == 0) return true;
+
+            void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                Close();
+                return false;
+            }
+            data = static_cast<const char*>(mapped);
+#endif
+            return true;
+        }
+
+        void Close() {
+#ifdef _WIN32
+            if (data) UnmapViewOfFile(data);
+            if (mappingHandle) CloseHandle(mappingHandle);
+            if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+            mappingHandle = NULL;
+            fileHandle = INVALID_HANDLE_VALUE;
+#else
+            if (data) munmap(const_cast<char*>(data), size);
+            if (fd >= 0) ::close(fd);
+            fd = -1;
+#endif
+            data = nullptr;
+            size = 0;
+        }
+
+        const char* Data() const { return data; }
+        size_t Size() const { return size; }
+
+    private:
+        const char* data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        HANDLE fileHandle = INVALID_HANDLE_VALUE;
+        HANDLE mappingHandle = NULL;
+#else
+        int fd = -1;
+#endif
+    };
+}
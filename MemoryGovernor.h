@@ -0,0 +1,160 @@
+#pragma once
+#include "ProcessUtils.h"
+#include "ProcessTree.h"
+#include "SystemInfo.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+
+namespace UEBuilder {
+
+    struct MemoryGovernorSettings {
+        double PauseBelowFree = 0.08;   // Pause a compiler when less than this fraction of RAM/commit is left
+        double ResumeAboveFree = 0.15;  // Resume one once this much is free again
+        double PausePressure = 40.0;    // Linux PSI "some avg10" percent; only counts below ResumeAboveFree
+        double ResumePressure = 10.0;
+        int IntervalMs = 250;
+        int ResumeDelayMs = 2000;       // Let a resumed compiler allocate before judging again
+        int MinRunning = 1;             // Never pause the last running compilers, so the build always progresses
+        std::vector<std::string> CompilerNames = {
+            "cl.exe", "clang-cl.exe", "clang.exe", "clang++.exe", "ispc.exe",
+            "clang", "clang++", "ispc", "cc1plus", "gcc", "g++"
+        };
+    };
+
+    // Keeps parallel builds out of the OOM/swap zone by freezing compilers instead of letting them fail.
+    //
+    // While UBT runs, a background thread polls system memory. Under pressure it suspends the
+    // youngest compiler below UBT (least work lost, still growing) one at a time; as memory
+    // frees up the oldest paused compiler resumes first. UBT just sees slower actions.
+    class MemoryGovernor {
+    public:
+        explicit MemoryGovernor(LogCallback onLog = nullptr, MemoryGovernorSettings settings = MemoryGovernorSettings())
+            : onLog(std::move(onLog)), settings(std::move(settings)) {}
+
+        ~MemoryGovernor() { Stop(); }
+
+        MemoryGovernor(const MemoryGovernor&) = delete;
+        MemoryGovernor& operator=(const MemoryGovernor&) = delete;
+
+        // Watches the process tree below root until Stop
+        void Start(ProcessId root) {
+            Stop();
+            rootPid = root;
+            stopRequested = false;
+            worker = std::thread([this]() { Loop(); });
+        }
+
+        // Resumes anything still paused; safe to call more than once
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopRequested = true;
+            }
+            wake.notify_all();
+            if (worker.joinable()) worker.join();
+
+            for (const auto& process : paused) ProcessTree::Resume(process.Pid);
+            paused.clear();
+        }
+
+        int TotalPauses() const { return totalPauses; }
+
+    private:
+        LogCallback onLog;
+        MemoryGovernorSettings settings;
+        ProcessId rootPid = 0;
+
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopRequested = false;
+
+        std::vector<ProcessInfo> paused;   // Only touched by the worker, or after it joined
+        int totalPauses = 0;
+        std::chrono::steady_clock::time_point lastResume;
+
+        void Loop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopRequested) {
+                lock.unlock();
+                Tick();
+                lock.lock();
+                wake.wait_for(lock, std::chrono::milliseconds(settings.IntervalMs), [this]() { return stopRequested; });
+            }
+        }
+
+        void Tick() {
+            MemoryStatus status = SystemInfo::GetMemoryStatus();
+            double free = status.FreeFraction();
+            bool psi = status.PressureAvg10 >= 0.0;
+
+            bool high = free < settings.PauseBelowFree ||
+                        (psi && status.PressureAvg10 > settings.PausePressure && free < settings.ResumeAboveFree);
+            bool low = free > settings.ResumeAboveFree && (!psi || status.PressureAvg10 < settings.ResumePressure);
+
+            // Paused compilers can still be killed (UBT cancelled, Ctrl+C)
+            paused.erase(std::remove_if(paused.begin(), paused.end(),
+                [](const ProcessInfo& p) { return !ProcessTree::IsRunning(p.Pid); }), paused.end());
+
+            std::vector<ProcessInfo> running;
+            if (high || !paused.empty()) {
+                for (const auto& process : ProcessTree::Descendants(rootPid)) {
+                    if (IsCompiler(process.Name) && !IsPaused(process.Pid)) running.push_back(process);
+                }
+            }
+
+            // Whatever the memory situation, the build must keep moving; otherwise UBT
+            // ends up waiting on compilers that only resume once memory it cannot free is freed
+            bool starving = !paused.empty() && static_cast<int>(running.size()) < settings.MinRunning;
+
+            if (high && !starving) {
+                if (static_cast<int>(running.size()) <= settings.MinRunning) return;
+
+                auto youngest = std::max_element(running.begin(), running.end(), IsOlder);
+                if (ProcessTree::Suspend(youngest->Pid)) {
+                    paused.push_back(*youngest);
+                    ++totalPauses;
+                    Log("Paused", *youngest, status);
+                }
+            }
+            else if ((low || starving) && !paused.empty()) {
+                auto now = std::chrono::steady_clock::now();
+                if (!starving && now - lastResume < std::chrono::milliseconds(settings.ResumeDelayMs)) return;
+
+                auto oldest = std::min_element(paused.begin(), paused.end(), IsOlder);
+                ProcessInfo process = *oldest;
+                paused.erase(oldest);
+                ProcessTree::Resume(process.Pid);
+                lastResume = now;
+                Log("Resumed", process, status);
+            }
+        }
+
+        static bool IsOlder(const ProcessInfo& a, const ProcessInfo& b) {
+            return a.StartTime != b.StartTime ? a.StartTime < b.StartTime : a.Pid < b.Pid;
+        }
+
+        bool IsCompiler(const std::string& name) const {
+            return std::find(settings.CompilerNames.begin(), settings.CompilerNames.end(), name) != settings.CompilerNames.end();
+        }
+
+        bool IsPaused(ProcessId pid) const {
+            return std::any_of(paused.begin(), paused.end(), [pid](const ProcessInfo& p) { return p.Pid == pid; });
+        }
+
+        void Log(const char* action, const ProcessInfo& process, const MemoryStatus& status) const {
+            if (!onLog) return;
+            char line[200];
+            std::snprintf(line, sizeof(line), "[Memory] %s %s (pid %u), %.1f GB free, %d paused\n",
+                          action, process.Name.c_str(), static_cast<unsigned>(process.Pid),
+                          status.AvailableBytes / 1073741824.0, static_cast<int>(paused.size()));
+            onLog(line);
+        }
+    };
+}
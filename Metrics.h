@@ -0,0 +1,298 @@
+#pragma once
+#include <atomic>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+namespace UEBuilder {
+
+    // Only ever goes up
+    class MetricCounter {
+    public:
+        void Add(uint64_t n = 1) { value.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t Value() const { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> value{ 0 };
+    };
+
+    // Goes up and down, or is set outright
+    class MetricGauge {
+    public:
+        void Set(double v) { value.store(v, std::memory_order_relaxed); }
+        void Add(double v) { value.fetch_add(v, std::memory_order_relaxed); }
+        double Value() const { return value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> value{ 0.0 };
+    };
+
+    // Fixed buckets (upper bounds); a count per bucket plus the sum, each its own atomic.
+    // A scrape may see an observation in the count and not yet in a bucket - Prometheus
+    // tolerates that much.
+    class MetricHistogram {
+    public:
+        explicit MetricHistogram(std::vector<double> bounds)
+            : bounds(std::move(bounds)), buckets(new std::atomic<uint64_t>[this->bounds.size() + 1]) {
+            for (size_t i = 0; i <= this->bounds.size(); ++i) buckets[i].store(0, std::memory_order_relaxed);
+        }
+
+        void Observe(double v) {
+            size_t i = 0;
+            while (i < bounds.size() && v > bounds[i]) ++i;
+            buckets[i].fetch_add(1, std::memory_order_relaxed);
+            sum.fetch_add(v, std::memory_order_relaxed);
+            count.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        const std::vector<double>& Bounds() const { return bounds; }
+        uint64_t Bucket(size_t i) const { return buckets[i].load(std::memory_order_relaxed); } // Bounds().size() = +Inf
+        double Sum() const { return sum.load(std::memory_order_relaxed); }
+        uint64_t Count() const { return count.load(std::memory_order_relaxed); }
+
+    private:
+        std::vector<double> bounds;
+        std::unique_ptr<std::atomic<uint64_t>[]> buckets;
+        std::atomic<double> sum{ 0.0 };
+        std::atomic<uint64_t> count{ 0 };
+    };
+
+    // One metric name with a child per label combination. Looking a child up takes a lock,
+    // so callers do it once (per build, per cache) and keep the reference; updating it never
+    // does. Children are never removed, so references stay valid.
+    template <typename Metric>
+    class MetricFamily {
+    public:
+        template <typename... Args>
+        MetricFamily(const char* name, const char* help, std::vector<std::string> labelNames, Args... args)
+            : name(name), help(help), labelNames(std::move(labelNames)), make([args...]() { return std::make_unique<Metric>(args...); }) {
+            if (this->labelNames.empty()) unlabeled = &With({});
+        }
+
+        // The child for these label values, in the order of the label names
+        Metric& With(const std::vector<std::string>& values) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto& child : children) {
+                if (child.Values == values) return *child.Value;
+            }
+            children.push_back({ values, make() });
+            return *children.back().Value;
+        }
+
+        // Families without labels
+        Metric& Get() { return *unlabeled; }
+
+        const char* Name() const { return name; }
+
+        void Render(std::string& out, const char* type) {
+            out += "# HELP ";
+            out += name;
+            out += ' ';
+            out += help;
+            out += "\n# TYPE ";
+            out += name;
+            out += ' ';
+            out += type;
+            out += '\n';
+
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const auto& child : children) RenderChild(out, child);
+        }
+
+    private:
+        struct Child {
+            std::vector<std::string> Values;
+            std::unique_ptr<Metric> Value;
+        };
+
+        const char* name;
+        const char* help;
+        std::vector<std::string> labelNames;
+        std::function<std::unique_ptr<Metric>()> make;
+        std::mutex mutex;
+        std::deque<Child> children;
+        Metric* unlabeled = nullptr;
+
+        // {a="x",b="y"} plus an extra label (le) when given
+        std::string Labels(const std::vector<std::string>& values, const char* extraName = nullptr, const std::string& extraValue = std::string()) const {
+            if (values.empty() && !extraName) return std::string();
+            std::string out = "{";
+            auto add = [&out](const std::string& label, const std::string& value) {
+                if (out.size() > 1) out += ',';
+                out += label;
+                out += "=\"";
+                for (char c : value) {
+                    if (c == '\\' || c == '"') out += '\\';
+                    if (c == '\n') {
+                        out += "\\n";
+                        continue;
+                    }
+                    out += c;
+                }
+                out += '"';
+            };
+            for (size_t i = 0; i < values.size() && i < labelNames.size(); ++i) add(labelNames[i], values[i]);
+            if (extraName) add(extraName, extraValue);
+            out += '}';
+            return out;
+        }
+
+        static std::string Number(double v) {
+            char text[32];
+            std::snprintf(text, sizeof(text), "%.17g", v);
+            return text;
+        }
+
+        void Line(std::string& out, const char* suffix, const std::string& labels, const std::string& value) const {
+            out += name;
+            out += suffix;
+            out += labels;
+            out += ' ';
+            out += value;
+            out += '\n';
+        }
+
+        void RenderChild(std::string& out, const Child& child) const;
+    };
+
+    template <>
+    inline void MetricFamily<MetricCounter>::RenderChild(std::string& out, const Child& child) const {
+        Line(out, "", Labels(child.Values), std::to_string(child.Value->Value()));
+    }
+
+    template <>
+    inline void MetricFamily<MetricGauge>::RenderChild(std::string& out, const Child& child) const {
+        Line(out, "", Labels(child.Values), Number(child.Value->Value()));
+    }
+
+    template <>
+    inline void MetricFamily<MetricHistogram>::RenderChild(std::string& out, const Child& child) const {
+        const MetricHistogram& h = *child.Value;
+        uint64_t cumulative = 0;
+        for (size_t i = 0; i <= h.Bounds().size(); ++i) {
+            cumulative += h.Bucket(i);
+            std::string le = i < h.Bounds().size() ? Number(h.Bounds()[i]) : "+Inf";
+            Line(out, "_bucket", Labels(child.Values, "le", le), std::to_string(cumulative));
+        }
+        Line(out, "_sum", Labels(child.Values), Number(h.Sum()));
+        Line(out, "_count", Labels(child.Values), std::to_string(cumulative));
+    }
+
+    // Everything the tool counts about itself, served in the Prometheus text format by
+    // MetricsServer. Updates are relaxed atomics on a child the caller already holds, so
+    // counting costs the output path no more than an uncontended add.
+    class Metrics {
+    public:
+        MetricFamily<MetricCounter> BuildsStarted{ "uebuilder_builds_started_total", "Builds that started.", { "target", "config" } };
+        MetricFamily<MetricCounter> BuildsSucceeded{ "uebuilder_builds_succeeded_total", "Builds that succeeded.", { "target", "config" } };
+        MetricFamily<MetricCounter> BuildsFailed{ "uebuilder_builds_failed_total", "Builds that failed or were cancelled.", { "target", "config" } };
+        MetricFamily<MetricHistogram> BuildDuration{ "uebuilder_build_duration_seconds", "Wall time of finished builds.", { "target", "config" },
+                                                     std::vector<double>{ 10, 30, 60, 120, 300, 600, 1200, 1800, 3600, 7200 } };
+        MetricFamily<MetricGauge> BuildsQueued{ "uebuilder_builds_queued", "Builds requested and waiting to start.", {} };
+        MetricFamily<MetricGauge> BuildsRunning{ "uebuilder_builds_running", "Builds running now.", {} };
+        MetricFamily<MetricCounter> LogLines{ "uebuilder_log_lines_total", "Lines of build output processed.", {} };
+        MetricFamily<MetricGauge> LogLinesPerSecond{ "uebuilder_log_lines_per_second", "Output lines per second of the last finished build.", {} };
+        MetricFamily<MetricCounter> CacheRequests{ "uebuilder_cache_requests_total", "Lookups per cache and result (hit or miss).", { "cache", "result" } };
+        MetricFamily<MetricGauge> ChildCpu{ "uebuilder_child_cpu_percent", "CPU use of the running build's process tree, 0-100 of all cores.", {} };
+        MetricFamily<MetricGauge> ChildRss{ "uebuilder_child_rss_bytes", "Resident memory of the running build's process tree.", {} };
+        MetricFamily<MetricGauge> ChildProcesses{ "uebuilder_child_processes", "Processes in the running build's tree.", {} };
+
+        static Metrics& Get() {
+            static Metrics metrics;
+            return metrics;
+        }
+
+        // A cache lookup; cache is e.g. "prebuilt", "toolchains"
+        static void CacheLookup(const char* cache, bool hit) {
+            Get().CacheRequests.With({ cache, hit ? "hit" : "miss" }).Add();
+        }
+
+        // The whole exposition, as served on /metrics
+        std::string Render() {
+            std::string out;
+            BuildsStarted.Render(out, "counter");
+            BuildsSucceeded.Render(out, "counter");
+            BuildsFailed.Render(out, "counter");
+            BuildDuration.Render(out, "histogram");
+            BuildsQueued.Render(out, "gauge");
+            BuildsRunning.Render(out, "gauge");
+            LogLines.Render(out, "counter");
+            LogLinesPerSecond.Render(out, "gauge");
+            CacheRequests.Render(out, "counter");
+            ChildCpu.Render(out, "gauge");
+            ChildRss.Render(out, "gauge");
+            ChildProcesses.Render(out, "gauge");
+            return out;
+        }
+
+    private:
+        Metrics() = default;
+    };
+
+    // One build's way through the metrics: queued when constructed, running from Start, and
+    // counted as succeeded or failed by Finish. A build that is dropped before it finishes
+    // counts as failed (or, if it never started, simply leaves the queue).
+    class BuildMetrics {
+    public:
+        BuildMetrics() : lines(Metrics::Get().LogLines.Get()) { Metrics::Get().BuildsQueued.Get().Add(1); }
+
+        ~BuildMetrics() {
+            if (state == State::Queued) Metrics::Get().BuildsQueued.Get().Add(-1);
+            else if (state == State::Running) Finish(false);
+        }
+
+        BuildMetrics(const BuildMetrics&) = delete;
+        BuildMetrics& operator=(const BuildMetrics&) = delete;
+
+        // target as UBT names it ("MyGameEditor"), config as given ("Development")
+        void Start(const std::string& target, const std::string& config) {
+            if (state != State::Queued) return;
+            Metrics& metrics = Metrics::Get();
+            succeeded = &metrics.BuildsSucceeded.With({ target, config });
+            failed = &metrics.BuildsFailed.With({ target, config });
+            duration = &metrics.BuildDuration.With({ target, config });
+            metrics.BuildsStarted.With({ target, config }).Add();
+
+            state = State::Running;
+            startTime = std::chrono::steady_clock::now();
+            metrics.BuildsQueued.Get().Add(-1);
+            metrics.BuildsRunning.Get().Add(1);
+        }
+
+        // Any thread: a chunk of the build's output, counted by its line ends
+        void CountOutput(const std::string& chunk) {
+            uint64_t n = static_cast<uint64_t>(std::count(chunk.begin(), chunk.end(), '\n'));
+            if (n == 0) return;
+            lines.Add(n);
+            buildLines.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        void Finish(bool success) {
+            if (state != State::Running) return;
+            state = State::Finished;
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+            Metrics::Get().BuildsRunning.Get().Add(-1);
+            (success ? succeeded : failed)->Add();
+            duration->Observe(seconds);
+            if (seconds > 0.0) Metrics::Get().LogLinesPerSecond.Get().Set(buildLines.load(std::memory_order_relaxed) / seconds);
+        }
+
+    private:
+        enum class State { Queued, Running, Finished };
+
+        MetricCounter& lines;
+        MetricCounter* succeeded = nullptr;
+        MetricCounter* failed = nullptr;
+        MetricHistogram* duration = nullptr;
+        std::atomic<uint64_t> buildLines{ 0 };
+        State state = State::Queued;
+        std::chrono::steady_clock::time_point startTime;
+    };
+}
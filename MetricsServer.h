@@ -0,0 +1,104 @@
+#pragma once
+#include "Sockets.h"
+#include "Metrics.h"
+#include <atomic>
+#include <string>
+#include <thread>
+
+namespace UEBuilder {
+
+    // Serves Metrics::Render on GET /metrics (Prometheus text format 0.0.4) from a thread of
+    // its own, one request per connection. Scrapes are rare and small, so there is no keep-alive,
+    // no TLS and nothing beyond the request line is parsed.
+    class MetricsServer {
+    public:
+        // "[address:]port"; a bare port listens on 127.0.0.1 only, "0.0.0.0:9464" on every interface
+        static constexpr const wchar_t* ListenEnvVar = L"UEBUILDER_METRICS";
+
+        MetricsServer() = default;
+        ~MetricsServer() { Stop(); }
+
+        MetricsServer(const MetricsServer&) = delete;
+        MetricsServer& operator=(const MetricsServer&) = delete;
+
+        bool Start(const std::string& listen) {
+            Stop();
+            std::string address = "127.0.0.1";
+            std::string port = listen;
+            size_t colon = listen.rfind(':');
+            if (colon != std::string::npos) {
+                address = listen.substr(0, colon);
+                port = listen.substr(colon + 1);
+                if (address.size() > 2 && address.front() == '[' && address.back() == ']') address = address.substr(1, address.size() - 2);
+            }
+            if (port.empty()) return false;
+
+            listener = Sockets::Listen(address, port);
+            if (listener == InvalidSocket) return false;
+            this->address = address.find(':') != std::string::npos ? "[" + address + "]" : address;
+            stopping = false;
+            worker = std::thread([this]() { Serve(); });
+            return true;
+        }
+
+        bool IsRunning() const { return listener != InvalidSocket; }
+        int Port() const { return IsRunning() ? Sockets::LocalPort(listener) : 0; }
+        std::string Url() const { return "http://" + address + ":" + std::to_string(Port()) + "/metrics"; }
+
+        void Stop() {
+            stopping = true;
+            if (worker.joinable()) worker.join();
+            Sockets::Close(listener);
+            listener = InvalidSocket;
+        }
+
+    private:
+        SocketHandle listener = InvalidSocket;
+        std::string address;
+        std::atomic<bool> stopping{ false };
+        std::thread worker;
+
+        void Serve() {
+            while (!stopping) {
+                // Short waits so Stop never takes long
+                SocketHandle client = Sockets::Accept(listener, 200);
+                if (client == InvalidSocket) continue;
+                Respond(client);
+                Sockets::Close(client);
+            }
+        }
+
+        static void Respond(SocketHandle client) {
+            Sockets::SetTimeout(client, 2000);
+
+            // Only the request line matters
+            std::string request;
+            char buffer[1024];
+            while (request.find("\r\n") == std::string::npos && request.size() < 8192) {
+                int got = Sockets::Recv(client, buffer, sizeof(buffer));
+                if (got <= 0) break;
+                request.append(buffer, static_cast<size_t>(got));
+            }
+
+            std::string status = "200 OK";
+            std::string type = "text/plain; version=0.0.4; charset=utf-8";
+            std::string body;
+            if (request.rfind("GET /metrics ", 0) == 0 || request.rfind("GET /metrics?", 0) == 0) {
+                body = Metrics::Get().Render();
+            }
+            else if (request.rfind("GET / ", 0) == 0) {
+                type = "text/plain; charset=utf-8";
+                body = "UEBuilder metrics are at /metrics\n";
+            }
+            else {
+                status = request.rfind("GET ", 0) == 0 ? "404 Not Found" : "405 Method Not Allowed";
+                type = "text/plain; charset=utf-8";
+                body = status + "\n";
+            }
+
+            std::string response = "HTTP/1.1 " + status + "\r\nContent-Type: " + type + "\r\nContent-Length: " +
+                                   std::to_string(body.size()) + "\r\nConnection: close\r\n\r\n" + body;
+            Sockets::SendAll(client, response);
+        }
+    };
+}
@@ -0,0 +1,331 @@
+#pragma once
+#include "LogClassifier.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <filesystem>
+#include <fstream>
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+#include <cwctype>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // Bounded lock-free queue for exactly one producer thread and one consumer thread.
+    // Capacity is rounded up to a power of two. Each side caches the other's index and only
+    // reloads it when the queue looks full (producer) or empty (consumer).
+    template <typename T>
+    class SpscRing {
+    public:
+        explicit SpscRing(size_t capacity) {
+            size_t size = 2;
+            while (size < capacity) size <<= 1;
+            cells.resize(size);
+            mask = size - 1;
+        }
+
+        size_t Capacity() const { return cells.size(); }
+
+        // Producer only
+        bool TryPush(T&& value) {
+            size_t tail = tailIndex.load(std::memory_order_relaxed);
+            if (tail - cachedHead >= cells.size()) {
+                cachedHead = headIndex.load(std::memory_order_acquire);
+                if (tail - cachedHead >= cells.size()) return false;
+            }
+            cells[tail & mask] = std::move(value);
+            tailIndex.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Producer only: items waiting, as of the consumer's last pop
+        size_t SizeFromProducer() {
+            cachedHead = headIndex.load(std::memory_order_acquire);
+            return tailIndex.load(std::memory_order_relaxed) - cachedHead;
+        }
+
+        // Consumer only
+        bool TryPop(T& value) {
+            size_t head = headIndex.load(std::memory_order_relaxed);
+            if (head == cachedTail) {
+                cachedTail = tailIndex.load(std::memory_order_acquire);
+                if (head == cachedTail) return false;
+            }
+            value = std::move(cells[head & mask]);
+            headIndex.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+    private:
+        std::vector<T> cells;
+        size_t mask = 0;
+        alignas(64) std::atomic<size_t> headIndex{ 0 };   // Written by the consumer
+        alignas(64) size_t cachedTail = 0;                // Consumer's copy of tailIndex
+        alignas(64) std::atomic<size_t> tailIndex{ 0 };   // Written by the producer
+        alignas(64) size_t cachedHead = 0;                // Producer's copy of headIndex
+    };
+
+    // What happens to output that arrives while the ring is full
+    enum class OverflowPolicy {
+        SpillToDisk,        // Lossless: later chunks go to a temp file until the consumer catches up
+        DropLowPriority,    // Keep errors, warnings and clean hints; drop everything else, counted
+    };
+
+    struct OutputQueueOptions {
+        size_t Capacity = 1024;     // Chunks; at most ~4 MB of pipe reads
+        OverflowPolicy Overflow = OverflowPolicy::SpillToDisk;
+        fs::path SpillDir;          // Empty = the system temp folder
+    };
+
+    struct OutputQueueStats {
+        uint64_t Chunks = 0;
+        uint64_t Bytes = 0;
+        size_t Capacity = 0;
+        size_t HighWater = 0;           // Most chunks waiting at once
+        uint64_t Overflows = 0;         // Times a chunk found the ring full
+        uint64_t SpilledChunks = 0;
+        uint64_t SpilledBytes = 0;
+        uint64_t DroppedLines = 0;
+        uint64_t DroppedBytes = 0;
+
+        bool Overflowed() const { return Overflows > 0; }
+    };
+
+    // Sits between a process's pipe reader and its LogCallback. The reader pushes chunks into an
+    // SpscRing and never waits on the callback, which runs on a delivery thread of its own, in
+    // order and with the original chunking. A consumer that falls behind (console writes on
+    // Windows, a busy GUI) therefore no longer fills the pipe and stalls the child.
+    //
+    // When the ring is full the overflow policy decides: SpillToDisk appends chunks to a temp
+    // file that the delivery thread reads once the ring is empty, so nothing is lost or
+    // reordered; DropLowPriority keeps only the lines LogClassifier flags and notes how many
+    // others were dropped.
+    class OutputQueue {
+    public:
+        using Consumer = std::function<void(const std::string&)>;
+
+        static constexpr const wchar_t* OverflowEnvVar = L"UEBUILDER_OUTPUT_OVERFLOW"; // "spill" (default) or "drop"
+
+        static OverflowPolicy ParseOverflowPolicy(const std::wstring& text) {
+            std::wstring lower = text;
+            for (auto& c : lower) c = static_cast<wchar_t>(towlower(c));
+            return lower == L"drop" ? OverflowPolicy::DropLowPriority : OverflowPolicy::SpillToDisk;
+        }
+
+        // "peak 1024/1024 chunks, 37 overflows, 2.1 MB spilled, 0 lines dropped"
+        static std::string FormatStats(const OutputQueueStats& stats) {
+            char text[160];
+            std::snprintf(text, sizeof(text), "peak %zu/%zu chunks, %llu overflows, %.1f MB spilled, %llu lines dropped",
+                          stats.HighWater, stats.Capacity, static_cast<unsigned long long>(stats.Overflows),
+                          stats.SpilledBytes / (1024.0 * 1024.0), static_cast<unsigned long long>(stats.DroppedLines));
+            return text;
+        }
+
+        explicit OutputQueue(Consumer consumer, const OutputQueueOptions& options = OutputQueueOptions())
+            : consumer(std::move(consumer)), options(options), ring(options.Capacity) {
+            stats.Capacity = ring.Capacity();
+            if (this->consumer) delivery = std::thread([this]() { Deliver(); });
+        }
+
+        ~OutputQueue() { Close(); }
+
+        OutputQueue(const OutputQueue&) = delete;
+        OutputQueue& operator=(const OutputQueue&) = delete;
+
+        // Reader thread only
+        void Push(const char* data, size_t len) {
+            if (!consumer || len == 0) return;
+            ++stats.Chunks;
+            stats.Bytes += len;
+
+            if (spilling) {
+                // Back to the ring only once everything on disk has been delivered
+                if (spillRead.load(std::memory_order_acquire) != spillWritten) {
+                    Spill(data, len);
+                    return;
+                }
+                spilling = false;
+            }
+
+            if (!DrainBacklog()) {
+                Filter(data, len);
+                return;
+            }
+
+            std::string chunk;
+            chunk.swap(carry);
+            chunk.append(data, len);
+            if (Enqueue(std::move(chunk))) return;
+
+            // A full ring leaves the chunk where it was
+            ++stats.Overflows;
+            if (options.Overflow == OverflowPolicy::SpillToDisk && StartSpill()) Spill(chunk.data(), chunk.size());
+            else Filter(chunk.data(), chunk.size());
+        }
+
+        // Reader thread: delivers whatever is still queued, then stops the delivery thread
+        void Close() {
+            if (!delivery.joinable()) return;
+
+            // The pipe is closed by now, so waiting for room here costs the child nothing
+            while (!DrainBacklog() || (!carry.empty() && !Enqueue(std::move(carry)))) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+
+            closed.store(true, std::memory_order_release);
+            wake.notify_one();
+            delivery.join();
+
+            if (spillOut.is_open()) {
+                spillOut.close();
+                std::error_code ec;
+                fs::remove(spillPath, ec);
+            }
+        }
+
+        // Complete once Close has returned
+        const OutputQueueStats& Stats() const { return stats; }
+
+    private:
+        Consumer consumer;
+        OutputQueueOptions options;
+        SpscRing<std::string> ring;
+        std::thread delivery;
+        std::atomic<bool> closed{ false };
+        std::atomic<bool> consumerIdle{ false };
+        std::mutex wakeMutex;
+        std::condition_variable wake;
+
+        // Producer state
+        OutputQueueStats stats;
+        bool spilling = false;
+        std::ofstream spillOut;
+        fs::path spillPath;
+        uint64_t spillWritten = 0;
+        std::atomic<uint64_t> spillCommitted{ 0 };  // Bytes of spillOut the consumer may read
+        std::atomic<uint64_t> spillRead{ 0 };       // Bytes of it the consumer has delivered
+        std::deque<std::string> backlog;            // DropLowPriority: kept lines waiting for room
+        std::string carry;                          // DropLowPriority: a line still missing its end
+        uint64_t droppedSinceNotice = 0;
+
+        bool Enqueue(std::string&& chunk) {
+            if (!ring.TryPush(std::move(chunk))) return false;
+            size_t waiting = ring.SizeFromProducer();
+            if (waiting > stats.HighWater) stats.HighWater = waiting;
+            // No lock on this side; a wakeup lost to the race is covered by the consumer's timeout
+            if (consumerIdle.load()) wake.notify_one();
+            return true;
+        }
+
+        bool StartSpill() {
+            if (!spillOut.is_open()) {
+                static std::atomic<unsigned> sequence{ 0 };
+                fs::path dir = options.SpillDir.empty() ? fs::temp_directory_path() : options.SpillDir;
+                spillPath = dir / ("uebuilder-output-" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count()) +
+                                   "-" + std::to_string(sequence++) + ".spill");
+                spillOut.open(spillPath, std::ios::binary | std::ios::trunc);
+                if (!spillOut.is_open()) return false;
+            }
+            spilling = true;
+            return true;
+        }
+
+        // Records are a 4-byte length and the chunk
+        void Spill(const char* data, size_t len) {
+            uint32_t size = static_cast<uint32_t>(len);
+            spillOut.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            spillOut.write(data, static_cast<std::streamsize>(len));
+            spillOut.flush();
+            spillWritten += sizeof(size) + len;
+            spillCommitted.store(spillWritten, std::memory_order_release);
+            ++stats.SpilledChunks;
+            stats.SpilledBytes += len;
+            if (consumerIdle.load()) wake.notify_one();
+        }
+
+        // Splits into lines, keeps the important ones for later and drops the rest
+        void Filter(const char* data, size_t len) {
+            carry.append(data, len);
+            size_t begin = 0;
+            for (size_t nl = carry.find('\n'); nl != std::string::npos; nl = carry.find('\n', begin)) {
+                if (IsHighPriority(carry.data() + begin, nl - begin)) {
+                    backlog.emplace_back(carry, begin, nl + 1 - begin);
+                }
+                else {
+                    ++stats.DroppedLines;
+                    stats.DroppedBytes += nl + 1 - begin;
+                    ++droppedSinceNotice;
+                }
+                begin = nl + 1;
+            }
+            carry.erase(0, begin);
+            DrainBacklog();
+        }
+
+        static bool IsHighPriority(const char* data, size_t len) {
+            LogClassification kind = LogClassifier::Classify(data, len);
+            if (kind.IsError || kind.SuggestsClean) return true;
+            LogDiagnostic diagnostic;
+            return LogClassifier::ParseDiagnostic(std::string(data, len), diagnostic);
+        }
+
+        // True once nothing from an earlier overflow is waiting
+        bool DrainBacklog() {
+            while (!backlog.empty()) {
+                if (!Enqueue(std::move(backlog.front()))) return false;
+                backlog.pop_front();
+            }
+            if (droppedSinceNotice > 0) {
+                std::string notice = "[UEBuilder] Output fell behind; " + std::to_string(droppedSinceNotice) + " low-priority lines dropped\n";
+                if (!Enqueue(std::move(notice))) return false;
+                droppedSinceNotice = 0;
+            }
+            return true;
+        }
+
+        // Delivery thread
+        void Deliver() {
+            std::ifstream spillIn;
+            uint64_t readOffset = 0;
+            std::string chunk;
+
+            while (true) {
+                bool done = closed.load(std::memory_order_acquire);
+                if (ring.TryPop(chunk)) {
+                    consumer(chunk);
+                    continue;
+                }
+
+                // Spilled chunks are always newer than anything in the ring
+                if (readOffset < spillCommitted.load(std::memory_order_acquire)) {
+                    if (!spillIn.is_open()) spillIn.open(spillPath, std::ios::binary);
+                    uint32_t size = 0;
+                    spillIn.clear();
+                    spillIn.seekg(static_cast<std::streamoff>(readOffset));
+                    spillIn.read(reinterpret_cast<char*>(&size), sizeof(size));
+                    chunk.resize(size);
+                    if (size > 0) spillIn.read(&chunk[0], size);
+                    readOffset += sizeof(size) + size;
+                    consumer(chunk);
+                    spillRead.store(readOffset, std::memory_order_release);
+                    continue;
+                }
+
+                if (done) break;
+
+                std::unique_lock<std::mutex> lock(wakeMutex);
+                consumerIdle.store(true);
+                wake.wait_for(lock, std::chrono::milliseconds(2));
+                consumerIdle.store(false);
+            }
+        }
+    };
+}
@@ -0,0 +1,212 @@
+#pragma once
+#include "ProcessUtils.h"
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <chrono>
+#include <thread>
+#include <atomic>
+#include <functional>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // One pipe read, exactly as RunProcess delivered it
+    struct OutputChunk {
+        uint64_t Micros = 0;    // Since recording started
+        std::string Data;
+    };
+
+    // File layout (output.ubtrec):
+    //   "UEBREC1\n"
+    //   'C' varint(micros since previous record) varint(length) bytes    - one per chunk
+    //   'E' varint(micros since previous record) byte(1 = succeeded)     - once, at the end
+    // Varints are LEB128. Overhead is 3-5 bytes per chunk; a recording without 'E' is from a
+    // build that crashed or was killed and still replays up to where it stopped.
+    namespace OutputRecordingFormat {
+        static constexpr char Magic[] = "UEBREC1\n";
+        static constexpr size_t MagicSize = sizeof(Magic) - 1;
+    }
+
+    // Captures a build's output stream, keeping chunk boundaries and timing, so the log path
+    // can later be replayed deterministically. Record() must be called from one thread.
+    class OutputRecorder {
+    public:
+        static constexpr const char* FileName = "output.ubtrec";
+
+        OutputRecorder() = default;
+        ~OutputRecorder() { Close(); }
+
+        OutputRecorder(const OutputRecorder&) = delete;
+        OutputRecorder& operator=(const OutputRecorder&) = delete;
+
+        bool Open(const fs::path& path) {
+            Close();
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+#ifdef _WIN32
+            if (_wfopen_s(&file, path.c_str(), L"wb") != 0) file = nullptr;
+#else
+            file = std::fopen(path.c_str(), "wb");
+#endif
+            if (!file) return false;
+            std::fwrite(OutputRecordingFormat::Magic, 1, OutputRecordingFormat::MagicSize, file);
+            last = std::chrono::steady_clock::now();
+            return true;
+        }
+
+        bool IsOpen() const { return file != nullptr; }
+
+        void Record(const char* data, size_t size) {
+            if (!file || size == 0) return;
+            std::string header(1, 'C');
+            AppendVarint(header, Elapsed());
+            AppendVarint(header, size);
+            std::fwrite(header.data(), 1, header.size(), file);
+            std::fwrite(data, 1, size, file);
+        }
+
+        void Record(const std::string& chunk) { Record(chunk.data(), chunk.size()); }
+
+        // For RunOptions::OnRawChunk: records each read on the pipe reader's thread, timed as it
+        // came in, ahead of the output queue (which may hold, merge or drop lines)
+        std::function<void(const char*, size_t)> Tap() {
+            return [this](const char* data, size_t size) { Record(data, size); };
+        }
+
+        // Writes the end record and closes the file
+        void Finish(bool succeeded) {
+            if (!file) return;
+            std::string end(1, 'E');
+            AppendVarint(end, Elapsed());
+            end += static_cast<char>(succeeded ? 1 : 0);
+            std::fwrite(end.data(), 1, end.size(), file);
+            Close();
+        }
+
+        void Close() {
+            if (!file) return;
+            std::fclose(file);
+            file = nullptr;
+        }
+
+    private:
+        std::FILE* file = nullptr;
+        std::chrono::steady_clock::time_point last;
+
+        uint64_t Elapsed() {
+            auto now = std::chrono::steady_clock::now();
+            auto micros = std::chrono::duration_cast<std::chrono::microseconds>(now - last).count();
+            last = now;
+            return micros > 0 ? static_cast<uint64_t>(micros) : 0;
+        }
+
+        static void AppendVarint(std::string& out, uint64_t value) {
+            while (value >= 0x80) {
+                out += static_cast<char>((value & 0x7F) | 0x80);
+                value >>= 7;
+            }
+            out += static_cast<char>(value);
+        }
+    };
+
+    // A loaded recording, replayable into any LogCallback at the original pace or faster
+    class OutputRecording {
+    public:
+        // Replay this recording instead of running UBT, at UEBUILDER_REPLAY_SPEED (1 = as
+        // recorded, 4 = four times faster, 0 or "max" = no waiting)
+        static constexpr const wchar_t* ReplayEnvVar = L"UEBUILDER_REPLAY";
+        static constexpr const wchar_t* SpeedEnvVar = L"UEBUILDER_REPLAY_SPEED";
+
+        static double SpeedFromEnv() {
+            std::string speed = StringUtils::ToUtf8(ProcessUtils::GetEnvVar(SpeedEnvVar));
+            if (speed.empty()) return 1.0;
+            if (speed == "max") return 0.0;
+            return std::atof(speed.c_str());
+        }
+
+        bool Load(const fs::path& path) {
+            chunks.clear();
+            complete = false;
+            succeeded = false;
+
+            std::ifstream in(path, std::ios::binary);
+            if (!in.is_open()) return false;
+            std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            if (data.compare(0, OutputRecordingFormat::MagicSize, OutputRecordingFormat::Magic) != 0) return false;
+
+            size_t pos = OutputRecordingFormat::MagicSize;
+            uint64_t micros = 0;
+            while (pos < data.size()) {
+                char tag = data[pos++];
+                uint64_t delta = 0;
+                if (!ReadVarint(data, pos, delta)) break;
+                micros += delta;
+
+                if (tag == 'C') {
+                    uint64_t length = 0;
+                    if (!ReadVarint(data, pos, length) || length > data.size() - pos) break;
+                    chunks.push_back({ micros, data.substr(pos, static_cast<size_t>(length)) });
+                    pos += static_cast<size_t>(length);
+                }
+                else if (tag == 'E' && pos < data.size()) {
+                    succeeded = data[pos++] != 0;
+                    complete = true;
+                    endMicros = micros;
+                    break;
+                }
+                else break;
+            }
+            if (!complete) endMicros = chunks.empty() ? 0 : chunks.back().Micros;
+            return true;
+        }
+
+        const std::vector<OutputChunk>& Chunks() const { return chunks; }
+        bool Complete() const { return complete; }     // False for a cut-off recording
+        bool Succeeded() const { return succeeded; }
+        double DurationSeconds() const { return endMicros / 1e6; }
+
+        uint64_t TotalBytes() const {
+            uint64_t total = 0;
+            for (const auto& c : chunks) total += c.Data.size();
+            return total;
+        }
+
+        // Delivers every chunk with the recorded gaps divided by speed (<= 0: no waiting).
+        // Returns what the recorded build returned, so it can stand in for RunProcess.
+        bool Replay(double speed, const LogCallback& onLog, const std::atomic<bool>* cancel = nullptr) const {
+            auto start = std::chrono::steady_clock::now();
+            for (const auto& chunk : chunks) {
+                if (cancel && *cancel) return false;
+                if (speed > 0.0) {
+                    std::this_thread::sleep_until(start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                                              std::chrono::duration<double>(chunk.Micros / 1e6 / speed)));
+                }
+                if (onLog) onLog(chunk.Data);
+            }
+            return succeeded;
+        }
+
+    private:
+        std::vector<OutputChunk> chunks;
+        bool complete = false;
+        bool succeeded = false;
+        uint64_t endMicros = 0;
+
+        static bool ReadVarint(const std::string& data, size_t& pos, uint64_t& value) {
+            value = 0;
+            for (int shift = 0; shift < 64 && pos < data.size(); shift += 7) {
+                uint8_t byte = static_cast<uint8_t>(data[pos++]);
+                value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+                if (!(byte & 0x80)) return true;
+            }
+            return false;
+        }
+    };
+}
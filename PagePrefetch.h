@@ -0,0 +1,329 @@
+#pragma once
+#include "ProcessUtils.h"
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include "BuildCommand.h"
+#include "JsonUtils.h"
+#include "StringUtils.h"
+#include "SystemInfo.h"
+#include "Profiler.h"
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // The files a build of this project reads, learned from the dependency files the compilers
+    // leave under Intermediate/ (clang .d, MSVC .dep.json), plus UnrealBuildTool's binaries and
+    // the toolchain binaries next to the system include folders those files name. Kept in
+    // Saved/UEBuilder/Prefetch.txt, one path per line.
+    class PrefetchList {
+    public:
+        static fs::path ListFile(const std::wstring& projectPath) {
+            return BuildCommand::GetToolDataDir(projectPath) / "Prefetch.txt";
+        }
+
+        static std::vector<fs::path> Load(const std::wstring& projectPath) {
+            UEBUILDER_PROFILE_SCOPE("PrefetchList::Load");
+            std::vector<fs::path> files;
+            std::ifstream in(ListFile(projectPath), std::ios::binary);
+            std::string line;
+            while (std::getline(in, line)) {
+                if (!line.empty() && line.back() == '\r') line.pop_back();
+                if (line.empty() || line[0] == '#') continue;
+                files.push_back(StringUtils::PathFromUtf8(line));
+            }
+            return files;
+        }
+
+        // Before anything was learned: UnrealBuildTool and the engine headers every module's
+        // precompiled header pulls in
+        static std::vector<fs::path> Seed(const std::wstring& engineRoot, const std::wstring& ubtPath) {
+            UEBUILDER_PROFILE_SCOPE("PrefetchList::Seed");
+            std::vector<fs::path> files;
+            AddFolder(fs::path(ubtPath).parent_path(), false, files);
+            if (engineRoot.empty()) return files;
+
+            static const char* modules[] = {
+                "Core", "CoreUObject", "Engine", "ApplicationCore", "InputCore", "SlateCore", "Slate", "RenderCore", "RHI",
+            };
+            fs::path runtime = fs::path(engineRoot) / "Engine" / "Source" / "Runtime";
+            for (const char* module : modules) {
+                AddFolder(runtime / module / "Public", true, files);
+                AddFolder(runtime / module / "Classes", true, files);
+            }
+            return files;
+        }
+
+        // Rebuilds the list after a build; returns the number of files in it
+        static size_t Learn(const std::wstring& projectPath, const std::wstring& ubtPath) {
+            fs::path root = fs::path(projectPath).parent_path();
+            std::vector<fs::path> depFiles;
+            FindDependencyFiles(root / "Intermediate" / "Build", depFiles);
+
+            std::error_code ec;
+            fs::path plugins = root / "Plugins";
+            if (fs::is_directory(plugins, ec)) {
+                for (auto it = fs::recursive_directory_iterator(plugins, fs::directory_options::skip_permission_denied, ec);
+                     it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                    if (ec) break;
+                    if (!it->is_directory(ec)) continue;
+                    std::wstring name = it->path().filename().wstring();
+                    if (name == L"Intermediate") {
+                        FindDependencyFiles(it->path() / "Build", depFiles);
+                        it.disable_recursion_pending();
+                    }
+                    else if (name == L"Content" || name == L"Binaries" || name == L"Source") {
+                        it.disable_recursion_pending();
+                    }
+                }
+            }
+
+            std::unordered_set<std::string> seen;
+            std::vector<std::string> paths;
+            auto add = [&](std::string path) {
+                if (path.empty()) return;
+                std::replace(path.begin(), path.end(), '\\', '/');
+                if (seen.insert(path).second) paths.push_back(std::move(path));
+            };
+
+            std::string text;
+            for (const auto& depFile : depFiles) {
+                std::ifstream in(depFile, std::ios::binary);
+                text.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+                if (depFile.extension() == L".d") ParseMakeDependencies(text, add);
+                else {
+                    JsonValue json = JsonValue::Parse(text);
+                    for (const auto& include : json["Data"]["Includes"].Items()) add(include.AsString());
+                    add(json["Data"]["PCH"].AsString());
+                }
+            }
+
+            // Compilers and their runtime libraries, found from the system headers they use
+            std::vector<fs::path> toolchainBins;
+            for (const auto& p : paths) {
+                fs::path bin = ToolchainBinFolder(p);
+                if (!bin.empty() && std::find(toolchainBins.begin(), toolchainBins.end(), bin) == toolchainBins.end()) {
+                    toolchainBins.push_back(bin);
+                }
+            }
+
+            std::vector<fs::path> extra;
+            if (!ubtPath.empty()) AddFolder(fs::path(ubtPath).parent_path(), false, extra);
+            for (const auto& bin : toolchainBins) AddFolder(bin, false, extra);
+            for (const auto& e : extra) add(StringUtils::PathToUtf8(e));
+
+            // Path order is close to on-disk order, which keeps the reads sequential-ish
+            std::sort(paths.begin(), paths.end());
+
+            fs::path listFile = ListFile(projectPath);
+            fs::create_directories(listFile.parent_path(), ec);
+            std::ofstream out(listFile, std::ios::binary | std::ios::trunc);
+            out << "# Files read by the last build, warmed before the next one. Rewritten after every build.\n";
+            for (const auto& p : paths) out << p << '\n';
+            return paths.size();
+        }
+
+    private:
+        static void AddFolder(const fs::path& dir, bool recursive, std::vector<fs::path>& out) {
+            std::error_code ec;
+            if (!fs::is_directory(dir, ec)) return;
+            if (recursive) {
+                for (auto it = fs::recursive_directory_iterator(dir, fs::directory_options::skip_permission_denied, ec);
+                     it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                    if (ec) break;
+                    if (it->is_regular_file(ec)) out.push_back(it->path());
+                }
+            }
+            else {
+                for (const auto& entry : fs::directory_iterator(dir, ec)) {
+                    if (entry.is_regular_file(ec)) out.push_back(entry.path());
+                }
+            }
+        }
+
+        static void FindDependencyFiles(const fs::path& dir, std::vector<fs::path>& out) {
+            std::error_code ec;
+            if (!fs::is_directory(dir, ec)) return;
+            for (auto it = fs::recursive_directory_iterator(dir, fs::directory_options::skip_permission_denied, ec);
+                 it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                if (!it->is_regular_file(ec)) continue;
+                const fs::path& p = it->path();
+                if (p.extension() == L".d") out.push_back(p);
+                else if (p.extension() == L".json" && p.stem().extension() == L".dep") out.push_back(p);
+            }
+        }
+
+        // "target.o: a.h b\ c.h \<newline> d.h"
+        template <typename Fn>
+        static void ParseMakeDependencies(const std::string& text, Fn&& add) {
+            size_t colon = text.find(": ");
+            if (colon == std::string::npos) return;
+            std::string token;
+            for (size_t i = colon + 2; i < text.size(); ++i) {
+                char c = text[i];
+                if (c == '\\' && i + 1 < text.size()) {
+                    char next = text[i + 1];
+                    if (next == ' ' || next == '#') {
+                        token += next;
+                        ++i;
+                        continue;
+                    }
+                    if (next == '\n' || next == '\r') continue;    // Line continuation
+                }
+                if (c == ' ' || c == '\t' || c == '\n' || c == '\r') {
+                    if (!token.empty()) add(token);
+                    token.clear();
+                    continue;
+                }
+                token += c;
+            }
+            if (!token.empty()) add(token);
+        }
+
+        // ".../VC/Tools/MSVC/<ver>/include/x.h" -> ".../VC/Tools/MSVC/<ver>/bin/Hostx64/x64"
+        // ".../lib/clang/<ver>/include/x.h"     -> ".../bin"
+        static fs::path ToolchainBinFolder(const std::string& header) {
+            size_t msvc = header.find("/VC/Tools/MSVC/");
+            if (msvc != std::string::npos) {
+                size_t version = header.find('/', msvc + 15);
+                if (version == std::string::npos) return {};
+                return StringUtils::PathFromUtf8(header.substr(0, version) + "/bin/Hostx64/x64");
+            }
+            size_t clang = header.find("/lib/clang/");
+            if (clang != std::string::npos) return StringUtils::PathFromUtf8(header.substr(0, clang) + "/bin");
+            return {};
+        }
+    };
+
+    // Pulls files into the OS page cache on a few background threads, so the first compile
+    // after a reboot doesn't wait on thousands of cold reads. Nothing is kept in this process:
+    //   Linux    readahead(), which fills the page cache without copying
+    //   macOS    fcntl(F_RDADVISE)
+    //   Windows  sequential ReadFile into a scratch buffer; the data lands in the standby list.
+    //            (PrefetchVirtualMemory needs a mapped view that lives until the I/O is done,
+    //            which would mean holding thousands of views open.)
+    // Stops at a byte budget and when destroyed; the build never waits for it.
+    class PagePrefetcher {
+    public:
+        // "0" turns prefetching off
+        static constexpr const wchar_t* EnvVar = L"UEBUILDER_PREFETCH";
+        static constexpr unsigned IoThreads = 8;    // Enough queue depth for SSDs; cheap on HDDs
+
+        static bool Enabled() { return ProcessUtils::GetEnvVar(EnvVar) != L"0"; }
+
+        PagePrefetcher() = default;
+        ~PagePrefetcher() { Stop(); }
+
+        PagePrefetcher(const PagePrefetcher&) = delete;
+        PagePrefetcher& operator=(const PagePrefetcher&) = delete;
+
+        // Quarter of RAM, at most 2 GB
+        static uint64_t DefaultBudget() {
+            uint64_t quarter = SystemInfo::GetTotalMemory() / 4;
+            uint64_t cap = 2ull << 30;
+            return quarter ? (std::min)(quarter, cap) : cap;
+        }
+
+        void Start(std::vector<fs::path> list, uint64_t budgetBytes = DefaultBudget()) {
+            Stop();
+            files = std::move(list);
+            budget = budgetBytes;
+            next = 0;
+            filesDone = 0;
+            bytesDone = 0;
+            stopRequested = false;
+            startTime = std::chrono::steady_clock::now();
+
+            unsigned count = static_cast<unsigned>((std::min)(static_cast<size_t>(IoThreads), files.size()));
+            for (unsigned t = 0; t < count; ++t) threads.emplace_back([this]() { Worker(); });
+        }
+
+        void Stop() {
+            stopRequested = true;
+            for (auto& t : threads) t.join();
+            threads.clear();
+        }
+
+        // Blocks until every file was read (or the budget was used up)
+        void Wait() {
+            for (auto& t : threads) t.join();
+            threads.clear();
+        }
+
+        size_t FileCount() const { return files.size(); }
+        uint64_t FilesDone() const { return filesDone; }
+        uint64_t BytesDone() const { return bytesDone; }
+        double Seconds() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count(); }
+
+        // Reads one file into the page cache; returns its size, 0 if it can't be opened
+        static uint64_t PrefetchFile(const fs::path& path) {
+#ifdef _WIN32
+            HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                                      NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+            if (file == INVALID_HANDLE_VALUE) return 0;
+            thread_local std::vector<char> buffer(1 << 20);
+            uint64_t total = 0;
+            DWORD got = 0;
+            while (ReadFile(file, buffer.data(), static_cast<DWORD>(buffer.size()), &got, NULL) && got > 0) total += got;
+            CloseHandle(file);
+            return total;
+#else
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) return 0;
+            struct stat st;
+            uint64_t size = 0;
+            if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+                size = static_cast<uint64_t>(st.st_size);
+#if defined(__linux__)
+                readahead(fd, 0, static_cast<size_t>(size));
+#elif defined(__APPLE__)
+                struct radvisory advice;
+                advice.ra_offset = 0;
+                advice.ra_count = static_cast<int>((std::min)(size, static_cast<uint64_t>(INT32_MAX)));
+                fcntl(fd, F_RDADVISE, &advice);
+#else
+                posix_fadvise(fd, 0, 0, POSIX_FADV_WILLNEED);
+#endif
+            }
+            ::close(fd);
+            return size;
+#endif
+        }
+
+    private:
+        std::vector<fs::path> files;
+        std::vector<std::thread> threads;
+        std::atomic<size_t> next{ 0 };
+        std::atomic<uint64_t> filesDone{ 0 };
+        std::atomic<uint64_t> bytesDone{ 0 };
+        std::atomic<bool> stopRequested{ false };
+        uint64_t budget = 0;
+        std::chrono::steady_clock::time_point startTime;
+
+        void Worker() {
+            for (size_t i = next.fetch_add(1); i < files.size(); i = next.fetch_add(1)) {
+                if (stopRequested || bytesDone >= budget) return;
+                uint64_t bytes = PrefetchFile(files[i]);
+                if (bytes == 0) continue;
+                bytesDone += bytes;
+                ++filesDone;
+            }
+        }
+    };
+}
@@ -0,0 +1,584 @@
+#pragma once
+#include "ProcessUtils.h"
+#include "EngineDetector.h"
+#include "BuildCommand.h"
+#include "BuildActionLog.h"
+#include "HashUtils.h"
+#include "JsonUtils.h"
+#include "StringUtils.h"
+#include "Metrics.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    enum class PipelineStageKind {
+        Build,      // UnrealBuildTool, same command line as a normal build
+        Cook,       // RunUAT BuildCookRun -cook
+        Package,    // RunUAT BuildCookRun -stage -pak -package -archive
+        Uat,        // RunUAT with the stage's args verbatim
+    };
+
+    struct PipelineStage {
+        std::string Name;
+        PipelineStageKind Kind = PipelineStageKind::Build;
+        std::vector<std::string> After;         // Stages that must succeed first
+        std::wstring Target;                    // Editor, Game, Client, Server (build)
+        std::wstring Config;
+        std::wstring Platform;
+        std::vector<std::wstring> Args;         // Appended to the generated command line
+        std::wstring Output;                    // package: archive directory
+        std::vector<std::string> Inputs;        // Project-relative files/folders that decide whether to rerun
+        bool Always = false;                    // Never skipped
+    };
+
+    struct PipelineDefinition {
+        std::string Name;                       // File stem; keys the saved state
+        std::vector<PipelineStage> Stages;
+        int MaxParallel = 0;                    // 0 = as many as the dependencies and locks allow
+    };
+
+    enum class PipelineStageStatus { Pending, Running, Succeeded, Skipped, Failed, Cancelled };
+
+    struct PipelineStageResult {
+        PipelineStageStatus Status = PipelineStageStatus::Pending;
+        double Seconds = 0.0;
+        std::string Reason;     // Why it was skipped, failed or cancelled
+    };
+
+    struct PipelineResult {
+        std::vector<PipelineStageResult> Stages;   // Same order as the definition
+        double Seconds = 0.0;
+
+        bool Succeeded() const {
+            for (const auto& s : Stages) {
+                if (s.Status != PipelineStageStatus::Succeeded && s.Status != PipelineStageStatus::Skipped) return false;
+            }
+            return true;
+        }
+    };
+
+    // A release pipeline described in JSON and run as a DAG:
+    //
+    //   { "platform": "Win64", "maxParallel": 3,
+    //     "stages": [
+    //       { "name": "editor",    "type": "build", "target": "Editor" },
+    //       { "name": "game-dev",  "type": "build", "target": "Game", "config": "Development", "after": ["editor"] },
+    //       { "name": "game-ship", "type": "build", "target": "Game", "config": "Shipping",    "after": ["editor"] },
+    //       { "name": "cook",      "type": "cook",  "config": "Shipping", "after": ["game-dev", "game-ship"] },
+    //       { "name": "package",   "type": "package", "config": "Shipping", "output": "D:/Releases", "after": ["cook"] } ] }
+    //
+    // Every stage starts as soon as everything it comes "after" has succeeded (or was skipped)
+    // and its lock is free: one per target/platform/config for builds, one shared by all RunUAT
+    // stages, which write the same Saved/Cooked and staging folders. A failure cancels the
+    // stages that depend on it, nothing else.
+    //
+    // A stage is skipped when its fingerprint - its own settings, the engine, its inputs'
+    // paths/sizes/timestamps and the fingerprints of the stages it depends on - matches its last
+    // successful run (Saved/UEBuilder/Pipeline/<name>.state.json). Default inputs: the .uproject,
+    // Source, Plugins and Config for builds; Content, Config and Plugins for cooks; nothing but
+    // the stages before it for packaging and plain UAT stages.
+    class Pipeline {
+    public:
+        static bool Load(const fs::path& file, PipelineDefinition& out, std::string& error) {
+            std::ifstream in(file, std::ios::binary);
+            if (!in.is_open()) {
+                error = "cannot read " + StringUtils::PathToUtf8(file);
+                return false;
+            }
+            std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            bool ok = false;
+            JsonValue root = JsonValue::Parse(text, &ok);
+            if (!ok || !root.IsObject()) {
+                error = "not valid JSON";
+                return false;
+            }
+
+            out = PipelineDefinition();
+            out.Name = StringUtils::PathToUtf8(file.stem());
+            out.MaxParallel = static_cast<int>((std::max)(int64_t(0), root["maxParallel"].AsInt(0)));
+            std::wstring platform = StringUtils::FromUtf8(root["platform"].AsString());
+
+            for (const JsonValue& s : root["stages"].Items()) {
+                PipelineStage stage;
+                stage.Name = s["name"].AsString();
+                if (stage.Name.empty()) {
+                    error = "every stage needs a name";
+                    return false;
+                }
+
+                std::string type = s["type"].AsString("build");
+                if (type == "build") stage.Kind = PipelineStageKind::Build;
+                else if (type == "cook") stage.Kind = PipelineStageKind::Cook;
+                else if (type == "package") stage.Kind = PipelineStageKind::Package;
+                else if (type == "uat") stage.Kind = PipelineStageKind::Uat;
+                else {
+                    error = "stage '" + stage.Name + "': unknown type '" + type + "' (build, cook, package, uat)";
+                    return false;
+                }
+
+                stage.Target = StringUtils::FromUtf8(s["target"].AsString());
+                stage.Config = StringUtils::FromUtf8(s["config"].AsString());
+                stage.Platform = StringUtils::FromUtf8(s["platform"].AsString());
+                if (stage.Platform.empty()) stage.Platform = platform;
+                stage.Output = StringUtils::FromUtf8(s["output"].AsString());
+                stage.Always = s["always"].AsBool(false);
+                for (const JsonValue& a : s["after"].Items()) stage.After.push_back(a.AsString());
+                for (const JsonValue& a : s["args"].Items()) stage.Args.push_back(StringUtils::FromUtf8(a.AsString()));
+                for (const JsonValue& i : s["inputs"].Items()) stage.Inputs.push_back(i.AsString());
+                if (!s.Has("inputs")) stage.Inputs = DefaultInputs(stage.Kind);
+                out.Stages.push_back(std::move(stage));
+            }
+
+            if (out.Stages.empty()) {
+                error = "no stages";
+                return false;
+            }
+            return Validate(out, error);
+        }
+
+        // Fills in what stages leave open from the command line's target/config/platform
+        static void ApplyDefaults(PipelineDefinition& definition, const std::wstring& target, const std::wstring& config,
+                                  const std::wstring& platform) {
+            for (auto& stage : definition.Stages) {
+                if (stage.Target.empty()) stage.Target = stage.Kind == PipelineStageKind::Build ? target : L"Game";
+                if (stage.Config.empty()) stage.Config = config;
+                if (stage.Platform.empty()) stage.Platform = platform;
+            }
+        }
+
+        // Executable and arguments that run the stage
+        static bool GetCommand(const PipelineStage& stage, const std::wstring& projectPath, const EngineInfo& engine,
+                               std::wstring& command, std::wstring& args) {
+            if (stage.Kind == PipelineStageKind::Build) {
+                BuildRequest request;
+                request.ProjectPath = projectPath;
+                request.Target = stage.Target;
+                request.Config = stage.Config;
+                request.Platform = stage.Platform;
+                request.ExtraArgs = stage.Args;
+                command = engine.UBTPath;
+                args = BuildCommand::GetUBTArgs(request);
+                return !command.empty();
+            }
+
+            std::error_code ec;
+            if (engine.UATPath.empty() || !fs::exists(engine.UATPath, ec)) return false;
+            std::wstring uat;
+            if (stage.Kind == PipelineStageKind::Uat) {
+                for (const auto& a : stage.Args) uat += (uat.empty() ? L"" : L" ") + a;
+            }
+            else {
+                uat = L"BuildCookRun -project=\"" + projectPath + L"\" -noP4 -unattended -utf8output -nocompileeditor"
+                      L" -platform=" + stage.Platform + L" -clientconfig=" + stage.Config + L" -skipbuild";
+                if (stage.Kind == PipelineStageKind::Cook) uat += L" -cook";
+                else {
+                    uat += L" -skipcook -stage -pak -package";
+                    if (!stage.Output.empty()) uat += L" -archive -archivedirectory=\"" + stage.Output + L"\"";
+                }
+                for (const auto& a : stage.Args) uat += L" " + a;
+            }
+#ifdef _WIN32
+            // A batch file needs the command interpreter
+            command = L"cmd.exe";
+            args = L"/c \"\"" + engine.UATPath + L"\" " + uat + L"\"";
+#else
+            command = engine.UATPath;
+            args = uat;
+#endif
+            return true;
+        }
+
+        static const char* StatusName(PipelineStageStatus status) {
+            switch (status) {
+            case PipelineStageStatus::Pending: return "pending";
+            case PipelineStageStatus::Running: return "running";
+            case PipelineStageStatus::Succeeded: return "succeeded";
+            case PipelineStageStatus::Skipped: return "skipped";
+            case PipelineStageStatus::Failed: return "failed";
+            case PipelineStageStatus::Cancelled: return "cancelled";
+            }
+            return "unknown";
+        }
+
+        static std::string FormatReport(const PipelineDefinition& definition, const PipelineResult& result) {
+            std::string out = "Pipeline " + definition.Name + ":\n";
+            char line[256];
+            for (size_t i = 0; i < definition.Stages.size(); ++i) {
+                const auto& r = result.Stages[i];
+                std::snprintf(line, sizeof(line), "  %-24s %-10s %8.1fs  ", definition.Stages[i].Name.c_str(),
+                              StatusName(r.Status), r.Seconds);
+                out += line;
+                out += r.Reason;
+                out += "\n";
+            }
+            std::snprintf(line, sizeof(line), "Total: %.1fs\n", result.Seconds);
+            out += line;
+            return out;
+        }
+
+    private:
+        static std::vector<std::string> DefaultInputs(PipelineStageKind kind) {
+            switch (kind) {
+            case PipelineStageKind::Build: return { "*.uproject", "Source", "Plugins", "Config" };
+            case PipelineStageKind::Cook: return { "*.uproject", "Content", "Config", "Plugins" };
+            default: return {};
+            }
+        }
+
+        // Unique names, known dependencies, no cycles
+        static bool Validate(const PipelineDefinition& definition, std::string& error) {
+            std::map<std::string, size_t> index;
+            for (size_t i = 0; i < definition.Stages.size(); ++i) {
+                if (!index.emplace(definition.Stages[i].Name, i).second) {
+                    error = "stage '" + definition.Stages[i].Name + "' is defined twice";
+                    return false;
+                }
+            }
+
+            std::vector<int> waiting(definition.Stages.size(), 0);
+            for (size_t i = 0; i < definition.Stages.size(); ++i) {
+                for (const auto& dep : definition.Stages[i].After) {
+                    if (!index.count(dep)) {
+                        error = "stage '" + definition.Stages[i].Name + "' comes after unknown stage '" + dep + "'";
+                        return false;
+                    }
+                    ++waiting[i];
+                }
+            }
+
+            // Kahn: whatever never becomes ready is on a cycle
+            std::vector<size_t> ready;
+            for (size_t i = 0; i < waiting.size(); ++i) {
+                if (waiting[i] == 0) ready.push_back(i);
+            }
+            size_t visited = 0;
+            while (!ready.empty()) {
+                size_t done = ready.back();
+                ready.pop_back();
+                ++visited;
+                for (size_t i = 0; i < definition.Stages.size(); ++i) {
+                    for (const auto& dep : definition.Stages[i].After) {
+                        if (dep == definition.Stages[done].Name && --waiting[i] == 0) ready.push_back(i);
+                    }
+                }
+            }
+            if (visited != definition.Stages.size()) {
+                error = "the stages' \"after\" lists form a cycle";
+                return false;
+            }
+            return true;
+        }
+    };
+
+    // Runs a validated PipelineDefinition. Output of concurrently running stages is passed to
+    // onLog one line at a time, prefixed with "[stage] ", and kept per stage in
+    // Saved/UEBuilder/Pipeline/Logs/<stage>.log.
+    class PipelineRunner {
+    public:
+        using StageListener = std::function<void(const PipelineStage& stage, const PipelineStageResult& result)>;
+
+        PipelineRunner(const PipelineDefinition& definition, std::wstring projectPath, EngineInfo engine, LogCallback onLog)
+            : definition(definition), projectPath(std::move(projectPath)), engine(std::move(engine)), onLog(std::move(onLog)) {}
+
+        void SetForce(bool value) { force = value; }                    // Ignore saved fingerprints
+        void SetStageListener(StageListener listener) { stageListener = std::move(listener); } // Start and end of every stage
+        void SetEnvironment(const EnvironmentBlock* value) { environment = value; } // For UBT/UAT; null inherits ours
+
+        PipelineResult Run() {
+            auto start = std::chrono::steady_clock::now();
+            const size_t count = definition.Stages.size();
+            result = PipelineResult();
+            result.Stages.resize(count);
+            fingerprints.assign(count, std::string());
+            LoadState();
+
+            // Build stages wait in the metrics' queue until they run (or are skipped/cancelled)
+            buildMetrics.clear();
+            buildMetrics.resize(count);
+            for (size_t i = 0; i < count; ++i) {
+                if (definition.Stages[i].Kind == PipelineStageKind::Build) buildMetrics[i] = std::make_unique<BuildMetrics>();
+            }
+
+            std::vector<std::thread> workers;
+            std::unique_lock<std::mutex> lock(mutex);
+            while (true) {
+                for (size_t i = 0; i < count; ++i) {
+                    if (!CanStart(i)) continue;
+                    result.Stages[i].Status = PipelineStageStatus::Running;
+                    locksHeld.insert(LockOf(definition.Stages[i]));
+                    ++running;
+                    workers.emplace_back([this, i]() { RunStage(i); });
+                }
+                if (running == 0) break;
+                changed.wait(lock);
+            }
+            lock.unlock();
+            for (auto& w : workers) w.join();
+            buildMetrics.clear();
+
+            // Anything left never had its dependencies met
+            for (auto& r : result.Stages) {
+                if (r.Status == PipelineStageStatus::Pending) {
+                    r.Status = PipelineStageStatus::Cancelled;
+                    if (r.Reason.empty()) r.Reason = "dependency did not succeed";
+                }
+            }
+            result.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            return result;
+        }
+
+    private:
+        const PipelineDefinition& definition;
+        std::wstring projectPath;
+        EngineInfo engine;
+        LogCallback onLog;
+        StageListener stageListener;
+        bool force = false;
+        const EnvironmentBlock* environment = nullptr;
+
+        std::mutex mutex;               // Guards everything below
+        std::condition_variable changed;
+        PipelineResult result;
+        std::vector<std::string> fingerprints;
+        std::set<std::string> locksHeld;
+        int running = 0;
+        std::map<std::string, std::string> saved;   // Stage name -> fingerprint of its last success
+        std::vector<std::unique_ptr<BuildMetrics>> buildMetrics; // Per stage, builds only; each touched by its stage's thread
+
+        std::mutex logMutex;            // One stage's line at a time
+
+        fs::path StateFile() const {
+            return BuildCommand::GetToolDataDir(projectPath) / "Pipeline" / (definition.Name + ".state.json");
+        }
+
+        size_t IndexOf(const std::string& name) const {
+            for (size_t i = 0; i < definition.Stages.size(); ++i) {
+                if (definition.Stages[i].Name == name) return i;
+            }
+            return definition.Stages.size();
+        }
+
+        static std::string LockOf(const PipelineStage& stage) {
+            if (stage.Kind != PipelineStageKind::Build) return "uat";
+            return "ubt:" + StringUtils::ToUtf8(stage.Target + L"|" + stage.Platform + L"|" + stage.Config);
+        }
+
+        bool CanStart(size_t i) const {
+            if (result.Stages[i].Status != PipelineStageStatus::Pending) return false;
+            if (definition.MaxParallel > 0 && running >= definition.MaxParallel) return false;
+            for (const auto& dep : definition.Stages[i].After) {
+                auto status = result.Stages[IndexOf(dep)].Status;
+                if (status != PipelineStageStatus::Succeeded && status != PipelineStageStatus::Skipped) return false;
+            }
+            return !locksHeld.count(LockOf(definition.Stages[i]));
+        }
+
+        // Called with the lock held
+        void CancelDependents(size_t failed) {
+            for (size_t i = 0; i < definition.Stages.size(); ++i) {
+                auto& r = result.Stages[i];
+                if (r.Status != PipelineStageStatus::Pending) continue;
+                const auto& after = definition.Stages[i].After;
+                if (std::find(after.begin(), after.end(), definition.Stages[failed].Name) == after.end()) continue;
+                r.Status = PipelineStageStatus::Cancelled;
+                r.Reason = "'" + definition.Stages[failed].Name + "' did not succeed";
+                CancelDependents(i);
+            }
+        }
+
+        void RunStage(size_t i) {
+            const PipelineStage& stage = definition.Stages[i];
+            auto start = std::chrono::steady_clock::now();
+            PipelineStageResult stageResult;
+            stageResult.Status = PipelineStageStatus::Running;
+            if (stageListener) stageListener(stage, stageResult);
+
+            std::vector<std::string> depFingerprints;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const auto& dep : stage.After) depFingerprints.push_back(fingerprints[IndexOf(dep)]);
+            }
+            std::string fingerprint = Fingerprint(stage, depFingerprints);
+
+            bool upToDate = false;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = saved.find(stage.Name);
+                upToDate = !force && !stage.Always && it != saved.end() && it->second == fingerprint;
+                if (upToDate && stage.Kind == PipelineStageKind::Package && !stage.Output.empty()) {
+                    std::error_code ec;
+                    upToDate = fs::is_directory(stage.Output, ec);
+                }
+            }
+
+            Metrics::CacheLookup("pipeline", upToDate);
+            BuildMetrics* metrics = buildMetrics[i].get();
+            if (upToDate) {
+                stageResult.Status = PipelineStageStatus::Skipped;
+                stageResult.Reason = "inputs unchanged";
+                Log(stage, "Skipped: inputs unchanged since the last successful run\n");
+            }
+            else {
+                std::wstring command, args;
+                if (!Pipeline::GetCommand(stage, projectPath, engine, command, args)) {
+                    stageResult.Status = PipelineStageStatus::Failed;
+                    stageResult.Reason = stage.Kind == PipelineStageKind::Build ? "no UnrealBuildTool" : "no RunUAT script in this engine";
+                    Log(stage, stageResult.Reason + "\n");
+                }
+                else {
+                    if (metrics) metrics->Start(StringUtils::ToUtf8(TargetName(stage)), StringUtils::ToUtf8(stage.Config));
+                    bool ok = RunLogged(stage, command, args, metrics);
+                    if (metrics) metrics->Finish(ok);
+                    stageResult.Status = ok ? PipelineStageStatus::Succeeded : PipelineStageStatus::Failed;
+                    if (!ok) stageResult.Reason = "see " + StringUtils::PathToUtf8(LogFile(stage));
+                }
+            }
+            buildMetrics[i].reset(); // A build that never started leaves the queue here
+            stageResult.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            if (stageListener) stageListener(stage, stageResult);  // Before any dependent can start
+
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                result.Stages[i] = stageResult;
+                locksHeld.erase(LockOf(stage));
+                --running;
+                if (stageResult.Status == PipelineStageStatus::Failed) {
+                    saved.erase(stage.Name);
+                    CancelDependents(i);
+                }
+                else {
+                    fingerprints[i] = fingerprint;
+                    saved[stage.Name] = fingerprint;
+                }
+                SaveState();
+            }
+            changed.notify_all();
+        }
+
+        fs::path LogFile(const PipelineStage& stage) const {
+            return BuildCommand::GetToolDataDir(projectPath) / "Pipeline" / "Logs" / (stage.Name + ".log");
+        }
+
+        // As UBT names it, e.g. MyGameEditor
+        std::wstring TargetName(const PipelineStage& stage) const {
+            BuildRequest request;
+            request.ProjectPath = projectPath;
+            request.Target = stage.Target;
+            return BuildCommand::GetBuildTarget(request);
+        }
+
+        bool RunLogged(const PipelineStage& stage, const std::wstring& command, const std::wstring& args, BuildMetrics* metrics) {
+            fs::path logPath = LogFile(stage);
+            std::error_code ec;
+            fs::create_directories(logPath.parent_path(), ec);
+            std::ofstream log(logPath, std::ios::binary | std::ios::trunc);
+
+            LineSplitter splitter;
+            auto emitLine = [&](const std::string& line) { Log(stage, line + "\n"); };
+            RunOptions options;
+            options.Environment = environment;
+            bool ok = ProcessUtils::RunProcess(command, args, L"", [&](const std::string& chunk) {
+                log.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                if (metrics) metrics->CountOutput(chunk);
+                splitter.Feed(chunk.data(), chunk.size(), emitLine);
+            }, options);
+            splitter.Flush(emitLine);
+            return ok;
+        }
+
+        void Log(const PipelineStage& stage, const std::string& text) {
+            if (!onLog) return;
+            std::lock_guard<std::mutex> lock(logMutex);
+            onLog("[" + stage.Name + "] " + text);
+        }
+
+        // Settings, engine, dependencies and input metadata. Timestamps and sizes rather than
+        // contents: a Content folder can hold hundreds of gigabytes.
+        std::string Fingerprint(const PipelineStage& stage, const std::vector<std::string>& depFingerprints) const {
+            Sha256 hasher;
+            std::wstring settings = std::to_wstring(static_cast<int>(stage.Kind)) + L"|" + stage.Target + L"|" + stage.Config +
+                                    L"|" + stage.Platform + L"|" + stage.Output + L"|" + engine.RootPath + L"|" + engine.Version;
+            for (const auto& a : stage.Args) settings += L"|" + a;
+            hasher.Update(StringUtils::ToUtf8(settings));
+            for (const auto& dep : depFingerprints) hasher.Update(dep);
+
+            fs::path root = fs::path(projectPath).parent_path();
+            std::vector<std::string> entries;
+            for (const auto& input : stage.Inputs) {
+                if (input == "*.uproject") AddInput(fs::path(projectPath), root, entries);
+                else AddInput(root / StringUtils::PathFromUtf8(input), root, entries);
+            }
+            std::sort(entries.begin(), entries.end());
+            for (const auto& e : entries) hasher.Update(e.c_str(), e.size() + 1);
+            return hasher.FinalHex();
+        }
+
+        // "relative|size|mtime" for a file, or for every file below a folder except build products
+        static void AddInput(const fs::path& path, const fs::path& root, std::vector<std::string>& out) {
+            std::error_code ec;
+            auto addFile = [&](const fs::path& file) {
+                std::error_code fec;
+                auto size = fs::file_size(file, fec);
+                auto time = fs::last_write_time(file, fec).time_since_epoch().count();
+                out.push_back(StringUtils::GenericRelative(file, root) + "|" + std::to_string(size) + "|" + std::to_string(time));
+            };
+
+            if (fs::is_regular_file(path, ec)) {
+                addFile(path);
+                return;
+            }
+            if (!fs::is_directory(path, ec)) return;
+
+            for (auto it = fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied, ec);
+                 it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                if (it->is_directory(ec)) {
+                    std::wstring name = it->path().filename().wstring();
+                    if (name == L"Binaries" || name == L"Intermediate" || name == L"Saved" || name == L"DerivedDataCache") {
+                        it.disable_recursion_pending();
+                    }
+                }
+                else if (it->is_regular_file(ec)) {
+                    addFile(it->path());
+                }
+            }
+        }
+
+        void LoadState() {
+            saved.clear();
+            std::ifstream in(StateFile(), std::ios::binary);
+            if (!in.is_open()) return;
+            std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            JsonValue root = JsonValue::Parse(text);
+            for (const auto& m : root["stages"].Members()) saved[m.first] = m.second.AsString();
+        }
+
+        // Called with the lock held
+        void SaveState() const {
+            JsonValue stages = JsonValue::MakeObject();
+            for (const auto& s : saved) stages.Set(s.first, s.second);
+            JsonValue root = JsonValue::MakeObject();
+            root.Set("stages", stages);
+
+            std::error_code ec;
+            fs::create_directories(StateFile().parent_path(), ec);
+            std::ofstream out(StateFile(), std::ios::binary | std::ios::trunc);
+            out << root.Dump(2);
+        }
+    };
+}
@@ -0,0 +1,728 @@
+#pragma once
+#include "ProcessUtils.h"
+#include "HttpClient.h"
+#include "HashUtils.h"
+#include "JsonUtils.h"
+#include "StringUtils.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include <string>
+#include <vector>
+#include <fstream>
+#include <filesystem>
+#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    struct PrebuiltFetchStats {
+        uint64_t FilesTotal = 0;
+        uint64_t FilesUnchanged = 0;
+        uint64_t BytesReused = 0;       // Copied from blocks we already had locally
+        uint64_t BytesTransferred = 0;  // Pulled from the shared location
+    };
+
+    // Publish/subscribe of prebuilt project binaries.
+    //
+    // A build machine publishes Binaries/ (project + plugins) into a shared location:
+    //   <Location>/<Revision>/manifest.json
+    //   <Location>/<Revision>/files/<relative path>
+    // The location is either a folder (network share) or a plain http:// file server
+    // serving that same folder. Subscribers only pull the blocks they don't already
+    // have, found with an rsync-style rolling checksum over their old local files.
+    class PrebuiltCache {
+    public:
+        // Where the GUI/CLI look for prebuilts when nothing else is configured
+        static constexpr const wchar_t* LocationEnvVar = L"UEBUILDER_PREBUILT_SOURCE";
+
+        // Fingerprint of everything that decides what the binaries look like:
+        // the .uproject, project + plugin sources and descriptors, engine version and build target.
+        static std::string ComputeRevision(const fs::path& projectFile, const std::wstring& association,
+                                           const std::wstring& buildTarget, const std::wstring& platform,
+                                           const std::wstring& config) {
+            UEBUILDER_PROFILE_SCOPE("PrebuiltCache::ComputeRevision");
+            fs::path projectRoot = projectFile.parent_path();
+
+            std::vector<fs::path> inputs;
+            inputs.push_back(projectFile);
+            CollectFiles(projectRoot / "Source", inputs, nullptr);
+            CollectPluginInputs(projectRoot / "Plugins", inputs);
+
+            std::sort(inputs.begin(), inputs.end());
+
+            Sha256 hasher;
+            hasher.Update(StringUtils::ToUtf8(association + L"|" + buildTarget + L"|" + platform + L"|" + config));
+
+            std::vector<char> chunk(1 << 16);
+            for (const auto& path : inputs) {
+                std::string rel = StringUtils::GenericRelative(path, projectRoot);
+                hasher.Update(rel.c_str(), rel.size() + 1); // Include the terminator as a separator
+
+                std::ifstream file(path, std::ios::binary);
+                while (file) {
+                    file.read(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+                    std::streamsize got = file.gcount();
+                    if (got > 0) hasher.Update(chunk.data(), static_cast<size_t>(got));
+                }
+            }
+            return hasher.FinalHex();
+        }
+
+        // Only a miss is counted here; a hit is counted by the Fetch that follows
+        static bool HasPrebuilt(const std::wstring& location, const std::string& revision) {
+            Store store(location);
+            bool exists = store.Exists(revision + "/manifest.json");
+            if (!exists) Metrics::CacheLookup("prebuilt", false);
+            return exists;
+        }
+
+        // Copies the project's binaries and a manifest to the shared location.
+        // Only folder locations can be published to; an HTTP server just serves that folder.
+        static bool Publish(const std::wstring& location, const fs::path& projectFile,
+                            const std::string& revision, LogCallback onLog) {
+            if (HttpClient::IsHttpUrl(StringUtils::ToUtf8(location))) {
+                Log(onLog, "[Prebuilt] Publishing needs a folder path; point the HTTP server at that folder instead.\n");
+                return false;
+            }
+
+            fs::path projectRoot = projectFile.parent_path();
+            std::vector<fs::path> binaries = CollectBinaries(projectRoot);
+            if (binaries.empty()) {
+                Log(onLog, "[Prebuilt] Nothing to publish: no files under Binaries/. Build the project first.\n");
+                return false;
+            }
+
+            fs::path revisionDir = fs::path(location) / StringUtils::FromUtf8(revision);
+            std::error_code ec;
+            fs::create_directories(revisionDir / "files", ec);
+            if (ec) {
+                Log(onLog, "[Prebuilt] Could not create " + StringUtils::PathToUtf8(revisionDir) + "\n");
+                return false;
+            }
+
+            JsonValue manifest = JsonValue::MakeObject();
+            manifest.Set("Revision", revision);
+            manifest.Set("Project", StringUtils::PathToUtf8(projectFile.stem()));
+            JsonValue files = JsonValue::MakeArray();
+
+            for (const auto& path : binaries) {
+                std::string rel = StringUtils::GenericRelative(path, projectRoot);
+
+                std::vector<uint8_t> data;
+                if (!ReadWholeFile(path, data)) {
+                    Log(onLog, "[Prebuilt] Could not read " + rel + "\n");
+                    return false;
+                }
+
+                fs::path dest = revisionDir / "files" / StringUtils::PathFromUtf8(rel);
+                fs::create_directories(dest.parent_path(), ec);
+                if (!WriteWholeFile(dest, data.data(), data.size())) {
+                    Log(onLog, "[Prebuilt] Could not write " + StringUtils::PathToUtf8(dest) + "\n");
+                    return false;
+                }
+
+                files.Push(DescribeFile(rel, data));
+                Log(onLog, "[Prebuilt] Published " + rel + "\n");
+            }
+            manifest.Set("Files", files);
+
+            // The manifest goes last: subscribers treat its presence as "revision complete"
+            std::string text = manifest.Dump(1);
+            fs::path manifestTmp = revisionDir / "manifest.json.tmp";
+            if (!WriteWholeFile(manifestTmp, text.data(), text.size())) return false;
+            fs::rename(manifestTmp, revisionDir / "manifest.json", ec);
+            if (ec) return false;
+
+            Log(onLog, "[Prebuilt] Revision " + revision.substr(0, 12) + " published (" +
+                       std::to_string(binaries.size()) + " files).\n");
+            return true;
+        }
+
+        // Brings the project's binaries up to the given revision, transferring only changed blocks
+        static bool Fetch(const std::wstring& location, const std::string& revision,
+                          const fs::path& projectFile, LogCallback onLog, PrebuiltFetchStats* stats = nullptr) {
+            UEBUILDER_PROFILE_SCOPE("PrebuiltCache::Fetch");
+            Store store(location);
+            fs::path projectRoot = projectFile.parent_path();
+
+            std::string manifestText;
+            bool found = store.ReadAll(revision + "/manifest.json", manifestText);
+            Metrics::CacheLookup("prebuilt", found);
+            if (!found) {
+                Log(onLog, "[Prebuilt] No prebuilt binaries for revision " + revision.substr(0, 12) + "\n");
+                return false;
+            }
+
+            bool ok = false;
+            JsonValue manifest = JsonValue::Parse(manifestText, &ok);
+            if (!ok || !manifest["Files"].IsArray()) {
+                Log(onLog, "[Prebuilt] Manifest is corrupt.\n");
+                return false;
+            }
+
+            // Every file goes to a staging folder next to the Binaries folder it belongs in, and the
+            // staged folders replace the live ones only once all of them are complete: a failure
+            // part way leaves the old binaries as they were, and files the revision no longer has
+            // (debug symbols included, which are never published) go with the old folders
+            std::vector<StagedFile> files;
+            std::vector<fs::path> roots;
+            for (const auto& entry : manifest["Files"].Items()) {
+                StagedFile file;
+                file.Entry = &entry;
+                file.Rel = entry["Path"].AsString();
+                if (!SplitBinariesPath(StringUtils::PathFromUtf8(file.Rel), file.Root, file.InRoot)) {
+                    Log(onLog, "[Prebuilt] Skipping invalid manifest entry: " + file.Rel + "\n");
+                    return false;
+                }
+                if (std::find(roots.begin(), roots.end(), file.Root) == roots.end()) roots.push_back(file.Root);
+                files.push_back(std::move(file));
+            }
+            for (const auto& local : CollectBinaryRoots(projectRoot)) {
+                fs::path root = local.lexically_relative(projectRoot);
+                if (std::find(roots.begin(), roots.end(), root) == roots.end()) roots.push_back(root);
+            }
+
+            std::error_code ec;
+            for (const auto& root : roots) {
+                RecoverSwap(projectRoot / root);
+                fs::create_directories(StagingPath(projectRoot / root), ec);
+            }
+
+            PrebuiltFetchStats localStats;
+            bool fetched = true;
+            for (const auto& file : files) {
+                localStats.FilesTotal++;
+                fs::path dest = StagingPath(projectRoot / file.Root) / file.InRoot;
+                if (!FetchFile(store, revision, *file.Entry, file.Rel, projectRoot / file.Root / file.InRoot, dest, onLog, localStats)) {
+                    fetched = false;
+                    break;
+                }
+            }
+            if (stats) *stats = localStats;
+
+            if (!fetched || !SwapIn(projectRoot, roots, onLog)) {
+                for (const auto& root : roots) fs::remove_all(StagingPath(projectRoot / root), ec);
+                return false;
+            }
+
+            Log(onLog, "[Prebuilt] " + std::to_string(localStats.FilesTotal) + " files, " +
+                       std::to_string(localStats.FilesUnchanged) + " already current, " +
+                       std::to_string(localStats.BytesTransferred / 1024) + " KiB transferred, " +
+                       std::to_string(localStats.BytesReused / 1024) + " KiB reused locally.\n");
+            return true;
+        }
+
+    private:
+        // Folder or http:// location, addressed with relative '/' paths
+        class Store {
+        public:
+            explicit Store(const std::wstring& location) {
+                std::string utf8 = StringUtils::ToUtf8(location);
+                isHttp = HttpClient::IsHttpUrl(utf8);
+                if (isHttp) {
+                    baseUrl = utf8;
+                    if (!baseUrl.empty() && baseUrl.back() == '/') baseUrl.pop_back();
+                }
+                else {
+                    baseDir = fs::path(location);
+                }
+            }
+
+            bool Exists(const std::string& rel) const {
+                if (!isHttp) return fs::exists(baseDir / StringUtils::PathFromUtf8(rel));
+
+                HttpResponse response;
+                return HttpClient::Head(Url(rel), response) && response.Status == 200;
+            }
+
+            bool ReadAll(const std::string& rel, std::string& out) const {
+                if (!isHttp) {
+                    std::ifstream file(baseDir / StringUtils::PathFromUtf8(rel), std::ios::binary);
+                    if (!file.is_open()) return false;
+                    out.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+                    return true;
+                }
+
+                HttpResponse response;
+                if (!HttpClient::Get(Url(rel), response) || response.Status != 200) return false;
+                out = std::move(response.Body);
+                return true;
+            }
+
+            // A server without Range support answers with the whole file: then out holds all of it,
+            // wholeFile is set, and later fetches skip straight to ReadAll (IgnoresRanges)
+            bool ReadRange(const std::string& rel, uint64_t offset, uint64_t length, std::string& out, bool& wholeFile) const {
+                wholeFile = false;
+                if (!isHttp) {
+                    std::ifstream file(baseDir / StringUtils::PathFromUtf8(rel), std::ios::binary);
+                    if (!file.is_open()) return false;
+                    file.seekg(static_cast<std::streamoff>(offset));
+                    out.resize(static_cast<size_t>(length));
+                    file.read(&out[0], static_cast<std::streamsize>(length));
+                    return static_cast<uint64_t>(file.gcount()) == length;
+                }
+
+                HttpResponse response;
+                if (!HttpClient::GetRange(Url(rel), offset, length, response)) return false;
+
+                if (response.Status == 206 && response.Body.size() == length) {
+                    out = std::move(response.Body);
+                    return true;
+                }
+                if (response.Status == 200 && response.Body.size() >= offset + length) {
+                    rangesIgnored = true;
+                    wholeFile = true;
+                    out = std::move(response.Body);
+                    return true;
+                }
+                return false;
+            }
+
+            bool IgnoresRanges() const { return rangesIgnored; }
+
+        private:
+            bool isHttp = false;
+            mutable bool rangesIgnored = false;
+            std::string baseUrl;
+            fs::path baseDir;
+
+            std::string Url(const std::string& rel) const {
+                return baseUrl + "/" + HttpClient::EncodePath(rel);
+            }
+        };
+
+        static constexpr size_t MaxRangeBytes = 8u << 20; // Coalesce missing blocks up to this size per request
+
+        static void Log(const LogCallback& onLog, const std::string& text) {
+            if (onLog) onLog(text);
+        }
+
+        // rsync's heuristic: ~sqrt(size), kept between 2 KiB and 64 KiB
+        static size_t ChooseBlockSize(uint64_t size) {
+            size_t bs = static_cast<size_t>(std::sqrt(static_cast<double>(size)));
+            bs = (bs + 1023) & ~static_cast<size_t>(1023);
+            return (std::min)((std::max)(bs, size_t(2048)), size_t(65536));
+        }
+
+        // Weak checksum (8 hex) + first 8 bytes of SHA-256 (16 hex) per block
+        static std::string BlockSignature(const uint8_t* data, size_t len) {
+            char weak[9];
+            std::snprintf(weak, sizeof(weak), "%08x", RollingChecksum::Compute(data, len));
+
+            Sha256 hasher;
+            hasher.Update(data, len);
+            std::vector<uint8_t> digest = hasher.Final();
+            return std::string(weak) + HashUtils::ToHex(digest.data(), 8);
+        }
+
+        static std::string StrongPart(const uint8_t* data, size_t len) {
+            Sha256 hasher;
+            hasher.Update(data, len);
+            std::vector<uint8_t> digest = hasher.Final();
+            return HashUtils::ToHex(digest.data(), 8);
+        }
+
+        static JsonValue DescribeFile(const std::string& rel, const std::vector<uint8_t>& data) {
+            size_t bs = ChooseBlockSize(data.size());
+
+            std::string blocks;
+            for (size_t offset = 0; offset < data.size(); offset += bs) {
+                size_t len = (std::min)(bs, data.size() - offset);
+                blocks += BlockSignature(data.data() + offset, len);
+            }
+
+            Sha256 whole;
+            whole.Update(data.data(), data.size());
+
+            JsonValue file = JsonValue::MakeObject();
+            file.Set("Path", rel);
+            file.Set("Size", static_cast<uint64_t>(data.size()));
+            file.Set("Sha256", whole.FinalHex());
+            file.Set("BlockSize", static_cast<uint64_t>(bs));
+            file.Set("Blocks", blocks);
+            return file;
+        }
+
+        // A manifest entry and where it goes: <Root>/<InRoot>, Root being a Binaries folder
+        struct StagedFile {
+            const JsonValue* Entry = nullptr;
+            std::string Rel;
+            fs::path Root;
+            fs::path InRoot;
+        };
+
+        static fs::path StagingPath(const fs::path& live) { fs::path p = live; p += L".uebstage"; return p; }
+        static fs::path RetiredPath(const fs::path& live) { fs::path p = live; p += L".uebold"; return p; }
+
+        // "Plugins/Foo/Binaries/Win64/x.dll" -> "Plugins/Foo/Binaries" + "Win64/x.dll". Anything that
+        // is absolute, climbs out with "..", or isn't under a Binaries folder is refused: a manifest
+        // never writes outside the project's binaries.
+        static bool SplitBinariesPath(const fs::path& rel, fs::path& root, fs::path& inRoot) {
+            if (rel.empty() || rel.has_root_path()) return false;
+            root.clear();
+            inRoot.clear();
+            bool found = false;
+            for (const auto& part : rel) {
+                if (part == L".." || part == L".") return false;
+                if (found) inRoot /= part;
+                else {
+                    root /= part;
+                    found = part == L"Binaries";
+                }
+            }
+            return found && !inRoot.empty();
+        }
+
+        // Undoes what an interrupted swap left behind: the old folder goes back if the new one
+        // never arrived, and leftover staging or retired folders are removed
+        static void RecoverSwap(const fs::path& live) {
+            std::error_code ec;
+            fs::path retired = RetiredPath(live);
+            if (!fs::exists(live, ec) && fs::exists(retired, ec)) fs::rename(retired, live, ec);
+            fs::remove_all(retired, ec);
+            fs::remove_all(StagingPath(live), ec);
+        }
+
+        // Retires every live folder and moves its staged one in; if any rename fails (a DLL in
+        // use), the ones already done are put back
+        static bool SwapIn(const fs::path& projectRoot, const std::vector<fs::path>& roots, const LogCallback& onLog) {
+            std::error_code ec;
+            std::vector<std::pair<fs::path, bool>> done; // Live folder, whether it had an old one
+            bool ok = true;
+            for (const auto& root : roots) {
+                fs::path live = projectRoot / root;
+                fs::path staged = StagingPath(live);
+                bool hadOld = fs::exists(live, ec);
+                if (hadOld) {
+                    fs::rename(live, RetiredPath(live), ec);
+                    if (ec) { ok = false; break; }
+                }
+                bool empty = fs::is_empty(staged, ec);
+                if (!empty) fs::rename(staged, live, ec);
+                if (!empty && ec) {
+                    if (hadOld) fs::rename(RetiredPath(live), live, ec);
+                    ok = false;
+                    break;
+                }
+                done.emplace_back(live, hadOld);
+            }
+
+            if (!ok) {
+                for (auto it = done.rbegin(); it != done.rend(); ++it) {
+                    if (fs::exists(it->first, ec)) fs::rename(it->first, StagingPath(it->first), ec);
+                    if (it->second) fs::rename(RetiredPath(it->first), it->first, ec);
+                }
+                Log(onLog, "[Prebuilt] Could not replace the binaries (is the editor running?)\n");
+                return false;
+            }
+            for (const auto& root : roots) {
+                fs::remove_all(RetiredPath(projectRoot / root), ec);
+                fs::remove_all(StagingPath(projectRoot / root), ec);
+            }
+            return true;
+        }
+
+        // Writes the revision's version of one file to dest, built from the blocks of the local
+        // basis file that still match plus the ranges that don't
+        static bool FetchFile(const Store& store, const std::string& revision, const JsonValue& entry, const std::string& rel,
+                              const fs::path& basisPath, const fs::path& dest, const LogCallback& onLog, PrebuiltFetchStats& stats) {
+            uint64_t size = static_cast<uint64_t>(entry["Size"].AsInt());
+            std::string expectedSha = entry["Sha256"].AsString();
+            size_t bs = static_cast<size_t>(entry["BlockSize"].AsInt());
+            std::string signatures = entry["Blocks"].AsString();
+            if (bs == 0) {
+                Log(onLog, "[Prebuilt] Skipping invalid manifest entry: " + rel + "\n");
+                return false;
+            }
+
+            std::vector<uint8_t> old;
+            std::error_code ec;
+            fs::create_directories(dest.parent_path(), ec);
+            if (fs::exists(basisPath, ec)) ReadWholeFile(basisPath, old);
+
+            if (old.size() == size) {
+                Sha256 current;
+                current.Update(old.data(), old.size());
+                if (current.FinalHex() == expectedSha) {
+                    // Linked where possible: the live folder is retired after the swap anyway
+                    fs::create_hard_link(basisPath, dest, ec);
+                    if (ec && !WriteWholeFile(dest, old.data(), old.size())) {
+                        Log(onLog, "[Prebuilt] Could not write " + StringUtils::PathToUtf8(dest) + "\n");
+                        return false;
+                    }
+                    stats.FilesUnchanged++;
+                    return true;
+                }
+            }
+
+            size_t blockCount = static_cast<size_t>((size + bs - 1) / bs);
+            if (signatures.size() != blockCount * 24) {
+                Log(onLog, "[Prebuilt] Manifest block list doesn't match file size for " + rel + "\n");
+                return false;
+            }
+
+            // --- STEP 1: find blocks we already have, at any offset in the old file ---
+            std::vector<int64_t> localOffset(blockCount, -1);
+            MatchLocalBlocks(old, signatures, bs, size, localOffset);
+
+            std::string remoteRel = revision + "/files/" + rel;
+            bool anyMissing = std::find(localOffset.begin(), localOffset.end(), -1) != localOffset.end();
+            if (anyMissing && store.IgnoresRanges()) {
+                // Each range would cost the whole file again; take it once
+                std::string whole;
+                if (!store.ReadAll(remoteRel, whole)) {
+                    Log(onLog, "[Prebuilt] Transfer failed for " + rel + "\n");
+                    return false;
+                }
+                return StoreWholeFile(whole, rel, dest, expectedSha, onLog, stats);
+            }
+
+            // --- STEP 2: assemble the new file from local blocks + fetched ranges ---
+            std::ofstream out(dest, std::ios::binary | std::ios::trunc);
+            if (!out.is_open()) {
+                Log(onLog, "[Prebuilt] Could not write " + StringUtils::PathToUtf8(dest) + "\n");
+                return false;
+            }
+
+            Sha256 verify;
+            uint64_t reused = 0;
+            uint64_t transferred = 0;
+            size_t i = 0;
+            while (i < blockCount) {
+                uint64_t offset = static_cast<uint64_t>(i) * bs;
+                size_t len = static_cast<size_t>((std::min)(static_cast<uint64_t>(bs), size - offset));
+
+                if (localOffset[i] >= 0) {
+                    const uint8_t* src = old.data() + localOffset[i];
+                    out.write(reinterpret_cast<const char*>(src), static_cast<std::streamsize>(len));
+                    verify.Update(src, len);
+                    reused += len;
+                    ++i;
+                    continue;
+                }
+
+                // Coalesce a run of missing blocks into one range request
+                size_t j = i;
+                uint64_t runBytes = 0;
+                while (j < blockCount && localOffset[j] < 0 && runBytes < MaxRangeBytes) {
+                    runBytes += (std::min)(static_cast<uint64_t>(bs), size - static_cast<uint64_t>(j) * bs);
+                    ++j;
+                }
+
+                std::string data;
+                bool wholeFile = false;
+                if (!store.ReadRange(remoteRel, offset, runBytes, data, wholeFile)) {
+                    out.close();
+                    fs::remove(dest, ec);
+                    Log(onLog, "[Prebuilt] Transfer failed for " + rel + "\n");
+                    return false;
+                }
+                if (wholeFile) {
+                    // The server ignored the range; what was assembled so far is moot
+                    out.close();
+                    return StoreWholeFile(data, rel, dest, expectedSha, onLog, stats);
+                }
+                out.write(data.data(), static_cast<std::streamsize>(data.size()));
+                verify.Update(data.data(), data.size());
+                transferred += data.size();
+                i = j;
+            }
+            out.close();
+            if (!out) {
+                fs::remove(dest, ec);
+                Log(onLog, "[Prebuilt] Could not write " + StringUtils::PathToUtf8(dest) + "\n");
+                return false;
+            }
+
+            if (verify.FinalHex() != expectedSha) {
+                fs::remove(dest, ec);
+                Log(onLog, "[Prebuilt] Checksum mismatch for " + rel + "\n");
+                return false;
+            }
+
+            stats.BytesReused += reused;
+            stats.BytesTransferred += transferred;
+            Log(onLog, "[Prebuilt] Updated " + rel + "\n");
+            return true;
+        }
+
+        // The whole new file, downloaded in one piece; counted in full as transferred
+        static bool StoreWholeFile(const std::string& data, const std::string& rel, const fs::path& dest,
+                                   const std::string& expectedSha, const LogCallback& onLog, PrebuiltFetchStats& stats) {
+            stats.BytesTransferred += data.size();
+            Sha256 verify;
+            verify.Update(data);
+            if (verify.FinalHex() != expectedSha) {
+                std::error_code ec;
+                fs::remove(dest, ec);
+                Log(onLog, "[Prebuilt] Checksum mismatch for " + rel + "\n");
+                return false;
+            }
+            if (!WriteWholeFile(dest, data.data(), data.size())) {
+                Log(onLog, "[Prebuilt] Could not write " + StringUtils::PathToUtf8(dest) + "\n");
+                return false;
+            }
+            Log(onLog, "[Prebuilt] Downloaded " + rel + " whole (the server ignores ranges)\n");
+            return true;
+        }
+
+        // Slides a rolling checksum across the old file and records where each wanted block lives
+        static void MatchLocalBlocks(const std::vector<uint8_t>& old, const std::string& signatures,
+                                     size_t bs, uint64_t size, std::vector<int64_t>& localOffset) {
+            size_t blockCount = localOffset.size();
+            if (old.empty() || blockCount == 0) return;
+
+            // Full-size blocks are found by rolling; the short tail block is checked separately
+            size_t fullBlocks = (size % bs == 0) ? blockCount : blockCount - 1;
+
+            std::unordered_map<uint32_t, std::vector<size_t>> byWeak;
+            for (size_t b = 0; b < fullBlocks; ++b) {
+                uint32_t weak = static_cast<uint32_t>(std::strtoul(signatures.substr(b * 24, 8).c_str(), nullptr, 16));
+                byWeak[weak].push_back(b);
+            }
+
+            size_t remaining = fullBlocks;
+            if (old.size() >= bs && remaining > 0) {
+                RollingChecksum rolling;
+                rolling.Init(old.data(), bs);
+                size_t pos = 0;
+
+                while (true) {
+                    bool matched = false;
+                    auto it = byWeak.find(rolling.Value());
+                    if (it != byWeak.end()) {
+                        std::string strong = StrongPart(old.data() + pos, bs);
+                        for (size_t b : it->second) {
+                            if (localOffset[b] < 0 && signatures.compare(b * 24 + 8, 16, strong) == 0) {
+                                localOffset[b] = static_cast<int64_t>(pos);
+                                matched = true;
+                                --remaining;
+                            }
+                        }
+                    }
+
+                    if (remaining == 0) break;
+
+                    if (matched) {
+                        pos += bs;
+                        if (pos + bs > old.size()) break;
+                        rolling.Init(old.data() + pos, bs);
+                    }
+                    else {
+                        if (pos + bs >= old.size()) break;
+                        rolling.Roll(old[pos], old[pos + bs]);
+                        ++pos;
+                    }
+                }
+            }
+
+            // Tail block: binaries usually keep their trailer, so just compare against the old tail
+            if (fullBlocks < blockCount) {
+                size_t tailLen = static_cast<size_t>(size - static_cast<uint64_t>(fullBlocks) * bs);
+                if (old.size() >= tailLen) {
+                    const uint8_t* tail = old.data() + old.size() - tailLen;
+                    if (BlockSignature(tail, tailLen) == signatures.substr(fullBlocks * 24, 24)) {
+                        localOffset[fullBlocks] = static_cast<int64_t>(old.size() - tailLen);
+                    }
+                }
+            }
+        }
+
+        static void CollectFiles(const fs::path& dir, std::vector<fs::path>& out, const wchar_t* skipExtension) {
+            std::error_code ec;
+            if (!fs::is_directory(dir, ec)) return;
+
+            for (auto it = fs::recursive_directory_iterator(dir, fs::directory_options::skip_permission_denied, ec);
+                 it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                if (!it->is_regular_file(ec)) continue;
+                if (skipExtension && it->path().extension() == skipExtension) continue;
+                out.push_back(it->path());
+            }
+        }
+
+        // Plugins/**/*.uplugin and Plugins/**/Source/**
+        static void CollectPluginInputs(const fs::path& pluginsDir, std::vector<fs::path>& out) {
+            std::error_code ec;
+            if (!fs::is_directory(pluginsDir, ec)) return;
+
+            for (auto it = fs::recursive_directory_iterator(pluginsDir, fs::directory_options::skip_permission_denied, ec);
+                 it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                if (ec) break;
+                std::wstring name = it->path().filename().wstring();
+
+                if (it->is_directory(ec)) {
+                    if (name == L"Source") {
+                        CollectFiles(it->path(), out, nullptr);
+                        it.disable_recursion_pending();
+                    }
+                    else if (name == L"Binaries" || name == L"Intermediate" || name == L"Content") {
+                        it.disable_recursion_pending();
+                    }
+                }
+                else if (it->path().extension() == L".uplugin") {
+                    out.push_back(it->path());
+                }
+            }
+        }
+
+        // Binaries/ and Plugins/**/Binaries/ that exist
+        static std::vector<fs::path> CollectBinaryRoots(const fs::path& projectRoot) {
+            std::vector<fs::path> roots;
+            std::error_code ec;
+            if (fs::is_directory(projectRoot / "Binaries", ec)) roots.push_back(projectRoot / "Binaries");
+
+            fs::path pluginsDir = projectRoot / "Plugins";
+            if (fs::is_directory(pluginsDir, ec)) {
+                for (auto it = fs::recursive_directory_iterator(pluginsDir, fs::directory_options::skip_permission_denied, ec);
+                     it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                    if (ec) break;
+                    if (!it->is_directory(ec)) continue;
+
+                    std::wstring name = it->path().filename().wstring();
+                    if (name == L"Binaries") {
+                        roots.push_back(it->path());
+                        it.disable_recursion_pending();
+                    }
+                    else if (name == L"Source" || name == L"Intermediate" || name == L"Content") {
+                        it.disable_recursion_pending();
+                    }
+                }
+            }
+            return roots;
+        }
+
+        // Binaries/** and Plugins/**/Binaries/**. Debug symbols are left out: they dwarf the
+        // DLLs themselves and non-programmers don't need them to open the editor.
+        static std::vector<fs::path> CollectBinaries(const fs::path& projectRoot) {
+            std::vector<fs::path> out;
+            for (const auto& root : CollectBinaryRoots(projectRoot)) CollectFiles(root, out, L".pdb");
+            std::sort(out.begin(), out.end());
+            return out;
+        }
+
+        static bool ReadWholeFile(const fs::path& path, std::vector<uint8_t>& out) {
+            std::ifstream file(path, std::ios::binary | std::ios::ate);
+            if (!file.is_open()) return false;
+
+            std::streamoff size = file.tellg();
+            file.seekg(0);
+            out.resize(static_cast<size_t>(size));
+            if (size > 0) file.read(reinterpret_cast<char*>(out.data()), size);
+            return static_cast<bool>(file);
+        }
+
+        static bool WriteWholeFile(const fs::path& path, const void* data, size_t len) {
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file.write(static_cast<const char*>(data), static_cast<std::streamsize>(len));
+            return static_cast<bool>(file);
+        }
+    };
+}
@@ -0,0 +1,276 @@
+#pragma once
+#include "ProcessUtils.h"
+#ifdef _WIN32
+#include <tlhelp32.h>
+#include <psapi.h>
+#pragma comment(lib, "Psapi.lib")
+#else
+#include <dirent.h>
+#include <signal.h>
+#include <fstream>
+#include <sstream>
+#endif
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+
+namespace UEBuilder {
+
+    struct ProcessInfo {
+        ProcessId Pid = 0;
+        ProcessId ParentPid = 0;
+        std::string Name;       // Executable name, lower-case, without path
+        uint64_t StartTime = 0; // Only comparable between processes of the same snapshot source
+    };
+
+    // Cumulative counters of one process since it started
+    struct ProcessUsage {
+        double CpuSeconds = 0.0;   // User + kernel
+        uint64_t RssBytes = 0;     // Current working set / resident size
+        uint64_t ReadBytes = 0;
+        uint64_t WriteBytes = 0;
+    };
+
+    // Point-in-time list of running processes, used to find the compilers UBT spawned
+    class ProcessTree {
+    public:
+        static std::vector<ProcessInfo> Snapshot() {
+            std::vector<ProcessInfo> processes;
+#ifdef _WIN32
+            HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+            if (snapshot == INVALID_HANDLE_VALUE) return processes;
+
+            PROCESSENTRY32W entry;
+            entry.dwSize = sizeof(entry);
+            for (BOOL more = Process32FirstW(snapshot, &entry); more; more = Process32NextW(snapshot, &entry)) {
+                ProcessInfo info;
+                info.Pid = entry.th32ProcessID;
+                info.ParentPid = entry.th32ParentProcessID;
+                info.Name = ToLower(StringUtils::ToUtf8(entry.szExeFile));
+                processes.push_back(info);
+            }
+            CloseHandle(snapshot);
+#else
+            DIR* proc = opendir("/proc");
+            if (!proc) return processes;
+
+            while (dirent* entry = readdir(proc)) {
+                if (!std::isdigit(static_cast<unsigned char>(entry->d_name[0]))) continue;
+
+                ProcessInfo info;
+                if (ReadProcStat(entry->d_name, info)) processes.push_back(info);
+            }
+            closedir(proc);
+#endif
+            return processes;
+        }
+
+        // All processes below root (children, grandchildren, ...), root excluded
+        static std::vector<ProcessInfo> Descendants(ProcessId root) {
+            std::vector<ProcessInfo> all = Snapshot();
+
+            std::unordered_multimap<ProcessId, size_t> children;
+            for (size_t i = 0; i < all.size(); ++i) {
+                // Windows reuses pids; a parent id can point to an unrelated newer process
+                if (all[i].Pid != all[i].ParentPid) children.emplace(all[i].ParentPid, i);
+            }
+
+            std::vector<ProcessInfo> result;
+            std::vector<ProcessId> pending = { root };
+            while (!pending.empty()) {
+                ProcessId pid = pending.back();
+                pending.pop_back();
+
+                auto range = children.equal_range(pid);
+                for (auto it = range.first; it != range.second; ++it) {
+                    result.push_back(all[it->second]);
+                    pending.push_back(all[it->second].Pid);
+                }
+            }
+
+#ifdef _WIN32
+            // Toolhelp has no start time; only fetch it for the processes we return
+            for (auto& info : result) info.StartTime = QueryStartTime(info.Pid);
+#endif
+            return result;
+        }
+
+        // Freezes a process without terminating it; its memory stays committed but stops growing
+        static bool Suspend(ProcessId pid) {
+#ifdef _WIN32
+            return CallNtProcessFunction("NtSuspendProcess", pid);
+#else
+            return kill(static_cast<pid_t>(pid), SIGSTOP) == 0;
+#endif
+        }
+
+        static bool Resume(ProcessId pid) {
+#ifdef _WIN32
+            return CallNtProcessFunction("NtResumeProcess", pid);
+#else
+            return kill(static_cast<pid_t>(pid), SIGCONT) == 0;
+#endif
+        }
+
+        static bool Terminate(ProcessId pid) {
+#ifdef _WIN32
+            HANDLE process = OpenProcess(PROCESS_TERMINATE, FALSE, pid);
+            if (!process) return false;
+            bool ok = TerminateProcess(process, 1) != 0;
+            CloseHandle(process);
+            return ok;
+#else
+            return kill(static_cast<pid_t>(pid), SIGKILL) == 0;
+#endif
+        }
+
+        // Ends root and everything below it. Children are listed before root goes, since they
+        // are re-parented after that; root goes first so it can't start new ones meanwhile.
+        static void TerminateTree(ProcessId root) {
+            std::vector<ProcessInfo> children = Descendants(root);
+            Terminate(root);
+            for (const auto& child : children) Terminate(child.Pid);
+        }
+
+        // False when the process is gone or not ours to inspect
+        static bool QueryUsage(ProcessId pid, ProcessUsage& usage) {
+            usage = ProcessUsage();
+#ifdef _WIN32
+            HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+            if (!process) return false;
+
+            FILETIME created, exited, kernel, user;
+            bool ok = GetProcessTimes(process, &created, &exited, &kernel, &user) != 0;
+            if (ok) {
+                auto ticks = [](const FILETIME& t) { return (static_cast<uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime; };
+                usage.CpuSeconds = (ticks(kernel) + ticks(user)) / 1e7; // 100 ns units
+            }
+
+            PROCESS_MEMORY_COUNTERS memory;
+            if (GetProcessMemoryInfo(process, &memory, sizeof(memory))) usage.RssBytes = memory.WorkingSetSize;
+
+            IO_COUNTERS io;
+            if (GetProcessIoCounters(process, &io)) {
+                usage.ReadBytes = io.ReadTransferCount;
+                usage.WriteBytes = io.WriteTransferCount;
+            }
+            CloseHandle(process);
+            return ok;
+#else
+            std::string dir = "/proc/" + std::to_string(pid);
+            std::ifstream stat(dir + "/stat");
+            std::string line;
+            if (!std::getline(stat, line)) return false;
+
+            size_t close = line.rfind(')');
+            if (close == std::string::npos) return false;
+
+            // Fields after comm start at 3 (state); utime=14, stime=15, rss=24 (pages)
+            std::istringstream fields(line.substr(close + 2));
+            std::string field;
+            static const double ticksPerSecond = static_cast<double>(sysconf(_SC_CLK_TCK));
+            static const uint64_t pageSize = static_cast<uint64_t>(sysconf(_SC_PAGESIZE));
+            for (int index = 3; fields >> field; ++index) {
+                if (index == 14 || index == 15) usage.CpuSeconds += std::strtoull(field.c_str(), nullptr, 10) / ticksPerSecond;
+                else if (index == 24) {
+                    usage.RssBytes = std::strtoull(field.c_str(), nullptr, 10) * pageSize;
+                    break;
+                }
+            }
+
+            // Storage-level I/O; unreadable for other users' processes, which is fine
+            std::ifstream io(dir + "/io");
+            std::string key;
+            uint64_t value = 0;
+            while (io >> key >> value) {
+                if (key == "read_bytes:") usage.ReadBytes = value;
+                else if (key == "write_bytes:") usage.WriteBytes = value;
+            }
+            return true;
+#endif
+        }
+
+        static bool IsRunning(ProcessId pid) {
+#ifdef _WIN32
+            HANDLE process = OpenProcess(SYNCHRONIZE, FALSE, pid);
+            if (!process) return false;
+            bool running = WaitForSingleObject(process, 0) == WAIT_TIMEOUT;
+            CloseHandle(process);
+            return running;
+#else
+            // A zombie still accepts signals; check its state instead
+            ProcessInfo info;
+            std::string state;
+            return ReadProcStat(std::to_string(pid), info, &state) && state != "Z";
+#endif
+        }
+
+    private:
+        static std::string ToLower(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+            return s;
+        }
+
+#ifdef _WIN32
+        static uint64_t QueryStartTime(ProcessId pid) {
+            HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, pid);
+            if (!process) return 0;
+
+            FILETIME created, exited, kernel, user;
+            uint64_t start = 0;
+            if (GetProcessTimes(process, &created, &exited, &kernel, &user)) {
+                start = (static_cast<uint64_t>(created.dwHighDateTime) << 32) | created.dwLowDateTime;
+            }
+            CloseHandle(process);
+            return start;
+        }
+
+        // NtSuspendProcess/NtResumeProcess are undocumented but stable since XP and the only
+        // way to freeze every thread of a process at once
+        static bool CallNtProcessFunction(const char* name, ProcessId pid) {
+            using NtProcessFn = LONG(NTAPI*)(HANDLE);
+            static HMODULE ntdll = GetModuleHandleW(L"ntdll.dll");
+            if (!ntdll) return false;
+            auto fn = reinterpret_cast<NtProcessFn>(GetProcAddress(ntdll, name));
+            if (!fn) return false;
+
+            HANDLE process = OpenProcess(PROCESS_SUSPEND_RESUME, FALSE, pid);
+            if (!process) return false;
+            bool ok = fn(process) >= 0; // NT_SUCCESS
+            CloseHandle(process);
+            return ok;
+        }
+#else
+        // /proc/<pid>/stat: "pid (comm) state ppid ... starttime(22) ..."; comm may contain spaces
+        static bool ReadProcStat(const std::string& pid, ProcessInfo& info, std::string* state = nullptr) {
+            std::ifstream file("/proc/" + pid + "/stat");
+            std::string line;
+            if (!std::getline(file, line)) return false;
+
+            size_t open = line.find('(');
+            size_t close = line.rfind(')');
+            if (open == std::string::npos || close == std::string::npos || close < open) return false;
+
+            info.Pid = static_cast<ProcessId>(std::strtoul(pid.c_str(), nullptr, 10));
+            info.Name = ToLower(line.substr(open + 1, close - open - 1));
+
+            std::istringstream fields(line.substr(close + 2));
+            std::string field;
+            for (int index = 3; fields >> field; ++index) {
+                if (index == 3 && state) *state = field;
+                else if (index == 4) info.ParentPid = static_cast<ProcessId>(std::strtoul(field.c_str(), nullptr, 10));
+                else if (index == 22) {
+                    info.StartTime = std::strtoull(field.c_str(), nullptr, 10);
+                    break;
+                }
+            }
+            return true;
+        }
+#endif
+    };
+}
@@ -1,29 +1,170 @@
 #pragma once
+#ifdef _WIN32
+#include <winsock2.h> // Must precede windows.h (HttpClient/Sockets use Winsock 2)
 #include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <cstring>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <fcntl.h>
+#endif
+
+#include "StringUtils.h"
+#include "OutputQueue.h"
 #include <string>
 #include <iostream>
 #include <functional>
 #include <vector>
+#include <chrono>
+#include <cstdint>
+#include <utility>
+#include <algorithm>
+#include <mutex>
+
+#ifndef _WIN32
+extern char** environ; // Not declared by every libc's unistd.h
+#endif
 
+#ifdef _WIN32
 // Link against these libraries
-#pragma comment(lib, "urlmon.lib") 
 #pragma comment(lib, "Advapi32.lib") // For Registry
+#endif
 
 namespace UEBuilder {
 
     // Callback function type for real-time log handling
     using LogCallback = std::function<void(const std::string&)>;
 
-    class ProcessUtils {
+    using ProcessId = uint32_t;
+
+    // Resource usage of a finished process and every child it spawned
+    struct ProcessStats {
+        double WallSeconds = 0.0;
+        double CpuSeconds = 0.0;        // User + kernel time across the whole tree
+        uint64_t PeakMemoryBytes = 0;   // Windows: whole tree at once. POSIX: largest single process
+        int ExitCode = -1;
+    };
+
+    // A child's complete environment, kept sorted by name: CreateProcess requires that of a
+    // Unicode block, and elsewhere it makes the block identical from run to run.
+    // Names compare case-insensitively on Windows, like the system does.
+    class EnvironmentBlock {
     public:
-        // Downloads a file from the internet to a local path
-        static bool DownloadFile(const std::wstring& url, const std::wstring& destPath) {
-            HRESULT hr = URLDownloadToFileW(NULL, url.c_str(), destPath.c_str(), 0, NULL);
-            return hr == S_OK;
+        using Variable = std::pair<std::wstring, std::wstring>;
+
+        // This process's environment
+        static EnvironmentBlock Current() {
+            EnvironmentBlock block;
+#ifdef _WIN32
+            wchar_t* strings = GetEnvironmentStringsW();
+            if (!strings) return block;
+            for (const wchar_t* entry = strings; *entry; entry += wcslen(entry) + 1) {
+                // "=C:=C:\dir" entries are cmd's per-drive directories, not variables
+                const wchar_t* equals = wcschr(entry + 1, L'=');
+                if (entry[0] == L'=' || !equals) continue;
+                block.vars.emplace_back(std::wstring(entry, equals), std::wstring(equals + 1));
+            }
+            FreeEnvironmentStringsW(strings);
+#else
+            for (char** entry = environ; *entry; ++entry) {
+                const char* equals = std::strchr(*entry, '=');
+                if (!equals || equals == *entry) continue;
+                block.vars.emplace_back(StringUtils::FromUtf8(std::string(const_cast<const char*>(*entry), equals)), StringUtils::FromUtf8(equals + 1));
+            }
+#endif
+            std::stable_sort(block.vars.begin(), block.vars.end(), Less);
+            return block;
+        }
+
+        bool Empty() const { return vars.empty(); }
+        const std::vector<Variable>& Variables() const { return vars; }
+
+        // Empty when not set
+        std::wstring Get(const std::wstring& name) const {
+            auto it = Find(name);
+            return it != vars.end() && SameName(it->first, name) ? it->second : L"";
+        }
+
+        void Set(const std::wstring& name, const std::wstring& value) {
+            auto it = Find(name);
+            if (it != vars.end() && SameName(it->first, name)) it->second = value;
+            else vars.insert(it, { name, value });
         }
 
+        void Remove(const std::wstring& name) {
+            auto it = Find(name);
+            if (it != vars.end() && SameName(it->first, name)) vars.erase(it);
+        }
+
+#ifdef _WIN32
+        // name=value\0 ... \0\0, for CREATE_UNICODE_ENVIRONMENT
+        std::wstring ToNative() const {
+            std::wstring block;
+            for (const auto& v : vars) {
+                block += v.first;
+                block += L'=';
+                block += v.second;
+                block += L'\0';
+            }
+            block += L'\0';
+            return block;
+        }
+#else
+        // name=value strings, for execle
+        std::vector<std::string> ToNative() const {
+            std::vector<std::string> strings;
+            strings.reserve(vars.size());
+            for (const auto& v : vars) strings.push_back(StringUtils::ToUtf8(v.first + L"=" + v.second));
+            return strings;
+        }
+#endif
+
+    private:
+        std::vector<Variable> vars;
+
+        static int CompareNames(const std::wstring& a, const std::wstring& b) {
+#ifdef _WIN32
+            return CompareStringOrdinal(a.c_str(), static_cast<int>(a.size()), b.c_str(), static_cast<int>(b.size()), TRUE) - CSTR_EQUAL;
+#else
+            return a.compare(b);
+#endif
+        }
+        static bool SameName(const std::wstring& a, const std::wstring& b) { return CompareNames(a, b) == 0; }
+        static bool Less(const Variable& a, const Variable& b) { return CompareNames(a.first, b.first) < 0; }
+
+        std::vector<Variable>::iterator Find(const std::wstring& name) {
+            return std::lower_bound(vars.begin(), vars.end(), name, [](const Variable& v, const std::wstring& n) { return CompareNames(v.first, n) < 0; });
+        }
+        std::vector<Variable>::const_iterator Find(const std::wstring& name) const {
+            return std::lower_bound(vars.begin(), vars.end(), name, [](const Variable& v, const std::wstring& n) { return CompareNames(v.first, n) < 0; });
+        }
+    };
+
+    // Optional extras for RunProcess; the defaults behave like the plain overload
+    struct RunOptions {
+        ProcessStats* Stats = nullptr;  // Filled in when the process exits
+        std::function<void(ProcessId)> OnStarted; // Called on the launching thread once the child runs
+        std::function<void(ProcessId)> OnExited;  // Called once it has exited but before it is reaped, so its id is not reused yet
+        const EnvironmentBlock* Environment = nullptr; // The child's whole environment; null inherits ours
+        std::function<void(const char*, size_t)> OnRawChunk; // Each pipe read as it arrives, on the reader thread, before any buffering or dropping
+        OutputQueueOptions Output;      // Buffering between the pipe reader and onLog
+        OutputQueueStats* OutputStats = nullptr; // Filled in when the process exits
+    };
+
+    class ProcessUtils {
+    public:
         // Runs a command and streams output to a callback function
         static bool RunProcess(const std::wstring& command, const std::wstring& args, const std::wstring& workDir, LogCallback onLog) {
+            return RunProcess(command, args, workDir, onLog, RunOptions());
+        }
+
+        static bool RunProcess(const std::wstring& command, const std::wstring& args, const std::wstring& workDir, LogCallback onLog,
+                               const RunOptions& options) {
+#ifdef _WIN32
             HANDLE hReadPipe, hWritePipe;
             SECURITY_ATTRIBUTES saAttr;
 
@@ -32,6 +173,10 @@ namespace UEBuilder {
             saAttr.bInheritHandle = TRUE;
             saAttr.lpSecurityDescriptor = NULL;
 
+            // The write end must be inheritable; until it is closed below, no other child may be
+            // started, or it would inherit it too and the reader would wait for that one as well
+            std::unique_lock<std::mutex> spawnLock(SpawnMutex());
+
             // Create a pipe for the child process's STDOUT
             if (!CreatePipe(&hReadPipe, &hWritePipe, &saAttr, 0)) return false;
 
@@ -51,6 +196,20 @@ namespace UEBuilder {
             std::wstring fullCmd = L"\"" + command + L"\" " + args;
             std::wstring currentDir = workDir.empty() ? L"" : workDir;
 
+            // A job object accounts for the compilers UBT spawns, not just UBT itself.
+            // Start suspended so nothing runs outside the job.
+            HANDLE hJob = options.Stats ? CreateJobObjectW(NULL, NULL) : NULL;
+            DWORD creationFlags = CREATE_NO_WINDOW; // Don't show a pop-up console
+            if (hJob) creationFlags |= CREATE_SUSPENDED;
+
+            std::wstring environment;
+            if (options.Environment) {
+                environment = options.Environment->ToNative();
+                creationFlags |= CREATE_UNICODE_ENVIRONMENT;
+            }
+
+            auto startTime = std::chrono::steady_clock::now();
+
             // Create the Child Process
             BOOL success = CreateProcessW(
                 NULL,
@@ -58,8 +217,8 @@ namespace UEBuilder {
                 NULL,            // Process handle not inheritable
                 NULL,            // Thread handle not inheritable
                 TRUE,            // Set handle inheritance to TRUE
-                CREATE_NO_WINDOW,// Don't show a pop-up console
-                NULL,            // Use parent's environment block
+                creationFlags,
+                options.Environment ? &environment[0] : NULL, // NULL: parent's environment
                 currentDir.empty() ? NULL : currentDir.c_str(),
                 &si,
                 &pi
@@ -67,13 +226,27 @@ namespace UEBuilder {
 
             // We can close the write end of the pipe now; the child has it.
             CloseHandle(hWritePipe);
+            spawnLock.unlock();
 
             if (!success) {
                 CloseHandle(hReadPipe);
+                if (hJob) CloseHandle(hJob);
                 return false;
             }
 
-            // Read output from the child process
+            if (hJob) {
+                if (!AssignProcessToJobObject(hJob, pi.hProcess)) {
+                    // Stats then cover UBT alone
+                    CloseHandle(hJob);
+                    hJob = NULL;
+                }
+                ResumeThread(pi.hThread);
+            }
+
+            if (options.OnStarted) options.OnStarted(static_cast<ProcessId>(pi.dwProcessId));
+
+            // Read output from the child process; onLog runs on the queue's thread
+            OutputQueue output(onLog, options.Output);
             DWORD dwRead;
             CHAR chBuf[4096];
             bool bSuccess = FALSE;
@@ -82,23 +255,210 @@ namespace UEBuilder {
                 bSuccess = ReadFile(hReadPipe, chBuf, 4095, &dwRead, NULL);
                 if (!bSuccess || dwRead == 0) break;
 
-                chBuf[dwRead] = '\0'; // Null terminate
-                if (onLog) onLog(std::string(chBuf));
+                // By length: output isn't always text (cmd /u writes UTF-16)
+                if (options.OnRawChunk) options.OnRawChunk(chBuf, dwRead);
+                output.Push(chBuf, dwRead);
             }
+            output.Close();
+            if (options.OutputStats) *options.OutputStats = output.Stats();
 
-            // Wait for process to finish
+            // Wait for process to finish; the id stays ours until the handle is closed
             WaitForSingleObject(pi.hProcess, INFINITE);
+            if (options.OnExited) options.OnExited(static_cast<ProcessId>(pi.dwProcessId));
 
             DWORD exitCode = 0;
             GetExitCodeProcess(pi.hProcess, &exitCode);
 
+            if (options.Stats) {
+                ProcessStats& stats = *options.Stats;
+                stats = ProcessStats();
+                stats.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                stats.ExitCode = static_cast<int>(exitCode);
+                QueryResourceUsage(hJob, pi.hProcess, stats);
+            }
+
+            if (hJob) CloseHandle(hJob);
             CloseHandle(pi.hProcess);
             CloseHandle(pi.hThread);
             CloseHandle(hReadPipe);
 
             return exitCode == 0;
+#else
+            // Same contract on Linux/Mac, without a shell: args are split with the Windows rules
+            // callers already quote for, so $, backticks and backslashes in paths reach the child verbatim
+            std::string program = FindExecutable(StringUtils::ToUtf8(command), options.Environment);
+            std::vector<std::string> argStrings = SplitArgs(StringUtils::ToUtf8(args));
+            argStrings.insert(argStrings.begin(), program);
+            std::string currentDir = StringUtils::ToUtf8(workDir);
+            std::string execFailed = "Cannot run " + program + "\n";
+
+            // Built before fork: the child may only make async-signal-safe calls
+            std::vector<char*> argv;
+            for (auto& arg : argStrings) argv.push_back(&arg[0]);
+            argv.push_back(nullptr);
+            // A script without a #! line is run by sh, as execvp does - as a file, never as a command line
+            std::vector<char*> shArgv;
+            std::string sh = "sh";
+            shArgv.push_back(&sh[0]);
+            for (auto& arg : argStrings) shArgv.push_back(&arg[0]);
+            shArgv.push_back(nullptr);
+
+            std::vector<std::string> environment;
+            std::vector<char*> envp;
+            if (options.Environment) {
+                environment = options.Environment->ToNative();
+                for (auto& entry : environment) envp.push_back(&entry[0]);
+                envp.push_back(nullptr);
+            }
+            char** childEnv = options.Environment ? envp.data() : environ;
+
+            // Close-on-exec, or children started at the same time (parallel pipeline stages, GUI
+            // jobs) would inherit this pipe's write end and its reader would wait for them too
+            int pipeFds[2];
+#ifdef __APPLE__
+            // No pipe2: the flags are set under the lock every fork here takes
+            std::unique_lock<std::mutex> spawnLock(SpawnMutex());
+            if (pipe(pipeFds) != 0) return false;
+            fcntl(pipeFds[0], F_SETFD, FD_CLOEXEC);
+            fcntl(pipeFds[1], F_SETFD, FD_CLOEXEC);
+#else
+            if (pipe2(pipeFds, O_CLOEXEC) != 0) return false;
+#endif
+
+            auto startTime = std::chrono::steady_clock::now();
+
+            pid_t pid = fork();
+#ifdef __APPLE__
+            spawnLock.unlock();
+#endif
+            if (pid < 0) {
+                close(pipeFds[0]);
+                close(pipeFds[1]);
+                return false;
+            }
+
+            if (pid == 0) {
+                // Child: stdout and stderr both go to the pipe
+                dup2(pipeFds[1], STDOUT_FILENO);
+                dup2(pipeFds[1], STDERR_FILENO);
+                close(pipeFds[0]);
+                close(pipeFds[1]);
+                if (!currentDir.empty() && chdir(currentDir.c_str()) != 0) _exit(127);
+                execve(argv[0], argv.data(), childEnv);
+                if (errno == ENOEXEC) execve("/bin/sh", shArgv.data(), childEnv);
+                ssize_t ignored = write(STDERR_FILENO, execFailed.data(), execFailed.size());
+                (void)ignored;
+                _exit(127);
+            }
+
+            // We can close the write end of the pipe now; the child has it.
+            close(pipeFds[1]);
+
+            if (options.OnStarted) options.OnStarted(static_cast<ProcessId>(pid));
+
+            // Read output from the child process; onLog runs on the queue's thread
+            OutputQueue output(onLog, options.Output);
+            char chBuf[4096];
+            while (true) {
+                ssize_t bytesRead = read(pipeFds[0], chBuf, sizeof(chBuf));
+                if (bytesRead < 0 && errno == EINTR) continue;
+                if (bytesRead <= 0) break;
+                if (options.OnRawChunk) options.OnRawChunk(chBuf, static_cast<size_t>(bytesRead));
+                output.Push(chBuf, static_cast<size_t>(bytesRead));
+            }
+            close(pipeFds[0]);
+            output.Close();
+            if (options.OutputStats) *options.OutputStats = output.Stats();
+
+            // Wait for process to finish without reaping it (WNOWAIT), so the id can't be reused yet
+            siginfo_t exited {};
+            while (waitid(P_PID, static_cast<id_t>(pid), &exited, WEXITED | WNOWAIT) < 0 && errno == EINTR) {}
+            if (options.OnExited) options.OnExited(static_cast<ProcessId>(pid));
+
+            // Then reap it; wait4 also reports the usage of children it reaped
+            int status = 0;
+            struct rusage usage {};
+            while (wait4(pid, &status, 0, &usage) < 0 && errno == EINTR) {}
+
+            int exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + (WIFSIGNALED(status) ? WTERMSIG(status) : 0);
+
+            if (options.Stats) {
+                ProcessStats& stats = *options.Stats;
+                stats = ProcessStats();
+                stats.WallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+                stats.ExitCode = exitCode;
+                stats.CpuSeconds = usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1e6 +
+                                   usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1e6;
+#ifdef __APPLE__
+                stats.PeakMemoryBytes = static_cast<uint64_t>(usage.ru_maxrss);         // bytes
+#else
+                stats.PeakMemoryBytes = static_cast<uint64_t>(usage.ru_maxrss) * 1024;  // kilobytes
+#endif
+            }
+
+            return exitCode == 0;
+#endif
+        }
+
+        // Splits a command line the way the Windows C runtime does: whitespace separates, "..."
+        // groups, and backslashes only escape a quote. This is what RunProcess's child gets as
+        // argv on Linux/Mac, so callers quote arguments once for every platform.
+        static std::vector<std::string> SplitArgs(const std::string& commandLine) {
+            std::vector<std::string> result;
+            std::string current;
+            bool inArg = false;
+            bool quoted = false;
+            for (size_t i = 0; i < commandLine.size(); ++i) {
+                char c = commandLine[i];
+                if (c == '\\') {
+                    size_t slashes = 0;
+                    while (i < commandLine.size() && commandLine[i] == '\\') { ++slashes; ++i; }
+                    if (i < commandLine.size() && commandLine[i] == '"') {
+                        current.append(slashes / 2, '\\');
+                        if (slashes % 2) current += '"';  // \" is a literal quote
+                        else quoted = !quoted;
+                    }
+                    else {
+                        current.append(slashes, '\\');
+                        --i;
+                    }
+                    inArg = true;
+                }
+                else if (c == '"') {
+                    quoted = !quoted;
+                    inArg = true;
+                }
+                else if ((c == ' ' || c == '\t') && !quoted) {
+                    if (inArg) result.push_back(std::move(current));
+                    current.clear();
+                    inArg = false;
+                }
+                else {
+                    current += c;
+                    inArg = true;
+                }
+            }
+            if (inArg) result.push_back(std::move(current));
+            return result;
         }
 
+        // Returns an empty string when the variable is not set
+        static std::wstring GetEnvVar(const std::wstring& name) {
+#ifdef _WIN32
+            DWORD size = GetEnvironmentVariableW(name.c_str(), NULL, 0);
+            if (size == 0) return L"";
+
+            std::wstring value(size, L'\0');
+            DWORD written = GetEnvironmentVariableW(name.c_str(), &value[0], size);
+            value.resize(written);
+            return value;
+#else
+            const char* value = std::getenv(StringUtils::ToUtf8(name).c_str());
+            return value ? StringUtils::FromUtf8(value) : L"";
+#endif
+        }
+
+#ifdef _WIN32
         // Helper to check registry keys (used to find Unreal)
         static std::wstring ReadRegistryString(HKEY hKeyRoot, const std::wstring& subKey, const std::wstring& valueName) {
             HKEY hKey;
@@ -116,5 +476,59 @@ namespace UEBuilder {
             RegCloseKey(hKey);
             return std::wstring(buffer);
         }
+
+    private:
+        static double TicksToSeconds(LARGE_INTEGER ticks) {
+            return static_cast<double>(ticks.QuadPart) / 1e7; // 100 ns units
+        }
+
+        static void QueryResourceUsage(HANDLE hJob, HANDLE hProcess, ProcessStats& stats) {
+            JOBOBJECT_BASIC_AND_IO_ACCOUNTING_INFORMATION accounting;
+            JOBOBJECT_EXTENDED_LIMIT_INFORMATION limits;
+
+            if (hJob &&
+                QueryInformationJobObject(hJob, JobObjectBasicAndIoAccountingInformation, &accounting, sizeof(accounting), NULL) &&
+                QueryInformationJobObject(hJob, JobObjectExtendedLimitInformation, &limits, sizeof(limits), NULL)) {
+                stats.CpuSeconds = TicksToSeconds(accounting.BasicInfo.TotalUserTime) +
+                                   TicksToSeconds(accounting.BasicInfo.TotalKernelTime);
+                stats.PeakMemoryBytes = static_cast<uint64_t>(limits.PeakJobMemoryUsed);
+                return;
+            }
+
+            // No job: fall back to the top-level process' own times
+            FILETIME created, exited, kernel, user;
+            if (GetProcessTimes(hProcess, &created, &exited, &kernel, &user)) {
+                LARGE_INTEGER k, u;
+                k.LowPart = kernel.dwLowDateTime; k.HighPart = static_cast<LONG>(kernel.dwHighDateTime);
+                u.LowPart = user.dwLowDateTime; u.HighPart = static_cast<LONG>(user.dwHighDateTime);
+                stats.CpuSeconds = TicksToSeconds(k) + TicksToSeconds(u);
+            }
+        }
+#endif
+
+    private:
+#ifndef _WIN32
+        // A bare name is looked up on the child's PATH, as the shell used to
+        static std::string FindExecutable(const std::string& name, const EnvironmentBlock* environment) {
+            if (name.empty() || name.find('/') != std::string::npos) return name;
+            std::string path = StringUtils::ToUtf8(environment ? environment->Get(L"PATH") : GetEnvVar(L"PATH"));
+            if (path.empty()) path = "/usr/bin:/bin";
+            size_t begin = 0;
+            while (begin <= path.size()) {
+                size_t end = path.find(':', begin);
+                if (end == std::string::npos) end = path.size();
+                std::string candidate = (end > begin ? path.substr(begin, end - begin) : std::string(".")) + "/" + name;
+                if (access(candidate.c_str(), X_OK) == 0) return candidate;
+                begin = end + 1;
+            }
+            return name;
+        }
+#endif
+
+        // Held while a child is started and its pipe's inheritable end is open
+        static std::mutex& SpawnMutex() {
+            static std::mutex mutex;
+            return mutex;
+        }
     };
 }
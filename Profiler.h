@@ -0,0 +1,283 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <cstdio>
+#include <cstdint>
+
+// Scoped timers for the tool's own code paths. Build with UEBUILDER_PROFILING=0 and
+// UEBUILDER_PROFILE_SCOPE expands to nothing: no clock reads, no buffers, no code.
+#ifndef UEBUILDER_PROFILING
+#define UEBUILDER_PROFILING 1
+#endif
+
+#define UEBUILDER_PROFILE_CONCAT_INNER(a, b) a##b
+#define UEBUILDER_PROFILE_CONCAT(a, b) UEBUILDER_PROFILE_CONCAT_INNER(a, b)
+
+#if UEBUILDER_PROFILING
+// Times the rest of the enclosing block. name must outlive the program (a string literal).
+#define UEBUILDER_PROFILE_SCOPE(name) ::UEBuilder::ProfileScope UEBUILDER_PROFILE_CONCAT(profileScope, __LINE__)(name)
+// Names the calling thread's track in the trace
+#define UEBUILDER_PROFILE_THREAD(name) ::UEBuilder::Profiler::NameThread(name)
+#else
+#define UEBUILDER_PROFILE_SCOPE(name) ((void)0)
+#define UEBUILDER_PROFILE_THREAD(name) ((void)0)
+#endif
+
+namespace UEBuilder {
+
+    struct ProfileSpan {
+        const char* Name = "";
+        int64_t StartNs = 0;        // Profiler::Now() clock
+        int64_t EndNs = 0;
+        uint32_t Thread = 0;        // Index into ProfileSnapshot::Threads
+        uint32_t Depth = 0;         // Spans open on the same thread around this one
+
+        double Seconds() const { return (EndNs - StartNs) / 1e9; }
+    };
+
+    // Everything recorded since a point in time, from every thread
+    struct ProfileSnapshot {
+        int64_t SinceNs = 0;
+        std::vector<ProfileSpan> Spans;         // Per thread, in the order they ended
+        std::vector<std::string> Threads;
+        bool Truncated = false;                 // A thread's ring had already overwritten spans after SinceNs
+
+        struct Row {
+            std::string Name;
+            size_t Calls = 0;
+            double TotalSeconds = 0.0;
+            double SelfSeconds = 0.0;           // Minus the spans nested in it
+            double MaxSeconds = 0.0;
+        };
+
+        // One row per span name, longest total first
+        std::vector<Row> Breakdown() const {
+            std::vector<double> self(Spans.size());
+            for (size_t i = 0; i < Spans.size(); ++i) self[i] = Spans[i].Seconds();
+
+            // Spans of a thread nest properly; a stack per thread finds each one's parent
+            std::vector<size_t> order(Spans.size());
+            for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+            std::sort(order.begin(), order.end(), [this](size_t a, size_t b) {
+                const ProfileSpan& x = Spans[a];
+                const ProfileSpan& y = Spans[b];
+                if (x.Thread != y.Thread) return x.Thread < y.Thread;
+                if (x.StartNs != y.StartNs) return x.StartNs < y.StartNs;
+                return x.Depth < y.Depth;
+            });
+            std::vector<size_t> open;
+            for (size_t k = 0; k < order.size(); ++k) {
+                const ProfileSpan& span = Spans[order[k]];
+                if (k > 0 && Spans[order[k - 1]].Thread != span.Thread) open.clear();
+                while (!open.empty() && Spans[open.back()].Depth >= span.Depth) open.pop_back();
+                if (!open.empty()) self[open.back()] -= span.Seconds();
+                open.push_back(order[k]);
+            }
+
+            std::unordered_map<std::string, size_t> index;
+            std::vector<Row> rows;
+            for (size_t i = 0; i < Spans.size(); ++i) {
+                auto it = index.emplace(Spans[i].Name, rows.size()).first;
+                if (it->second == rows.size()) rows.push_back({ Spans[i].Name });
+                Row& row = rows[it->second];
+                ++row.Calls;
+                row.TotalSeconds += Spans[i].Seconds();
+                row.SelfSeconds += self[i];
+                row.MaxSeconds = (std::max)(row.MaxSeconds, Spans[i].Seconds());
+            }
+            std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) { return a.TotalSeconds > b.TotalSeconds; });
+            return rows;
+        }
+
+        std::string FormatBreakdown() const {
+            std::string out = "Tool timings";
+            char line[256];
+            if (Spans.empty()) {
+                out += UEBUILDER_PROFILING ? ": nothing recorded\n" : ": compiled out (UEBUILDER_PROFILING=0)\n";
+                return out;
+            }
+
+            int64_t first = Spans.front().StartNs;
+            int64_t last = Spans.front().EndNs;
+            for (const auto& span : Spans) {
+                first = (std::min)(first, span.StartNs);
+                last = (std::max)(last, span.EndNs);
+            }
+            std::snprintf(line, sizeof(line), "\n  %zu spans on %zu threads, %.1f ms from the first to the last%s\n\n",
+                          Spans.size(), Threads.size(), (last - first) / 1e6, Truncated ? " (oldest ones overwritten)" : "");
+            out += line;
+            out += "  Total ms    Self ms   Calls    Max ms  Span\n";
+            for (const auto& row : Breakdown()) {
+                std::snprintf(line, sizeof(line), "  %8.2f  %9.2f  %6zu  %8.2f  %s\n", row.TotalSeconds * 1e3, row.SelfSeconds * 1e3,
+                              row.Calls, row.MaxSeconds * 1e3, row.Name.c_str());
+                out += line;
+            }
+            return out;
+        }
+    };
+
+    // Where ProfileScope records to. Each thread appends to a ring of its own with plain
+    // relaxed stores and one release store of its count - no locks, no allocation and no
+    // shared cache lines on the recording path. Collect reads the rings from another thread
+    // and drops whatever was overwritten while it read.
+    class Profiler {
+    public:
+        static constexpr size_t SpansPerThread = 4096;     // Power of two
+
+        // Nanoseconds on the steady clock since the first call
+        static int64_t Now() {
+            static const auto epoch = std::chrono::steady_clock::now();
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+        }
+
+        static void Record(const char* name, int64_t startNs, int64_t endNs, uint32_t depth) {
+            ThreadBuffer& buffer = Local();
+            uint64_t n = buffer.Written.load(std::memory_order_relaxed);
+            Slot& slot = buffer.Slots[n & (SpansPerThread - 1)];
+            slot.Name.store(name, std::memory_order_relaxed);
+            slot.StartNs.store(startNs, std::memory_order_relaxed);
+            slot.EndNs.store(endNs, std::memory_order_relaxed);
+            slot.Depth.store(depth, std::memory_order_relaxed);
+            buffer.Written.store(n + 1, std::memory_order_release);
+        }
+
+        // Shown as the track name in the trace; name must outlive the program
+        static void NameThread(const char* name) { Local().Name.store(name, std::memory_order_relaxed); }
+
+        // Spans that started at or after sinceNs and have ended by now
+        static ProfileSnapshot Collect(int64_t sinceNs) {
+            ProfileSnapshot snapshot;
+            snapshot.SinceNs = sinceNs;
+
+            std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+            {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.Mutex);
+                buffers = registry.Buffers;
+            }
+
+            for (const auto& buffer : buffers) {
+                uint64_t written = buffer->Written.load(std::memory_order_acquire);
+                uint64_t first = written > SpansPerThread ? written - SpansPerThread : 0;
+
+                std::vector<ProfileSpan> spans;
+                for (uint64_t n = first; n < written; ++n) {
+                    const Slot& slot = buffer->Slots[n & (SpansPerThread - 1)];
+                    ProfileSpan span;
+                    span.Name = slot.Name.load(std::memory_order_relaxed);
+                    span.StartNs = slot.StartNs.load(std::memory_order_relaxed);
+                    span.EndNs = slot.EndNs.load(std::memory_order_relaxed);
+                    span.Depth = slot.Depth.load(std::memory_order_relaxed);
+                    spans.push_back(span);
+                }
+
+                // The owner kept recording meanwhile: anything it may have reused is suspect,
+                // including the slot it is filling right now (counted only once it is done)
+                uint64_t reused = buffer->Written.load(std::memory_order_acquire) + 1;
+                size_t skip = reused > SpansPerThread && reused - SpansPerThread > first
+                            ? static_cast<size_t>((std::min)(reused - SpansPerThread - first, static_cast<uint64_t>(spans.size())))
+                            : 0;
+                if (first > 0 || skip > 0) {
+                    const ProfileSpan* oldest = skip < spans.size() ? &spans[skip] : nullptr;
+                    if (!oldest || oldest->StartNs > sinceNs) snapshot.Truncated = true;
+                }
+
+                bool any = false;
+                for (size_t i = skip; i < spans.size(); ++i) {
+                    if (spans[i].StartNs < sinceNs) continue;
+                    spans[i].Thread = static_cast<uint32_t>(snapshot.Threads.size());
+                    snapshot.Spans.push_back(spans[i]);
+                    any = true;
+                }
+                if (any) {
+                    const char* name = buffer->Name.load(std::memory_order_relaxed);
+                    snapshot.Threads.push_back(name ? name : "Thread " + std::to_string(buffer->Index));
+                }
+            }
+            return snapshot;
+        }
+
+    private:
+        friend class ProfileScope;
+
+        struct Slot {
+            std::atomic<const char*> Name{ "" };
+            std::atomic<int64_t> StartNs{ 0 };
+            std::atomic<int64_t> EndNs{ 0 };
+            std::atomic<uint32_t> Depth{ 0 };
+        };
+
+        struct ThreadBuffer {
+            std::unique_ptr<Slot[]> Slots{ new Slot[SpansPerThread] };
+            alignas(64) std::atomic<uint64_t> Written{ 0 };
+            std::atomic<const char*> Name{ nullptr };
+            std::atomic<bool> InUse{ true };
+            uint32_t Index = 0;
+            uint32_t Depth = 0;     // Owner only
+        };
+
+        struct Registry {
+            std::mutex Mutex;
+            std::vector<std::shared_ptr<ThreadBuffer>> Buffers;
+        };
+
+        static Registry& GetRegistry() {
+            static Registry registry;
+            return registry;
+        }
+
+        // A thread's buffer outlives it, so its spans can still be collected; the next new
+        // thread takes it over (spans and all), which keeps the count at the most threads
+        // that were ever alive at once
+        struct LocalHandle {
+            std::shared_ptr<ThreadBuffer> Buffer;
+
+            LocalHandle() {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.Mutex);
+                for (const auto& buffer : registry.Buffers) {
+                    bool idle = false;
+                    if (buffer->InUse.compare_exchange_strong(idle, true)) {
+                        Buffer = buffer;
+                        Buffer->Name.store(nullptr, std::memory_order_relaxed);
+                        Buffer->Depth = 0;
+                        return;
+                    }
+                }
+                Buffer = std::make_shared<ThreadBuffer>();
+                Buffer->Index = static_cast<uint32_t>(registry.Buffers.size() + 1);
+                registry.Buffers.push_back(Buffer);
+            }
+            ~LocalHandle() { Buffer->InUse.store(false); }
+        };
+
+        static ThreadBuffer& Local() {
+            thread_local LocalHandle handle;
+            return *handle.Buffer;
+        }
+    };
+
+    class ProfileScope {
+    public:
+        explicit ProfileScope(const char* name) : name(name), depth(Profiler::Local().Depth++), start(Profiler::Now()) {}
+        ~ProfileScope() {
+            int64_t end = Profiler::Now();
+            --Profiler::Local().Depth;
+            Profiler::Record(name, start, end, depth);
+        }
+
+        ProfileScope(const ProfileScope&) = delete;
+        ProfileScope& operator=(const ProfileScope&) = delete;
+
+    private:
+        const char* name;
+        uint32_t depth;
+        int64_t start;
+    };
+}
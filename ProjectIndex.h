@@ -0,0 +1,495 @@
+#pragma once
+#include "ProcessUtils.h"
+#include "StringUtils.h"
+#include "JsonUtils.h"
+#include "SystemInfo.h"
+#include "BuildCommand.h"
+#include "Profiler.h"
+#include "Log.h"
+#include <string>
+#include <vector>
+#include <deque>
+#include <unordered_map>
+#include <unordered_set>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <ctime>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // Outcome of the last build of a project made with the tool. Kept with the project's build
+    // records (Saved/UEBuilder/LastBuild.json), so CLI and GUI builds - anyone's - show up in
+    // every index that covers the project.
+    struct ProjectBuildStatus {
+        std::string Result;         // "succeeded", "failed" or "cancelled"; empty if never built with the tool
+        std::string Target;         // "MyGameEditor"
+        std::string Config;         // "Development"
+        int64_t FinishedAt = 0;     // Unix time
+        double Seconds = 0.0;
+
+        static int64_t Now() { return static_cast<int64_t>(std::time(nullptr)); }
+
+        // "failed  MyGameEditor Development  2026-10-19 14:03", or "-" if never built with the tool
+        std::string Describe() const {
+            if (Result.empty()) return "-";
+            std::time_t when = static_cast<std::time_t>(FinishedAt);
+            std::tm local{};
+#ifdef _WIN32
+            localtime_s(&local, &when);
+#else
+            localtime_r(&when, &local);
+#endif
+            char stamp[32];
+            std::strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M", &local);
+            return Result + "  " + Target + " " + Config + "  " + stamp;
+        }
+
+        bool Save(const fs::path& path) const {
+            JsonValue root = JsonValue::MakeObject();
+            root.Set("Result", Result);
+            root.Set("Target", Target);
+            root.Set("Config", Config);
+            root.Set("FinishedAt", FinishedAt);
+            root.Set("Seconds", Seconds);
+
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            fs::path tmp = path;
+            tmp += ".tmp";
+            {
+                std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) return false;
+                file << root.Dump(2);
+                if (!file) return false;
+            }
+            fs::rename(tmp, path, ec);
+            return !ec;
+        }
+
+        bool Load(const fs::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) return false;
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            bool ok = false;
+            JsonValue root = JsonValue::Parse(text, &ok);
+            if (!ok) return false;
+            Result = root["Result"].AsString();
+            Target = root["Target"].AsString();
+            Config = root["Config"].AsString();
+            FinishedAt = root["FinishedAt"].AsInt();
+            Seconds = root["Seconds"].AsNumber();
+            return true;
+        }
+    };
+
+    struct IndexedProject {
+        fs::path File;                      // The .uproject
+        std::string Name;                   // Its file name without the extension
+        std::string EngineAssociation;      // "5.4", or a source build's GUID
+        std::vector<std::string> Targets;   // From Source/*.Target.cs: "MyGame", "MyGameEditor"; none for Blueprint-only projects
+        ProjectBuildStatus LastBuild;
+
+        // Write times of the .uproject, Source/ and LastBuild.json when they were last read;
+        // each part is only read again once its stamp changes
+        std::string FileStamp;
+        std::string SourceStamp;
+        std::string StatusStamp;
+    };
+
+    struct ProjectScanStats {
+        size_t Folders = 0;         // Visited
+        size_t FoldersListed = 0;   // New or changed since the last scan, so listed again
+        size_t ProjectsRead = 0;    // Projects with at least one part read again
+        double Seconds = 0.0;
+    };
+
+    // Every .uproject under one or more workspace roots, with what the project list shows:
+    // engine association, targets and the last build. Kept in the user data folder
+    // (projects.json) and loaded as-is at startup; Refresh brings it up to date.
+    //
+    // Refresh walks the roots on several threads. A folder whose write time is unchanged since
+    // the last scan has the same entries, so its recorded subfolders are reused without listing
+    // it; projects are only re-read where their own stamps changed. A folder that holds a
+    // .uproject is a project and is not descended into (projects don't nest, and Content/ is
+    // where most of a workspace's files are); Intermediate, Saved, DerivedDataCache and .git
+    // are never entered.
+    class ProjectIndex {
+    public:
+        // Workspace roots, separated like PATH (';' on Windows, ':' elsewhere)
+        static constexpr const wchar_t* WorkspaceEnvVar = L"UEBUILDER_WORKSPACE";
+
+        static fs::path DefaultPath() { return SystemInfo::GetUserDataDir() / "projects.json"; }
+
+        static fs::path StatusPath(const fs::path& project) { return BuildCommand::GetToolDataDir(project.wstring()) / "LastBuild.json"; }
+
+        // Stores the outcome of a build for the index to pick up
+        static bool RecordBuild(const fs::path& project, const ProjectBuildStatus& status) { return status.Save(StatusPath(project)); }
+
+        static bool IsSkippedFolder(const fs::path& name) {
+            static const wchar_t* skipped[] = { L"Intermediate", L"Saved", L"DerivedDataCache", L".git" };
+            for (const wchar_t* s : skipped) {
+                if (name == s) return true;
+            }
+            return false;
+        }
+
+        static std::vector<fs::path> WorkspaceFromEnv() {
+            std::vector<fs::path> result;
+            std::wstring value = ProcessUtils::GetEnvVar(WorkspaceEnvVar);
+#ifdef _WIN32
+            const wchar_t separator = L';';
+#else
+            const wchar_t separator = L':';
+#endif
+            size_t begin = 0;
+            while (begin <= value.size()) {
+                size_t end = value.find(separator, begin);
+                if (end == std::wstring::npos) end = value.size();
+                if (end > begin) result.push_back(fs::path(value.substr(begin, end - begin)));
+                begin = end + 1;
+            }
+            return result;
+        }
+
+        bool Load(const fs::path& path = DefaultPath()) {
+            UEBUILDER_PROFILE_SCOPE("ProjectIndex::Load");
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) return false;
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            bool ok = false;
+            JsonValue root = JsonValue::Parse(text, &ok);
+            if (!ok) return false;
+
+            roots.clear();
+            projects.clear();
+            folders.clear();
+            for (const auto& item : root["Roots"].Items()) roots.push_back(StringUtils::PathFromUtf8(item.AsString()));
+            for (const auto& item : root["Projects"].Items()) {
+                IndexedProject project;
+                project.File = StringUtils::PathFromUtf8(item["File"].AsString());
+                project.Name = item["Name"].AsString();
+                project.EngineAssociation = item["EngineAssociation"].AsString();
+                for (const auto& target : item["Targets"].Items()) project.Targets.push_back(target.AsString());
+                project.FileStamp = item["FileStamp"].AsString();
+                project.SourceStamp = item["SourceStamp"].AsString();
+                project.StatusStamp = item["StatusStamp"].AsString();
+                const JsonValue& last = item["LastBuild"];
+                project.LastBuild.Result = last["Result"].AsString();
+                project.LastBuild.Target = last["Target"].AsString();
+                project.LastBuild.Config = last["Config"].AsString();
+                project.LastBuild.FinishedAt = last["FinishedAt"].AsInt();
+                project.LastBuild.Seconds = last["Seconds"].AsNumber();
+                projects.push_back(std::move(project));
+            }
+            for (const auto& item : root["Folders"].Items()) {
+                Folder folder;
+                folder.Stamp = item["Stamp"].AsString();
+                folder.Project = item["Project"].AsString();
+                for (const auto& sub : item["Subfolders"].Items()) folder.Subfolders.push_back(sub.AsString());
+                folders[item["Path"].AsString()] = std::move(folder);
+            }
+            return true;
+        }
+
+        // Written to a temporary file and moved over the old one, so a reader never sees half
+        bool Save(const fs::path& path = DefaultPath()) const {
+            JsonValue rootList = JsonValue::MakeArray();
+            for (const auto& root : roots) rootList.Push(StringUtils::PathToUtf8(root));
+
+            JsonValue projectList = JsonValue::MakeArray();
+            for (const auto& project : projects) {
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("File", StringUtils::PathToUtf8(project.File));
+                item.Set("Name", project.Name);
+                item.Set("EngineAssociation", project.EngineAssociation);
+                JsonValue targets = JsonValue::MakeArray();
+                for (const auto& target : project.Targets) targets.Push(target);
+                item.Set("Targets", targets);
+                item.Set("FileStamp", project.FileStamp);
+                item.Set("SourceStamp", project.SourceStamp);
+                item.Set("StatusStamp", project.StatusStamp);
+                JsonValue last = JsonValue::MakeObject();
+                last.Set("Result", project.LastBuild.Result);
+                last.Set("Target", project.LastBuild.Target);
+                last.Set("Config", project.LastBuild.Config);
+                last.Set("FinishedAt", project.LastBuild.FinishedAt);
+                last.Set("Seconds", project.LastBuild.Seconds);
+                item.Set("LastBuild", last);
+                projectList.Push(item);
+            }
+
+            // Sorted so the file only changes where the workspace did
+            std::vector<const std::pair<const std::string, Folder>*> sorted;
+            for (const auto& entry : folders) sorted.push_back(&entry);
+            std::sort(sorted.begin(), sorted.end(), [](const auto* a, const auto* b) { return a->first < b->first; });
+            JsonValue folderList = JsonValue::MakeArray();
+            for (const auto* entry : sorted) {
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("Path", entry->first);
+                item.Set("Stamp", entry->second.Stamp);
+                if (!entry->second.Project.empty()) item.Set("Project", entry->second.Project);
+                JsonValue subfolders = JsonValue::MakeArray();
+                for (const auto& sub : entry->second.Subfolders) subfolders.Push(sub);
+                item.Set("Subfolders", subfolders);
+                folderList.Push(item);
+            }
+
+            JsonValue root = JsonValue::MakeObject();
+            root.Set("Roots", rootList);
+            root.Set("Projects", projectList);
+            root.Set("Folders", folderList);
+
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            fs::path tmp = path;
+            tmp += ".tmp";
+            {
+                std::ofstream file(tmp, std::ios::binary | std::ios::trunc);
+                if (!file.is_open()) return false;
+                file << root.Dump(1);
+                if (!file) return false;
+            }
+            fs::rename(tmp, path, ec);
+            return !ec;
+        }
+
+        const std::vector<fs::path>& Roots() const { return roots; }
+
+        // False if it (or an equal path) is already a root
+        bool AddRoot(const fs::path& root) {
+            std::error_code ec;
+            fs::path absolute = fs::absolute(root, ec);
+            fs::path normal = (ec ? root : absolute).lexically_normal();
+            if (normal.has_relative_path() && !normal.has_filename()) normal = normal.parent_path(); // "C:/Work/" -> "C:/Work"
+            if (std::find(roots.begin(), roots.end(), normal) != roots.end()) return false;
+            roots.push_back(normal);
+            return true;
+        }
+
+        // By name, then path
+        const std::vector<IndexedProject>& Projects() const { return projects; }
+
+        const IndexedProject* Find(const fs::path& file) const {
+            for (const auto& project : projects) {
+                if (project.File == file) return &project;
+            }
+            return nullptr;
+        }
+
+        // Case-insensitive; several when the workspace has projects of the same name
+        std::vector<const IndexedProject*> FindByName(const std::string& name) const {
+            std::vector<const IndexedProject*> found;
+            for (const auto& project : projects) {
+                if (project.Name.size() != name.size()) continue;
+                bool same = std::equal(name.begin(), name.end(), project.Name.begin(), [](char a, char b) {
+                    return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+                });
+                if (same) found.push_back(&project);
+            }
+            return found;
+        }
+
+        // Brings the index up to date with the roots. force lists every folder and re-reads
+        // every project, for file systems that don't keep folder write times.
+        ProjectScanStats Refresh(bool force = false, size_t threads = 0) {
+            UEBUILDER_PROFILE_SCOPE("ProjectIndex::Refresh");
+            auto started = std::chrono::steady_clock::now();
+            if (threads == 0) threads = (std::min)((std::max)(std::thread::hardware_concurrency(), 2u), 8u);
+
+            std::unordered_map<std::string, const IndexedProject*> known;
+            for (const auto& project : projects) known[StringUtils::PathToUtf8(project.File)] = &project;
+
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::deque<fs::path> queue;
+            std::unordered_set<std::string> queued;
+            size_t busy = 0;
+            std::unordered_map<std::string, Folder> seen;
+            std::vector<IndexedProject> found;
+            ProjectScanStats stats;
+
+            for (const auto& root : roots) {
+                if (queued.insert(StringUtils::PathToUtf8(root)).second) queue.push_back(root);
+            }
+
+            auto work = [&]() {
+                std::unique_lock<std::mutex> lock(mutex);
+                for (;;) {
+                    wake.wait(lock, [&]() { return !queue.empty() || busy == 0; });
+                    if (queue.empty()) return;
+                    fs::path dir = std::move(queue.front());
+                    queue.pop_front();
+                    ++busy;
+                    lock.unlock();
+
+                    // Only the old index is read here, and it is not written until the end
+                    std::string key = StringUtils::PathToUtf8(dir);
+                    Folder folder;
+                    bool listed = Visit(dir, key, force, folder);
+                    IndexedProject project;
+                    bool read = false;
+                    if (!folder.Project.empty()) {
+                        fs::path file = dir / StringUtils::PathFromUtf8(folder.Project);
+                        auto old = known.find(StringUtils::PathToUtf8(file));
+                        project = ReadProject(file, old != known.end() ? old->second : nullptr, force, read);
+                    }
+
+                    lock.lock();
+                    --busy;
+                    ++stats.Folders;
+                    stats.FoldersListed += listed;
+                    stats.ProjectsRead += read;
+                    for (const auto& sub : folder.Subfolders) {
+                        fs::path child = dir / StringUtils::PathFromUtf8(sub);
+                        if (queued.insert(StringUtils::PathToUtf8(child)).second) queue.push_back(std::move(child));
+                    }
+                    if (!folder.Project.empty()) found.push_back(std::move(project));
+                    seen[key] = std::move(folder);
+                    wake.notify_all();
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for (size_t i = 1; i < threads; ++i) workers.emplace_back(work);
+            work();
+            for (auto& worker : workers) worker.join();
+
+            std::sort(found.begin(), found.end(), [](const IndexedProject& a, const IndexedProject& b) {
+                return a.Name != b.Name ? a.Name < b.Name : a.File < b.File;
+            });
+            projects = std::move(found);
+            folders = std::move(seen);
+
+            stats.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+            Log::Debug("ProjectIndex", "Workspace scanned", { { "roots", roots.size() }, { "projects", projects.size() }, { "folders", stats.Folders },
+                                                             { "listed", stats.FoldersListed }, { "read", stats.ProjectsRead },
+                                                             { "ms", stats.Seconds * 1e3 } });
+            return stats;
+        }
+
+        // Takes the projects and folders of a scan that ran on a copy of this index (Refresh on
+        // another thread). The roots stay this index's own, so one added since the copy was
+        // taken is kept; it is covered from the next Refresh on.
+        void AdoptScan(ProjectIndex&& scan) {
+            projects = std::move(scan.projects);
+            folders = std::move(scan.folders);
+        }
+
+        // Re-reads whatever changed of one indexed project (e.g. right after building it);
+        // false if it isn't in the index
+        bool RefreshProject(const fs::path& file) {
+            for (auto& project : projects) {
+                if (project.File != file) continue;
+                bool read = false;
+                project = ReadProject(file, &project, false, read);
+                return true;
+            }
+            return false;
+        }
+
+        // "MyGame", "MyGameEditor" from Source/<name>.Target.cs
+        static std::vector<std::string> ReadTargets(const fs::path& sourceDir) {
+            static const std::string suffix = ".Target.cs";
+            std::vector<std::string> targets;
+            std::error_code ec;
+            for (fs::directory_iterator it(sourceDir, ec), end; !ec && it != end; it.increment(ec)) {
+                std::string name = StringUtils::PathToUtf8(it->path().filename());
+                if (name.size() > suffix.size() && name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0) {
+                    targets.push_back(name.substr(0, name.size() - suffix.size()));
+                }
+            }
+            std::sort(targets.begin(), targets.end());
+            return targets;
+        }
+
+    private:
+        struct Folder {
+            std::string Stamp;
+            std::vector<std::string> Subfolders;    // Names, sorted; none in a project folder
+            std::string Project;                    // .uproject file name when this is a project folder
+        };
+
+        std::vector<fs::path> roots;
+        std::vector<IndexedProject> projects;
+        std::unordered_map<std::string, Folder> folders;  // By UTF-8 path, as of the last scan
+
+        static std::string Stamp(const fs::path& path) {
+            std::error_code ec;
+            auto time = fs::last_write_time(path, ec);
+            return ec ? std::string() : std::to_string(time.time_since_epoch().count());
+        }
+
+        // The folder's entries, from the last scan when its write time is unchanged. True if listed.
+        bool Visit(const fs::path& dir, const std::string& key, bool force, Folder& folder) const {
+            folder.Stamp = Stamp(dir);
+            auto old = folders.find(key);
+            if (!force && old != folders.end() && !folder.Stamp.empty() && old->second.Stamp == folder.Stamp) {
+                folder = old->second;
+                return false;
+            }
+
+            // Extension and type come with the entry on both platforms; no stat per file
+            std::error_code ec;
+            for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+                const fs::path& path = it->path();
+                std::error_code typeEc;
+                if (path.extension() == L".uproject") {
+                    // Several in one folder: the same one every time
+                    std::string name = StringUtils::PathToUtf8(path.filename());
+                    if (it->is_regular_file(typeEc) && (folder.Project.empty() || name < folder.Project)) folder.Project = name;
+                    continue;
+                }
+                if (it->is_symlink(typeEc) || !it->is_directory(typeEc) || IsSkippedFolder(path.filename())) continue;
+                folder.Subfolders.push_back(StringUtils::PathToUtf8(path.filename()));
+            }
+            if (!folder.Project.empty()) folder.Subfolders.clear();
+            std::sort(folder.Subfolders.begin(), folder.Subfolders.end());
+            return true;
+        }
+
+        static IndexedProject ReadProject(const fs::path& file, const IndexedProject* old, bool force, bool& read) {
+            IndexedProject project = old ? *old : IndexedProject();
+            project.File = file;
+            project.Name = StringUtils::PathToUtf8(file.stem());
+            read = false;
+
+            std::string fileStamp = Stamp(file);
+            if (force || !old || fileStamp != project.FileStamp) {
+                std::ifstream in(file, std::ios::binary);
+                std::string text((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+                if (text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.erase(0, 3);
+                bool ok = false;
+                JsonValue root = JsonValue::Parse(text, &ok);
+                project.EngineAssociation = ok ? root["EngineAssociation"].AsString() : std::string();
+                project.FileStamp = fileStamp;
+                read = true;
+            }
+
+            fs::path source = file.parent_path() / "Source";
+            std::string sourceStamp = Stamp(source);
+            if (force || !old || sourceStamp != project.SourceStamp) {
+                project.Targets = ReadTargets(source);
+                project.SourceStamp = sourceStamp;
+                read = true;
+            }
+
+            fs::path status = StatusPath(file);
+            std::string statusStamp = Stamp(status);
+            if (force || !old || statusStamp != project.StatusStamp) {
+                project.LastBuild = ProjectBuildStatus();
+                project.LastBuild.Load(status);
+                project.StatusStamp = statusStamp;
+                read = true;
+            }
+            return project;
+        }
+    };
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include "Profiler.h"
+#include <string>
+#include <filesystem>
+#include <algorithm>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // Turns what the user typed, pasted or dropped into a .uproject path (shared by CLI and GUI)
+    class ProjectLocator {
+    public:
+        // Trims whitespace and drag-and-drop quotes, repairs "/C:/..." and "C/..." drive
+        // prefixes, and switches to forward slashes for filesystem consistency
+        static std::wstring SanitizeInputPath(std::wstring input) {
+            if (input.empty()) return input;
+
+            input.erase(0, input.find_first_not_of(L" \t\n\r"));
+            input.erase(input.find_last_not_of(L" \t\n\r") + 1);
+
+            if (!input.empty() && input.front() == L'"') input.erase(0, 1);
+            if (!input.empty() && input.back() == L'"') input.pop_back();
+
+            if (input.length() > 1 && input[1] == L':' && input[0] == L'/') {
+                input.erase(0, 1);
+            }
+            else if (input.length() > 1 && input[1] == L'/' && (input[0] >= L'A' && input[0] <= L'Z')) {
+                input.insert(1, L":");
+            }
+
+            std::replace(input.begin(), input.end(), L'\\', L'/');
+            return input;
+        }
+
+        // The .uproject itself, or the first one directly inside a project folder; empty if none
+        static std::wstring ResolveProjectFile(const fs::path& target) {
+            UEBUILDER_PROFILE_SCOPE("ProjectLocator::ResolveProjectFile");
+            if (target.extension() == L".uproject") return target.wstring();
+
+            std::error_code ec;
+            if (!fs::is_directory(target, ec)) return L"";
+
+            // Extension first: it is free, while is_regular_file may cost a stat per entry
+            UEBUILDER_PROFILE_SCOPE("ProjectLocator: folder scan");
+            for (fs::directory_iterator it(target, ec), end; !ec && it != end; it.increment(ec)) {
+                const fs::path& path = it->path();
+                if (path.extension() == L".uproject" && it->is_regular_file(ec)) return path.wstring();
+            }
+            return L"";
+        }
+    };
+}
@@ -0,0 +1,238 @@
+#pragma once
+#include "ProcessUtils.h"
+#include "ProcessTree.h"
+#include "Metrics.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // One tick, summed over UBT and everything below it
+    struct ResourceSample {
+        float Seconds = 0.0f;           // Since sampling started
+        float CpuPercent = 0.0f;        // 0-100 of all logical cores
+        uint64_t RssBytes = 0;
+        float ReadBytesPerSec = 0.0f;
+        float WriteBytesPerSec = 0.0f;
+        uint16_t Processes = 0;
+    };
+
+    // One process in one tick; kept small because a build produces hundreds of thousands
+    struct ProcessSample {
+        float Seconds = 0.0f;
+        ProcessId Pid = 0;
+        uint16_t Name = 0;              // Index into ResourceSampler::Names()
+        float CpuPercent = 0.0f;        // Of one core, so a busy compiler reads ~100
+        uint32_t RssKB = 0;
+        uint32_t ReadKB = 0;            // During this tick
+        uint32_t WriteKB = 0;
+    };
+
+    // Samples CPU, resident memory and I/O of a process tree at a fixed interval, so a slow
+    // build can be told apart as CPU-, memory- or I/O-bound. Counters are cumulative per
+    // process, so each tick records the difference to the previous one.
+    class ResourceSampler {
+    public:
+        using SampleCallback = std::function<void(const ResourceSample&)>;
+
+        static constexpr const wchar_t* IntervalEnvVar = L"UEBUILDER_SAMPLE_INTERVAL_MS";
+
+        // 500 ms unless overridden through UEBUILDER_SAMPLE_INTERVAL_MS
+        static int DefaultIntervalMs() {
+            int interval = std::atoi(StringUtils::ToUtf8(ProcessUtils::GetEnvVar(IntervalEnvVar)).c_str());
+            return interval >= 50 ? interval : 500;
+        }
+
+        // onSample runs on the sampler thread
+        explicit ResourceSampler(int intervalMs = DefaultIntervalMs(), SampleCallback onSample = nullptr)
+            : intervalMs((std::max)(50, intervalMs)), onSample(std::move(onSample)) {}
+
+        ~ResourceSampler() { Stop(); }
+
+        ResourceSampler(const ResourceSampler&) = delete;
+        ResourceSampler& operator=(const ResourceSampler&) = delete;
+
+        void Start(ProcessId root) {
+            Stop();
+            rootPid = root;
+            stopRequested = false;
+            samples.clear();
+            processSamples.clear();
+            names.clear();
+            nameIndex.clear();
+            previous.clear();
+            startTime = lastTick = std::chrono::steady_clock::now();
+            worker = std::thread([this]() { Loop(); });
+        }
+
+        void Stop() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                stopRequested = true;
+            }
+            wake.notify_all();
+            if (worker.joinable()) worker.join();
+        }
+
+        // Only valid once Stop returned
+        const std::vector<ResourceSample>& Samples() const { return samples; }
+        const std::vector<ProcessSample>& ProcessSamples() const { return processSamples; }
+        const std::vector<std::string>& Names() const { return names; }
+        int IntervalMs() const { return intervalMs; }
+
+        // utilization.csv (whole tree) and processes.csv (per process), for spreadsheets or pandas
+        bool SaveCsv(const fs::path& dir) const {
+            std::error_code ec;
+            fs::create_directories(dir, ec);
+
+            std::ofstream totals(dir / "utilization.csv", std::ios::trunc);
+            std::ofstream perProcess(dir / "processes.csv", std::ios::trunc);
+            if (!totals.is_open() || !perProcess.is_open()) return false;
+
+            char line[256];
+            totals << "seconds,cpu_percent,rss_mb,read_mb_per_s,write_mb_per_s,processes\n";
+            for (const auto& s : samples) {
+                std::snprintf(line, sizeof(line), "%.2f,%.1f,%.1f,%.2f,%.2f,%u\n",
+                              s.Seconds, s.CpuPercent, s.RssBytes / 1048576.0,
+                              s.ReadBytesPerSec / 1048576.0, s.WriteBytesPerSec / 1048576.0, static_cast<unsigned>(s.Processes));
+                totals << line;
+            }
+
+            perProcess << "seconds,pid,name,cpu_percent,rss_mb,read_kb,write_kb\n";
+            for (const auto& s : processSamples) {
+                std::snprintf(line, sizeof(line), "%.2f,%u,%s,%.1f,%.1f,%u,%u\n",
+                              s.Seconds, static_cast<unsigned>(s.Pid), names[s.Name].c_str(),
+                              s.CpuPercent, s.RssKB / 1024.0, s.ReadKB, s.WriteKB);
+                perProcess << line;
+            }
+            return static_cast<bool>(totals) && static_cast<bool>(perProcess);
+        }
+
+    private:
+        struct Previous {
+            uint64_t StartTime = 0;
+            ProcessUsage Usage;
+        };
+
+        int intervalMs;
+        SampleCallback onSample;
+        ProcessId rootPid = 0;
+        int cores = (std::max)(1u, std::thread::hardware_concurrency());
+
+        std::thread worker;
+        std::mutex mutex;
+        std::condition_variable wake;
+        bool stopRequested = false;
+
+        // Owned by the worker while it runs
+        std::vector<ResourceSample> samples;
+        std::vector<ProcessSample> processSamples;
+        std::vector<std::string> names;
+        std::unordered_map<std::string, uint16_t> nameIndex;
+        std::unordered_map<ProcessId, Previous> previous;
+        std::chrono::steady_clock::time_point startTime;
+        std::chrono::steady_clock::time_point lastTick;
+
+        void Loop() {
+            std::unique_lock<std::mutex> lock(mutex);
+            while (!stopRequested) {
+                wake.wait_for(lock, std::chrono::milliseconds(intervalMs), [this]() { return stopRequested; });
+                lock.unlock();
+                Tick();
+                lock.lock();
+            }
+
+            // Nothing of ours is running any more
+            Metrics& metrics = Metrics::Get();
+            metrics.ChildCpu.Get().Set(0);
+            metrics.ChildRss.Get().Set(0);
+            metrics.ChildProcesses.Get().Set(0);
+        }
+
+        void Tick() {
+            auto now = std::chrono::steady_clock::now();
+            double dt = std::chrono::duration<double>(now - lastTick).count();
+            lastTick = now;
+            if (dt <= 0.0) return;
+
+            std::vector<ProcessInfo> tree = ProcessTree::Descendants(rootPid);
+            ProcessInfo root;
+            root.Pid = rootPid;
+            root.Name = "(build)"; // The process RunProcess launched
+            tree.insert(tree.begin(), root);
+
+            ResourceSample total;
+            total.Seconds = static_cast<float>(std::chrono::duration<double>(now - startTime).count());
+            double cpuSeconds = 0.0, readBytes = 0.0, writeBytes = 0.0;
+
+            std::unordered_map<ProcessId, Previous> current;
+            for (const auto& process : tree) {
+                ProcessUsage usage;
+                if (!ProcessTree::QueryUsage(process.Pid, usage)) continue;
+
+                // A reused pid is a new process: count it from zero
+                ProcessUsage delta = usage;
+                auto prev = previous.find(process.Pid);
+                if (prev != previous.end() && prev->second.StartTime == process.StartTime) {
+                    delta.CpuSeconds = (std::max)(0.0, usage.CpuSeconds - prev->second.Usage.CpuSeconds);
+                    delta.ReadBytes = usage.ReadBytes - (std::min)(usage.ReadBytes, prev->second.Usage.ReadBytes);
+                    delta.WriteBytes = usage.WriteBytes - (std::min)(usage.WriteBytes, prev->second.Usage.WriteBytes);
+                }
+                current[process.Pid] = { process.StartTime, usage };
+
+                cpuSeconds += delta.CpuSeconds;
+                readBytes += static_cast<double>(delta.ReadBytes);
+                writeBytes += static_cast<double>(delta.WriteBytes);
+                total.RssBytes += usage.RssBytes;
+                ++total.Processes;
+
+                ProcessSample sample;
+                sample.Seconds = total.Seconds;
+                sample.Pid = process.Pid;
+                sample.Name = Intern(process.Name);
+                sample.CpuPercent = static_cast<float>(delta.CpuSeconds / dt * 100.0);
+                sample.RssKB = static_cast<uint32_t>(usage.RssBytes / 1024);
+                sample.ReadKB = static_cast<uint32_t>(delta.ReadBytes / 1024);
+                sample.WriteKB = static_cast<uint32_t>(delta.WriteBytes / 1024);
+                processSamples.push_back(sample);
+            }
+            previous.swap(current);
+
+            total.CpuPercent = static_cast<float>((std::min)(100.0, cpuSeconds / (dt * cores) * 100.0));
+            total.ReadBytesPerSec = static_cast<float>(readBytes / dt);
+            total.WriteBytesPerSec = static_cast<float>(writeBytes / dt);
+            samples.push_back(total);
+
+            Metrics& metrics = Metrics::Get();
+            metrics.ChildCpu.Get().Set(total.CpuPercent);
+            metrics.ChildRss.Get().Set(static_cast<double>(total.RssBytes));
+            metrics.ChildProcesses.Get().Set(total.Processes);
+
+            if (onSample) onSample(total);
+        }
+
+        uint16_t Intern(const std::string& name) {
+            auto it = nameIndex.find(name);
+            if (it != nameIndex.end()) return it->second;
+            if (names.size() >= 0xFFFF) return 0;
+
+            uint16_t index = static_cast<uint16_t>(names.size());
+            names.push_back(name);
+            nameIndex.emplace(name, index);
+            return index;
+        }
+    };
+}
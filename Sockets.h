@@ -0,0 +1,176 @@
+#pragma once
+// Thin portable layer over BSD sockets / Winsock.
+// Keep <winsock2.h> ahead of <windows.h>, otherwise the old winsock.h gets pulled in.
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#include <windows.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include <string>
+#include <cstring>
+
+namespace UEBuilder {
+
+#ifdef _WIN32
+    using SocketHandle = SOCKET;
+    static const SocketHandle InvalidSocket = INVALID_SOCKET;
+#else
+    using SocketHandle = int;
+    static const SocketHandle InvalidSocket = -1;
+#endif
+
+    class Sockets {
+    public:
+        // Winsock needs a one-time WSAStartup; harmless to call repeatedly
+        static bool Init() {
+#ifdef _WIN32
+            static bool initialized = [] {
+                WSADATA wsa;
+                return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+            }();
+            return initialized;
+#else
+            return true;
+#endif
+        }
+
+        static void Close(SocketHandle s) {
+            if (s == InvalidSocket) return;
+#ifdef _WIN32
+            closesocket(s);
+#else
+            ::close(s);
+#endif
+        }
+
+        // Resolves host and connects; returns InvalidSocket on failure
+        static SocketHandle Connect(const std::string& host, const std::string& port, int timeoutMs = 30000) {
+            if (!Init()) return InvalidSocket;
+
+            addrinfo hints;
+            std::memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+
+            addrinfo* result = nullptr;
+            if (getaddrinfo(host.c_str(), port.c_str(), &hints, &result) != 0) return InvalidSocket;
+
+            SocketHandle s = InvalidSocket;
+            for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+                s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+                if (s == InvalidSocket) continue;
+
+                SetTimeout(s, timeoutMs);
+                if (connect(s, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0) break;
+
+                Close(s);
+                s = InvalidSocket;
+            }
+            freeaddrinfo(result);
+
+            if (s != InvalidSocket) {
+                int one = 1;
+                setsockopt(s, IPPROTO_TCP, TCP_NODELAY, reinterpret_cast<const char*>(&one), sizeof(one));
+            }
+            return s;
+        }
+
+        // Bound to address:port ("0.0.0.0" for every interface) and listening; InvalidSocket on failure
+        static SocketHandle Listen(const std::string& address, const std::string& port, int backlog = 16) {
+            if (!Init()) return InvalidSocket;
+
+            addrinfo hints;
+            std::memset(&hints, 0, sizeof(hints));
+            hints.ai_family = AF_UNSPEC;
+            hints.ai_socktype = SOCK_STREAM;
+            hints.ai_flags = AI_PASSIVE;
+
+            addrinfo* result = nullptr;
+            if (getaddrinfo(address.empty() ? nullptr : address.c_str(), port.c_str(), &hints, &result) != 0) return InvalidSocket;
+
+            SocketHandle s = InvalidSocket;
+            for (addrinfo* ai = result; ai; ai = ai->ai_next) {
+                s = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+                if (s == InvalidSocket) continue;
+
+#ifndef _WIN32
+                // Restarting right after a previous run must not wait for TIME_WAIT to expire
+                int one = 1;
+                setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&one), sizeof(one));
+#endif
+                if (bind(s, ai->ai_addr, static_cast<int>(ai->ai_addrlen)) == 0 && listen(s, backlog) == 0) break;
+
+                Close(s);
+                s = InvalidSocket;
+            }
+            freeaddrinfo(result);
+            return s;
+        }
+
+        // Waits up to timeoutMs for a connection; InvalidSocket when none came (or on error)
+        static SocketHandle Accept(SocketHandle listener, int timeoutMs) {
+            fd_set readable;
+            FD_ZERO(&readable);
+            FD_SET(listener, &readable);
+            timeval tv;
+            tv.tv_sec = timeoutMs / 1000;
+            tv.tv_usec = (timeoutMs % 1000) * 1000;
+            if (select(static_cast<int>(listener + 1), &readable, nullptr, nullptr, &tv) <= 0) return InvalidSocket;
+
+            SocketHandle s = accept(listener, nullptr, nullptr);
+            return s;
+        }
+
+        // The port a socket is bound to (Listen with port "0" picks a free one)
+        static int LocalPort(SocketHandle s) {
+            sockaddr_storage address;
+            socklen_t len = sizeof(address);
+            if (getsockname(s, reinterpret_cast<sockaddr*>(&address), &len) != 0) return 0;
+            if (address.ss_family == AF_INET) return ntohs(reinterpret_cast<sockaddr_in*>(&address)->sin_port);
+            if (address.ss_family == AF_INET6) return ntohs(reinterpret_cast<sockaddr_in6*>(&address)->sin6_port);
+            return 0;
+        }
+
+        static bool SendAll(SocketHandle s, const char* data, size_t len) {
+            while (len > 0) {
+                int chunk = static_cast<int>(len > (1 << 30) ? (1 << 30) : len);
+                int sent = static_cast<int>(send(s, data, chunk, 0));
+                if (sent <= 0) return false;
+                data += sent;
+                len -= static_cast<size_t>(sent);
+            }
+            return true;
+        }
+
+        static bool SendAll(SocketHandle s, const std::string& data) { return SendAll(s, data.data(), data.size()); }
+
+        // Returns bytes read, 0 on orderly close, -1 on error/timeout
+        static int Recv(SocketHandle s, char* buffer, size_t len) {
+            int got = static_cast<int>(recv(s, buffer, static_cast<int>(len), 0));
+            return got < 0 ? -1 : got;
+        }
+
+        static void SetTimeout(SocketHandle s, int timeoutMs) {
+#ifdef _WIN32
+            DWORD tv = static_cast<DWORD>(timeoutMs);
+#else
+            timeval tv;
+            tv.tv_sec = timeoutMs / 1000;
+            tv.tv_usec = (timeoutMs % 1000) * 1000;
+#endif
+            setsockopt(s, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+            setsockopt(s, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<const char*>(&tv), sizeof(tv));
+        }
+    };
+}
@@ -0,0 +1,305 @@
+#pragma once
+#include "EventLoop.h"
+#include "WorkerPool.h"
+#include "ProjectLocator.h"
+#include "EngineDetector.h"
+#include "ToolchainManager.h"
+#include "ToolchainEnvironment.h"
+#include "PagePrefetch.h"
+#include "PrebuiltCache.h"
+#include "BuildCommand.h"
+#include <string>
+#include <vector>
+#include <filesystem>
+#include <chrono>
+#include <exception>
+#include <mutex>
+#include <cstdio>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    enum class StartupError {
+        None,
+        ToolchainMissing,       // No MSVC at all (Windows)
+        ProjectNotFound,
+        EngineNotFound,
+        NoMatchingToolchain,    // Nothing installed fits the engine (Windows); see Problem
+        Failed,                 // Unexpected; see Problem
+    };
+
+    struct StartupOptions {
+        std::wstring Project;                   // Folder or .uproject, as typed or dropped
+        std::wstring EngineRoot;                // Use this engine instead of looking it up
+        bool NeedsEngine = true;                // Commands that run UBT; the rest only need the project
+        PagePrefetcher* Prefetcher = nullptr;   // Started as soon as there is something to read
+        bool ComputeRevision = false;           // Prebuilt revision of Request (ProjectPath is filled in)
+        BuildRequest Request;
+    };
+
+    struct StartupStage {
+        std::string Name;
+        double Start = 0.0;     // Seconds since the pipeline started
+        double Seconds = 0.0;
+    };
+
+    struct StartupResult {
+        StartupError Error = StartupError::None;
+        std::string Problem;
+
+        fs::path TargetPath;                    // The sanitized input
+        bool TargetIsDirectory = false;
+        std::wstring ProjectPath;               // The .uproject; empty when none was found
+        std::wstring Association;
+        EngineInfo Engine;
+        bool ToolchainSelected = false;         // False with a stand-in UBT or without an engine
+        ToolchainSelection Toolchain;
+        EnvironmentBlock Environment;           // Empty inherits ours
+        std::string EnvironmentLog;             // What capturing the environment printed
+        std::string PrefetchSource;             // What the prefetcher was started with, if anything
+        std::string PrebuiltRevision;
+
+        std::vector<StartupStage> Stages;       // In the order they finished
+        double Seconds = 0.0;
+
+        bool Ok() const { return Error == StartupError::None; }
+
+        // "toolchain discovery 0.012s @0.000, project lookup 0.001s @0.000, ..."
+        std::string FormatStages() const {
+            std::string out;
+            char text[128];
+            for (const auto& stage : Stages) {
+                std::snprintf(text, sizeof(text), "%s%s %.3fs @%.3f", out.empty() ? "" : ", ", stage.Name.c_str(), stage.Seconds, stage.Start);
+                out += text;
+            }
+            return out;
+        }
+    };
+
+    // Everything between "build this project" and starting UnrealBuildTool, shared by the CLI,
+    // the GUI and anything else that builds. The stages form a small graph rather than a line:
+    //
+    //   toolchain discovery ------------------------------------------+--> selection --> environment
+    //   project lookup --> project parse --> engine lookup --> requirements
+    //                  |                 \-> prebuilt revision
+    //                  \-> prefetch list (the prefetcher starts right away; engine seed if empty)
+    //
+    // so the time to UBT is that of the longest chain, not the sum. Each stage's blocking work
+    // (file system, registry, vcvarsall) runs on the worker pool through EventLoop::Offload;
+    // the coroutines only decide what comes next, on the loop thread.
+    //
+    // Nothing is printed: callers report the result (and EnvironmentLog) their own way.
+    class StartupPipeline {
+    public:
+        // Enough workers for every stage that can run at once
+        static constexpr size_t Concurrency = 4;
+
+        static Task<StartupResult> Run(EventLoop& loop, WorkerPool& pool, StartupOptions options) {
+            co_await loop.Schedule();
+#if UEBUILDER_PROFILING
+            int64_t profileStart = Profiler::Now();     // One span for the whole graph, on the loop's track
+#endif
+            State state(loop, pool, std::move(options));
+            state.NeedsToolchain = state.Options.NeedsEngine && EngineDetector::GetUBTOverride().empty();
+
+            try {
+                Task<> toolchains = DiscoverToolchains(state);
+                Task<> project = LocateProject(state);
+                co_await WhenAll(toolchains, project);
+                if (state.Result.Ok()) co_await SelectToolchain(state);
+            }
+            catch (const std::exception& e) {
+                Fail(state, StartupError::Failed, e.what());
+            }
+            state.Result.Seconds = state.Elapsed();
+#if UEBUILDER_PROFILING
+            Profiler::Record("startup", profileStart, Profiler::Now(), 0);
+#endif
+            co_return std::move(state.Result);
+        }
+
+        // For callers that have nothing else to do meanwhile (the CLI)
+        static StartupResult RunBlocking(const StartupOptions& options) {
+            WorkerPool pool(Concurrency);
+            EventLoop loop;
+            return loop.Run(Run(loop, pool, options));
+        }
+
+    private:
+        struct State {
+            State(EventLoop& loop, WorkerPool& pool, StartupOptions options)
+                : Loop(loop), Pool(pool), Options(std::move(options)) {}
+
+            EventLoop& Loop;
+            WorkerPool& Pool;
+            StartupOptions Options;
+            bool NeedsToolchain = false;
+            ToolchainInventory Inventory;
+            ToolchainRequirements Requirements;
+            StartupResult Result;
+            std::chrono::steady_clock::time_point StartTime = std::chrono::steady_clock::now();
+
+            std::mutex StagesMutex;     // Stages finish on the pool's threads
+
+            double Elapsed() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - StartTime).count(); }
+
+            void Record(const char* name, double start, double seconds) {
+                std::lock_guard<std::mutex> lock(StagesMutex);
+                Result.Stages.push_back({ name, start, seconds });
+            }
+        };
+
+        // A missing toolchain is reported first, as it was when the checks ran one by one
+        static void Fail(State& state, StartupError error, const std::string& problem = std::string()) {
+            if (!state.Result.Ok() && error != StartupError::ToolchainMissing) return;
+            state.Result.Error = error;
+            state.Result.Problem = problem;
+        }
+
+        // co_await Stage(...) runs fn on the pool and records how long it took there.
+        // fn captures by reference only, for the GCC 12 problem described at WhenAll.
+        template <typename Fn>
+        static auto Stage(State& state, const char* name, Fn fn) {
+            return state.Loop.Offload(state.Pool, [&state, name, fn = std::move(fn)]() mutable {
+                UEBUILDER_PROFILE_SCOPE(name);
+                double start = state.Elapsed();
+                auto result = fn();
+                state.Record(name, start, state.Elapsed() - start);
+                return result;
+            });
+        }
+
+        static Task<> DiscoverToolchains(State& state) {
+            if (!state.NeedsToolchain) co_return;
+            state.Inventory = co_await Stage(state, "toolchain discovery", []() { return ToolchainManager::Discover(); });
+#ifdef _WIN32
+            // Other platforms build with the engine's bundled clang or Xcode
+            if (state.Inventory.Msvc.empty()) Fail(state, StartupError::ToolchainMissing);
+#endif
+        }
+
+        struct LocatedProject {
+            fs::path Target;
+            bool IsDirectory = false;
+            std::wstring Project;
+            bool Exists = false;
+        };
+
+        static Task<> LocateProject(State& state) {
+            StartupResult& result = state.Result;
+            LocatedProject located = co_await Stage(state, "project lookup", [&state]() {
+                LocatedProject out;
+                // Trim, strip drag-and-drop quotes, repair the drive prefix, forward slashes
+                out.Target = fs::path(ProjectLocator::SanitizeInputPath(state.Options.Project));
+                out.Project = ProjectLocator::ResolveProjectFile(out.Target);
+                std::error_code ec;
+                out.IsDirectory = fs::is_directory(out.Target, ec);
+                out.Exists = !out.Project.empty() && fs::exists(out.Project, ec);
+                return out;
+            });
+            result.TargetPath = located.Target;
+            result.TargetIsDirectory = located.IsDirectory;
+            result.ProjectPath = located.Project;
+            if (!located.Exists) {
+                Fail(state, StartupError::ProjectNotFound);
+                co_return;
+            }
+
+            Task<> engine = FindEngine(state);
+            Task<> prefetchList = LoadPrefetchList(state);
+            co_await WhenAll(engine, prefetchList);
+
+            // Nothing recorded from an earlier build: warm the engine's headers and tools instead
+            PagePrefetcher* prefetcher = state.Options.Prefetcher;
+            if (prefetcher && prefetcher->FileCount() == 0 && result.Engine.IsValid) {
+                std::vector<fs::path> seed = co_await Stage(state, "prefetch seed", [&result]() {
+                    return PrefetchList::Seed(result.Engine.RootPath, result.Engine.UBTPath);
+                });
+                if (!seed.empty()) {
+                    prefetcher->Start(std::move(seed));
+                    result.PrefetchSource = "engine headers and tools";
+                }
+            }
+        }
+
+        static Task<> LoadPrefetchList(State& state) {
+            PagePrefetcher* prefetcher = state.Options.Prefetcher;
+            if (!prefetcher || prefetcher->FileCount() > 0) co_return;
+            std::vector<fs::path> files = co_await Stage(state, "prefetch list", [&state]() {
+                return PrefetchList::Load(state.Result.ProjectPath);
+            });
+            if (files.empty()) co_return;
+            prefetcher->Start(std::move(files));
+            state.Result.PrefetchSource = "files read by the last build";
+        }
+
+        static Task<> FindEngine(State& state) {
+            StartupResult& result = state.Result;
+            result.Association = co_await Stage(state, "project parse", [&result]() {
+                return EngineDetector::GetEngineAssociation(result.ProjectPath);
+            });
+            Task<> engine = LookUpEngine(state);
+            Task<> revision = ComputeRevision(state);
+            co_await WhenAll(engine, revision);
+        }
+
+        static Task<> LookUpEngine(State& state) {
+            if (!state.Options.NeedsEngine) co_return;
+            StartupResult& result = state.Result;
+            result.Engine = co_await Stage(state, "engine lookup", [&state]() {
+                return EngineDetector::FindEngine(state.Result.Association, state.Options.EngineRoot);
+            });
+            if (!result.Engine.IsValid) {
+                Fail(state, StartupError::EngineNotFound);
+                co_return;
+            }
+            if (!state.NeedsToolchain) co_return;
+            state.Requirements = co_await Stage(state, "engine requirements", [&result]() {
+                return ToolchainManager::GetRequirements(result.Engine.RootPath, result.Engine.Version);
+            });
+        }
+
+        // Hashes the project's sources, so it runs beside the engine lookup instead of after it
+        static Task<> ComputeRevision(State& state) {
+            if (!state.Options.ComputeRevision) co_return;
+            BuildRequest& request = state.Options.Request;
+            request.ProjectPath = state.Result.ProjectPath;
+            state.Result.PrebuiltRevision = co_await Stage(state, "prebuilt revision", [&state]() {
+                const BuildRequest& request = state.Options.Request;
+                return PrebuiltCache::ComputeRevision(request.ProjectPath, state.Result.Association, BuildCommand::GetBuildTarget(request),
+                                                      request.Platform, request.Config);
+            });
+        }
+
+        // The compiler this engine version wants, out of everything installed
+        static Task<> SelectToolchain(State& state) {
+            if (!state.NeedsToolchain) co_return;
+            StartupResult& result = state.Result;
+            result.Toolchain = co_await Stage(state, "toolchain selection", [&state]() {
+                return ToolchainManager::Select(state.Inventory, state.Requirements, state.Result.Engine.RootPath);
+            });
+            result.ToolchainSelected = true;
+
+            if (!result.Toolchain.IsValid) {
+#ifdef _WIN32
+                Fail(state, StartupError::NoMatchingToolchain, result.Toolchain.Problem);
+#endif
+                // Elsewhere UBT can still find one we don't know about (e.g. under a custom UE_SDKS_ROOT layout)
+                co_return;
+            }
+
+            struct Captured {
+                EnvironmentBlock Environment;
+                std::string Log;
+            };
+            Captured captured = co_await Stage(state, "build environment", [&result]() {
+                Captured out;
+                out.Environment = ToolchainEnvironment::ForBuild(result.Toolchain, [&out](const std::string& line) { out.Log += line; });
+                return out;
+            });
+            result.Environment = std::move(captured.Environment);
+            result.EnvironmentLog = std::move(captured.Log);
+        }
+    };
+}
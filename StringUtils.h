@@ -0,0 +1,111 @@
+#pragma once
+#include <string>
+#include <filesystem>
+#include <cstdint>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // Portable UTF-8 <-> wide conversions.
+    // wchar_t is UTF-16 on Windows and UTF-32 elsewhere, so we handle both here
+    // instead of relying on WideCharToMultiByte (Windows only) or <codecvt> (deprecated).
+    class StringUtils {
+    public:
+        static std::string ToUtf8(const std::wstring& wstr) {
+            std::string out;
+            out.reserve(wstr.size());
+
+            for (size_t i = 0; i < wstr.size(); ++i) {
+                uint32_t cp = static_cast<uint32_t>(wstr[i]);
+
+                // Join UTF-16 surrogate pairs
+                if (sizeof(wchar_t) == 2 && cp >= 0xD800 && cp <= 0xDBFF && i + 1 < wstr.size()) {
+                    uint32_t low = static_cast<uint32_t>(wstr[i + 1]);
+                    if (low >= 0xDC00 && low <= 0xDFFF) {
+                        cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        ++i;
+                    }
+                }
+
+                AppendUtf8(out, cp);
+            }
+            return out;
+        }
+
+        static std::wstring FromUtf8(const std::string& str) {
+            std::wstring out;
+            out.reserve(str.size());
+
+            size_t i = 0;
+            while (i < str.size()) {
+                unsigned char c = static_cast<unsigned char>(str[i]);
+                uint32_t cp = 0;
+                size_t extra = 0;
+
+                if (c < 0x80) { cp = c; }
+                else if ((c & 0xE0) == 0xC0) { cp = c & 0x1F; extra = 1; }
+                else if ((c & 0xF0) == 0xE0) { cp = c & 0x0F; extra = 2; }
+                else if ((c & 0xF8) == 0xF0) { cp = c & 0x07; extra = 3; }
+                else { cp = 0xFFFD; } // Invalid lead byte
+
+                if (extra && i + extra >= str.size()) {
+                    // Truncated sequence at the end of the input
+                    out.push_back(static_cast<wchar_t>(0xFFFD));
+                    break;
+                }
+
+                for (size_t k = 1; k <= extra; ++k) {
+                    cp = (cp << 6) | (static_cast<unsigned char>(str[i + k]) & 0x3F);
+                }
+                i += extra + 1;
+
+                if (sizeof(wchar_t) == 2 && cp >= 0x10000) {
+                    cp -= 0x10000;
+                    out.push_back(static_cast<wchar_t>(0xD800 + (cp >> 10)));
+                    out.push_back(static_cast<wchar_t>(0xDC00 + (cp & 0x3FF)));
+                }
+                else {
+                    out.push_back(static_cast<wchar_t>(cp));
+                }
+            }
+            return out;
+        }
+
+        // fs::path::u8string() changes its return type in C++20, so go through wstring
+        static std::string PathToUtf8(const fs::path& path) {
+            return ToUtf8(path.wstring());
+        }
+
+        static fs::path PathFromUtf8(const std::string& str) {
+            return fs::path(FromUtf8(str));
+        }
+
+        // Relative path with forward slashes, used as a stable key in manifests and reports
+        static std::string GenericRelative(const fs::path& path, const fs::path& base) {
+            return ToUtf8(path.lexically_relative(base).generic_wstring());
+        }
+
+    private:
+        static void AppendUtf8(std::string& out, uint32_t cp) {
+            if (cp < 0x80) {
+                out.push_back(static_cast<char>(cp));
+            }
+            else if (cp < 0x800) {
+                out.push_back(static_cast<char>(0xC0 | (cp >> 6)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else if (cp < 0x10000) {
+                out.push_back(static_cast<char>(0xE0 | (cp >> 12)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+            else {
+                out.push_back(static_cast<char>(0xF0 | (cp >> 18)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 12) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | ((cp >> 6) & 0x3F)));
+                out.push_back(static_cast<char>(0x80 | (cp & 0x3F)));
+            }
+        }
+    };
+}
@@ -0,0 +1,165 @@
+#pragma once
+#ifdef _WIN32
+#include "ProcessUtils.h"
+#else
+#include <unistd.h>
+#include <fstream>
+#endif
+
+#include "StringUtils.h"
+#include "HashUtils.h"
+#include <string>
+#include <filesystem>
+#include <thread>
+#include <cstdint>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // The hardware a build ran on. Machines with the same CPU, thread count and RAM
+    // share an Id, so tuning results carry over between identical build agents.
+    struct MachineProfile {
+        std::string HostName;
+        std::string Cpu;
+        int LogicalCores = 1;
+        uint64_t MemoryBytes = 0;
+
+        std::string Id() const {
+            std::string cpu;
+            for (char c : Cpu) {
+                if (std::isalnum(static_cast<unsigned char>(c))) cpu += c;
+                else if (!cpu.empty() && cpu.back() != '-') cpu += '-';
+            }
+            while (!cpu.empty() && cpu.back() == '-') cpu.pop_back();
+            if (cpu.size() > 48) {
+                // Keep file names short but distinct
+                uint8_t hash[4];
+                uint64_t full = HashUtils::Fnv1a64(Cpu);
+                for (int i = 0; i < 4; ++i) hash[i] = static_cast<uint8_t>(full >> (8 * i));
+                cpu = cpu.substr(0, 40) + "-" + HashUtils::ToHex(hash, 4);
+            }
+            if (cpu.empty()) cpu = "UnknownCPU";
+
+            uint64_t gigabytes = (MemoryBytes + (512ull << 20)) >> 30; // Round to whole GB
+            return cpu + "-" + std::to_string(LogicalCores) + "t-" + std::to_string(gigabytes) + "GB";
+        }
+    };
+
+    // Memory available right now. On Windows the commit limit matters as much as RAM:
+    // MSVC's out-of-heap errors (C1060/C3859) come from running out of commit, not pages.
+    struct MemoryStatus {
+        uint64_t TotalBytes = 0;
+        uint64_t AvailableBytes = 0;
+        uint64_t CommitLimitBytes = 0;
+        uint64_t CommitAvailableBytes = 0;
+        double PressureAvg10 = -1.0;    // Linux PSI "some avg10" in percent, -1 if unsupported
+
+        // The tighter of RAM and commit, as a fraction
+        double FreeFraction() const {
+            double free = TotalBytes ? static_cast<double>(AvailableBytes) / TotalBytes : 1.0;
+            if (CommitLimitBytes) free = (std::min)(free, static_cast<double>(CommitAvailableBytes) / CommitLimitBytes);
+            return free;
+        }
+    };
+
+    class SystemInfo {
+    public:
+        static MachineProfile GetMachineProfile() {
+            MachineProfile profile;
+            profile.LogicalCores = (std::max)(1u, std::thread::hardware_concurrency());
+            profile.MemoryBytes = GetTotalMemory();
+#ifdef _WIN32
+            WCHAR name[256];
+            DWORD nameSize = 256;
+            if (GetComputerNameW(name, &nameSize)) profile.HostName = StringUtils::ToUtf8(std::wstring(name, nameSize));
+
+            profile.Cpu = StringUtils::ToUtf8(ProcessUtils::ReadRegistryString(
+                HKEY_LOCAL_MACHINE, L"HARDWARE\\DESCRIPTION\\System\\CentralProcessor\\0", L"ProcessorNameString"));
+#else
+            char name[256] = {};
+            if (gethostname(name, sizeof(name) - 1) == 0) profile.HostName = name;
+
+            std::ifstream cpuinfo("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(cpuinfo, line)) {
+                if (line.compare(0, 10, "model name") != 0) continue;
+                size_t colon = line.find(':');
+                if (colon != std::string::npos) profile.Cpu = line.substr(colon + 1);
+                break;
+            }
+#endif
+            // Trim the padding some vendors put in the brand string
+            profile.Cpu.erase(0, (std::min)(profile.Cpu.size(), profile.Cpu.find_first_not_of(" \t")));
+            while (!profile.Cpu.empty() && (profile.Cpu.back() == ' ' || profile.Cpu.back() == '\t')) profile.Cpu.pop_back();
+            return profile;
+        }
+
+        static uint64_t GetTotalMemory() {
+#ifdef _WIN32
+            MEMORYSTATUSEX status;
+            status.dwLength = sizeof(status);
+            if (GlobalMemoryStatusEx(&status)) return static_cast<uint64_t>(status.ullTotalPhys);
+            return 0;
+#else
+            long pages = sysconf(_SC_PHYS_PAGES);
+            long pageSize = sysconf(_SC_PAGE_SIZE);
+            if (pages <= 0 || pageSize <= 0) return 0;
+            return static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize);
+#endif
+        }
+
+        static MemoryStatus GetMemoryStatus() {
+            MemoryStatus status;
+#ifdef _WIN32
+            MEMORYSTATUSEX memory;
+            memory.dwLength = sizeof(memory);
+            if (GlobalMemoryStatusEx(&memory)) {
+                status.TotalBytes = memory.ullTotalPhys;
+                status.AvailableBytes = memory.ullAvailPhys;
+                status.CommitLimitBytes = memory.ullTotalPageFile;
+                status.CommitAvailableBytes = memory.ullAvailPageFile;
+            }
+#else
+            std::ifstream meminfo("/proc/meminfo");
+            std::string key;
+            uint64_t kilobytes = 0;
+            std::string unit;
+            while (meminfo >> key >> kilobytes) {
+                if (key == "MemTotal:") status.TotalBytes = kilobytes * 1024;
+                else if (key == "MemAvailable:") status.AvailableBytes = kilobytes * 1024;
+                std::getline(meminfo, unit);
+            }
+
+            // "some avg10=1.23 avg60=... total=..." (kernel 4.20+)
+            std::ifstream pressure("/proc/pressure/memory");
+            std::string line;
+            if (std::getline(pressure, line)) {
+                size_t at = line.find("avg10=");
+                if (line.compare(0, 5, "some ") == 0 && at != std::string::npos) {
+                    status.PressureAvg10 = std::strtod(line.c_str() + at + 6, nullptr);
+                }
+            }
+#endif
+            return status;
+        }
+
+        // Per-user folder for tool data that is not tied to one project
+        // (%LOCALAPPDATA%\UEBuilder, or $XDG_DATA_HOME/UEBuilder / ~/.local/share/UEBuilder)
+        static fs::path GetUserDataDir() {
+#ifdef _WIN32
+            std::wstring base = ProcessUtils::GetEnvVar(L"LOCALAPPDATA");
+            if (!base.empty()) return fs::path(base) / "UEBuilder";
+#else
+            const char* xdg = std::getenv("XDG_DATA_HOME");
+            if (xdg && *xdg) return fs::path(xdg) / "UEBuilder";
+            const char* home = std::getenv("HOME");
+            if (home && *home) return fs::path(home) / ".local" / "share" / "UEBuilder";
+#endif
+            return fs::temp_directory_path() / "UEBuilder";
+        }
+    };
+}
@@ -0,0 +1,219 @@
+#pragma once
+#include "ToolchainManager.h"
+#include "ProcessUtils.h"
+#include "StringUtils.h"
+#include "HashUtils.h"
+#include "JsonUtils.h"
+#include "SystemInfo.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cwctype>
+#include <algorithm>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    // One variable a toolchain sets. Prepend ones (PATH, INCLUDE, LIB...) only hold the part
+    // the toolchain puts in front, so they apply on top of whatever the machine has.
+    struct ToolchainVariable {
+        std::wstring Name;
+        std::wstring Value;
+        bool Prepend = false;
+    };
+
+    // The environment builds run in: this process's environment, sorted, with the selected
+    // toolchain's variables applied and PATH-style lists de-duplicated.
+    //
+    // On Windows the toolchain's variables are what vcvarsall.bat sets for the selected MSVC
+    // toolset and SDK. Running it takes seconds, so it is captured once per toolset/SDK pair
+    // and kept in the user data folder until vcvarsall.bat or the toolset changes. For clang
+    // they follow from the selection itself: LINUX_MULTIARCH_ROOT pins a UE toolchain, and a
+    // system clang's folder goes first on PATH.
+    class ToolchainEnvironment {
+    public:
+        static EnvironmentBlock ForBuild(const ToolchainSelection& toolchain, LogCallback onLog = nullptr) {
+            UEBUILDER_PROFILE_SCOPE("ToolchainEnvironment::ForBuild");
+            EnvironmentBlock environment = EnvironmentBlock::Current();
+            for (const auto& variable : GetVariables(toolchain, onLog)) {
+                std::wstring value = variable.Value;
+                if (variable.Prepend) {
+                    std::wstring current = environment.Get(variable.Name);
+                    if (!current.empty()) value += ListSeparator + current;
+                }
+                environment.Set(variable.Name, variable.Prepend ? UniqueList(value) : value);
+            }
+            return environment;
+        }
+
+        static std::vector<ToolchainVariable> GetVariables(const ToolchainSelection& toolchain, LogCallback onLog = nullptr) {
+            std::vector<ToolchainVariable> variables;
+#ifdef _WIN32
+            if (toolchain.HasMsvc) variables = GetMsvcVariables(toolchain, onLog);
+#else
+            (void)onLog;
+#endif
+            if (toolchain.HasClang) {
+                if (!toolchain.Clang.Name.empty()) {
+                    // <root>/x86_64-unknown-linux-gnu/bin/clang++
+                    fs::path root = toolchain.Clang.Compiler.parent_path().parent_path().parent_path();
+                    variables.push_back({ L"LINUX_MULTIARCH_ROOT", root.wstring(), false });
+                }
+#ifndef _WIN32
+                else {
+                    variables.push_back({ L"PATH", toolchain.Clang.Compiler.parent_path().wstring(), true });
+                }
+#endif
+            }
+            return variables;
+        }
+
+    private:
+#ifdef _WIN32
+        static constexpr wchar_t ListSeparator = L';';
+#else
+        static constexpr wchar_t ListSeparator = L':';
+#endif
+
+        // Drops repeated entries, keeping the first; also empty ones
+        static std::wstring UniqueList(const std::wstring& list) {
+            std::vector<std::wstring> seen;
+            std::wstring out;
+            size_t begin = 0;
+            while (begin <= list.size()) {
+                size_t end = list.find(ListSeparator, begin);
+                if (end == std::wstring::npos) end = list.size();
+                std::wstring entry = list.substr(begin, end - begin);
+                begin = end + 1;
+
+                std::wstring key = entry;
+#ifdef _WIN32
+                for (auto& c : key) c = static_cast<wchar_t>(towlower(c));
+                while (key.size() > 3 && (key.back() == L'\\' || key.back() == L'/')) key.pop_back();
+#endif
+                if (entry.empty() || std::find(seen.begin(), seen.end(), key) != seen.end()) continue;
+                seen.push_back(key);
+                if (!out.empty()) out += ListSeparator;
+                out += entry;
+            }
+            return out;
+        }
+
+#ifdef _WIN32
+        static std::vector<ToolchainVariable> GetMsvcVariables(const ToolchainSelection& toolchain, LogCallback onLog) {
+            fs::path vcvarsall = toolchain.Msvc.InstallPath / "VC" / "Auxiliary" / "Build" / "vcvarsall.bat";
+            std::string key = CacheKey(toolchain, vcvarsall);
+            fs::path cachePath = SystemInfo::GetUserDataDir() / "Environments" /
+                                 ("msvc-" + toolchain.Msvc.Version + "-sdk-" + toolchain.Sdk.Version + ".json");
+
+            std::vector<ToolchainVariable> variables;
+            bool cached = Load(cachePath, key, variables);
+            Metrics::CacheLookup("environment", cached);
+            if (cached) return variables;
+
+            if (onLog) onLog("[Toolchain] Capturing the MSVC " + toolchain.Msvc.Version + " environment (once per toolset)...\n");
+            if (!Capture(vcvarsall, toolchain, variables)) {
+                if (onLog) onLog("[Warning] vcvarsall.bat failed; building with the current environment\n");
+                return {};
+            }
+            Save(cachePath, key, variables);
+            return variables;
+        }
+
+        // vcvarsall.bat and the toolset folder change with every VS update that touches them
+        static std::string CacheKey(const ToolchainSelection& toolchain, const fs::path& vcvarsall) {
+            std::string key = StringUtils::PathToUtf8(toolchain.Msvc.Root) + "|" + toolchain.Sdk.Version;
+            for (const fs::path& path : { vcvarsall, toolchain.Msvc.Root }) {
+                std::error_code ec;
+                auto time = fs::last_write_time(path, ec);
+                key += "|" + (ec ? std::string("-") : std::to_string(time.time_since_epoch().count()));
+            }
+            char hex[24];
+            std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(HashUtils::Fnv1a64(key)));
+            return hex;
+        }
+
+        // Runs vcvarsall and then "set" in one cmd, and keeps what differs from our own environment.
+        // cmd /u makes "set" write UTF-16, so paths outside the ANSI code page survive.
+        static bool Capture(const fs::path& vcvarsall, const ToolchainSelection& toolchain, std::vector<ToolchainVariable>& variables) {
+            std::wstring args = L"/d /u /s /c \"\"" + vcvarsall.wstring() + L"\" x64 " + StringUtils::FromUtf8(toolchain.Sdk.Version) +
+                                L" -vcvars_ver=" + StringUtils::FromUtf8(toolchain.Msvc.Version) + L" >nul 2>&1 && set\"";
+            std::string bytes;
+            if (!ProcessUtils::RunProcess(L"cmd.exe", args, L"", [&bytes](const std::string& chunk) { bytes += chunk; })) return false;
+
+            std::wstring text(bytes.size() / 2, L'\0');
+            for (size_t i = 0; i < text.size(); ++i) {
+                text[i] = static_cast<wchar_t>(static_cast<unsigned char>(bytes[2 * i]) | (static_cast<unsigned char>(bytes[2 * i + 1]) << 8));
+            }
+
+            EnvironmentBlock before = EnvironmentBlock::Current();
+            size_t begin = 0;
+            while (begin < text.size()) {
+                size_t end = text.find(L"\r\n", begin);
+                if (end == std::wstring::npos) end = text.size();
+                std::wstring line = text.substr(begin, end - begin);
+                begin = end + 2;
+
+                size_t equals = line.find(L'=', 1);
+                if (equals == std::wstring::npos) continue;
+                std::wstring name = line.substr(0, equals);
+                std::wstring value = line.substr(equals + 1);
+                std::wstring old = before.Get(name);
+                if (value == old) continue;
+
+                // vcvarsall puts its folders in front of the existing list
+                if (!old.empty() && value.size() > old.size() && value.compare(value.size() - old.size(), old.size(), old) == 0) {
+                    std::wstring added = value.substr(0, value.size() - old.size());
+                    while (!added.empty() && added.back() == L';') added.pop_back();
+                    variables.push_back({ name, added, true });
+                }
+                else {
+                    variables.push_back({ name, value, false });
+                }
+            }
+            return !variables.empty();
+        }
+
+        static bool Load(const fs::path& path, const std::string& key, std::vector<ToolchainVariable>& variables) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) return false;
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+            bool ok = false;
+            JsonValue root = JsonValue::Parse(text, &ok);
+            if (!ok || root["Key"].AsString() != key) return false;
+            for (const auto& item : root["Variables"].Items()) {
+                variables.push_back({ StringUtils::FromUtf8(item["Name"].AsString()), StringUtils::FromUtf8(item["Value"].AsString()),
+                                      item["Prepend"].AsBool() });
+            }
+            return true;
+        }
+
+        static bool Save(const fs::path& path, const std::string& key, const std::vector<ToolchainVariable>& variables) {
+            JsonValue list = JsonValue::MakeArray();
+            for (const auto& variable : variables) {
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("Name", StringUtils::ToUtf8(variable.Name));
+                item.Set("Value", StringUtils::ToUtf8(variable.Value));
+                item.Set("Prepend", variable.Prepend);
+                list.Push(item);
+            }
+            JsonValue root = JsonValue::MakeObject();
+            root.Set("Key", key);
+            root.Set("Variables", list);
+
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file << root.Dump(2);
+            return static_cast<bool>(file);
+        }
+#endif
+    };
+}
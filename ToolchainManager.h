@@ -1,40 +1,397 @@
 #pragma once
 #include "ProcessUtils.h"
+#include "StringUtils.h"
+#include "HashUtils.h"
+#include "JsonUtils.h"
+#include "SystemInfo.h"
+#include "BuildConfigurationFile.h"
+#include "Downloader.h"
+#include "Profiler.h"
+#include "Metrics.h"
+#include "Log.h"
 #include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
 
 namespace UEBuilder {
 
     namespace fs = std::filesystem; // Define fs namespace alias here for clarity
 
+    // Dotted numeric version: "14.38.33130", "10.0.22621.0", "16.0.6".
+    // Missing trailing parts compare as 0, so "14.38" == "14.38.0".
+    struct ToolVersion {
+        std::vector<int> Parts;
+
+        // Reads the leading digits and dots; "16.0.6-centos7" -> 16.0.6
+        static ToolVersion Parse(const std::string& text) {
+            ToolVersion version;
+            size_t i = 0;
+            while (i < text.size() && text[i] >= '0' && text[i] <= '9') {
+                int value = 0;
+                while (i < text.size() && text[i] >= '0' && text[i] <= '9') value = value * 10 + (text[i++] - '0');
+                version.Parts.push_back(value);
+                if (i + 1 < text.size() && text[i] == '.' && text[i + 1] >= '0' && text[i + 1] <= '9') ++i;
+                else break;
+            }
+            return version;
+        }
+
+        bool IsValid() const { return !Parts.empty(); }
+
+        int Compare(const ToolVersion& other) const {
+            size_t count = std::max(Parts.size(), other.Parts.size());
+            for (size_t i = 0; i < count; ++i) {
+                int a = i < Parts.size() ? Parts[i] : 0;
+                int b = i < other.Parts.size() ? other.Parts[i] : 0;
+                if (a != b) return a < b ? -1 : 1;
+            }
+            return 0;
+        }
+
+        // "14.38" matches every 14.38.x
+        bool Matches(const ToolVersion& prefix) const {
+            if (prefix.Parts.size() > Parts.size()) return false;
+            return std::equal(prefix.Parts.begin(), prefix.Parts.end(), Parts.begin());
+        }
+
+        std::string ToString() const {
+            std::string out;
+            for (size_t i = 0; i < Parts.size(); ++i) {
+                if (i) out += '.';
+                out += std::to_string(Parts[i]);
+            }
+            return out;
+        }
+
+        bool operator<(const ToolVersion& other) const { return Compare(other) < 0; }
+    };
+
+    // "14.38.33130-14.38.99999", or a single version meaning exactly that one
+    struct ToolVersionRange {
+        ToolVersion Min;
+        ToolVersion Max;
+
+        static ToolVersionRange Parse(const std::string& text) {
+            ToolVersionRange range;
+            size_t dash = text.find('-');
+            range.Min = ToolVersion::Parse(text.substr(0, dash));
+            range.Max = dash == std::string::npos ? range.Min : ToolVersion::Parse(text.substr(dash + 1));
+            return range;
+        }
+
+        bool Contains(const ToolVersion& version) const {
+            return Min.IsValid() && version.Compare(Min) >= 0 && (!Max.IsValid() || version.Compare(Max) <= 0);
+        }
+    };
+
+    struct VisualStudioInstance {
+        fs::path InstallPath;
+        std::string Product;    // "Visual Studio 2022 Professional"
+        std::string Version;    // installationVersion, e.g. "17.8.34330.188"
+    };
+
+    struct MsvcToolset {
+        std::string Version;    // "14.38.33130"
+        fs::path Root;          // <VS>/VC/Tools/MSVC/14.38.33130
+        fs::path InstallPath;   // The Visual Studio instance it belongs to
+        std::string Product;
+    };
+
+    struct WindowsSdk {
+        std::string Version;    // "10.0.22621.0"
+        fs::path Root;          // Windows Kits/10
+    };
+
+    struct ClangToolchain {
+        std::string Version;    // "16.0.6"
+        std::string Name;       // UE toolchain folder ("v22_clang-16.0.6-centos7"), empty for system clang
+        fs::path Compiler;      // clang++
+        std::string Source;     // LINUX_MULTIARCH_ROOT, UE_SDKS_ROOT, engine or system
+    };
+
+    // Everything installed on this machine; independent of any engine
+    struct ToolchainInventory {
+        std::vector<VisualStudioInstance> Instances;
+        std::vector<MsvcToolset> Msvc;      // Newest first
+        std::vector<WindowsSdk> Sdks;       // Newest first
+        std::vector<ClangToolchain> Clang;
+    };
+
+    // What an engine asks for: Engine/Config/Windows/Windows_SDK.json and Linux/Linux_SDK.json,
+    // then the user's BuildConfiguration.xml pins (WindowsPlatform CompilerVersion/WindowsSdkVersion)
+    struct ToolchainRequirements {
+        ToolVersion MinMsvc;
+        std::vector<ToolVersionRange> PreferredMsvc;
+        ToolVersion PinnedMsvc;
+        bool LatestMsvc = false;
+        ToolVersion MinSdk;
+        ToolVersion MaxSdk;
+        ToolVersion PinnedSdk;
+        std::string LinuxToolchain;         // Linux_SDK.json MainVersion
+        ToolVersion MinClang;
+        ToolVersion MaxClang;
+        std::string Source;                 // Where MinMsvc came from, for messages
+    };
+
+    struct ToolchainSelection {
+        bool IsValid = false;
+        bool HasMsvc = false;
+        bool HasClang = false;
+        MsvcToolset Msvc;
+        WindowsSdk Sdk;
+        ClangToolchain Clang;
+        std::string Problem;    // Why IsValid is false
+
+        std::string Describe() const {
+            std::string out;
+            if (HasMsvc) {
+                out = "MSVC " + Msvc.Version + " (" + Msvc.Product + ")";
+                if (!Sdk.Version.empty()) out += ", Windows SDK " + Sdk.Version;
+            }
+            if (HasClang) {
+                if (!out.empty()) out += ", Linux ";
+                out += "clang " + Clang.Version + " (" + (Clang.Name.empty() ? Clang.Source : Clang.Source + " " + Clang.Name) + ")";
+            }
+            return out;
+        }
+    };
+
     class ToolchainManager {
     public:
-        // Checks if MSVC is generally available by looking for a known path
-        // Note: A robust check would query the VS Installer API, but checking path is easier for a learner
+        // Any usable MSVC toolset in any Visual Studio instance (Community, Professional,
+        // Enterprise, Build Tools, custom install folders, 2019 and later)
         bool IsMSVCInstalled() {
-            // Check a common default path for VS2022
-            // In a production app, we would use "vswhere.exe" to find this dynamically
-            fs::path defaultPath = "C:\\Program Files\\Microsoft Visual Studio\\2022\\Community\\VC\\Tools\\MSVC";
-            fs::path buildToolsPath = "C:\\Program Files (x86)\\Microsoft Visual Studio\\2022\\BuildTools\\VC\\Tools\\MSVC";
+            UEBUILDER_PROFILE_SCOPE("ToolchainManager::IsMSVCInstalled");
+            return !Discover().Msvc.empty();
+        }
 
-            return fs::exists(defaultPath) || fs::exists(buildToolsPath);
+        // The machine's compilers and SDKs. Enumerating them (and asking each system clang for
+        // its version) is only done when something changed since the last run: the result is
+        // kept in the user data folder with a fingerprint of the VS instance state files, the
+        // toolset and SDK folders and the variables that point at toolchains.
+        static ToolchainInventory Discover(bool refresh = false) {
+            UEBUILDER_PROFILE_SCOPE("ToolchainManager::Discover");
+            fs::path cachePath = SystemInfo::GetUserDataDir() / "toolchains.json";
+
+            ToolchainInventory cached;
+            std::string cachedFingerprint;
+            bool loaded = !refresh && LoadInventory(cachePath, cached, cachedFingerprint);
+            std::string fingerprint = loaded ? Fingerprint(cached) : std::string();
+            if (loaded && cachedFingerprint == fingerprint) {
+                Metrics::CacheLookup("toolchains", true);
+                Log::Debug("ToolchainManager", "Toolchain inventory unchanged", { { "cache", cachePath }, { "fingerprint", fingerprint } });
+                return cached;
+            }
+            Metrics::CacheLookup("toolchains", false);
+            Log::Debug("ToolchainManager", "Enumerating toolchains", { { "reason", refresh ? "refresh" : loaded ? "fingerprint changed" : "no cache" } });
+
+            ToolchainInventory inventory = Enumerate();
+            Log::Debug("ToolchainManager", "Toolchains found", { { "vs_instances", inventory.Instances.size() }, { "msvc", inventory.Msvc.size() },
+                                                                { "sdks", inventory.Sdks.size() }, { "clang", inventory.Clang.size() } });
+            if (!SaveInventory(cachePath, inventory, Fingerprint(inventory))) {
+                Log::Warning("ToolchainManager", "Cannot save the toolchain inventory; the next run enumerates again", { { "cache", cachePath } });
+            }
+            return inventory;
         }
 
-        void InstallTools() {
-            std::wcout << L"[Toolchain] MSVC not detected. Initiating Auto-Install..." << std::endl;
+        static ToolchainRequirements GetRequirements(const std::wstring& engineRoot, const std::wstring& engineVersion) {
+            UEBUILDER_PROFILE_SCOPE("ToolchainManager::GetRequirements");
+            ToolchainRequirements req;
+            fs::path config = fs::path(engineRoot) / "Engine" / "Config";
 
-            // 1. Download
-            std::wstring installerUrl = L"https://aka.ms/vs/17/release/vs_BuildTools.exe";
-            std::wstring installerPath = L"vs_BuildTools.exe"; // Save in current dir
+            bool ok = false;
+            JsonValue windowsSdk = JsonValue::Parse(ReadText(config / "Windows" / "Windows_SDK.json"), &ok);
+            if (ok) {
+                req.MinMsvc = ToolVersion::Parse(windowsSdk["MinimumVisualCppVersion"].AsString());
+                for (const auto& range : windowsSdk["PreferredVisualCppVersions"].Items()) {
+                    req.PreferredMsvc.push_back(ToolVersionRange::Parse(range.AsString()));
+                }
+                req.MinSdk = ToolVersion::Parse(windowsSdk["MinVersion"].AsString());
+                req.MaxSdk = ToolVersion::Parse(windowsSdk["MaxVersion"].AsString());
+                if (req.MinMsvc.IsValid()) req.Source = "Windows_SDK.json";
+            }
 
-            std::wcout << L"[Toolchain] Downloading installer..." << std::endl;
-            if (ProcessUtils::DownloadFile(installerUrl, installerPath)) {
-                std::wcout << L"[Toolchain] Download complete." << std::endl;
+            if (!req.MinMsvc.IsValid()) {
+                // Older engines don't list it; minimums from the release notes. Source builds
+                // associate by GUID, so the version comes from Build.version when it's there.
+                ToolVersion engine = ToolVersion::Parse(StringUtils::ToUtf8(engineVersion));
+                JsonValue build = JsonValue::Parse(ReadText(fs::path(engineRoot) / "Engine" / "Build" / "Build.version"), &ok);
+                if (ok && build["MajorVersion"].IsNumber()) {
+                    engine.Parts = { static_cast<int>(build["MajorVersion"].AsInt()), static_cast<int>(build["MinorVersion"].AsInt()) };
+                }
+                if (engine.Compare(ToolVersion::Parse("5.4")) >= 0) req.MinMsvc = ToolVersion::Parse("14.38");
+                else if (engine.Compare(ToolVersion::Parse("5.2")) >= 0) req.MinMsvc = ToolVersion::Parse("14.34");
+                else if (engine.Compare(ToolVersion::Parse("5.0")) >= 0) req.MinMsvc = ToolVersion::Parse("14.29");
+                if (req.MinMsvc.IsValid()) req.Source = "UE " + engine.ToString() + " release notes";
+                if (!req.MinSdk.IsValid() && engine.Compare(ToolVersion::Parse("5.0")) >= 0) req.MinSdk = ToolVersion::Parse("10.0.18362.0");
             }
-            else {
-                std::cerr << "[Error] Failed to download VS Build Tools." << std::endl;
-                return;
+
+            JsonValue linuxSdk = JsonValue::Parse(ReadText(config / "Linux" / "Linux_SDK.json"), &ok);
+            if (ok) {
+                req.LinuxToolchain = linuxSdk["MainVersion"].AsString();
+                req.MinClang = ClangVersionFromName(linuxSdk["MinVersion"].AsString());
+                req.MaxClang = ClangVersionFromName(linuxSdk["MaxVersion"].AsString());
+            }
+
+            BuildConfigurationFile buildConfig;
+            fs::path buildConfigPath = BuildConfigurationFile::GetUserPath();
+            if (!buildConfigPath.empty() && buildConfig.Load(buildConfigPath)) {
+                std::string compiler = buildConfig.Get("WindowsPlatform", "CompilerVersion");
+                if (compiler == "Latest") req.LatestMsvc = true;
+                else req.PinnedMsvc = ToolVersion::Parse(compiler);
+                req.PinnedSdk = ToolVersion::Parse(buildConfig.Get("WindowsPlatform", "WindowsSdkVersion"));
+            }
+            if (Log::Enabled(LogLevel::Debug)) {
+                Log::Debug("ToolchainManager", "Engine toolchain requirements", { { "engine", engineVersion }, { "min_msvc", req.MinMsvc.ToString() },
+                                                                                   { "source", req.Source }, { "pinned_msvc", req.PinnedMsvc.ToString() },
+                                                                                   { "min_sdk", req.MinSdk.ToString() }, { "linux_toolchain", req.LinuxToolchain } });
+            }
+            return req;
+        }
+
+        // Picks what UnrealBuildTool would: a pinned version when one is set, else the newest
+        // toolset in one of the engine's preferred ranges, else the newest at or above its minimum
+        static ToolchainSelection Select(const ToolchainInventory& inventory, const ToolchainRequirements& req, const std::wstring& engineRoot) {
+            UEBUILDER_PROFILE_SCOPE("ToolchainManager::Select");
+            ToolchainSelection selection;
+#ifdef _WIN32
+            selection.HasMsvc = SelectMsvc(inventory, req, selection);
+            if (selection.HasMsvc) SelectSdk(inventory, req, selection);
+            // Linux cross-compiling is optional on Windows
+            SelectClang(inventory, req, engineRoot, selection);
+            selection.IsValid = selection.HasMsvc && !selection.Sdk.Version.empty();
+#else
+            selection.IsValid = SelectClang(inventory, req, engineRoot, selection);
+            if (!selection.IsValid && selection.Problem.empty()) {
+                selection.Problem = "No clang toolchain found (run the engine's Setup.sh, set LINUX_MULTIARCH_ROOT or install clang)";
+            }
+#endif
+            if (Log::Enabled(LogLevel::Debug)) {
+                // Describe() builds a string, so only when someone is listening
+                if (selection.IsValid) Log::Debug("ToolchainManager", "Toolchain selected", { { "toolchain", selection.Describe() } });
+                else Log::Debug("ToolchainManager", "No usable toolchain", { { "problem", selection.Problem } });
+            }
+            return selection;
+        }
+
+        static ToolchainSelection SelectForEngine(const std::wstring& engineRoot, const std::wstring& engineVersion) {
+            return Select(Discover(), GetRequirements(engineRoot, engineVersion), engineRoot);
+        }
+
+        // --- Enumeration; each takes its root so it can be pointed anywhere ---
+
+        // One state.json per instance in ProgramData\Microsoft\VisualStudio\Packages\_Instances\<id>,
+        // which is what vswhere and the VS setup API read
+        static std::vector<VisualStudioInstance> FindVisualStudioInstances(const fs::path& instancesDir) {
+            std::vector<VisualStudioInstance> instances;
+            std::error_code ec;
+            for (fs::directory_iterator it(instancesDir, ec), end; !ec && it != end; it.increment(ec)) {
+                bool ok = false;
+                JsonValue state = JsonValue::Parse(ReadText(it->path() / "state.json"), &ok);
+                std::string installPath = state["installationPath"].AsString();
+                if (!ok || installPath.empty()) continue;
+
+                VisualStudioInstance instance;
+                instance.InstallPath = StringUtils::PathFromUtf8(installPath);
+                instance.Version = state["installationVersion"].AsString();
+                instance.Product = ProductName(state["product"]["id"].AsString(), state["catalogInfo"]["productLineVersion"].AsString());
+                instances.push_back(instance);
+            }
+            return instances;
+        }
+
+        // Toolsets with a 64-bit host compiler
+        static std::vector<MsvcToolset> FindMsvcToolsets(const VisualStudioInstance& instance) {
+            std::vector<MsvcToolset> toolsets;
+            std::error_code ec;
+            for (fs::directory_iterator it(instance.InstallPath / "VC" / "Tools" / "MSVC", ec), end; !ec && it != end; it.increment(ec)) {
+                std::string name = StringUtils::PathToUtf8(it->path().filename());
+                if (!ToolVersion::Parse(name).IsValid()) continue;
+                if (!fs::exists(it->path() / "bin" / "Hostx64" / "x64" / "cl.exe")) continue;
+
+                MsvcToolset toolset;
+                toolset.Version = name;
+                toolset.Root = it->path();
+                toolset.InstallPath = instance.InstallPath;
+                toolset.Product = instance.Product;
+                toolsets.push_back(toolset);
+            }
+            return toolsets;
+        }
+
+        // Windows Kits\10\Include\<version> with the headers and x64 import libraries both present
+        static std::vector<WindowsSdk> FindWindowsSdks(const fs::path& kitsRoot) {
+            std::vector<WindowsSdk> sdks;
+            std::error_code ec;
+            for (fs::directory_iterator it(kitsRoot / "Include", ec), end; !ec && it != end; it.increment(ec)) {
+                std::string name = StringUtils::PathToUtf8(it->path().filename());
+                if (name.compare(0, 3, "10.") != 0) continue;
+                if (!fs::exists(it->path() / "um" / "Windows.h")) continue;
+                if (!fs::exists(kitsRoot / "Lib" / name / "um" / "x64" / "kernel32.Lib")) continue;
+                sdks.push_back({ name, kitsRoot });
+            }
+            return sdks;
+        }
+
+        // UE toolchain folders: <root>/<v22_clang-16.0.6-centos7>/x86_64-unknown-linux-gnu/bin/clang++
+        static std::vector<ClangToolchain> FindLinuxToolchains(const fs::path& root, const std::string& source) {
+            std::vector<ClangToolchain> found;
+            std::error_code ec;
+            for (fs::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+                ClangToolchain toolchain;
+                if (!ReadLinuxToolchain(it->path(), source, toolchain)) continue;
+                found.push_back(toolchain);
+            }
+            return found;
+        }
+
+        // Where the Build Tools bootstrapper comes from, and its expected SHA-256. Microsoft updates
+        // the file behind the default link without notice, so there is no built-in checksum; set
+        // both to install from a mirror with a known file.
+        static constexpr const wchar_t* BootstrapperUrlEnvVar = L"UEBUILDER_VS_BOOTSTRAPPER_URL";
+        static constexpr const wchar_t* BootstrapperSha256EnvVar = L"UEBUILDER_VS_BOOTSTRAPPER_SHA256";
+
+        // Downloads the Build Tools bootstrapper (resuming a partial download) and runs it silently.
+        // Messages go to onLog when given, else to the console.
+        bool InstallTools(LogCallback onLog = nullptr) {
+            auto log = [&onLog](const std::string& line) {
+                if (onLog) onLog(line);
+                else std::cout << line << std::flush;
+            };
+            log("[Toolchain] MSVC not detected. Initiating Auto-Install...\n");
+
+            // 1. Download
+            std::string installerUrl = StringUtils::ToUtf8(ProcessUtils::GetEnvVar(BootstrapperUrlEnvVar));
+            if (installerUrl.empty()) installerUrl = "https://aka.ms/vs/17/release/vs_BuildTools.exe";
+            fs::path installerPath = SystemInfo::GetUserDataDir() / "Downloads" / "vs_BuildTools.exe";
+
+            DownloadOptions options;
+            options.Sha256 = StringUtils::ToUtf8(ProcessUtils::GetEnvVar(BootstrapperSha256EnvVar));
+            int lastTenth = -1;
+            options.OnProgress = [&](const DownloadProgress& progress) {
+                if (!onLog) {
+                    std::cout << "\r[Toolchain] Downloading installer: " << Downloader::FormatProgress(progress) << "   " << std::flush;
+                    return;
+                }
+                // A log panel gets a line per 10%, not one per tick
+                int tenth = progress.Total > 0 ? static_cast<int>(progress.Bytes * 10 / progress.Total) : 0;
+                if (tenth == lastTenth) return;
+                lastTenth = tenth;
+                onLog("[Toolchain] Downloading installer: " + Downloader::FormatProgress(progress) + "\n");
+            };
+
+            log("[Toolchain] Downloading installer...\n");
+            std::string error;
+            if (!Downloader::Download(installerUrl, installerPath, options, error)) {
+                log("\n[Error] Failed to download VS Build Tools: " + error + "\n");
+                return false;
             }
+            log(std::string(onLog ? "" : "\n") + "[Toolchain] Download complete.\n");
 
             // 2. Run Silent Install
             // Arguments strictly from your request
@@ -43,19 +400,390 @@ namespace UEBuilder {
                 L"--add Microsoft.VisualStudio.Component.Windows10SDK.19041 "
                 L"--includeRecommended";
 
-            std::wcout << L"[Toolchain] Installing... This may take a while. Do not close." << std::endl;
+            log("[Toolchain] Installing... This may take a while. Do not close.\n");
 
-            bool result = ProcessUtils::RunProcess(installerPath, args, L"", [](const std::string& log) {
-                // The bootstrapper might not output much to stdout, but we capture it anyway
-                std::cout << log;
-                });
+            // The bootstrapper might not output much to stdout, but we capture it anyway
+            bool result = ProcessUtils::RunProcess(installerPath.wstring(), args, L"", log);
 
             if (result) {
-                std::wcout << L"[Toolchain] Installation successful!" << std::endl;
+                log("[Toolchain] Installation successful!\n");
+                Discover(true);
             }
             else {
-                std::cerr << "[Error] Installation failed or cancelled." << std::endl;
+                log("[Error] Installation failed or cancelled.\n");
+            }
+            return result;
+        }
+
+    private:
+        static std::string ReadText(const fs::path& path) {
+            std::ifstream file(path, std::ios::binary);
+            if (!file.is_open()) return "";
+            std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+            if (text.compare(0, 3, "\xEF\xBB\xBF") == 0) text.erase(0, 3);
+            return text;
+        }
+
+        static std::string ProductName(const std::string& productId, const std::string& year) {
+            // "Microsoft.VisualStudio.Product.BuildTools"
+            std::string edition = productId.substr(productId.rfind('.') + 1);
+            if (edition == "BuildTools") edition = "Build Tools";
+            std::string name = "Visual Studio";
+            if (!year.empty()) name += " " + year;
+            if (!edition.empty()) name += " " + edition;
+            return name;
+        }
+
+        // "v22_clang-16.0.6-centos7" -> 16.0.6
+        static ToolVersion ClangVersionFromName(const std::string& name) {
+            size_t at = name.find("clang-");
+            return at == std::string::npos ? ToolVersion() : ToolVersion::Parse(name.substr(at + 6));
+        }
+
+        static fs::path ExecutableName(const char* name) {
+#ifdef _WIN32
+            return fs::path(std::string(name) + ".exe");
+#else
+            return fs::path(name);
+#endif
+        }
+
+        static bool ReadLinuxToolchain(const fs::path& dir, const std::string& source, ClangToolchain& toolchain) {
+            fs::path compiler = dir / "x86_64-unknown-linux-gnu" / "bin" / ExecutableName("clang++");
+            if (!fs::exists(compiler)) return false;
+            toolchain.Name = StringUtils::PathToUtf8(dir.filename());
+            toolchain.Version = ClangVersionFromName(toolchain.Name).ToString();
+            toolchain.Compiler = compiler;
+            toolchain.Source = source;
+            return true;
+        }
+
+        static fs::path VisualStudioInstancesDir() {
+            std::wstring programData = ProcessUtils::GetEnvVar(L"ProgramData");
+            fs::path base = programData.empty() ? fs::path("C:/ProgramData") : fs::path(programData);
+            return base / "Microsoft" / "VisualStudio" / "Packages" / "_Instances";
+        }
+
+        static fs::path WindowsKitsRoot() {
+#ifdef _WIN32
+            std::wstring root = ProcessUtils::ReadRegistryString(HKEY_LOCAL_MACHINE,
+                L"SOFTWARE\\Microsoft\\Windows Kits\\Installed Roots", L"KitsRoot10");
+            if (root.empty()) {
+                root = ProcessUtils::ReadRegistryString(HKEY_LOCAL_MACHINE,
+                    L"SOFTWARE\\WOW6432Node\\Microsoft\\Windows Kits\\Installed Roots", L"KitsRoot10");
+            }
+            if (!root.empty()) return fs::path(root);
+#endif
+            return fs::path("C:/Program Files (x86)/Windows Kits/10");
+        }
+
+        // Variables that point at toolchains; part of the fingerprint
+        static std::vector<std::wstring> ToolchainEnvVars() {
+            return { L"LINUX_MULTIARCH_ROOT", L"LINUX_ROOT", L"UE_SDKS_ROOT", L"PATH" };
+        }
+
+        static ToolchainInventory Enumerate() {
+            UEBUILDER_PROFILE_SCOPE("ToolchainManager::Enumerate");
+            ToolchainInventory inventory;
+#ifdef _WIN32
+            inventory.Instances = FindVisualStudioInstances(VisualStudioInstancesDir());
+            if (inventory.Instances.empty()) {
+                // No setup state (e.g. copied installs): the default install folders
+                for (const char* programFiles : { "C:/Program Files", "C:/Program Files (x86)" }) {
+                    for (const char* year : { "2026", "2022", "2019" }) {
+                        for (const char* edition : { "Enterprise", "Professional", "Community", "BuildTools" }) {
+                            fs::path path = fs::path(programFiles) / "Microsoft Visual Studio" / year / edition;
+                            if (!fs::exists(path / "VC" / "Tools" / "MSVC")) continue;
+                            inventory.Instances.push_back({ path, ProductName(edition, year), "" });
+                        }
+                    }
+                }
+            }
+            for (const auto& instance : inventory.Instances) {
+                auto toolsets = FindMsvcToolsets(instance);
+                inventory.Msvc.insert(inventory.Msvc.end(), toolsets.begin(), toolsets.end());
+            }
+            std::stable_sort(inventory.Msvc.begin(), inventory.Msvc.end(), [](const MsvcToolset& a, const MsvcToolset& b) {
+                return ToolVersion::Parse(b.Version) < ToolVersion::Parse(a.Version);
+            });
+
+            inventory.Sdks = FindWindowsSdks(WindowsKitsRoot());
+            std::sort(inventory.Sdks.begin(), inventory.Sdks.end(), [](const WindowsSdk& a, const WindowsSdk& b) {
+                return ToolVersion::Parse(b.Version) < ToolVersion::Parse(a.Version);
+            });
+#endif
+
+            // Cross-compile toolchain the engine itself looks for first
+            std::wstring multiArch = ProcessUtils::GetEnvVar(L"LINUX_MULTIARCH_ROOT");
+            ClangToolchain toolchain;
+            if (!multiArch.empty() && ReadLinuxToolchain(fs::path(multiArch), "LINUX_MULTIARCH_ROOT", toolchain)) {
+                inventory.Clang.push_back(toolchain);
+            }
+
+            std::wstring sdksRoot = ProcessUtils::GetEnvVar(L"UE_SDKS_ROOT");
+            if (!sdksRoot.empty()) {
+#ifdef _WIN32
+                fs::path hostDir = fs::path(sdksRoot) / "HostWin64" / "Linux_x64";
+#else
+                fs::path hostDir = fs::path(sdksRoot) / "HostLinux" / "Linux_x64";
+#endif
+                auto found = FindLinuxToolchains(hostDir, "UE_SDKS_ROOT");
+                inventory.Clang.insert(inventory.Clang.end(), found.begin(), found.end());
+            }
+
+#ifndef _WIN32
+            auto system = FindSystemClang();
+            inventory.Clang.insert(inventory.Clang.end(), system.begin(), system.end());
+#endif
+            return inventory;
+        }
+
+#ifndef _WIN32
+        // clang++ and clang++-<N> on PATH; the version comes from --version
+        static std::vector<ClangToolchain> FindSystemClang() {
+            std::vector<ClangToolchain> found;
+            std::vector<fs::path> seen;
+            std::string path = StringUtils::ToUtf8(ProcessUtils::GetEnvVar(L"PATH"));
+
+            size_t begin = 0;
+            while (begin <= path.size()) {
+                size_t end = path.find(':', begin);
+                if (end == std::string::npos) end = path.size();
+                fs::path dir = path.substr(begin, end - begin);
+                begin = end + 1;
+                if (dir.empty()) continue;
+
+                std::error_code ec;
+                for (fs::directory_iterator it(dir, ec), last; !ec && it != last; it.increment(ec)) {
+                    std::string name = it->path().filename().string();
+                    if (name != "clang++" && (name.compare(0, 8, "clang++-") != 0 || !ToolVersion::Parse(name.substr(8)).IsValid())) continue;
+
+                    // /usr/bin/clang++ is usually a link to one of the versioned ones
+                    fs::path target = fs::canonical(it->path(), ec);
+                    if (ec || std::find(seen.begin(), seen.end(), target) != seen.end()) { ec.clear(); continue; }
+                    seen.push_back(target);
+
+                    std::string output;
+                    ProcessUtils::RunProcess(it->path().wstring(), L"--version", L"", [&](const std::string& chunk) { output += chunk; });
+                    size_t at = output.find("clang version ");
+                    if (at == std::string::npos) continue;
+
+                    ClangToolchain toolchain;
+                    toolchain.Version = ToolVersion::Parse(output.substr(at + 14)).ToString();
+                    toolchain.Compiler = it->path();
+                    toolchain.Source = "system";
+                    found.push_back(toolchain);
+                }
+            }
+            std::stable_sort(found.begin(), found.end(), [](const ClangToolchain& a, const ClangToolchain& b) {
+                return ToolVersion::Parse(b.Version) < ToolVersion::Parse(a.Version);
+            });
+            return found;
+        }
+#endif
+
+        // Changes whenever an install, update or removal could have changed the inventory
+        static std::string Fingerprint(const ToolchainInventory& inventory) {
+            UEBUILDER_PROFILE_SCOPE("ToolchainManager::Fingerprint");
+            std::string key;
+            auto addStamp = [&key](const fs::path& path) {
+                std::error_code ec;
+                auto time = fs::last_write_time(path, ec);
+                key += StringUtils::PathToUtf8(path);
+                key += '|';
+                key += ec ? "-" : std::to_string(time.time_since_epoch().count());
+                key += '\n';
+            };
+
+#ifdef _WIN32
+            std::error_code ec;
+            for (fs::directory_iterator it(VisualStudioInstancesDir(), ec), end; !ec && it != end; it.increment(ec)) {
+                addStamp(it->path() / "state.json");
             }
+            for (const auto& instance : inventory.Instances) addStamp(instance.InstallPath / "VC" / "Tools" / "MSVC");
+            addStamp(WindowsKitsRoot() / "Include");
+#endif
+            for (const auto& toolchain : inventory.Clang) addStamp(toolchain.Compiler);
+            for (const auto& name : ToolchainEnvVars()) key += StringUtils::ToUtf8(name + L"=" + ProcessUtils::GetEnvVar(name)) + '\n';
+
+            char hex[24];
+            std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(HashUtils::Fnv1a64(key)));
+            return hex;
+        }
+
+        static bool LoadInventory(const fs::path& path, ToolchainInventory& inventory, std::string& fingerprint) {
+            UEBUILDER_PROFILE_SCOPE("ToolchainManager::LoadInventory");
+            bool ok = false;
+            JsonValue root = JsonValue::Parse(ReadText(path), &ok);
+            if (!ok) return false;
+
+            fingerprint = root["Fingerprint"].AsString();
+            for (const auto& item : root["Instances"].Items()) {
+                inventory.Instances.push_back({ StringUtils::PathFromUtf8(item["InstallPath"].AsString()),
+                                                item["Product"].AsString(), item["Version"].AsString() });
+            }
+            for (const auto& item : root["Msvc"].Items()) {
+                inventory.Msvc.push_back({ item["Version"].AsString(), StringUtils::PathFromUtf8(item["Root"].AsString()),
+                                           StringUtils::PathFromUtf8(item["InstallPath"].AsString()), item["Product"].AsString() });
+            }
+            for (const auto& item : root["Sdks"].Items()) {
+                inventory.Sdks.push_back({ item["Version"].AsString(), StringUtils::PathFromUtf8(item["Root"].AsString()) });
+            }
+            for (const auto& item : root["Clang"].Items()) {
+                inventory.Clang.push_back({ item["Version"].AsString(), item["Name"].AsString(),
+                                            StringUtils::PathFromUtf8(item["Compiler"].AsString()), item["Source"].AsString() });
+            }
+            return true;
+        }
+
+        static bool SaveInventory(const fs::path& path, const ToolchainInventory& inventory, const std::string& fingerprint) {
+            JsonValue instances = JsonValue::MakeArray();
+            for (const auto& instance : inventory.Instances) {
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("InstallPath", StringUtils::PathToUtf8(instance.InstallPath));
+                item.Set("Product", instance.Product);
+                item.Set("Version", instance.Version);
+                instances.Push(item);
+            }
+            JsonValue msvc = JsonValue::MakeArray();
+            for (const auto& toolset : inventory.Msvc) {
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("Version", toolset.Version);
+                item.Set("Root", StringUtils::PathToUtf8(toolset.Root));
+                item.Set("InstallPath", StringUtils::PathToUtf8(toolset.InstallPath));
+                item.Set("Product", toolset.Product);
+                msvc.Push(item);
+            }
+            JsonValue sdks = JsonValue::MakeArray();
+            for (const auto& sdk : inventory.Sdks) {
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("Version", sdk.Version);
+                item.Set("Root", StringUtils::PathToUtf8(sdk.Root));
+                sdks.Push(item);
+            }
+            JsonValue clang = JsonValue::MakeArray();
+            for (const auto& toolchain : inventory.Clang) {
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("Version", toolchain.Version);
+                item.Set("Name", toolchain.Name);
+                item.Set("Compiler", StringUtils::PathToUtf8(toolchain.Compiler));
+                item.Set("Source", toolchain.Source);
+                clang.Push(item);
+            }
+
+            JsonValue root = JsonValue::MakeObject();
+            root.Set("Fingerprint", fingerprint);
+            root.Set("Instances", instances);
+            root.Set("Msvc", msvc);
+            root.Set("Sdks", sdks);
+            root.Set("Clang", clang);
+
+            std::error_code ec;
+            fs::create_directories(path.parent_path(), ec);
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file << root.Dump(2);
+            return static_cast<bool>(file);
+        }
+
+        static bool SelectMsvc(const ToolchainInventory& inventory, const ToolchainRequirements& req, ToolchainSelection& selection) {
+            if (inventory.Msvc.empty()) {
+                selection.Problem = "No MSVC toolset found in any Visual Studio instance";
+                return false;
+            }
+
+            // Newest first, so the first match wins
+            if (req.PinnedMsvc.IsValid()) {
+                for (const auto& toolset : inventory.Msvc) {
+                    if (!ToolVersion::Parse(toolset.Version).Matches(req.PinnedMsvc)) continue;
+                    selection.Msvc = toolset;
+                    return true;
+                }
+                selection.Problem = "MSVC " + req.PinnedMsvc.ToString() + " (CompilerVersion in BuildConfiguration.xml) is not installed";
+                return false;
+            }
+
+            const MsvcToolset* newest = nullptr;
+            for (const auto& toolset : inventory.Msvc) {
+                ToolVersion version = ToolVersion::Parse(toolset.Version);
+                if (req.MinMsvc.IsValid() && version < req.MinMsvc) continue;
+                if (!newest) newest = &toolset;
+                if (req.LatestMsvc) break;
+
+                for (const auto& range : req.PreferredMsvc) {
+                    if (!range.Contains(version)) continue;
+                    selection.Msvc = toolset;
+                    return true;
+                }
+            }
+            if (newest) {
+                selection.Msvc = *newest;
+                return true;
+            }
+
+            selection.Problem = "The engine needs MSVC " + req.MinMsvc.ToString() + " or later (" + req.Source + "); installed:";
+            for (const auto& toolset : inventory.Msvc) selection.Problem += " " + toolset.Version;
+            return false;
+        }
+
+        static bool SelectSdk(const ToolchainInventory& inventory, const ToolchainRequirements& req, ToolchainSelection& selection) {
+            for (const auto& sdk : inventory.Sdks) {
+                ToolVersion version = ToolVersion::Parse(sdk.Version);
+                if (req.PinnedSdk.IsValid() ? !version.Matches(req.PinnedSdk)
+                                            : (req.MinSdk.IsValid() && version < req.MinSdk) || (req.MaxSdk.IsValid() && req.MaxSdk < version)) {
+                    continue;
+                }
+                selection.Sdk = sdk;
+                return true;
+            }
+
+            if (req.PinnedSdk.IsValid()) selection.Problem = "Windows SDK " + req.PinnedSdk.ToString() + " (WindowsSdkVersion in BuildConfiguration.xml) is not installed";
+            else if (inventory.Sdks.empty()) selection.Problem = "No Windows 10/11 SDK found";
+            else selection.Problem = "No installed Windows SDK is between " + req.MinSdk.ToString() + " and " + req.MaxSdk.ToString();
+            return false;
+        }
+
+        // The engine's own toolchain (the one its Linux_SDK.json names) wherever it is, then any
+        // UE toolchain inside its supported range, then system clang
+        static bool SelectClang(const ToolchainInventory& inventory, const ToolchainRequirements& req, const std::wstring& engineRoot, ToolchainSelection& selection) {
+            std::vector<ClangToolchain> candidates = inventory.Clang;
+#ifndef _WIN32
+            // Bundled by Setup.sh; per engine, so looked up every time rather than cached
+            fs::path bundled = fs::path(engineRoot) / "Engine" / "Extras" / "ThirdPartyNotUE" / "SDKs" / "HostLinux" / "Linux_x64";
+            auto engineToolchains = FindLinuxToolchains(bundled, "engine");
+            candidates.insert(candidates.begin(), engineToolchains.begin(), engineToolchains.end());
+#else
+            (void)engineRoot;
+#endif
+
+            auto inRange = [&req](const ClangToolchain& toolchain) {
+                ToolVersion version = ToolVersion::Parse(toolchain.Version);
+                return (!req.MinClang.IsValid() || req.MinClang.Compare(version) <= 0) &&
+                       (!req.MaxClang.IsValid() || version.Compare(req.MaxClang) <= 0);
+            };
+
+            const ClangToolchain* pick = nullptr;
+            for (const auto& toolchain : candidates) {
+                if (!req.LinuxToolchain.empty() && toolchain.Name == req.LinuxToolchain) { pick = &toolchain; break; }
+            }
+            for (size_t i = 0; !pick && i < candidates.size(); ++i) {
+                if (!candidates[i].Name.empty() && inRange(candidates[i])) pick = &candidates[i];
+            }
+            for (size_t i = 0; !pick && i < candidates.size(); ++i) {
+                if (inRange(candidates[i])) pick = &candidates[i];
+            }
+            if (!pick) {
+                if (!candidates.empty()) {
+                    selection.Problem = "No clang toolchain between " + req.MinClang.ToString() + " and " + req.MaxClang.ToString() +
+                                        " (Linux_SDK.json); found:";
+                    for (const auto& toolchain : candidates) selection.Problem += " " + toolchain.Version;
+                }
+                return false;
+            }
+
+            selection.Clang = *pick;
+            selection.HasClang = true;
+            return true;
         }
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,391 @@
+#pragma once
+#include "BuildActionLog.h"
+#include "IncludeScanner.h"
+#include "StringUtils.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <filesystem>
+#include <algorithm>
+#include <functional>
+#include <sstream>
+#include <cstdio>
+
+namespace UEBuilder {
+
+    namespace fs = std::filesystem;
+
+    struct UnityMember {
+        std::string Path;               // As written in the unity .cpp
+        uint64_t Size = 0;
+        double EstimatedSeconds = 0.0;  // Share of the blob's compile time
+    };
+
+    struct UnityBlob {
+        std::string Item;               // Module.Foo.1.cpp
+        std::string Module;
+        double Seconds = 0.0;
+        uint64_t Bytes = 0;
+        std::vector<UnityMember> Members;
+    };
+
+    struct UnityRecommendation {
+        std::string Module;
+        std::string Summary;
+        std::string BuildCsSnippet;
+        double WallBefore = 0.0;
+        double WallAfter = 0.0;
+        double CpuBefore = 0.0;         // Compile time only, like UnityAdvice::CpuSeconds
+        double CpuAfter = 0.0;
+    };
+
+    struct UnityAdvice {
+        int Lanes = 1;
+        double MeasuredSeconds = 0.0;
+        double SimulatedWall = 0.0;     // Current grouping, through the same model as the proposals
+        double CpuSeconds = 0.0;        // Compile actions only: links don't change with the grouping
+        std::vector<UnityBlob> Blobs;   // Slowest first
+        std::vector<BuildAction> Slowest;
+        std::vector<UnityRecommendation> Recommendations; // Biggest win first
+    };
+
+    // Suggests unity settings from a recorded build: measured per-action times (BuildActionLog)
+    // are split across unity members by file size, then alternative groupings are simulated
+    // on the same number of executor slots before anything touches a Build.cs.
+    class UnityAdvisor {
+    public:
+        static UnityAdvice Analyze(const BuildActionLog& log, const fs::path& projectRoot) {
+            UnityAdvice advice;
+            advice.Lanes = (std::max)(1, log.Parallelism());
+            advice.MeasuredSeconds = log.TotalSeconds();
+
+            const auto& actions = log.Actions();
+            if (actions.empty()) return advice;
+
+            // --- STEP 1: Index the unity .cpp files UBT generated under Intermediate ---
+            std::unordered_map<std::string, fs::path> unityFiles;
+            FindUnityFiles(projectRoot, unityFiles);
+
+            // Fixed cost of any compile action (process start, PCH load), taken from the fastest one
+            double overhead = 0.0;
+            bool haveCompile = false;
+            for (const auto& a : actions) {
+                if (a.Verb != "Compile") continue;
+                overhead = haveCompile ? (std::min)(overhead, a.Duration()) : a.Duration();
+                haveCompile = true;
+            }
+            overhead = (std::max)(0.05, overhead * 0.5);
+
+            // --- STEP 2: Split blob time across members by size ---
+            std::vector<Job> jobs;
+            std::map<std::string, std::vector<size_t>> blobsByModule; // Module -> indices into advice.Blobs
+
+            for (const auto& a : actions) {
+                Job job{ a.Duration(), a.Verb == "Compile", "" };
+                if (job.IsCompile) advice.CpuSeconds += job.Seconds;
+
+                std::string module;
+                auto unity = unityFiles.find(a.Item);
+                if (job.IsCompile && ParseUnityName(a.Item, module) && unity != unityFiles.end()) {
+                    UnityBlob blob;
+                    blob.Item = a.Item;
+                    blob.Module = module;
+                    blob.Seconds = a.Duration();
+                    ReadMembers(unity->second, blob);
+
+                    if (blob.Members.size() > 1 && blob.Bytes > 0) {
+                        double work = (std::max)(0.0, blob.Seconds - overhead);
+                        for (auto& m : blob.Members) {
+                            m.EstimatedSeconds = work * static_cast<double>(m.Size) / static_cast<double>(blob.Bytes);
+                        }
+                        job.Module = module;
+                        blobsByModule[module].push_back(advice.Blobs.size());
+                        advice.Blobs.push_back(std::move(blob));
+                    }
+                }
+                jobs.push_back(job);
+            }
+
+            advice.SimulatedWall = Simulate(jobs, advice.Lanes);
+
+            // --- STEP 3: Try alternatives for modules whose blobs stand out ---
+            double medianCompile = MedianCompile(actions);
+            for (const auto& entry : blobsByModule) {
+                const std::string& module = entry.first;
+
+                bool standsOut = false;
+                for (size_t idx : entry.second) {
+                    if (advice.Blobs[idx].Seconds >= 1.5 * medianCompile) standsOut = true;
+                }
+                if (!standsOut) continue;
+
+                UnityRecommendation best;
+                bool haveBest = false;
+                auto consider = [&](const std::vector<Job>& newJobs, const std::string& summary, const std::string& snippet) {
+                    double wall = Simulate(newJobs, advice.Lanes);
+                    if (wall >= advice.SimulatedWall * 0.98) return; // Not worth the churn
+                    if (haveBest && wall >= best.WallAfter) return;
+
+                    best.Module = module;
+                    best.Summary = summary;
+                    best.BuildCsSnippet = snippet;
+                    best.WallBefore = advice.SimulatedWall;
+                    best.WallAfter = wall;
+                    best.CpuBefore = advice.CpuSeconds;
+                    best.CpuAfter = 0.0;
+                    for (const auto& j : newJobs) {
+                        if (j.IsCompile) best.CpuAfter += j.Seconds;
+                    }
+                    haveBest = true;
+                };
+
+                std::vector<UnityMember> members;
+                uint64_t moduleBytes = 0;
+                const UnityMember* heaviest = nullptr;
+                for (size_t idx : entry.second) {
+                    for (const auto& m : advice.Blobs[idx].Members) {
+                        members.push_back(m);
+                        moduleBytes += m.Size;
+                    }
+                }
+                for (const auto& m : members) {
+                    if (!heaviest || m.EstimatedSeconds > heaviest->EstimatedSeconds) heaviest = &m;
+                }
+
+                // a) Smaller blobs. A limit equal to the heaviest file's size puts it in a blob of its own.
+                std::vector<uint64_t> limits;
+                if (heaviest) limits.push_back(heaviest->Size);
+                for (int parts = 2; parts <= 4; ++parts) limits.push_back(moduleBytes / parts);
+
+                for (uint64_t limit : limits) {
+                    if (limit == 0) continue;
+                    std::vector<Job> newJobs = Regroup(jobs, module, members, limit, overhead);
+
+                    std::string summary = "Split " + module + " into smaller unity blobs (<= " +
+                        std::to_string(limit / 1024) + " KB each)";
+                    if (heaviest && limit == heaviest->Size) {
+                        summary += ", isolating " + StringUtils::PathToUtf8(StringUtils::PathFromUtf8(heaviest->Path).filename());
+                    }
+                    std::string snippet = "// " + module + ".Build.cs\nNumIncludedBytesPerUnityCPPOverride = " +
+                        std::to_string(limit) + ";";
+                    consider(newJobs, summary, snippet);
+                }
+
+                // b) No unity at all; only pays off when the module's files are few and heavy
+                std::vector<Job> noUnity = Regroup(jobs, module, members, 0, overhead);
+                consider(noUnity, "Disable unity for " + module,
+                         "// " + module + ".Build.cs\nbUseUnity = false;\n"
+                         "PCHUsage = PCHUsageMode.UseExplicitOrSharedPCHs;\n"
+                         "MinFilesUsingPrecompiledHeaderOverride = 1; // Every file still gets the PCH");
+
+                if (haveBest) advice.Recommendations.push_back(best);
+            }
+
+            std::sort(advice.Recommendations.begin(), advice.Recommendations.end(),
+                      [](const UnityRecommendation& a, const UnityRecommendation& b) {
+                          return (a.WallBefore - a.WallAfter) > (b.WallBefore - b.WallAfter);
+                      });
+
+            std::sort(advice.Blobs.begin(), advice.Blobs.end(), [](const UnityBlob& a, const UnityBlob& b) {
+                return a.Seconds > b.Seconds;
+            });
+
+            advice.Slowest = actions;
+            std::sort(advice.Slowest.begin(), advice.Slowest.end(), [](const BuildAction& a, const BuildAction& b) {
+                return a.Duration() > b.Duration();
+            });
+            if (advice.Slowest.size() > 10) advice.Slowest.resize(10);
+
+            return advice;
+        }
+
+        static std::string FormatReport(const UnityAdvice& advice) {
+            std::ostringstream out;
+            char line[256];
+
+            out << "Unity build advisor\n";
+            std::snprintf(line, sizeof(line), "  Measured build time:   %.1f s\n  Simulated (model):     %.1f s on %d slots\n  Total compile CPU:     %.1f s\n\n",
+                          advice.MeasuredSeconds, advice.SimulatedWall, advice.Lanes, advice.CpuSeconds);
+            out << line;
+
+            out << "Slowest actions:\n";
+            for (const auto& a : advice.Slowest) {
+                std::snprintf(line, sizeof(line), "  %8.1f s  %s %s\n", a.Duration(), a.Verb.c_str(), a.Item.c_str());
+                out << line;
+            }
+
+            out << "\nSlowest unity blobs (estimated share per file):\n";
+            size_t shown = 0;
+            for (const auto& blob : advice.Blobs) {
+                if (++shown > 5) break;
+                std::snprintf(line, sizeof(line), "  %8.1f s  %s (%zu files, %.0f KB)\n",
+                              blob.Seconds, blob.Item.c_str(), blob.Members.size(), blob.Bytes / 1024.0);
+                out << line;
+
+                std::vector<UnityMember> members = blob.Members;
+                std::sort(members.begin(), members.end(), [](const UnityMember& a, const UnityMember& b) {
+                    return a.EstimatedSeconds > b.EstimatedSeconds;
+                });
+                for (size_t i = 0; i < members.size() && i < 3; ++i) {
+                    std::snprintf(line, sizeof(line), "      %6.1f s  ", members[i].EstimatedSeconds);
+                    out << line << StringUtils::PathToUtf8(StringUtils::PathFromUtf8(members[i].Path).filename()) << "\n";
+                }
+            }
+
+            out << "\nRecommendations (simulated, nothing has been changed):\n";
+            if (advice.Recommendations.empty()) {
+                out << "  None: no unity blob is holding the build back.\n";
+            }
+            for (const auto& r : advice.Recommendations) {
+                std::snprintf(line, sizeof(line), "  - %s\n    wall %.1f s -> %.1f s, CPU %.1f s -> %.1f s\n",
+                              r.Summary.c_str(), r.WallBefore, r.WallAfter, r.CpuBefore, r.CpuAfter);
+                out << line;
+
+                std::istringstream snippet(r.BuildCsSnippet);
+                std::string snippetLine;
+                while (std::getline(snippet, snippetLine)) out << "      " << snippetLine << "\n";
+            }
+            return out.str();
+        }
+
+    private:
+        struct Job {
+            double Seconds = 0.0;
+            bool IsCompile = false;
+            std::string Module;         // Set for unity blobs we know the members of
+        };
+
+        // "Module.Foo.1.cpp" / "Module.Foo.cpp" -> "Foo"
+        static bool ParseUnityName(const std::string& item, std::string& module) {
+            if (item.compare(0, 7, "Module.") != 0 || item.size() < 12) return false;
+            std::string rest = item.substr(7, item.size() - 7 - 4); // Strip "Module." and ".cpp"
+
+            size_t lastDot = rest.rfind('.');
+            if (lastDot != std::string::npos && rest.find_first_not_of("0123456789", lastDot + 1) == std::string::npos) {
+                rest = rest.substr(0, lastDot);
+            }
+            module = rest;
+            return !module.empty();
+        }
+
+        static void FindUnityFiles(const fs::path& projectRoot, std::unordered_map<std::string, fs::path>& out) {
+            std::vector<fs::path> roots = { projectRoot / "Intermediate" / "Build" };
+
+            std::error_code ec;
+            if (fs::is_directory(projectRoot / "Plugins", ec)) {
+                for (auto it = fs::recursive_directory_iterator(projectRoot / "Plugins", fs::directory_options::skip_permission_denied, ec);
+                     it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                    if (ec) break;
+                    if (!it->is_directory(ec)) continue;
+                    std::wstring name = it->path().filename().wstring();
+                    if (name == L"Intermediate") {
+                        roots.push_back(it->path() / "Build");
+                        it.disable_recursion_pending();
+                    }
+                    else if (name == L"Source" || name == L"Content" || name == L"Binaries") {
+                        it.disable_recursion_pending();
+                    }
+                }
+            }
+
+            std::unordered_map<std::string, fs::file_time_type> newest;
+            for (const auto& root : roots) {
+                if (!fs::is_directory(root, ec)) continue;
+                for (auto it = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, ec);
+                     it != fs::recursive_directory_iterator(); it.increment(ec)) {
+                    if (ec) break;
+                    if (!it->is_regular_file(ec)) continue;
+
+                    std::string name = StringUtils::PathToUtf8(it->path().filename());
+                    std::string module;
+                    if (it->path().extension() != ".cpp" || !ParseUnityName(name, module)) continue;
+
+                    // Several configs leave same-named blobs around; the newest one matches the recorded build
+                    fs::file_time_type written = it->last_write_time(ec);
+                    auto existing = newest.find(name);
+                    if (existing == newest.end() || written > existing->second) {
+                        newest[name] = written;
+                        out[name] = it->path();
+                    }
+                }
+            }
+        }
+
+        static void ReadMembers(const fs::path& unityFile, UnityBlob& blob) {
+            MappedFile file;
+            if (!file.Open(unityFile)) return;
+
+            std::vector<std::string> includes;
+            IncludeScanner::ExtractIncludes(file.Data(), file.Size(), includes);
+
+            std::error_code ec;
+            for (const auto& inc : includes) {
+                if (!BuildActionLog::IsCompileItem(inc)) continue; // Skip the PCH / definitions headers
+
+                UnityMember member;
+                member.Path = inc;
+                uintmax_t size = fs::file_size(StringUtils::PathFromUtf8(inc), ec);
+                member.Size = ec ? 0 : static_cast<uint64_t>(size);
+                blob.Bytes += member.Size;
+                blob.Members.push_back(member);
+            }
+        }
+
+        // Replaces a module's unity blobs with a regrouping of its members.
+        // limitBytes == 0 means one file per action (bUseUnity = false).
+        static std::vector<Job> Regroup(const std::vector<Job>& jobs, const std::string& module,
+                                        const std::vector<UnityMember>& members, uint64_t limitBytes, double overhead) {
+            std::vector<Job> result;
+            for (const auto& j : jobs) {
+                if (j.Module != module) result.push_back(j);
+            }
+
+            // UBT fills blobs in order until the next file would exceed the byte limit
+            double current = 0.0;
+            uint64_t currentBytes = 0;
+            bool open = false;
+            for (const auto& m : members) {
+                if (open && (limitBytes == 0 || currentBytes + m.Size > limitBytes)) {
+                    result.push_back({ overhead + current, true, "" });
+                    current = 0.0;
+                    currentBytes = 0;
+                }
+                current += m.EstimatedSeconds;
+                currentBytes += m.Size;
+                open = true;
+            }
+            if (open) result.push_back({ overhead + current, true, "" });
+            return result;
+        }
+
+        // Compiles first, then links, each longest-first on 'lanes' slots
+        static double Simulate(const std::vector<Job>& jobs, int lanes) {
+            std::vector<double> compiles, others;
+            for (const auto& j : jobs) (j.IsCompile ? compiles : others).push_back(j.Seconds);
+            return Makespan(compiles, lanes) + Makespan(others, lanes);
+        }
+
+        static double Makespan(std::vector<double> durations, int lanes) {
+            if (durations.empty()) return 0.0;
+            std::sort(durations.begin(), durations.end(), std::greater<double>());
+
+            std::vector<double> laneEnds(static_cast<size_t>((std::max)(1, lanes)), 0.0);
+            for (double d : durations) {
+                auto slot = std::min_element(laneEnds.begin(), laneEnds.end());
+                *slot += d;
+            }
+            return *std::max_element(laneEnds.begin(), laneEnds.end());
+        }
+
+        static double MedianCompile(const std::vector<BuildAction>& actions) {
+            std::vector<double> d;
+            for (const auto& a : actions) {
+                if (a.Verb == "Compile") d.push_back(a.Duration());
+            }
+            if (d.empty()) return 0.0;
+            std::nth_element(d.begin(), d.begin() + d.size() / 2, d.end());
+            return d[d.size() / 2];
+        }
+    };
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include "JsonUtils.h"
+#include "SystemInfo.h"
+#include <string>
+#include <vector>
+#include <functional>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <cstdio>
+#include <ctime>
+
+namespace UEBuilder {
+
+    // What one run of a benchmark body processed
+    struct BenchWork {
+        double Items = 0.0;   // Lines, files, parses... (see BenchResult::Unit)
+        double Bytes = 0.0;   // 0 when bytes are meaningless for the benchmark
+    };
+
+    struct BenchResult {
+        std::string Name;
+        std::string Unit;                 // What Items counts, e.g. "lines"
+        double Items = 0.0;               // Per run
+        double Bytes = 0.0;               // Per run
+        std::vector<double> RunSeconds;   // One per measured repeat
+
+        double MedianSeconds() const {
+            if (RunSeconds.empty()) return 0.0;
+            std::vector<double> sorted = RunSeconds;
+            std::sort(sorted.begin(), sorted.end());
+            size_t mid = sorted.size() / 2;
+            return sorted.size() % 2 ? sorted[mid] : (sorted[mid - 1] + sorted[mid]) / 2.0;
+        }
+        double ItemsPerSecond() const { double s = MedianSeconds(); return s > 0.0 ? Items / s : 0.0; }
+        double BytesPerSecond() const { double s = MedianSeconds(); return s > 0.0 ? Bytes / s : 0.0; }
+        double NanosPerItem() const { return Items > 0.0 ? MedianSeconds() * 1e9 / Items : 0.0; }
+    };
+
+    // Runs named benchmarks (one warm-up, then N timed repeats, median reported) and writes
+    // the results as JSON, so two commits can be compared with --compare.
+    class BenchRunner {
+    public:
+        struct Options {
+            std::string OutPath = "benchmark-results.json";
+            std::string Label;            // e.g. a commit id; free text
+            std::string Filter;           // Substring of benchmark names to run
+            std::string ComparePath;      // Earlier results to diff against
+            std::string RecordingPath;    // A real build's output.ubtrec to benchmark with
+            int Repeats = 5;
+            bool Quick = false;           // Smaller inputs, for a fast sanity run
+        };
+
+        // --out FILE  --label TEXT  --filter TEXT  --compare FILE  --recording FILE  --repeats N  --quick
+        static bool ParseArgs(int argc, char** argv, Options& options) {
+            for (int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+                auto value = [&](std::string& out) {
+                    if (i + 1 >= argc) return false;
+                    out = argv[++i];
+                    return true;
+                };
+
+                std::string repeats;
+                if (arg == "--out") { if (!value(options.OutPath)) return false; }
+                else if (arg == "--label") { if (!value(options.Label)) return false; }
+                else if (arg == "--filter") { if (!value(options.Filter)) return false; }
+                else if (arg == "--compare") { if (!value(options.ComparePath)) return false; }
+                else if (arg == "--recording") { if (!value(options.RecordingPath)) return false; }
+                else if (arg == "--repeats") {
+                    if (!value(repeats)) return false;
+                    options.Repeats = (std::max)(1, std::atoi(repeats.c_str()));
+                }
+                else if (arg == "--quick") options.Quick = true;
+                else return false;
+            }
+            return true;
+        }
+
+        static void PrintUsage(const char* program) {
+            std::cerr << "Usage: " << program
+                      << " [--out FILE] [--label TEXT] [--filter TEXT] [--compare FILE] [--recording FILE] [--repeats N] [--quick]\n";
+        }
+
+        explicit BenchRunner(Options options) : options(std::move(options)) {}
+
+        const Options& Settings() const { return options; }
+
+        // body runs once untimed, then Repeats times; setup (optional) runs untimed before each
+        void Run(const std::string& name, const std::string& unit, const std::function<BenchWork()>& body,
+                 const std::function<void()>& setup = nullptr) {
+            if (!options.Filter.empty() && name.find(options.Filter) == std::string::npos) return;
+
+            BenchResult result;
+            result.Name = name;
+            result.Unit = unit;
+
+            if (setup) setup();
+            BenchWork work = body();
+            for (int i = 0; i < options.Repeats; ++i) {
+                if (setup) setup();
+                auto start = std::chrono::steady_clock::now();
+                work = body();
+                result.RunSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+            }
+            result.Items = work.Items;
+            result.Bytes = work.Bytes;
+
+            Print(result);
+            results.push_back(result);
+        }
+
+        // Writes OutPath and, with --compare, prints the change against the earlier file
+        bool Finish() {
+            bool ok = Save();
+            if (!options.ComparePath.empty()) Compare(options.ComparePath);
+            return ok;
+        }
+
+    private:
+        Options options;
+        std::vector<BenchResult> results;
+
+        static void Print(const BenchResult& r) {
+            char line[256];
+            std::snprintf(line, sizeof(line), "%-44s %10.3f ms  %12.0f %s/s", r.Name.c_str(),
+                          r.MedianSeconds() * 1e3, r.ItemsPerSecond(), r.Unit.c_str());
+            std::cout << line;
+            if (r.Bytes > 0.0) {
+                std::snprintf(line, sizeof(line), "  %8.1f MB/s", r.BytesPerSecond() / 1048576.0);
+                std::cout << line;
+            }
+            std::snprintf(line, sizeof(line), "  %9.1f ns each\n", r.NanosPerItem());
+            std::cout << line;
+        }
+
+        bool Save() const {
+            MachineProfile machine = SystemInfo::GetMachineProfile();
+
+            JsonValue root = JsonValue::MakeObject();
+            root.Set("Label", options.Label);
+            root.Set("Timestamp", static_cast<int64_t>(std::time(nullptr)));
+            JsonValue host = JsonValue::MakeObject();
+            host.Set("Id", machine.Id());
+            host.Set("Cpu", machine.Cpu);
+            host.Set("LogicalCores", machine.LogicalCores);
+            host.Set("MemoryBytes", machine.MemoryBytes);
+            root.Set("Machine", host);
+            root.Set("Repeats", options.Repeats);
+            root.Set("Quick", options.Quick);
+
+            JsonValue list = JsonValue::MakeArray();
+            for (const auto& r : results) {
+                JsonValue item = JsonValue::MakeObject();
+                item.Set("Name", r.Name);
+                item.Set("Unit", r.Unit);
+                item.Set("Items", r.Items);
+                item.Set("Bytes", r.Bytes);
+                item.Set("MedianSeconds", r.MedianSeconds());
+                item.Set("ItemsPerSecond", r.ItemsPerSecond());
+                item.Set("BytesPerSecond", r.BytesPerSecond());
+                item.Set("NanosPerItem", r.NanosPerItem());
+                JsonValue runs = JsonValue::MakeArray();
+                for (double s : r.RunSeconds) runs.Push(s);
+                item.Set("RunSeconds", runs);
+                list.Push(item);
+            }
+            root.Set("Results", list);
+
+            std::ofstream out(options.OutPath, std::ios::trunc);
+            if (!out.is_open()) {
+                std::cerr << "[Error] Cannot write " << options.OutPath << "\n";
+                return false;
+            }
+            out << root.Dump(2) << "\n";
+            std::cout << "\nResults written to " << options.OutPath << "\n";
+            return static_cast<bool>(out);
+        }
+
+        void Compare(const std::string& path) const {
+            std::ifstream in(path);
+            std::stringstream text;
+            text << in.rdbuf();
+            bool ok = false;
+            JsonValue earlier = JsonValue::Parse(text.str(), &ok);
+            if (!ok) {
+                std::cerr << "[Error] Cannot read " << path << "\n";
+                return;
+            }
+
+            std::cout << "\nCompared with " << path;
+            if (!earlier["Label"].AsString().empty()) std::cout << " (" << earlier["Label"].AsString() << ")";
+            if (earlier["Machine"]["Id"].AsString() != SystemInfo::GetMachineProfile().Id()) std::cout << " [different machine]";
+            std::cout << ":\n";
+
+            for (const auto& r : results) {
+                for (const auto& old : earlier["Results"].Items()) {
+                    if (old["Name"].AsString() != r.Name) continue;
+
+                    double before = old["MedianSeconds"].AsNumber();
+                    double after = r.MedianSeconds();
+                    if (before <= 0.0 || after <= 0.0) break;
+
+                    // Positive = faster now
+                    char line[160];
+                    std::snprintf(line, sizeof(line), "%-44s %+7.1f%%  (%.3f -> %.3f ms)\n", r.Name.c_str(),
+                                  (before / after - 1.0) * 100.0, before * 1e3, after * 1e3);
+                    std::cout << line;
+                    break;
+                }
+            }
+        }
+    };
+}
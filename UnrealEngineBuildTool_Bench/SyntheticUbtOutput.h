@@ -0,0 +1,180 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+
+namespace UEBuilder {
+
+    struct SyntheticUbtOptions {
+        uint32_t Seed = 20240611u;
+        std::string Target = "SampleEditor";
+        int Actions = 4000;
+        int Processes = 32;
+        int WarningPercent = 20;        // Actions followed by a deprecation warning
+        double ErrorPercent = 0.0;      // Actions followed by a compile error
+        int ErrorActions = 0;           // Or: exactly this many failing actions, spread out
+        bool ClangDiagnostics = false;  // file:line:col: style instead of MSVC's file(line):
+        bool Utf8Paths = false;         // Non-ASCII folder and file names in diagnostics
+        bool Progress = true;           // "@progress" markers, as UBT prints with -progress
+    };
+
+    // Deterministic stand-in for UnrealBuildTool console output: phase lines, "[n/m]" action
+    // lines, compiler diagnostics and the closing summary, in roughly the mix a real editor
+    // build prints. Same options, same bytes, so numbers from different commits compare.
+    class SyntheticUbtOutput {
+    public:
+        explicit SyntheticUbtOutput(SyntheticUbtOptions options = SyntheticUbtOptions())
+            : options(std::move(options)), state(this->options.Seed) {
+            this->options.Actions = (std::max)(1, this->options.Actions);
+
+            // Exact error count: every k-th action, offset so the first isn't action 1
+            if (this->options.ErrorActions > 0) {
+                errorStride = (std::max)(1, this->options.Actions / this->options.ErrorActions);
+            }
+        }
+
+        const SyntheticUbtOptions& Options() const { return options; }
+        int ErrorsEmitted() const { return errors; }
+        bool Done() const { return action >= options.Actions; }
+
+        // Everything UBT prints before the first action
+        void Preamble(std::vector<std::string>& lines) const {
+            const std::string& t = options.Target;
+            lines.push_back("Using bundled DotNet SDK version: 8.0.300");
+            lines.push_back("Log file: " + LogPath());
+            if (options.Progress) lines.push_back("@progress push 5%");
+            lines.push_back("Creating makefile for " + t + " (no existing makefile)");
+            if (options.Progress) lines.push_back("@progress 'Generating code...' 0%");
+            lines.push_back("Parsing headers for " + t);
+            lines.push_back("  Running Internal UnrealHeaderTool " + t + ".uproject");
+            lines.push_back("Reflection code generated for " + t + " in 3.8 seconds");
+            if (options.Progress) lines.push_back("@progress 'Generating code...' 100%");
+            if (options.Progress) lines.push_back("@progress pop");
+            lines.push_back("Building " + t + "...");
+            lines.push_back("Determining max actions to execute in parallel (" + std::to_string(options.Processes / 2) +
+                            " physical cores, " + std::to_string(options.Processes) + " logical cores)");
+            lines.push_back("  Executing up to " + std::to_string(options.Processes) + " processes, one per logical core");
+            lines.push_back("Building " + std::to_string(options.Actions) + " actions with " +
+                            std::to_string(options.Processes) + " processes...");
+        }
+
+        // Lines of the next action (its "[n/m]" line plus any diagnostics); false when done
+        bool NextAction(std::vector<std::string>& lines) {
+            if (Done()) return false;
+            ++action;
+
+            const char* module = Modules[Next() % ModuleCount];
+            unsigned file = Next() % 400;
+            char line[512];
+
+            bool link = action > options.Actions - options.Actions / 50;  // Links bunch up at the end
+            if (link) {
+                std::snprintf(line, sizeof(line), "[%d/%d] Link [x64] UnrealEditor-%s.dll", action, options.Actions, module);
+                lines.push_back(line);
+                return true;
+            }
+
+            std::snprintf(line, sizeof(line), "[%d/%d] Compile [x64] Module.%s.%u_of_%u.cpp",
+                          action, options.Actions, module, file % 40 + 1, 40u);
+            lines.push_back(line);
+
+            // cl.exe echoes the source name of non-unity files
+            if (Next() % 100 < 7) lines.push_back(std::string("  ") + module + "Component" + std::to_string(file) + ".cpp");
+
+            if (static_cast<int>(Next() % 100) < options.WarningPercent) {
+                lines.push_back(Diagnostic(module, file, false));
+            }
+
+            bool fail = options.ErrorActions > 0
+                ? (errors < options.ErrorActions && action % errorStride == errorStride / 2)
+                : (options.ErrorPercent > 0.0 && (Next() % 10000) < options.ErrorPercent * 100.0);
+            if (fail) {
+                lines.push_back(Diagnostic(module, file, true));
+                ++errors;
+            }
+            return true;
+        }
+
+        // Closing summary; matches how UBT reports success and failure
+        void Epilogue(std::vector<std::string>& lines, double executorSeconds, double totalSeconds) const {
+            char line[160];
+            std::snprintf(line, sizeof(line), "Total time in Parallel executor: %.2f seconds", executorSeconds);
+            lines.push_back(line);
+            std::snprintf(line, sizeof(line), "Total execution time: %.2f seconds", totalSeconds);
+            lines.push_back(line);
+            lines.push_back(errors > 0 ? "Result: Failed (OtherCompilationError)" : "Result: Succeeded");
+        }
+
+        // About lineCount lines of CRLF-terminated text, actions repeating as needed
+        std::string Generate(size_t lineCount) {
+            std::vector<std::string> lines;
+            Preamble(lines);
+            while (lines.size() < lineCount) {
+                if (Done()) action = 0;
+                NextAction(lines);
+            }
+            lines.resize(lineCount);
+
+            std::string out;
+            out.reserve(lineCount * 90);
+            for (const auto& l : lines) {
+                out += l;
+                out += "\r\n";
+            }
+            return out;
+        }
+
+    private:
+        SyntheticUbtOptions options;
+        uint32_t state;
+        int action = 0;
+        int errors = 0;
+        int errorStride = 1;
+
+        static constexpr const char* Modules[] = {
+            "Engine", "CoreUObject", "Renderer", "Slate", "UMG", "Niagara", "Chaos", "AIModule", "Landscape", "Sample"
+        };
+        static constexpr size_t ModuleCount = sizeof(Modules) / sizeof(Modules[0]);
+
+        uint32_t Next() {
+            state = state * 1664525u + 1013904223u;
+            return state >> 8;
+        }
+
+        std::string ProjectDir() const {
+            std::string dir = options.ClangDiagnostics ? "/home/dev/Projects/" : "C:\\Projects\\";
+            dir += options.Utf8Paths ? "Spiel-Prototyp \xC3\x9C" "bung \xE6\x97\xA5\xE6\x9C\xAC" : "Sample";  // "Spiel-Prototyp Übung 日本"
+            return dir;
+        }
+
+        std::string LogPath() const {
+            return options.ClangDiagnostics ? "/home/dev/.config/Unreal Engine/UnrealBuildTool/Log.txt"
+                                            : "C:\\Users\\dev\\AppData\\Local\\UnrealBuildTool\\Log.txt";
+        }
+
+        std::string Diagnostic(const char* module, unsigned file, bool error) {
+            const char sep = options.ClangDiagnostics ? '/' : '\\';
+            std::string path = ProjectDir() + sep + "Source" + sep + module + sep + "Private" + sep + module +
+                               (options.Utf8Paths ? "Gr\xC3\xB6\xC3\x9F" "e" : "Component") + std::to_string(file) + ".cpp";
+            unsigned lineNo = Next() % 2000 + 1;
+            unsigned column = Next() % 80 + 1;
+
+            char line[768];
+            if (options.ClangDiagnostics) {
+                if (error) std::snprintf(line, sizeof(line), "%s:%u:%u: error: use of undeclared identifier 'Undeclared'", path.c_str(), lineNo, column);
+                else std::snprintf(line, sizeof(line), "%s:%u:%u: warning: 'Call' is deprecated: Use FNewApi instead. "
+                                   "Please update your code to the new API before upgrading to the next release. [-Wdeprecated-declarations]",
+                                   path.c_str(), lineNo, column);
+            }
+            else {
+                if (error) std::snprintf(line, sizeof(line), "%s(%u): error C2065: 'Undeclared': undeclared identifier", path.c_str(), lineNo);
+                else std::snprintf(line, sizeof(line), "%s(%u): warning C4996: 'FOldApi::Call': Use FNewApi instead. "
+                                   "Please update your code to the new API before upgrading to the next release.",
+                                   path.c_str(), lineNo);
+            }
+            return line;
+        }
+    };
+}
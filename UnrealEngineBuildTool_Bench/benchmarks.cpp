@@ -0,0 +1,446 @@
+// Microbenchmarks for the hot paths of UEBuilder that don't need Qt or an engine install.
+// Builds and runs on a plain Linux box:
+//
+//   cmake -S UnrealEngineBuildTool_Bench -B build-bench -DCMAKE_BUILD_TYPE=Release
+//   cmake --build build-bench
+//   ./build-bench/UEBuilderBench --label "$(git rev-parse --short HEAD)" --out before.json
+//   ... change something ...
+//   ./build-bench/UEBuilderBench --compare before.json
+
+#include "BenchHarness.h"
+#include "SyntheticUbtOutput.h"
+#include "BuildActionLog.h"
+#include "LogClassifier.h"
+#include "EngineDetector.h"
+#include "ProjectLocator.h"
+#include "ProcessUtils.h"
+#include "OutputRecording.h"
+#include "OutputQueue.h"
+#include "Log.h"
+#include "ProjectIndex.h"
+#include "PrebuiltCache.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <map>
+#include <random>
+
+using namespace UEBuilder;
+namespace fs = std::filesystem;
+
+namespace {
+
+    // Pipe reads on both platforms hand over at most this much per callback
+    constexpr size_t ChunkSize = 4095;
+
+    struct PipelineSink {
+        size_t Lines = 0;
+        size_t Errors = 0;
+        size_t CleanHints = 0;
+
+        void operator()(const std::string& line) {
+            LogClassification kind = LogClassifier::Classify(line);
+            ++Lines;
+            Errors += kind.IsError;
+            CleanHints += kind.SuggestsClean;
+        }
+    };
+
+    std::vector<std::string> SplitLines(const std::string& text) {
+        std::vector<std::string> lines;
+        LineSplitter splitter;
+        splitter.Feed(text.data(), text.size(), [&](const std::string& line) { lines.push_back(line); });
+        splitter.Flush([&](const std::string& line) { lines.push_back(line); });
+        return lines;
+    }
+
+    bool WriteFile(const fs::path& path, const std::string& text) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+        return static_cast<bool>(out);
+    }
+
+    std::string MakeUProject(int plugins, bool associationLast) {
+        std::string association = "\t\"EngineAssociation\": \"5.4\",\n";
+        std::string json = "{\n\t\"FileVersion\": 3,\n";
+        if (!associationLast) json += association;
+        json += "\t\"Category\": \"\",\n\t\"Description\": \"\",\n\t\"Modules\": [\n"
+                "\t\t{\n\t\t\t\"Name\": \"Sample\",\n\t\t\t\"Type\": \"Runtime\",\n\t\t\t\"LoadingPhase\": \"Default\"\n\t\t}\n\t],\n"
+                "\t\"Plugins\": [\n";
+        for (int i = 0; i < plugins; ++i) {
+            json += "\t\t{\n\t\t\t\"Name\": \"Plugin" + std::to_string(i) + "\",\n\t\t\t\"Enabled\": true,\n"
+                    "\t\t\t\"SupportedTargetPlatforms\": [ \"Win64\", \"Linux\", \"Mac\" ]\n\t\t}";
+            json += i + 1 < plugins ? ",\n" : "\n";
+        }
+        json += "\t]";
+        if (associationLast) json += ",\n" + association.substr(0, association.size() - 2) + "\n";
+        else json += "\n";
+        json += "}\n";
+        return json;
+    }
+
+    // Relative path -> contents of every file under a project's Binaries folders (staging
+    // leftovers included, so a fetch that leaves any behind shows up as a difference)
+    using FileTree = std::map<std::string, std::string>;
+
+    FileTree ReadBinaries(const fs::path& projectRoot) {
+        FileTree tree;
+        std::error_code ec;
+        for (auto it = fs::recursive_directory_iterator(projectRoot, ec); !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+            if (!it->is_regular_file() || it->path().extension() == ".uproject") continue;
+            std::ifstream in(it->path(), std::ios::binary);
+            tree[StringUtils::GenericRelative(it->path(), projectRoot)] =
+                std::string((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        }
+        return tree;
+    }
+
+    void WriteTree(const fs::path& projectRoot, const FileTree& tree) {
+        std::error_code ec;
+        fs::remove_all(projectRoot / "Binaries", ec);
+        fs::remove_all(projectRoot / "Plugins", ec);
+        for (const auto& [rel, data] : tree) {
+            fs::path path = projectRoot / StringUtils::PathFromUtf8(rel);
+            fs::create_directories(path.parent_path(), ec);
+            WriteFile(path, data);
+        }
+    }
+
+    std::string RandomBytes(std::mt19937& rng, size_t size) {
+        std::string data(size, '\0');
+        for (auto& c : data) c = static_cast<char>(rng() & 0xFF);
+        return data;
+    }
+
+    // Publishes revisions a and b of a project, fetches a then b into a second project and
+    // checks both byte for byte; then a fetch of c that breaks part way must leave b intact.
+    // Returns the publisher and consumer project files for the timed fetches.
+    bool CheckPrebuiltRoundTrip(const fs::path& dir, fs::path& publisher, fs::path& consumer, std::wstring& share) {
+        std::error_code ec;
+        publisher = dir / "Publisher" / "Game.uproject";
+        consumer = dir / "Consumer" / "Game.uproject";
+        share = (dir / "share").wstring();
+        fs::create_directories(publisher.parent_path(), ec);
+        fs::create_directories(consumer.parent_path(), ec);
+        WriteFile(publisher, MakeUProject(1, false));
+        WriteFile(consumer, MakeUProject(1, false));
+
+        std::mt19937 rng(26);
+        FileTree a;
+        a["Binaries/Win64/UnrealEditor-Game.dll"] = RandomBytes(rng, 3 << 20);
+        a["Binaries/Win64/UnrealEditor-Tools.dll"] = RandomBytes(rng, 300 << 10);
+        a["Binaries/Win64/UnrealEditor-Removed.dll"] = RandomBytes(rng, 100 << 10);
+        a["Binaries/Win64/UnrealEditor.modules"] = "{ \"BuildId\": \"a\" }";
+        a["Plugins/Gameplay/Binaries/Win64/UnrealEditor-Gameplay..dll"] = RandomBytes(rng, 200 << 10);
+
+        FileTree b = a;
+        std::string& game = b["Binaries/Win64/UnrealEditor-Game.dll"];
+        game.replace(1 << 20, 4096, RandomBytes(rng, 4096));   // A changed function
+        game.insert(2 << 20, RandomBytes(rng, 1000));           // Everything after it moves
+        b.erase("Binaries/Win64/UnrealEditor-Removed.dll");
+        b["Binaries/Win64/UnrealEditor-Added.dll"] = RandomBytes(rng, 50 << 10);
+        b["Binaries/Win64/UnrealEditor.modules"] = "{ \"BuildId\": \"b\" }";
+
+        FileTree c = b;
+        c["Binaries/Win64/UnrealEditor-Tools.dll"] = RandomBytes(rng, 300 << 10);
+        c["Binaries/Win64/UnrealEditor-Game.dll"][10] ^= 1;
+
+        for (const auto& [revision, tree] : { std::pair<const char*, const FileTree*>{ "a", &a }, { "b", &b }, { "c", &c } }) {
+            WriteTree(publisher.parent_path(), *tree);
+            if (!PrebuiltCache::Publish(share, publisher, revision, nullptr)) {
+                std::cerr << "[Error] Prebuilt round trip: publishing " << revision << " failed\n";
+                return false;
+            }
+        }
+
+        // The consumer starts with local debug symbols, which the revision doesn't have
+        WriteTree(consumer.parent_path(), { { "Binaries/Win64/UnrealEditor-Game.pdb", "symbols" } });
+        PrebuiltFetchStats stats;
+        if (!PrebuiltCache::Fetch(share, "a", consumer, nullptr) || ReadBinaries(consumer.parent_path()) != a) {
+            std::cerr << "[Error] Prebuilt round trip: revision a differs after fetching it\n";
+            return false;
+        }
+        if (!PrebuiltCache::Fetch(share, "b", consumer, nullptr, &stats) || ReadBinaries(consumer.parent_path()) != b) {
+            std::cerr << "[Error] Prebuilt round trip: revision b differs after fetching it over a\n";
+            return false;
+        }
+        if (stats.BytesTransferred >= stats.BytesReused) {
+            std::cerr << "[Error] Prebuilt round trip: fetching b over a reused only " << stats.BytesReused << " bytes\n";
+            return false;
+        }
+
+        // c's copy of the Game DLL on the share is cut off inside its changed first block, so the
+        // transfer breaks part way through the revision
+        fs::path broken = fs::path(share) / "c" / "files" / "Binaries" / "Win64" / "UnrealEditor-Game.dll";
+        fs::resize_file(broken, 5, ec);
+        if (PrebuiltCache::Fetch(share, "c", consumer, nullptr) || ReadBinaries(consumer.parent_path()) != b) {
+            std::cerr << "[Error] Prebuilt round trip: an interrupted fetch of c changed the binaries\n";
+            return false;
+        }
+        return true;
+    }
+
+    // Folder with fileCount plain files and no .uproject, so resolution has to walk all of it
+    bool MakeLargeFolder(const fs::path& dir, size_t fileCount) {
+        std::error_code ec;
+        fs::create_directories(dir, ec);
+        for (size_t i = 0; i < fileCount; ++i) {
+            std::ofstream touch(dir / ("Asset_" + std::to_string(i) + ".uasset"));
+            if (!touch) return false;
+        }
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+    BenchRunner::Options options;
+    if (!BenchRunner::ParseArgs(argc, argv, options)) {
+        BenchRunner::PrintUsage(argv[0]);
+        return 2;
+    }
+    BenchRunner bench(options);
+
+    const size_t lineCount = options.Quick ? 200000 : 2000000;
+    SyntheticUbtOptions mix;
+    mix.ErrorPercent = 1.0;  // Enough to exercise the error path without dominating
+    const std::string output = SyntheticUbtOutput(mix).Generate(lineCount);
+    const std::vector<std::string> lines = SplitLines(output);
+    const double outputBytes = static_cast<double>(output.size());
+
+    std::error_code ec;
+    fs::path scratch = fs::temp_directory_path(ec) / ("uebuilder-bench-" + std::to_string(
+        std::chrono::steady_clock::now().time_since_epoch().count()));
+    fs::create_directories(scratch, ec);
+    if (ec) {
+        std::cerr << "[Error] Cannot create scratch folder " << scratch.string() << "\n";
+        return 1;
+    }
+
+    std::cout << "Synthetic UBT output: " << lines.size() << " lines, " << output.size() / 1048576.0 << " MB\n\n";
+
+    // --- Output pipeline: chunk -> line split -> classify -> sink ---
+
+    bench.Run("classify.per_line", "lines", [&]() {
+        PipelineSink sink;
+        for (const auto& line : lines) sink(line);
+        return BenchWork{ static_cast<double>(sink.Lines), outputBytes };
+    });
+
+    bench.Run("pipeline.split", "lines", [&]() {
+        LineSplitter splitter;
+        size_t count = 0;
+        auto onLine = [&](const std::string&) { ++count; };
+        for (size_t at = 0; at < output.size(); at += ChunkSize) {
+            splitter.Feed(output.data() + at, (std::min)(ChunkSize, output.size() - at), onLine);
+        }
+        splitter.Flush(onLine);
+        return BenchWork{ static_cast<double>(count), outputBytes };
+    });
+
+    bench.Run("pipeline.split_classify", "lines", [&]() {
+        LineSplitter splitter;
+        PipelineSink sink;
+        auto onLine = [&](const std::string& line) { sink(line); };
+        for (size_t at = 0; at < output.size(); at += ChunkSize) {
+            splitter.Feed(output.data() + at, (std::min)(ChunkSize, output.size() - at), onLine);
+        }
+        splitter.Flush(onLine);
+        return BenchWork{ static_cast<double>(sink.Lines), outputBytes };
+    });
+
+    // What a CLI/GUI build does per chunk: classify for display, parse for actions.json/trace
+    bench.Run("pipeline.split_classify_actionlog", "lines", [&]() {
+        LineSplitter splitter;
+        PipelineSink sink;
+        BuildActionLog log;
+        double seconds = 0.0;
+        auto onLine = [&](const std::string& line) {
+            sink(line);
+            log.OnLine(line, seconds += 0.0001);
+        };
+        for (size_t at = 0; at < output.size(); at += ChunkSize) {
+            splitter.Feed(output.data() + at, (std::min)(ChunkSize, output.size() - at), onLine);
+        }
+        splitter.Flush(onLine);
+        log.Finish();
+        return BenchWork{ static_cast<double>(sink.Lines), outputBytes };
+    });
+
+    // Hand-off from the pipe reader to the delivery thread (RunProcess's OutputQueue)
+    bench.Run("pipeline.queue_split_classify", "lines", [&]() {
+        LineSplitter splitter;
+        PipelineSink sink;
+        auto onLine = [&](const std::string& line) { sink(line); };
+        OutputQueue queue([&](const std::string& chunk) { splitter.Feed(chunk.data(), chunk.size(), onLine); });
+        for (size_t at = 0; at < output.size(); at += ChunkSize) {
+            queue.Push(output.data() + at, (std::min)(ChunkSize, output.size() - at));
+        }
+        queue.Close();
+        splitter.Flush(onLine);
+        return BenchWork{ static_cast<double>(sink.Lines), outputBytes };
+    });
+
+    // Same, but the bytes come through a real pipe from a child process
+    fs::path outputFile = scratch / "ubt-output.txt";
+    if (WriteFile(outputFile, output)) {
+        bench.Run("pipeline.process_pipe", "lines", [&]() {
+            LineSplitter splitter;
+            PipelineSink sink;
+            auto onLine = [&](const std::string& line) { sink(line); };
+#ifdef _WIN32
+            ProcessUtils::RunProcess(L"cmd.exe", L"/c type \"" + outputFile.wstring() + L"\"", L"",
+#else
+            ProcessUtils::RunProcess(L"cat", L"\"" + outputFile.wstring() + L"\"", L"",
+#endif
+                [&](const std::string& chunk) { splitter.Feed(chunk.data(), chunk.size(), onLine); });
+            splitter.Flush(onLine);
+            return BenchWork{ static_cast<double>(sink.Lines), outputBytes };
+        });
+    }
+
+    // Cost of keeping output.ubtrec next to every build
+    bench.Run("pipeline.record", "chunks", [&]() {
+        OutputRecorder recorder;
+        recorder.Open(scratch / OutputRecorder::FileName);
+        size_t chunks = 0;
+        std::string chunk;
+        for (size_t at = 0; at < output.size(); at += ChunkSize, ++chunks) {
+            chunk.assign(output.data() + at, (std::min)(ChunkSize, output.size() - at));
+            recorder.Record(chunk);
+        }
+        recorder.Finish(true);
+        return BenchWork{ static_cast<double>(chunks), outputBytes };
+    });
+
+    // Real, customer-shaped output with its original chunk boundaries
+    if (!options.RecordingPath.empty()) {
+        OutputRecording recording;
+        if (recording.Load(fs::u8path(options.RecordingPath))) {
+            const double recordedBytes = static_cast<double>(recording.TotalBytes());
+            bench.Run("replay.split_classify_actionlog", "lines", [&]() {
+                LineSplitter splitter;
+                PipelineSink sink;
+                BuildActionLog log;
+                auto onLine = [&](const std::string& line) {
+                    sink(line);
+                    log.OnLine(line, 0.0);
+                };
+                recording.Replay(0.0, [&](const std::string& chunk) { splitter.Feed(chunk.data(), chunk.size(), onLine); });
+                splitter.Flush(onLine);
+                log.Finish();
+                return BenchWork{ static_cast<double>(sink.Lines), recordedBytes };
+            });
+        }
+        else {
+            std::cerr << "[Error] Cannot read recording " << options.RecordingPath << "\n";
+        }
+    }
+
+    // --- Diagnostics logging (Log.h) ---
+
+    const size_t logCount = options.Quick ? 100000 : 1000000;
+    const std::wstring logPath = L"C:/Program Files/Epic Games/UE_5.4";
+
+    // No sink takes Debug: the call site's cost in production
+    bench.Run("log.disabled", "records", [&]() {
+        for (size_t i = 0; i < logCount; ++i) Log::Debug("Bench", "Using engine root", { { "root", logPath }, { "i", i } });
+        return BenchWork{ static_cast<double>(logCount), 0.0 };
+    });
+
+    // Formatting into the ring plus the writer thread's hand-off, up to the last record
+    // reaching a (trivial) sink; records dropped for a full ring still count as handled
+    bench.Run("log.enqueue_flush", "records", [&]() {
+        std::atomic<size_t> received{ 0 };
+        int sink = Log::AddSink(LogLevel::Debug, [&received](const LogRecord&) { received.fetch_add(1, std::memory_order_relaxed); });
+        for (size_t i = 0; i < logCount; ++i) Log::Debug("Bench", "Using engine root", { { "root", logPath }, { "i", i } });
+        Log::Flush();
+        Log::RemoveSink(sink);
+        return BenchWork{ static_cast<double>(logCount), 0.0 };
+    });
+
+    // --- .uproject parsing ---
+
+    struct UProjectCase { const char* Name; int Plugins; bool AssociationLast; };
+    const UProjectCase uprojects[] = {
+        { "engine_association.typical", 8, false },
+        { "engine_association.large_last", 2000, true },
+    };
+    for (const auto& c : uprojects) {
+        fs::path path = scratch / (std::string(c.Name) + ".uproject");
+        std::string text = MakeUProject(c.Plugins, c.AssociationLast);
+        if (!WriteFile(path, text)) continue;
+
+        const int parses = c.Plugins > 100 ? 200 : 5000;
+        std::wstring projectPath = path.wstring();
+        bench.Run(c.Name, "parses", [&]() {
+            size_t found = 0;
+            for (int i = 0; i < parses; ++i) found += !EngineDetector::GetEngineAssociation(projectPath).empty();
+            return BenchWork{ static_cast<double>(found), static_cast<double>(text.size()) * parses };
+        });
+    }
+
+    // --- Project resolution over large folders ---
+
+    std::vector<size_t> folderSizes = { 10000 };
+    if (!options.Quick) folderSizes.push_back(100000);
+    for (size_t files : folderSizes) {
+        fs::path folder = scratch / ("folder_" + std::to_string(files));
+        if (!MakeLargeFolder(folder, files)) continue;
+
+        bench.Run("project_resolution.scan_" + std::to_string(files), "entries", [&]() {
+            std::wstring resolved = ProjectLocator::ResolveProjectFile(ProjectLocator::SanitizeInputPath(L" \"" + folder.wstring() + L"\" "));
+            return BenchWork{ resolved.empty() ? static_cast<double>(files) : 0.0, 0.0 };
+        });
+    }
+
+    // --- Workspace project index: a monorepo of 40 projects beside a tools tree ---
+
+    fs::path workspace = scratch / "workspace";
+    for (int i = 0; i < 40; ++i) {
+        std::string name = "Game" + std::to_string(i);
+        fs::path project = workspace / "Games" / ("Team" + std::to_string(i % 8)) / name;
+        fs::create_directories(project / "Source", ec);
+        fs::create_directories(project / "Content", ec);
+        WriteFile(project / (name + ".uproject"), MakeUProject(8, false));
+        WriteFile(project / "Source" / (name + ".Target.cs"), "");
+        WriteFile(project / "Source" / (name + "Editor.Target.cs"), "");
+    }
+    for (int i = 0; i < 500; ++i) fs::create_directories(workspace / "Tools" / ("Tool" + std::to_string(i / 50)) / std::to_string(i), ec);
+
+    ProjectIndex index;
+    index.AddRoot(workspace);
+    bench.Run("project_index.full_scan", "projects", [&]() {
+        index.Refresh(true);
+        return BenchWork{ static_cast<double>(index.Projects().size()), 0.0 };
+    });
+    bench.Run("project_index.rescan_unchanged", "projects", [&]() {
+        index.Refresh();
+        return BenchWork{ static_cast<double>(index.Projects().size()), 0.0 };
+    });
+
+    // --- Prebuilt binaries: publish, then patch a local copy from one revision to the next ---
+
+    bool prebuiltOk = true;
+    const std::string& filter = bench.Settings().Filter;
+    if (filter.empty() || std::string("prebuilt.fetch_patch").find(filter) != std::string::npos) {
+        fs::path publisher, consumer;
+        std::wstring share;
+        prebuiltOk = CheckPrebuiltRoundTrip(scratch / "prebuilt", publisher, consumer, share);
+        if (prebuiltOk) {
+            bool toB = true;
+            bench.Run("prebuilt.fetch_patch", "files", [&]() {
+                PrebuiltFetchStats stats;
+                PrebuiltCache::Fetch(share, toB ? "b" : "a", consumer, nullptr, &stats);
+                toB = !toB;
+                return BenchWork{ static_cast<double>(stats.FilesTotal), static_cast<double>(stats.BytesReused + stats.BytesTransferred) };
+            });
+        }
+    }
+
+    fs::remove_all(scratch, ec);
+    if (!bench.Finish() || !prebuiltOk) return 1;
+    return 0;
+}
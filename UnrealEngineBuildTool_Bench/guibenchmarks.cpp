@@ -0,0 +1,66 @@
+// Cost of MainWindow::appendLog per line, the last stage of the output pipeline.
+// Runs headless on the offscreen Qt platform, so it works over SSH and in CI:
+//
+//   ./build-bench/UEBuilderGuiBench --out gui.json
+
+#include "BenchHarness.h"
+#include "SyntheticUbtOutput.h"
+#include "BuildActionLog.h"
+#include "mainwindow.h"
+#include <QApplication>
+#include <QString>
+#include <vector>
+#include <memory>
+
+using namespace UEBuilder;
+
+int main(int argc, char** argv) {
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) qputenv("QT_QPA_PLATFORM", "offscreen");
+
+    // Qt consumes its own arguments (-platform ...); ours are what remains
+    QApplication app(argc, argv);
+
+    BenchRunner::Options options;
+    options.OutPath = "benchmark-results-gui.json";
+    if (!BenchRunner::ParseArgs(argc, argv, options)) {
+        BenchRunner::PrintUsage(argv[0]);
+        return 2;
+    }
+    BenchRunner bench(options);
+
+    // The log widget slows down as it fills, so each run starts from a fresh window
+    const size_t lineCount = options.Quick ? 5000 : 50000;
+    std::vector<QString> lines;
+    std::vector<QString> errorLines;
+    LineSplitter splitter;
+    SyntheticUbtOptions mix;
+    mix.ErrorPercent = 1.0;  // Enough to exercise the error path without dominating
+    std::string output = SyntheticUbtOutput(mix).Generate(lineCount);
+    double outputBytes = static_cast<double>(output.size());
+    splitter.Feed(output.data(), output.size(), [&](const std::string& line) {
+        lines.push_back(QString::fromStdString(line));
+        if (line.find("error C") != std::string::npos) errorLines.push_back(lines.back());
+    });
+
+    std::unique_ptr<MainWindow> window;
+    auto freshWindow = [&]() {
+        window.reset(new MainWindow());
+        QApplication::processEvents();
+    };
+
+    bench.Run("gui.append_log.mixed", "lines", [&]() {
+        for (const auto& line : lines) window->appendLog(line);
+        QApplication::processEvents();
+        return BenchWork{ static_cast<double>(lines.size()), outputBytes };
+    }, freshWindow);
+
+    // Errors take the HTML path; a failing build can print thousands of them
+    bench.Run("gui.append_log.errors", "lines", [&]() {
+        for (const auto& line : errorLines) window->appendLog(line);
+        QApplication::processEvents();
+        return BenchWork{ static_cast<double>(errorLines.size()), 0.0 };
+    }, freshWindow);
+
+    window.reset();
+    return bench.Finish() ? 0 : 1;
+}
@@ -0,0 +1,273 @@
+// Stand-in for UnrealBuildTool that prints realistic build output at a chosen rate, so the
+// runner, classifier, trace and GUI can be load-tested without an engine or Windows.
+//
+// Takes UBT's own command line (target, platform, config, -Project=..., -Clean, ...) and is
+// configured through environment variables, or the same names as -Sim<Name>=value arguments
+// (BuildRequest::ExtraArgs) which win over the environment:
+//
+//   UEBUILDER_SIM_ACTIONS       Number of compile/link actions                 (2000)
+//   UEBUILDER_SIM_RATE          Lines per second, 0 = as fast as possible       (200)
+//   UEBUILDER_SIM_PROCESSES     Executor processes reported                     (32)
+//   UEBUILDER_SIM_WARNINGS      Percent of actions followed by a warning         (10)
+//   UEBUILDER_SIM_ERRORS        Exactly this many failing actions                (0)
+//   UEBUILDER_SIM_ERRORPERCENT  Or: percent of actions that fail                 (0)
+//   UEBUILDER_SIM_STALLAT       Comma-separated action numbers to stall before   (none)
+//   UEBUILDER_SIM_STALLMS       Length of each stall                             (5000)
+//   UEBUILDER_SIM_DIAGNOSTICS   msvc or clang                                    (platform)
+//   UEBUILDER_SIM_UTF8          1 = non-ASCII paths in diagnostics               (0)
+//   UEBUILDER_SIM_EXITCODE      Forced exit code; otherwise 0, or 6 after errors
+//   UEBUILDER_SIM_SEED          Output is identical for identical settings
+//   UEBUILDER_SIM_REPLAY        Play back a recorded output.ubtrec instead      (none)
+//   UEBUILDER_SIM_SPEED         Replay speed, 0 = as fast as possible            (1)
+//
+// Like UBT, -WriteOutdatedActions=<file> writes the action graph of the build these settings
+// would print (compiles feed their module's link, links chain in order) and exits.
+//
+// Point the tool at it with UEBUILDER_UBT_PATH=/path/to/UnrealBuildToolSim.
+
+#include "SyntheticUbtOutput.h"
+#include "OutputRecording.h"
+#include "BuildActionLog.h"
+#include "JsonUtils.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <cstdio>
+#include <cstdlib>
+#include <cctype>
+#include <algorithm>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
+
+using namespace UEBuilder;
+
+namespace {
+
+    // -SimName=value arguments, then UEBUILDER_SIM_NAME, then the default
+    class SimSettings {
+    public:
+        SimSettings(int argc, char** argv) {
+            for (int i = 1; i < argc; ++i) {
+                std::string arg = argv[i];
+                if (arg.compare(0, 4, "-Sim") != 0) continue;
+                size_t eq = arg.find('=');
+                if (eq == std::string::npos) continue;
+                args[Upper(arg.substr(4, eq - 4))] = arg.substr(eq + 1);
+            }
+        }
+
+        std::string Get(const std::string& name, const std::string& fallback) const {
+            auto it = args.find(name);
+            if (it != args.end()) return it->second;
+            const char* env = std::getenv(("UEBUILDER_SIM_" + name).c_str());
+            return env && *env ? env : fallback;
+        }
+
+        int Int(const std::string& name, int fallback) const { return std::atoi(Get(name, std::to_string(fallback)).c_str()); }
+        double Double(const std::string& name, double fallback) const { return std::atof(Get(name, std::to_string(fallback)).c_str()); }
+
+    private:
+        std::map<std::string, std::string> args;
+
+        static std::string Upper(std::string s) {
+            std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) { return static_cast<char>(std::toupper(c)); });
+            return s;
+        }
+    };
+
+    // Writes lines at a fixed rate. Lines due at the same time go out together, then stdout is
+    // flushed, so the reader sees chunk sizes that grow with the rate just like a busy UBT.
+    class PacedWriter {
+    public:
+        explicit PacedWriter(double linesPerSecond)
+            : rate(linesPerSecond), origin(std::chrono::steady_clock::now()), start(origin) {}
+
+        void Write(const std::string& line) {
+            if (rate > 0.0) {
+                auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                       std::chrono::duration<double>(written / rate));
+                if (due > std::chrono::steady_clock::now()) {
+                    std::fflush(stdout);
+                    std::this_thread::sleep_until(due);
+                }
+            }
+            std::fwrite(line.data(), 1, line.size(), stdout);
+            std::fwrite("\r\n", 1, 2, stdout);
+            ++written;
+        }
+
+        void Stall(int milliseconds) {
+            std::fflush(stdout);
+            auto before = std::chrono::steady_clock::now();
+            std::this_thread::sleep_for(std::chrono::milliseconds(milliseconds));
+            start += std::chrono::steady_clock::now() - before; // The schedule resumes where it stopped
+        }
+
+        double Elapsed() const { return std::chrono::duration<double>(std::chrono::steady_clock::now() - origin).count(); }
+
+    private:
+        double rate;
+        double written = 0.0;
+        std::chrono::steady_clock::time_point origin;
+        std::chrono::steady_clock::time_point start;    // Of the rate schedule; moved on by stalls
+    };
+
+    // The graph behind the actions SyntheticUbtOutput prints: every compile produces an .obj
+    // that its module's link consumes, and each link also needs the one before it
+    bool WriteActionGraph(const SyntheticUbtOptions& options, const std::string& path) {
+        SyntheticUbtOutput generator(options);
+        std::vector<std::string> lines;
+        JsonValue actions = JsonValue::MakeArray();
+        std::map<std::string, std::vector<std::string>> moduleObjects;
+        std::string previousLink;
+
+        for (int id = 0; !generator.Done(); ++id) {
+            lines.clear();
+            generator.NextAction(lines);
+            BuildAction action;
+            if (lines.empty() || !BuildActionLog::ParseActionLine(lines[0], action)) continue;
+
+            JsonValue node = JsonValue::MakeObject();
+            node.Set("Id", id);
+            node.Set("Type", action.Verb);
+            node.Set("StatusDescription", action.Item);
+            JsonValue produced = JsonValue::MakeArray();
+            JsonValue prerequisites = JsonValue::MakeArray();
+
+            if (action.Verb == "Link") {
+                std::string module = action.Item.substr(action.Item.find('-') + 1);
+                module = module.substr(0, module.rfind('.'));
+                for (const auto& obj : moduleObjects[module]) prerequisites.Push(obj);
+                if (!previousLink.empty()) prerequisites.Push(previousLink);
+                previousLink = "Binaries/" + std::to_string(id) + "/" + action.Item;   // Items can repeat; outputs can't
+                produced.Push(previousLink);
+            }
+            else {
+                std::string module = action.Item.substr(7, action.Item.find('.', 7) - 7);  // Module.<Name>.n_of_m.cpp
+                std::string obj = "Intermediate/" + action.Item + "." + std::to_string(id) + ".obj";
+                moduleObjects[module].push_back(obj);
+                produced.Push(obj);
+                prerequisites.Push("Source/" + action.Item);
+            }
+            node.Set("ProducedItems", produced);
+            node.Set("PrerequisiteItems", prerequisites);
+            actions.Push(node);
+        }
+
+        JsonValue root = JsonValue::MakeObject();
+        root.Set("Actions", actions);
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (!file) return false;
+        std::string text = root.Dump(1);
+        std::fwrite(text.data(), 1, text.size(), file);
+        std::fclose(file);
+        return true;
+    }
+}
+
+int main(int argc, char** argv) {
+#ifdef _WIN32
+    // Lines already end in CRLF; stop the CRT from adding another CR
+    _setmode(_fileno(stdout), _O_BINARY);
+#endif
+
+    SimSettings settings(argc, argv);
+
+    // UBT's own arguments: the first bare word is the target; -Clean only cleans
+    std::string target;
+    std::string graphFile;
+    bool clean = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "-Clean" || arg == "-clean") clean = true;
+        else if (arg.compare(0, 22, "-WriteOutdatedActions=") == 0) {
+            graphFile = arg.substr(22);
+            if (graphFile.size() >= 2 && graphFile.front() == '"') graphFile = graphFile.substr(1, graphFile.size() - 2);
+        }
+        else if (!arg.empty() && arg[0] != '-' && target.empty()) target = arg;
+    }
+    if (target.empty()) target = "SampleEditor";
+
+    // A real build's output through a real pipe: same chunks, same pauses
+    std::string replay = settings.Get("REPLAY", "");
+    if (!replay.empty()) {
+        OutputRecording recording;
+        if (!recording.Load(fs::u8path(replay))) {
+            std::fprintf(stderr, "Cannot read recording %s\n", replay.c_str());
+            return 1;
+        }
+        bool succeeded = recording.Replay(settings.Double("SPEED", 1.0), [](const std::string& chunk) {
+            std::fwrite(chunk.data(), 1, chunk.size(), stdout);
+            std::fflush(stdout);
+        });
+        return settings.Int("EXITCODE", succeeded ? 0 : 6);
+    }
+
+    SyntheticUbtOptions options;
+    options.Target = target;
+    options.Seed = static_cast<uint32_t>(settings.Int("SEED", static_cast<int>(options.Seed)));
+    options.Actions = (std::max)(1, settings.Int("ACTIONS", 2000));
+    options.Processes = (std::max)(1, settings.Int("PROCESSES", 32));
+    options.WarningPercent = settings.Int("WARNINGS", 10);
+    options.ErrorActions = settings.Int("ERRORS", 0);
+    options.ErrorPercent = settings.Double("ERRORPERCENT", 0.0);
+#ifdef _WIN32
+    options.ClangDiagnostics = settings.Get("DIAGNOSTICS", "msvc") == "clang";
+#else
+    options.ClangDiagnostics = settings.Get("DIAGNOSTICS", "clang") != "msvc";
+#endif
+    options.Utf8Paths = settings.Int("UTF8", 0) != 0;
+
+    std::set<int> stallAt;
+    std::string stalls = settings.Get("STALLAT", "");
+    for (size_t pos = 0; pos < stalls.size();) {
+        size_t comma = stalls.find(',', pos);
+        if (comma == std::string::npos) comma = stalls.size();
+        int at = std::atoi(stalls.substr(pos, comma - pos).c_str());
+        if (at > 0) stallAt.insert(at);
+        pos = comma + 1;
+    }
+    int stallMs = (std::max)(0, settings.Int("STALLMS", 5000));
+
+    if (!graphFile.empty()) {
+        std::printf("Writing outdated actions to %s\r\n", graphFile.c_str());
+        return WriteActionGraph(options, graphFile) ? 0 : 1;
+    }
+
+    PacedWriter out(settings.Double("RATE", 200.0));
+    SyntheticUbtOutput generator(options);
+    std::vector<std::string> lines;
+
+    if (clean) {
+        out.Write("Log file: (simulated)");
+        out.Write("Cleaning " + target + " binaries...");
+        out.Write("Deleting Intermediate files...");
+        out.Write("Result: Succeeded");
+        std::fflush(stdout);
+        return settings.Int("EXITCODE", 0);
+    }
+
+    generator.Preamble(lines);
+    for (const auto& line : lines) out.Write(line);
+
+    double executorStart = out.Elapsed();
+    for (int action = 1; !generator.Done(); ++action) {
+        if (stallAt.count(action)) out.Stall(stallMs);
+
+        lines.clear();
+        generator.NextAction(lines);
+        for (const auto& line : lines) out.Write(line);
+    }
+
+    lines.clear();
+    generator.Epilogue(lines, out.Elapsed() - executorStart, out.Elapsed());
+    for (const auto& line : lines) out.Write(line);
+    std::fflush(stdout);
+
+    return settings.Int("EXITCODE", generator.ErrorsEmitted() > 0 ? 6 : 0);
+}
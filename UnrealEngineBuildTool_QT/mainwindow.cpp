@@ -4,14 +4,35 @@
 #include <QFileDialog>
 #include <QMessageBox>
 #include <QMetaObject>
+#include <QListWidget>
 
 #include <filesystem>
-#include <thread>
+#include <mutex>
+#include <memory>
 #include <algorithm>
+#include <chrono>
 
 #include "ToolchainManager.h"
+#include "ToolchainEnvironment.h"
 #include "EngineDetector.h"
 #include "ProcessUtils.h"
+#include "PrebuiltCache.h"
+#include "BuildCommand.h"
+#include "BuildActionLog.h"
+#include "MemoryGovernor.h"
+#include "ResourceSampler.h"
+#include "BuildTrace.h"
+#include "LogClassifier.h"
+#include "ProjectLocator.h"
+#include "OutputRecording.h"
+#include "PagePrefetch.h"
+#include "ProcessTree.h"
+#include "StartupPipeline.h"
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "Log.h"
+#include "ProjectIndex.h"
+#include "AutoTuner.h"
 
 using namespace UEBuilder;
 namespace fs = std::filesystem;
@@ -19,6 +40,8 @@ namespace fs = std::filesystem;
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , pool(std::make_unique<WorkerPool>())
+    , loop(std::make_unique<EventLoop>())
 {
     ui->setupUi(this);
 
@@ -33,6 +56,41 @@ MainWindow::MainWindow(QWidget *parent)
 
     connect(ui->cleanButton, &QPushButton::clicked,
             this, &MainWindow::onCleanButtonClicked);
+
+    connect(ui->resourceGraph, &ResourceGraph::exportRequested,
+            this, &MainWindow::onExportResourcesRequested);
+
+    connect(ui->addWorkspaceButton, &QPushButton::clicked,
+            this, &MainWindow::onAddWorkspaceClicked);
+
+    connect(ui->projectList, &QListWidget::itemClicked,
+            this, &MainWindow::onProjectClicked);
+
+    // Diagnostics of the engine and toolchain lookups (Log.h): the log panel from
+    // UEBUILDER_LOG_LEVEL up (the writer thread posts them over), all of them to the log file
+    logSink = Log::AddSink(Log::ConfiguredLevel(), [this](const LogRecord &record) {
+        QString line = QString::fromStdString(Log::FormatLine(record));
+        QMetaObject::invokeMethod(this, [this, line]() { appendLog(line); }, Qt::QueuedConnection);
+    });
+    logFileSink = Log::AddFileSink("gui");
+
+    // The list as it was last time, straight away; the rescan catches up in the background
+    projectIndex = std::make_unique<ProjectIndex>();
+    projectIndex->Load();
+    for (const auto &root : ProjectIndex::WorkspaceFromEnv())
+        projectIndex->AddRoot(root);
+    showProjects();
+    refreshProjects();
+
+    // Prometheus endpoint for build farms, e.g. UEBUILDER_METRICS=0.0.0.0:9464
+    std::string metricsListen = StringUtils::ToUtf8(ProcessUtils::GetEnvVar(MetricsServer::ListenEnvVar));
+    if (!metricsListen.empty()) {
+        metricsServer = std::make_unique<MetricsServer>();
+        if (metricsServer->Start(metricsListen))
+            appendLog(QString::fromStdString("Metrics at " + metricsServer->Url() + "\n"));
+        else
+            appendLog(QString::fromStdString("Cannot serve metrics on " + metricsListen + "\n"));
+    }
 }
 
 void MainWindow::onBrowseButtonClicked()
@@ -48,6 +106,89 @@ void MainWindow::onBrowseButtonClicked()
     }
 }
 
+void MainWindow::onAddWorkspaceClicked()
+{
+    QString folder = QFileDialog::getExistingDirectory(
+        this,
+        "Select Workspace Folder (searched for projects)"
+        );
+
+    if (!folder.isEmpty() && projectIndex->AddRoot(fs::path(folder.toStdWString()))) {
+        appendLog("Added workspace: " + folder);
+        refreshProjects();
+    }
+}
+
+void MainWindow::onProjectClicked(QListWidgetItem *item)
+{
+    ui->projectPathEdit->setText(item->data(Qt::UserRole).toString());
+}
+
+void MainWindow::showProjects()
+{
+    ui->projectList->clear();
+    for (const auto &project : projectIndex->Projects()) {
+        std::string targets;
+        for (const auto &target : project.Targets)
+            targets += (targets.empty() ? "" : ", ") + target;
+
+        std::string text = project.Name + "    " + (project.EngineAssociation.empty() ? "?" : project.EngineAssociation)
+                         + "    " + project.LastBuild.Describe();
+        auto *item = new QListWidgetItem(QString::fromStdString(text));
+        item->setData(Qt::UserRole, QString::fromStdWString(project.File.wstring()));
+        item->setToolTip(QString::fromStdWString(project.File.wstring())
+                         + (targets.empty() ? QString() : QString::fromStdString("\nTargets: " + targets)));
+        ui->projectList->addItem(item);
+    }
+}
+
+void MainWindow::refreshProjects()
+{
+    if (projectIndex->Roots().empty())
+        return;
+    if (projectsRefreshing) {
+        projectsRefreshAgain = true;
+        return;
+    }
+    projectsRefreshing = true;
+
+    // The scan works on a copy; the list keeps showing the old one until it is done. Only its
+    // projects and folders come back: roots added meanwhile stay, and projects built meanwhile
+    // are re-read over the copy's older entries.
+    auto index = std::make_shared<ProjectIndex>(*projectIndex);
+    pool->Submit([this, index](const CancellationToken &)
+                 {
+                     index->Refresh();
+                     index->Save();
+                     QMetaObject::invokeMethod(
+                         this,
+                         [this, index]()
+                         {
+                             projectIndex->AdoptScan(std::move(*index));
+                             projectsRefreshing = false;
+                             for (const auto &built : projectsBuiltDuringRefresh)
+                                 projectIndex->RefreshProject(built);
+                             projectsBuiltDuringRefresh.clear();
+                             showProjects();
+                             if (projectsRefreshAgain) {
+                                 projectsRefreshAgain = false;
+                                 refreshProjects();
+                             }
+                         },
+                         Qt::QueuedConnection
+                         );
+                 },
+                 JobPriority::High);
+}
+
+void MainWindow::refreshProject(const std::wstring &projectPath)
+{
+    if (projectsRefreshing)
+        projectsBuiltDuringRefresh.push_back(projectPath);
+    if (projectIndex->RefreshProject(projectPath))
+        showProjects();
+}
+
 void MainWindow::onBuildButtonClicked()
 {
     //----------------------------------------------------------
@@ -60,94 +201,116 @@ void MainWindow::onBuildButtonClicked()
         return;
     }
 
-    //----------------------------------------------------------
-    // 2. Check MSVC Build Tools
-    //----------------------------------------------------------
-    ToolchainManager toolManager;
-    if (!toolManager.IsMSVCInstalled()) {
-        QMessageBox::critical(this, "MSVC Build Tools Missing",
-                              "Microsoft C++ Build Tools were not detected.\n\n"
-                              "Please install them (or use the CLI auto-install) "
-                              "before building.");
-        return;
-    }
+    // An auto-tune that never finished would otherwise build on its trial settings
+    AutoTuner::RestoreInterrupted([this](const std::string &line) { appendLog(QString::fromStdString(line)); });
 
     //----------------------------------------------------------
-    // 3. Convert QString → std::wstring and sanitize
+    // 2. Toolchain, project and engine checks, all at once and off the UI thread
+    //    (StartupPipeline.h - the same one the CLI runs)
     //----------------------------------------------------------
-    std::wstring inputPathStr = qPath.toStdWString();
-
-    if (!inputPathStr.empty()) {
+    // Warms the page cache with what the last build read while the engine is looked up;
+    // the build job keeps it alive
+    auto prefetcher = std::make_shared<PagePrefetcher>();
 
-        // Trim whitespace
-        inputPathStr.erase(0, inputPathStr.find_first_not_of(L" \t\n\r"));
-        inputPathStr.erase(inputPathStr.find_last_not_of(L" \t\n\r") + 1);
+    StartupOptions options;
+    options.Project = qPath.toStdWString();
+    options.Prefetcher = PagePrefetcher::Enabled() ? prefetcher.get() : nullptr;
+    options.Request.Target = L"Editor"; // always Editor for now
+    options.Request.Config = L"Development";
+    options.ComputeRevision = !ProcessUtils::GetEnvVar(PrebuiltCache::LocationEnvVar).empty();
 
-        // Strip quotes
-        if (!inputPathStr.empty() && inputPathStr.front() == L'"')
-            inputPathStr.erase(0, 1);
-        if (!inputPathStr.empty() && inputPathStr.back() == L'"')
-            inputPathStr.pop_back();
-
-        // Fix drive prefix
-        if (inputPathStr.length() > 1 &&
-            inputPathStr[1] == L':' && inputPathStr[0] == L'/') {
-            inputPathStr.erase(0, 1);
-        }
-        else if (inputPathStr.length() > 1 &&
-                 inputPathStr[1] == L'/' &&
-                 (inputPathStr[0] >= L'A' && inputPathStr[0] <= L'Z')) {
-            inputPathStr.insert(1, L":");
-        }
+    ui->buildButton->setEnabled(false);
+    buildRequestedAt = Profiler::Now();
+    requestedBuild = std::make_shared<BuildMetrics>();
+    loop->Spawn(StartupPipeline::Run(*loop, *pool, options),
+                [this, prefetcher](StartupResult startup)
+                {
+                    QMetaObject::invokeMethod(
+                        this,
+                        [this, prefetcher, startup]() { onStartupFinished(startup, prefetcher); },
+                        Qt::QueuedConnection
+                        );
+                });
+}
 
-        // Normalize slashes
-        std::replace(inputPathStr.begin(), inputPathStr.end(), L'\\', L'/');
-    }
+void MainWindow::onStartupFinished(const StartupResult &startup, std::shared_ptr<PagePrefetcher> prefetcher)
+{
+    ui->buildButton->setEnabled(true);
+    std::shared_ptr<BuildMetrics> metrics = std::move(requestedBuild); // Leaves the queue if we stop here
 
     //----------------------------------------------------------
-    // 4. Resolve folder → .uproject
+    // 3. MSVC Build Tools
     //----------------------------------------------------------
-    fs::path targetPath(inputPathStr);
-    std::wstring projectPathStr;
+    // A stand-in UBT (UEBUILDER_UBT_PATH) needs no compiler
+    if (startup.Error == StartupError::ToolchainMissing) {
+        auto answer = QMessageBox::question(this, "MSVC Build Tools Missing",
+                                            "Microsoft C++ Build Tools were not detected.\n\n"
+                                            "Download and install them now? The download resumes "
+                                            "if it was interrupted before.");
+        if (answer != QMessageBox::Yes)
+            return;
 
-    if (targetPath.extension() == L".uproject") {
+        // Not cancellable: stopping the VS installer halfway can leave a broken install
+        ui->buildButton->setEnabled(false);
+        pool->Submit([this](const CancellationToken &)
+                    {
+                        auto postLog = [this](const std::string &line)
+                        {
+                            QString qLine = QString::fromStdString(line);
+                            QMetaObject::invokeMethod(
+                                this,
+                                [this, qLine]() { appendLog(qLine); },
+                                Qt::QueuedConnection
+                                );
+                        };
 
-        projectPathStr = targetPath.wstring();
+                        ToolchainManager installer;
+                        bool installed = installer.InstallTools(postLog);
 
-    } else if (fs::is_directory(targetPath)) {
+                        QMetaObject::invokeMethod(
+                            this,
+                            [this, installed]()
+                            {
+                                ui->buildButton->setEnabled(true);
+                                if (installed)
+                                    appendLog("Build Tools installed. Press Build to continue.\n");
+                            },
+                            Qt::QueuedConnection
+                            );
+                    }, JobPriority::High);
+        return;
+    }
 
-        bool found = false;
-        for (const auto &entry : fs::directory_iterator(targetPath)) {
-            if (entry.is_regular_file() && entry.path().extension() == L".uproject") {
-                projectPathStr = entry.path().wstring();
-                found = true;
-                break;
-            }
-        }
+    if (startup.Error == StartupError::Failed) {
+        QMessageBox::critical(this, "Build Setup Failed", QString::fromStdString(startup.Problem));
+        return;
+    }
 
-        if (!found) {
+    //----------------------------------------------------------
+    // 4. Folder → .uproject
+    //----------------------------------------------------------
+    if (startup.ProjectPath.empty()) {
+        if (startup.TargetIsDirectory) {
             QMessageBox::critical(this, "No .uproject Found",
                                   "No .uproject file was found in the selected folder.");
-            return;
+        } else {
+            QMessageBox::critical(this, "Invalid Path",
+                                  "The selected path is not a folder or a .uproject file.");
         }
-
-    } else {
-        QMessageBox::critical(this, "Invalid Path",
-                              "The selected path is not a folder or a .uproject file.");
         return;
     }
 
-    if (!fs::exists(projectPathStr)) {
+    if (startup.Error == StartupError::ProjectNotFound) {
         QMessageBox::critical(this, "Path Error",
                               "The resolved .uproject path does not exist.");
         return;
     }
+    std::wstring projectPathStr = startup.ProjectPath;
 
     //----------------------------------------------------------
     // 5. Engine detection
     //----------------------------------------------------------
-    std::wstring association =
-        EngineDetector::GetEngineAssociation(projectPathStr);
+    std::wstring association = startup.Association;
 
     if (association.empty()) {
         QMessageBox::critical(this, "Engine Detection Failed",
@@ -155,41 +318,50 @@ void MainWindow::onBuildButtonClicked()
         return;
     }
 
-    EngineInfo engine = EngineDetector::FindEngine(association);
-
-    if (!engine.IsValid) {
+    if (startup.Error == StartupError::EngineNotFound) {
         QMessageBox::critical(this, "Unreal Engine Not Found",
                               "Could not locate the Unreal Engine installation.\n"
                               "Verify this version is installed and registered.");
         return;
     }
+    const EngineInfo &engine = startup.Engine;
+
+    ToolchainSelection toolchain;
+    if (startup.ToolchainSelected) {
+        toolchain = startup.Toolchain;
+        if (toolchain.IsValid) {
+            appendLog(QString::fromStdString("[Info] Toolchain: " + toolchain.Describe() + "\n"));
+            if (!startup.EnvironmentLog.empty())
+                appendLog(QString::fromStdString(startup.EnvironmentLog));
+        }
+        else {
+#ifdef _WIN32
+            QMessageBox::critical(this, "No Matching Toolchain", QString::fromStdString(toolchain.Problem));
+            return;
+#else
+            appendLog(QString::fromStdString("[Warning] " + toolchain.Problem + "\n"));
+#endif
+        }
+    }
+    // Toolchain variables applied (vcvarsall's, captured once per toolset)
+    EnvironmentBlock environment = startup.Environment;
 
     //----------------------------------------------------------
     // 6. Build command (always Development)
     //----------------------------------------------------------
-    std::wstring filename =
-        fs::path(projectPathStr).stem().wstring();
-
-    std::string config   = "Development";
-    std::string platform = "Win64";
-    std::string target   = "Editor"; // always Editor for now
-
-    std::wstring buildTarget =
-        (target == "Game")
-            ? filename
-            : filename + std::wstring(target.begin(), target.end());
+    BuildRequest request;
+    request.ProjectPath = projectPathStr;
+    request.Target      = L"Editor"; // always Editor for now
+    request.Config      = L"Development";
 
-    std::wstring wConfig(config.begin(), config.end());
-    std::wstring wPlatform(platform.begin(), platform.end());
-
-    std::wstring args =
-        buildTarget + L" " + wPlatform + L" " + wConfig +
-        L" -project=\"" + projectPathStr + L"\"" +
-        L" -waitmutex -progress";
+    std::wstring buildTarget = BuildCommand::GetBuildTarget(request);
+    std::wstring args        = BuildCommand::GetUBTArgs(request);
 
     appendLog("Starting build...\n");
+    ui->resourceGraph->clear();
 
     // Disable button during build
+    buildRunning = true;
     ui->buildButton->setEnabled(false);
     ui->buildButton->setText("Building...");
 
@@ -198,42 +370,219 @@ void MainWindow::onBuildButtonClicked()
     //----------------------------------------------------------
     auto ubtPath = engine.UBTPath; // copy for lambda
 
-    std::thread([this, ubtPath, args]()
+    // Optional shared location where a build machine publishes prebuilt binaries
+    std::wstring prebuiltSource = ProcessUtils::GetEnvVar(PrebuiltCache::LocationEnvVar);
+    std::string prebuiltRevision = startup.PrebuiltRevision; // Hashed during startup
+
+    int64_t requestedAt = buildRequestedAt;
+
+    buildJob = pool->Submit([this, ubtPath, args, projectPathStr, prebuiltSource, prebuiltRevision,
+                 buildTarget, request, prefetcher, environment, requestedAt, metrics](const CancellationToken &token)
                 {
-                    bool success = ProcessUtils::RunProcess(
-                        ubtPath,
-                        args,
-                        L"",
-                        [this](const std::string &line)
+                    metrics->Start(StringUtils::ToUtf8(buildTarget), StringUtils::ToUtf8(request.Config));
+                    auto started = std::chrono::steady_clock::now();
+
+                    // For the project list: kept with the project, then re-read into the index
+                    auto recordBuild = [&](const char *result)
+                    {
+                        ProjectBuildStatus status;
+                        status.Result = result;
+                        status.Target = StringUtils::ToUtf8(buildTarget);
+                        status.Config = StringUtils::ToUtf8(request.Config);
+                        status.FinishedAt = ProjectBuildStatus::Now();
+                        status.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+                        ProjectIndex::RecordBuild(projectPathStr, status);
+                    };
+
+                    auto postLog = [this](const std::string &line)
+                    {
+                        QString qLine = QString::fromStdString(line);
+                        QMetaObject::invokeMethod(
+                            this,
+                            [this, qLine]() { appendLog(qLine); },
+                            Qt::QueuedConnection
+                            );
+                    };
+
+                    // Everything measured is kept with the build; the trace is written as it happens
+                    fs::path recordDir = BuildCommand::CreateBuildRecordDir(projectPathStr);
+                    BuildTrace trace;
+                    trace.Open(recordDir / "trace.json");
+
+                    //------------------------------------------------------
+                    // Skip compiling entirely if a matching prebuilt exists
+                    //------------------------------------------------------
+                    if (!prebuiltSource.empty() && !prebuiltRevision.empty()) {
+                        auto stage = trace.Stage("Prebuilt check");
+                        if (PrebuiltCache::HasPrebuilt(prebuiltSource, prebuiltRevision) &&
+                            PrebuiltCache::Fetch(prebuiltSource, prebuiltRevision, projectPathStr, postLog)) {
+                            BuildTrace::SaveProfile(recordDir, requestedAt);
+                            metrics->Finish(true);
+                            recordBuild("succeeded");
+                            QMetaObject::invokeMethod(
+                                this,
+                                [this, projectPathStr]()
+                                {
+                                    appendLog("\n--- PREBUILT BINARIES APPLIED ---\n");
+                                    refreshProject(projectPathStr);
+                                    buildRunning = false;
+                                    ui->buildButton->setEnabled(true);
+                                    ui->buildButton->setText("Build");
+                                },
+                                Qt::QueuedConnection
+                                );
+                            return;
+                        }
+                        postLog("No usable prebuilt binaries, building locally.\n");
+                    }
+
+                    // Where the tool's own time went between the click and UBT
+                    BuildTrace::SaveProfile(recordDir, requestedAt);
+
+                    // Per-action timings, kept with the build for the unity advisor
+                    BuildActionLog actionLog(trace.StartTime());
+                    trace.Attach(actionLog);
+
+                    // Pauses compilers instead of letting them run out of memory
+                    MemoryGovernor governor(postLog);
+
+                    // Feeds the live graph next to the log
+                    ResourceSampler sampler(
+                        ResourceSampler::DefaultIntervalMs(),
+                        [this](const ResourceSample &sample)
                         {
-                            QString qLine = QString::fromStdString(line);
                             QMetaObject::invokeMethod(
                                 this,
-                                [this, qLine]() { appendLog(qLine); },
+                                [this, sample]() { ui->resourceGraph->addSample(sample); },
                                 Qt::QueuedConnection
                                 );
+                        });
+
+                    RunOptions runOptions;
+                    OutputQueueStats outputStats;
+                    runOptions.Output.Overflow = OutputQueue::ParseOverflowPolicy(
+                        ProcessUtils::GetEnvVar(OutputQueue::OverflowEnvVar));
+                    runOptions.OutputStats = &outputStats;
+                    // Cancel (or closing the window) ends UBT and the compilers it started. The
+                    // callback can outlive this job (Cancel may come after it returns), so it only
+                    // shares the pid, which is cleared before UBT is reaped and its id can be reused.
+                    struct UbtProcess {
+                        std::mutex Mutex;
+                        ProcessId Pid = 0;
+                    };
+                    auto ubt = std::make_shared<UbtProcess>();
+                    runOptions.OnStarted = [&governor, &sampler, ubt, &token](ProcessId pid)
+                    {
+                        {
+                            std::lock_guard<std::mutex> lock(ubt->Mutex);
+                            ubt->Pid = pid;
                         }
-                        );
+                        governor.Start(pid);
+                        sampler.Start(pid);
+                        if (token.IsCancelled())
+                            ProcessTree::TerminateTree(pid);
+                    };
+                    runOptions.OnExited = [ubt](ProcessId)
+                    {
+                        std::lock_guard<std::mutex> lock(ubt->Mutex);
+                        ubt->Pid = 0;
+                    };
+                    size_t onCancel = token.OnCancel([ubt]()
+                    {
+                        std::lock_guard<std::mutex> lock(ubt->Mutex);
+                        if (ubt->Pid != 0)
+                            ProcessTree::TerminateTree(ubt->Pid);
+                    });
+
+                    if (!environment.Empty())
+                        runOptions.Environment = &environment;
+
+                    // Raw output with its original chunking and timing; UEBUILDER_REPLAY
+                    // plays such a recording back instead of running UBT
+                    std::wstring replayPath = ProcessUtils::GetEnvVar(OutputRecording::ReplayEnvVar);
+                    OutputRecorder recorder;
+                    if (replayPath.empty() && recorder.Open(recordDir / OutputRecorder::FileName))
+                        runOptions.OnRawChunk = recorder.Tap();
+
+                    LogCallback onOutput = [&actionLog, &postLog, &metrics](const std::string &line)
+                    {
+                        actionLog.Feed(line);
+                        metrics->CountOutput(line);
+                        postLog(line);
+                    };
+
+                    bool success = false;
+                    {
+                        auto stage = trace.Stage("UnrealBuildTool");
+                        if (token.IsCancelled()) {
+                            // Cancelled while the prebuilt check or the environment capture ran
+                        } else if (!replayPath.empty()) {
+                            OutputRecording recording;
+                            if (recording.Load(replayPath))
+                                success = recording.Replay(OutputRecording::SpeedFromEnv(), onOutput);
+                            else
+                                postLog("Cannot read recording " + StringUtils::ToUtf8(replayPath) + "\n");
+                        } else {
+                            success = ProcessUtils::RunProcess(
+                                ubtPath,
+                                args,
+                                L"",
+                                onOutput,
+                                runOptions
+                                );
+                        }
+                        token.RemoveOnCancel(onCancel);
+                        recorder.Finish(success);
+                        governor.Stop();
+                        sampler.Stop();
+                        actionLog.Finish();
+                        metrics->Finish(success);
+                    }
+                    if (outputStats.Overflowed())
+                        postLog("[Info] Output fell behind UBT: " + OutputQueue::FormatStats(outputStats) + "\n");
+
+                    {
+                        auto stage = trace.Stage("Save build records");
+                        actionLog.Save(recordDir / "actions.json");
+                        sampler.SaveCsv(recordDir);
+                        if (replayPath.empty())
+                            PrefetchList::Learn(projectPathStr, ubtPath);
+                    }
+                    trace.Close();
+
+                    QString qRecordDir = QString::fromStdWString(recordDir.wstring());
+                    bool cancelled = token.IsCancelled();
+                    recordBuild(success ? "succeeded" : cancelled ? "cancelled" : "failed");
 
                     QMetaObject::invokeMethod(
                         this,
-                        [this, success]()
+                        [this, success, cancelled, qRecordDir, projectPathStr]()
                         {
-                            appendLog(success
-                                          ? "\n--- BUILD SUCCESSFUL ---\n"
-                                          : "\n--- BUILD FAILED ---\n");
+                            lastBuildRecordDir = qRecordDir;
+
+                            appendLog(success     ? "\n--- BUILD SUCCESSFUL ---\n"
+                                      : cancelled ? "\n--- BUILD CANCELLED ---\n"
+                                                  : "\n--- BUILD FAILED ---\n");
+                            refreshProject(projectPathStr);
 
                             // Re-enable build button
+                            buildRunning = false;
                             ui->buildButton->setEnabled(true);
                             ui->buildButton->setText("Build");
                         },
                         Qt::QueuedConnection
                         );
-                }).detach();
+                });
 }
 
+// Stops a running build; otherwise closes the window
 void MainWindow::onCancelButtonClicked()
 {
+    if (buildRunning) {
+        appendLog("\nCancelling build...\n");
+        buildJob.Cancel();
+        return;
+    }
     close();
 }
 
@@ -250,11 +599,13 @@ void MainWindow::onCleanButtonClicked()
     ui->cleanButton->setEnabled(false);
     ui->cleanButton->setText("Cleaning...");
 
-    // Clean in a background thread
-    std::thread([this]()
+    // Read on the UI thread; the job only gets the copy
+    fs::path selectedPath(ui->projectPathEdit->text().trimmed().toStdWString());
+
+    // Clean in the background; ahead of any queued build work
+    pool->Submit([this, selectedPath](const CancellationToken &token)
                 {
                     // Resolve project root from what is in the line edit
-                    fs::path selectedPath(ui->projectPathEdit->text().toStdWString());
                     fs::path projectRoot;
 
                     if (selectedPath.extension() == L".uproject") {
@@ -276,10 +627,13 @@ void MainWindow::onCleanButtonClicked()
                         return;
                     }
 
-                    // Delete Intermediate, Saved, Binaries
-                    fs::remove_all(projectRoot / "Intermediate");
-                    fs::remove_all(projectRoot / "Saved");
-                    fs::remove_all(projectRoot / "Binaries");
+                    // Delete Intermediate, Saved, Binaries; a window closing meanwhile skips the rest
+                    std::error_code ec;
+                    for (const char *folder : { "Intermediate", "Saved", "Binaries" }) {
+                        if (token.IsCancelled())
+                            return;
+                        fs::remove_all(projectRoot / folder, ec);
+                    }
 
                     // When done, trigger rebuild on UI thread
                     QMetaObject::invokeMethod(
@@ -298,50 +652,68 @@ void MainWindow::onCleanButtonClicked()
                         Qt::QueuedConnection
                         );
 
-                }).detach();
+                }, JobPriority::High);
+}
+
+// ----------------------------------------------------
+// EXPORT RESOURCE SAMPLES (graph context menu)
+// ----------------------------------------------------
+void MainWindow::onExportResourcesRequested()
+{
+    if (lastBuildRecordDir.isEmpty()) {
+        QMessageBox::information(this, "Nothing to Export",
+                                 "Resource samples are available after a build finishes.");
+        return;
+    }
+
+    QString folder = QFileDialog::getExistingDirectory(this, "Export Resource Samples To");
+    if (folder.isEmpty())
+        return;
+
+    fs::path source(lastBuildRecordDir.toStdWString());
+    fs::path target(folder.toStdWString());
+    std::error_code ec;
+    for (const char *name : { "utilization.csv", "processes.csv" })
+        fs::copy_file(source / name, target / name, fs::copy_options::overwrite_existing, ec);
+
+    if (ec)
+        appendLog("Export failed: " + QString::fromStdString(ec.message()));
+    else
+        appendLog("Resource samples exported to: " + folder);
 }
 
 MainWindow::~MainWindow()
 {
+    // Cancels and joins the jobs while the widgets they post to still exist; a startup
+    // still in flight is left where it is
+    Log::RemoveSink(logSink);
+    pool->Shutdown();
+    loop->Stop();
+    Log::RemoveSink(logFileSink);
     delete ui;
 }
 
 void MainWindow::appendLog(const QString &text)
 {
-    QString line  = text;
-    QString lower = line.toLower();
+    const LogClassification kind = LogClassifier::Classify(text.toStdString());
 
     // ----------------------------------------------------
     // 1. Detect when a clean is needed (before any coloring)
     // ----------------------------------------------------
-    if (!cleanNeeded &&
-        (lower.contains("intermediate") ||
-         lower.contains("msb3073") ||
-         lower.contains("ubt error") ||
-         lower.contains("action failed") ||
-         lower.contains("build failed") ||
-         lower.contains("could not find") ||
-         lower.contains("cannot open include file")))
+    if (!cleanNeeded && kind.SuggestsClean)
     {
         cleanNeeded = true;
         ui->cleanButton->setEnabled(true);
     }
 
     // ----------------------------------------------------
-    // 2. Detect typical *error* patterns (case-insensitive)
+    // 2. Typical *error* patterns (case-insensitive)
     // ----------------------------------------------------
-    bool isError =
-        lower.contains("error:") ||
-        lower.contains("error ")  ||
-        lower.contains("failed")  ||
-        lower.contains("unresolved external") ||
-        lower.contains("fatal error");
-
-    if (isError)
+    if (kind.IsError)
     {
         // Wrap in HTML for red text
         QString html = "<span style=\"color:#ff4444;\">" +
-                       line.toHtmlEscaped() +
+                       text.toHtmlEscaped() +
                        "</span>";
 
         ui->logOutput->appendHtml(html);
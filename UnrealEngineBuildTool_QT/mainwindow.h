@@ -3,6 +3,23 @@
 
 #include <QMainWindow>
 
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "WorkerPool.h"
+#include "EventLoop.h"
+
+namespace UEBuilder {
+struct StartupResult;
+class PagePrefetcher;
+class BuildMetrics;
+class MetricsServer;
+class ProjectIndex;
+}
+
+class QListWidgetItem;
+
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MainWindow;
@@ -17,22 +34,57 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // Adds one line of build output, coloured by LogClassifier (GUI thread only)
+    void appendLog(const QString& text);
+
 private slots:
     void onBrowseButtonClicked();
     void onBuildButtonClicked();
     void onCancelButtonClicked();
     void onCleanButtonClicked();
+    void onExportResourcesRequested();
+    void onAddWorkspaceClicked();
+    void onProjectClicked(QListWidgetItem *item);
 
 private:
     Ui::MainWindow *ui;
 
-    void appendLog(const QString& text);
+    // Reports the startup checks and starts the build (GUI thread)
+    void onStartupFinished(const UEBuilder::StartupResult &startup, std::shared_ptr<UEBuilder::PagePrefetcher> prefetcher);
+
+    // Fills the project list from the index as it stands (GUI thread)
+    void showProjects();
+    // Rescans the workspace roots on the pool and shows the result when it is done
+    void refreshProjects();
+    // Re-reads one project after building it and shows the change (GUI thread)
+    void refreshProject(const std::wstring &projectPath);
 
     // --------------------------
     // Build/Clean state tracking
     // --------------------------
     bool buildRunning = false;   // True only while a build is active
     bool cleanNeeded = false;    // Becomes true if log suggests a clean is required
+    int64_t buildRequestedAt = 0; // Profiler::Now() at the Build click; the build's Profile.txt starts here
+
+    QString lastBuildRecordDir;  // Saved/UEBuilder/Builds/<timestamp> of the last finished build
+
+    // All background work (builds, cleans, installs) runs here. Its jobs touch the window only
+    // through queued calls, and the destructor cancels and joins them before the UI goes away.
+    std::unique_ptr<UEBuilder::WorkerPool> pool;
+    std::unique_ptr<UEBuilder::EventLoop> loop; // Runs the startup pipeline's coroutines
+    UEBuilder::Job<void> buildJob; // The running build, for Cancel
+
+    std::shared_ptr<UEBuilder::BuildMetrics> requestedBuild; // Queued from the Build click until the job takes it
+    std::unique_ptr<UEBuilder::MetricsServer> metricsServer; // Only with UEBUILDER_METRICS set
+    // Every project under the workspace roots (ProjectIndex.h); shown as loaded at startup,
+    // then updated from each background rescan
+    std::unique_ptr<UEBuilder::ProjectIndex> projectIndex;
+    bool projectsRefreshing = false;
+    bool projectsRefreshAgain = false; // A root was added during a rescan
+    std::vector<std::wstring> projectsBuiltDuringRefresh; // Re-read again once the rescan's older copy lands
+
+    int logSink = 0;        // Log.h sink feeding appendLog; removed before the window goes
+    int logFileSink = 0;
 };
 
 #endif // MAINWINDOW_H
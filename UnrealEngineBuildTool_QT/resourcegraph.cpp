@@ -0,0 +1,97 @@
+#include "resourcegraph.h"
+
+#include <QPainter>
+#include <QPainterPath>
+#include <QContextMenuEvent>
+#include <QMenu>
+
+#include <algorithm>
+
+#include "SystemInfo.h"
+
+ResourceGraph::ResourceGraph(QWidget *parent)
+    : QWidget(parent)
+    , totalMemory(static_cast<double>(UEBuilder::SystemInfo::GetTotalMemory()))
+{
+    setToolTip("Build resource usage\n"
+               "Green: CPU (all cores)\n"
+               "Blue: memory (of physical RAM)\n"
+               "Orange: disk I/O (relative to peak)\n\n"
+               "Right-click to export the last build's samples.");
+}
+
+void ResourceGraph::addSample(const UEBuilder::ResourceSample &sample)
+{
+    samples.push_back(sample);
+    if (samples.size() > maxSamples)
+        samples.remove(0, samples.size() - maxSamples);
+
+    peakIo = std::max(peakIo, static_cast<double>(sample.ReadBytesPerSec + sample.WriteBytesPerSec));
+    update();
+}
+
+void ResourceGraph::clear()
+{
+    samples.clear();
+    peakIo = 1.0;
+    update();
+}
+
+void ResourceGraph::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), QColor(30, 30, 30));
+
+    // 25% grid lines
+    painter.setPen(QColor(60, 60, 60));
+    for (int i = 1; i < 4; ++i) {
+        int y = height() * i / 4;
+        painter.drawLine(0, y, width(), y);
+    }
+
+    if (samples.size() < 2)
+        return;
+
+    // One series as 0..1 values, newest sample at the right edge
+    auto drawSeries = [&](const QColor &color, auto valueOf)
+    {
+        QPainterPath path;
+        double step = static_cast<double>(width()) / (maxSamples - 1);
+        double x = width() - step * (samples.size() - 1);
+
+        for (int i = 0; i < samples.size(); ++i, x += step) {
+            double value = std::clamp(valueOf(samples[i]), 0.0, 1.0);
+            QPointF point(x, (height() - 1) * (1.0 - value));
+            if (i == 0) path.moveTo(point);
+            else path.lineTo(point);
+        }
+
+        painter.setPen(QPen(color, 1.5));
+        painter.drawPath(path);
+    };
+
+    drawSeries(QColor(255, 160, 60), [this](const UEBuilder::ResourceSample &s)
+               { return (s.ReadBytesPerSec + s.WriteBytesPerSec) / peakIo; });
+    drawSeries(QColor(80, 160, 255), [this](const UEBuilder::ResourceSample &s)
+               { return totalMemory > 0.0 ? s.RssBytes / totalMemory : 0.0; });
+    drawSeries(QColor(90, 220, 90), [](const UEBuilder::ResourceSample &s)
+               { return s.CpuPercent / 100.0; });
+
+    // Latest values
+    const auto &last = samples.back();
+    painter.setPen(Qt::white);
+    painter.drawText(rect().adjusted(4, 2, -4, -2), Qt::AlignLeft | Qt::AlignTop,
+                     QString("CPU %1%\nMem %2 GB\nI/O %3 MB/s")
+                         .arg(last.CpuPercent, 0, 'f', 0)
+                         .arg(last.RssBytes / 1073741824.0, 0, 'f', 1)
+                         .arg((last.ReadBytesPerSec + last.WriteBytesPerSec) / 1048576.0, 0, 'f', 1));
+}
+
+void ResourceGraph::contextMenuEvent(QContextMenuEvent *event)
+{
+    QMenu menu(this);
+    QAction *exportAction = menu.addAction("Export samples...");
+    if (menu.exec(event->globalPos()) == exportAction)
+        emit exportRequested();
+}
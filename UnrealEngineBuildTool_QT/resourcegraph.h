@@ -0,0 +1,34 @@
+#ifndef RESOURCEGRAPH_H
+#define RESOURCEGRAPH_H
+
+#include <QWidget>
+#include <QVector>
+
+#include "ResourceSampler.h"
+
+// Live CPU / memory / I/O chart of the running build, fed by ResourceSampler
+class ResourceGraph : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ResourceGraph(QWidget *parent = nullptr);
+
+    void addSample(const UEBuilder::ResourceSample &sample);
+    void clear();
+
+signals:
+    void exportRequested();
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void contextMenuEvent(QContextMenuEvent *event) override;
+
+private:
+    QVector<UEBuilder::ResourceSample> samples; // Most recent maxSamples only
+    int maxSamples = 240;
+    double totalMemory = 0.0;
+    double peakIo = 1.0;                        // I/O has no natural ceiling; scale to the busiest tick
+};
+
+#endif // RESOURCEGRAPH_H
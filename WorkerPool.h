@@ -0,0 +1,271 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <algorithm>
+#include "Profiler.h"
+
+namespace UEBuilder {
+
+    // Shared flag a job polls to find out it should stop. Cancel() also runs the callbacks
+    // registered with OnCancel - that is how a job stops a child process it is waiting on.
+    class CancellationToken {
+    public:
+        CancellationToken() : state(std::make_shared<State>()) {}
+
+        bool IsCancelled() const { return state->Cancelled.load(); }
+        bool SameAs(const CancellationToken& other) const { return state == other.state; }
+
+        void Cancel() const {
+            std::vector<std::pair<size_t, std::function<void()>>> callbacks;
+            {
+                std::lock_guard<std::mutex> lock(state->Mutex);
+                if (state->Cancelled.exchange(true)) return;
+                callbacks.swap(state->Callbacks);
+            }
+            for (auto& callback : callbacks) callback.second();
+        }
+
+        // Runs right away when already cancelled (and returns 0). The id removes it again with
+        // RemoveOnCancel, which a job must do before anything the callback uses goes away.
+        size_t OnCancel(std::function<void()> callback) const {
+            {
+                std::lock_guard<std::mutex> lock(state->Mutex);
+                if (!state->Cancelled.load()) {
+                    size_t id = ++state->NextId;
+                    state->Callbacks.emplace_back(id, std::move(callback));
+                    return id;
+                }
+            }
+            callback();
+            return 0;
+        }
+
+        // A callback already running (Cancel on another thread) is not waited for
+        void RemoveOnCancel(size_t id) const {
+            if (id == 0) return;
+            std::lock_guard<std::mutex> lock(state->Mutex);
+            auto& callbacks = state->Callbacks;
+            callbacks.erase(std::remove_if(callbacks.begin(), callbacks.end(), [id](const auto& c) { return c.first == id; }),
+                            callbacks.end());
+        }
+
+    private:
+        struct State {
+            std::atomic<bool> Cancelled{ false };
+            std::mutex Mutex;
+            std::vector<std::pair<size_t, std::function<void()>>> Callbacks;
+            size_t NextId = 0;
+        };
+        std::shared_ptr<State> state;
+    };
+
+    enum class JobPriority {
+        High,       // Short and user-facing: cleans, hashes, lookups
+        Normal,     // Builds
+    };
+
+    // What Submit hands back: the job's result once it finishes, and the token that stops it.
+    // A job dropped by Shutdown before it started leaves a future that throws broken_promise.
+    template <typename T>
+    struct Job {
+        std::shared_future<T> Result;
+        CancellationToken Token;
+
+        bool IsValid() const { return Result.valid(); }
+        bool IsDone() const { return Result.valid() && Result.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+        void Cancel() const { Token.Cancel(); }
+    };
+
+    // Small work-stealing pool that owns background work. Each worker has its own deque: jobs a
+    // worker submits go to the back of it and it takes from the back (the most recent, still warm
+    // work); idle workers steal from the front of the others'. Jobs from outside the pool are dealt
+    // round-robin. High-priority jobs share one queue that every worker checks first, so a clean
+    // or a hash never waits behind a build.
+    //
+    // Shutdown() cancels every job's token, drops the ones that haven't started and joins the
+    // workers; the destructor does the same. Jobs are expected to check their token (or register
+    // OnCancel) so that takes moments, not a whole build.
+    class WorkerPool {
+    public:
+        explicit WorkerPool(size_t threads = DefaultThreads()) {
+            threads = (std::max)(threads, static_cast<size_t>(1));
+            for (size_t i = 0; i < threads; ++i) queues.emplace_back(new WorkerQueue());
+            for (size_t i = 0; i < threads; ++i) workers.emplace_back([this, i]() { WorkerLoop(i); });
+        }
+
+        ~WorkerPool() { Shutdown(); }
+
+        WorkerPool(const WorkerPool&) = delete;
+        WorkerPool& operator=(const WorkerPool&) = delete;
+
+        // Builds mostly wait on UBT, so a few threads go a long way
+        static size_t DefaultThreads() {
+            return (std::max)(2u, (std::min)(4u, std::thread::hardware_concurrency()));
+        }
+
+        // fn(const CancellationToken&) -> T. After Shutdown the job is not run and its future is broken.
+        template <typename Fn>
+        auto Submit(Fn&& fn, JobPriority priority = JobPriority::Normal) -> Job<std::invoke_result_t<Fn&, const CancellationToken&>> {
+            using Result = std::invoke_result_t<Fn&, const CancellationToken&>;
+            Job<Result> job;
+            CancellationToken token = job.Token;
+            auto task = std::make_shared<std::packaged_task<Result()>>(
+                [fn = std::forward<Fn>(fn), token]() mutable { return fn(token); });
+            job.Result = task->get_future().share();
+
+            Task entry{ [task]() { (*task)(); }, token };
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) return job;
+                WorkerQueue& queue = priority == JobPriority::High ? highPriority
+                                   : CurrentWorker() >= 0 ? *queues[static_cast<size_t>(CurrentWorker())]
+                                   : *queues[nextQueue++ % queues.size()];
+                {
+                    std::lock_guard<std::mutex> queueLock(queue.Mutex);
+                    queue.Tasks.push_back(std::move(entry));
+                }
+                tokens.push_back(token);
+                ++pending;  // Only after the task is queued: a worker that claims it will find it
+            }
+            wake.notify_one();
+            return job;
+        }
+
+        size_t ThreadCount() const { return workers.size(); }
+
+        // Submitted and not yet finished, running ones included
+        size_t ActiveJobs() const {
+            std::lock_guard<std::mutex> lock(mutex);
+            return pending + running;
+        }
+
+        void CancelAll() {
+            std::vector<CancellationToken> all;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                all = tokens;
+            }
+            for (const auto& token : all) token.Cancel();
+        }
+
+        // Blocks until every worker has exited
+        void Shutdown() {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (stopping) return;
+                stopping = true;
+            }
+            CancelAll();
+            wake.notify_all();
+            for (auto& worker : workers) {
+                if (worker.joinable()) worker.join();
+            }
+
+            // Never started: dropping the tasks breaks their futures
+            std::lock_guard<std::mutex> lock(mutex);
+            {
+                std::lock_guard<std::mutex> queueLock(highPriority.Mutex);
+                highPriority.Tasks.clear();
+            }
+            for (auto& queue : queues) {
+                std::lock_guard<std::mutex> queueLock(queue->Mutex);
+                queue->Tasks.clear();
+            }
+            pending = 0;
+            tokens.clear();
+        }
+
+    private:
+        struct Task {
+            std::function<void()> Run;
+            CancellationToken Token;
+        };
+
+        struct WorkerQueue {
+            std::mutex Mutex;
+            std::deque<Task> Tasks;
+        };
+
+        std::vector<std::unique_ptr<WorkerQueue>> queues;
+        std::vector<std::thread> workers;
+        WorkerQueue highPriority;
+        std::vector<CancellationToken> tokens;      // Of unfinished jobs, for CancelAll
+        mutable std::mutex mutex;                   // Guards the counters, tokens and stopping; queues have their own
+        std::condition_variable wake;
+        size_t pending = 0;
+        size_t running = 0;
+        size_t nextQueue = 0;
+        bool stopping = false;
+
+        // This thread's index in this pool; -1 on other threads, other pools' workers included
+        int CurrentWorker() const { return currentPool == this ? currentIndex : -1; }
+        static thread_local const WorkerPool* currentPool;
+        static thread_local int currentIndex;
+
+        static bool TakeFront(WorkerQueue& queue, Task& task) {
+            std::lock_guard<std::mutex> lock(queue.Mutex);
+            if (queue.Tasks.empty()) return false;
+            task = std::move(queue.Tasks.front());
+            queue.Tasks.pop_front();
+            return true;
+        }
+
+        // High priority first, then our own queue from the back, then the others from the front
+        bool Take(size_t self, Task& task) {
+            if (TakeFront(highPriority, task)) return true;
+            for (size_t n = 0; n < queues.size(); ++n) {
+                size_t i = (self + n) % queues.size();
+                std::lock_guard<std::mutex> lock(queues[i]->Mutex);
+                auto& tasks = queues[i]->Tasks;
+                if (tasks.empty()) continue;
+                if (n == 0) {
+                    task = std::move(tasks.back());
+                    tasks.pop_back();
+                }
+                else {
+                    task = std::move(tasks.front());
+                    tasks.pop_front();
+                }
+                return true;
+            }
+            return false;
+        }
+
+        void WorkerLoop(size_t self) {
+            currentPool = this;
+            currentIndex = static_cast<int>(self);
+            UEBUILDER_PROFILE_THREAD("Worker pool");
+            while (true) {
+                // Claim one of the queued tasks, then go and find it
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    wake.wait(lock, [&]() { return stopping || pending > 0; });
+                    if (stopping) return;
+                    --pending;
+                    ++running;
+                }
+                Task task;
+                while (!Take(self, task)) std::this_thread::yield(); // Claims never outnumber queued tasks; this is a formality
+
+                task.Run();
+
+                std::lock_guard<std::mutex> lock(mutex);
+                --running;
+                auto it = std::find_if(tokens.begin(), tokens.end(), [&](const CancellationToken& t) { return t.SameAs(task.Token); });
+                if (it != tokens.end()) tokens.erase(it);
+            }
+        }
+    };
+
+    inline thread_local const WorkerPool* WorkerPool::currentPool = nullptr;
+    inline thread_local int WorkerPool::currentIndex = -1;
+}
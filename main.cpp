@@ -1,214 +1,689 @@
 #define NOMINMAX
 
-#include "processutils.h"
-#include "toolchainmanager.h"
-#include "enginedetector.h"
+#include "ProcessUtils.h"
+#include "ToolchainManager.h"
+#include "ToolchainEnvironment.h"
+#include "EngineDetector.h"
+#include "PrebuiltCache.h"
+#include "IncludeScanner.h"
+#include "BuildCommand.h"
+#include "BuildActionLog.h"
+#include "UnityAdvisor.h"
+#include "AutoTuner.h"
+#include "MemoryGovernor.h"
+#include "ResourceSampler.h"
+#include "BuildTrace.h"
+#include "ProjectLocator.h"
+#include "OutputRecording.h"
+#include "CommandLine.h"
+#include "BuildEvents.h"
+#include "Pipeline.h"
+#include "CriticalPath.h"
+#include "PagePrefetch.h"
+#include "Downloader.h"
+#include "StartupPipeline.h"
+#include "Metrics.h"
+#include "MetricsServer.h"
+#include "Log.h"
+#include "ProjectIndex.h"
 #include <iostream>
+#include <fstream>
 #include <string>
+#include <vector>
 #include <filesystem>
-#include <algorithm> 
-#include <sstream>
-#include <limits>    
-#include <windows.h> 
+#include <algorithm>
+#include <mutex>
+#include <chrono>
+#ifdef _WIN32
+#include <io.h>
+#include <fcntl.h>
+#endif
 
 using namespace UEBuilder;
 namespace fs = std::filesystem; // Define fs namespace alias here
 
-// Helper function to convert wstring to string using Windows API
-std::string WStringToString(const std::wstring& wstr) {
-    if (wstr.empty()) return "";
-    int size_needed = WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), NULL, 0, NULL, NULL);
-    std::string strTo(size_needed, 0);
-    WideCharToMultiByte(CP_UTF8, 0, wstr.c_str(), (int)wstr.length(), &strTo[0], size_needed, NULL, NULL);
-    return strTo;
+// Everything resolved from the command line before a command runs
+struct CliContext {
+    CliOptions Options;
+    std::wstring ProjectPath;   // The .uproject
+    std::wstring Association;   // EngineAssociation from the .uproject
+    EngineInfo Engine;          // Only looked up for commands that run UBT
+    ToolchainSelection Toolchain; // Compiler and SDK the engine will build with
+    EnvironmentBlock Environment; // What UBT and UAT run with; empty inherits ours
+    std::string PrebuiltRevision; // Computed during startup when a prebuilt source is set
+    EventStream* Events = nullptr;
+};
+
+static int Exit(ExitCode code) { return static_cast<int>(code); }
+
+static RunOptions ChildOptions(const CliContext& context) {
+    RunOptions options;
+    if (!context.Environment.Empty()) options.Environment = &context.Environment;
+    options.Output.Overflow = OutputQueue::ParseOverflowPolicy(ProcessUtils::GetEnvVar(OutputQueue::OverflowEnvVar));
+    return options;
 }
 
-// UI Helper - Made static as suggested
 static void PrintHeader() {
-    system("cls");
     std::cout << "============================================\n";
     std::cout << "      STANDALONE UNREAL ENGINE BUILDER      \n";
     std::cout << "============================================\n";
 }
 
-int main() {
-    PrintHeader();
+static BuildRequest MakeRequest(const CliContext& context) {
+    BuildRequest request;
+    request.ProjectPath = context.ProjectPath;
+    request.Target = context.Options.Target;
+    request.Config = context.Options.Config;
+    request.Platform = context.Options.Platform;
+    if (context.Options.Jobs > 0) request.ExtraArgs.push_back(L"-MaxParallelActions=" + std::to_wstring(context.Options.Jobs));
+    request.ExtraArgs.insert(request.ExtraArgs.end(), context.Options.UBTArgs.begin(), context.Options.UBTArgs.end());
+    return request;
+}
+
+// Joins a build's exported action graph with its measured actions and reports the critical path
+static int ReportCriticalPath(const CliContext& context, const fs::path& recordDir) {
+    ActionGraph graph;
+    BuildActionLog actionLog;
+    if (!graph.Load(recordDir / ActionGraph::FileName) || !actionLog.Load(recordDir / "actions.json")) {
+        std::wcerr << L"[Error] No action graph and action timings in " << recordDir.wstring() << std::endl;
+        return Exit(ExitCode::OperationFailed);
+    }
+    graph.JoinDurations(actionLog.Actions());
+
+    CriticalPathReport report = CriticalPathAnalyzer::Analyze(graph, actionLog);
+    std::string text = CriticalPathAnalyzer::FormatReport(report);
+    std::cout << "\n" << text;
+    std::ofstream(recordDir / "CriticalPath.txt", std::ios::trunc) << text;
+    CriticalPathAnalyzer::Save(report, recordDir / "criticalpath.json");
+
+    context.Events->Emit("critical_path", [&](EventFields& f) {
+        f.Bool("valid", report.Valid).Num("critical_seconds", report.CriticalSeconds).Num("work_seconds", report.WorkSeconds)
+         .Num("measured_seconds", report.MeasuredSeconds).Num("parallelism", report.Parallelism).Num("slack", report.Slack)
+         .Int("slots", report.Slots).Bool("estimated", report.Estimated).Bool("clamped", report.Clamped);
+        if (!report.Path.empty()) f.Str("gating", report.Gating.front().Description);
+    });
+    return Exit(report.Valid ? ExitCode::Success : ExitCode::OperationFailed);
+}
+
+// What the project list shows as the project's last build
+static void RecordLastBuild(const CliContext& context, const std::wstring& buildTarget, const char* result,
+                            std::chrono::steady_clock::time_point started) {
+    ProjectBuildStatus status;
+    status.Result = result;
+    status.Target = StringUtils::ToUtf8(buildTarget);
+    status.Config = StringUtils::ToUtf8(context.Options.Config);
+    status.FinishedAt = ProjectBuildStatus::Now();
+    status.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    ProjectIndex::RecordBuild(context.ProjectPath, status);
+}
+
+static int RunBuild(const CliContext& context) {
+    AutoTuner::RestoreInterrupted([](const std::string& line) { std::cout << line; });
+    BuildRequest request = MakeRequest(context);
+    std::wstring buildTarget = BuildCommand::GetBuildTarget(request);
+    std::wstring args = BuildCommand::GetUBTArgs(request);
+    const std::wstring& projectPathStr = context.ProjectPath;
+    auto started = std::chrono::steady_clock::now();
+
+    // Counted as failed unless it gets to Finish(true)
+    BuildMetrics metrics;
+    metrics.Start(StringUtils::ToUtf8(buildTarget), StringUtils::ToUtf8(request.Config));
+
+    // Timeline of this build for chrome://tracing / ui.perfetto.dev, written as it happens
+    fs::path recordDir = BuildCommand::CreateBuildRecordDir(projectPathStr);
+    BuildTrace trace;
+    trace.Open(recordDir / "trace.json");
+
+    EventStream& events = *context.Events;
+    trace.SetStageListener([&events](const std::string& name, bool started, double seconds) {
+        events.Emit(started ? "stage_start" : "stage_end", [&](EventFields& f) { f.Str("stage", name).Seconds("at", seconds); });
+    });
+
+    if (context.Options.Clean) {
+        auto stage = trace.Stage("Clean");
+        std::cout << "\n--- CLEANING " << StringUtils::ToUtf8(buildTarget) << " ---\n";
+        BuildRequest clean = request;
+        clean.ExtraArgs.push_back(L"-Clean");
+        if (!ProcessUtils::RunProcess(context.Engine.UBTPath, BuildCommand::GetUBTArgs(clean), L"",
+                                      [](const std::string& line) { std::cout << line; }, ChildOptions(context))) {
+            std::cerr << "\n--- CLEAN FAILED ---\n";
+            RecordLastBuild(context, buildTarget, "failed", started);
+            return Exit(ExitCode::BuildFailed);
+        }
+    }
 
-    // --- STEP 1: Toolchain Check ---
-    ToolchainManager toolManager;
-    std::cout << "[Init] Checking for MSVC Build Tools...\n";
-    if (!toolManager.IsMSVCInstalled()) {
-        std::cout << "[Init] MSVC not found.\n";
-        std::cout << "Do you want to auto-install Visual Studio Build Tools? (y/n): ";
-        char resp;
-        std::cin >> resp;
-        // Only clear the buffer if we actually used cin above
-        std::cin.ignore((std::numeric_limits<std::streamsize>::max)(), '\n');
-
-        if (resp == 'y' || resp == 'Y') {
-            toolManager.InstallTools();
+    // Prefer binaries a build machine already published for this exact revision
+    std::wstring prebuiltSource = ProcessUtils::GetEnvVar(PrebuiltCache::LocationEnvVar);
+    if (!prebuiltSource.empty() && !context.Options.Clean) {
+        auto stage = trace.Stage("Prebuilt check");
+        std::cout << "\n[Info] Checking for prebuilt binaries...\n";
+        std::string revision = !context.PrebuiltRevision.empty() ? context.PrebuiltRevision
+            : PrebuiltCache::ComputeRevision(projectPathStr, context.Association, buildTarget, request.Platform, request.Config);
+
+        if (PrebuiltCache::Fetch(prebuiltSource, revision, projectPathStr, [](const std::string& line) { std::cout << line; })) {
+            BuildTrace::SaveProfile(recordDir, 0);
+            metrics.Finish(true);
+            std::cout << "\n--- PREBUILT BINARIES APPLIED ---\n";
+            RecordLastBuild(context, buildTarget, "succeeded", started);
+            return Exit(ExitCode::Success);
+        }
+        std::cout << "[Info] No usable prebuilt, building locally.\n";
+    }
+
+    std::wstring replayPath = ProcessUtils::GetEnvVar(OutputRecording::ReplayEnvVar);
+
+    // UBT writes the graph of what it is about to run and stops, so this is a run of its own;
+    // the makefile it builds is reused by the real build right after
+    bool graphExported = false;
+    if (context.Options.CriticalPath && replayPath.empty()) {
+        auto stage = trace.Stage("Action graph export");
+        std::cout << "\n[Info] Exporting UnrealBuildTool's action graph...\n";
+        BuildRequest exportRequest = request;
+        exportRequest.ExtraArgs.push_back(ActionGraph::ExportArg(recordDir / ActionGraph::FileName));
+        graphExported = ProcessUtils::RunProcess(context.Engine.UBTPath, BuildCommand::GetUBTArgs(exportRequest), L"",
+                                                 [](const std::string& line) { std::cout << line; }, ChildOptions(context)) &&
+                        fs::exists(recordDir / ActionGraph::FileName);
+        if (!graphExported) std::cerr << "[Warning] UnrealBuildTool did not export an action graph; no critical path this time.\n";
+    }
+
+    // Where this run's own time went before UBT (profile.json / Profile.txt)
+    BuildTrace::SaveProfile(recordDir, 0);
+
+    std::cout << "\n--- STARTING BUILD ---\n";
+
+    BuildActionLog actionLog(trace.StartTime()); // Per-action timings for the unity advisor
+    BuildEventReporter reporter(events);
+    actionLog.SetListeners(
+        [&trace, &reporter](const std::string& line, double seconds) {
+            trace.OnLine(line, seconds);
+            reporter.OnLine(line, seconds);
+        },
+        [&trace, &reporter](const BuildAction& action) {
+            trace.OnAction(action);
+            reporter.OnAction(action);
+        });
+
+    // Pauses compilers instead of letting them run out of memory
+    MemoryGovernor governor([](const std::string& line) { std::cout << line; });
+    ResourceSampler sampler; // CPU/memory/I-O timeline, kept with the build
+    RunOptions runOptions = ChildOptions(context);
+    OutputQueueStats outputStats;
+    runOptions.OutputStats = &outputStats;
+    runOptions.OnStarted = [&governor, &sampler](ProcessId pid) {
+        governor.Start(pid);
+        sampler.Start(pid);
+    };
+
+    // Raw output with its original chunking and timing, for replaying later.
+    // UEBUILDER_REPLAY plays such a recording back instead of running UBT.
+    OutputRecorder recorder;
+    if (replayPath.empty() && recorder.Open(recordDir / OutputRecorder::FileName)) runOptions.OnRawChunk = recorder.Tap();
+
+    LogCallback onOutput = [&actionLog, &metrics](const std::string& line) {
+        actionLog.Feed(line);
+        metrics.CountOutput(line);
+
+        // Colorize output simply for console
+        if (line.find("error") != std::string::npos)
+            std::cout << "!! " << line; // Highlight error
+        else
+            std::cout << line;
+        };
+
+    bool success = false;
+    {
+        auto stage = trace.Stage("UnrealBuildTool");
+        if (!replayPath.empty()) {
+            OutputRecording recording;
+            if (recording.Load(replayPath)) {
+                std::wcout << L"[Info] Replaying " << replayPath << std::endl;
+                success = recording.Replay(OutputRecording::SpeedFromEnv(), onOutput);
+            }
+            else {
+                std::wcerr << L"[Error] Cannot read recording " << replayPath << std::endl;
+            }
         }
         else {
-            std::cout << "Cannot proceed without compiler. Exiting.\n";
-            return 1;
+            success = ProcessUtils::RunProcess(context.Engine.UBTPath, args, L"", onOutput, runOptions);
         }
+        recorder.Finish(success);
+        governor.Stop();
+        sampler.Stop();
+        actionLog.Finish();
+        metrics.Finish(success);
     }
-    else {
-        std::cout << "[Init] MSVC Build Tools detected.\n";
+
+    if (success) std::cout << "\n--- BUILD SUCCESSFUL ---\n";
+    else std::cerr << "\n--- BUILD FAILED ---\n";
+    RecordLastBuild(context, buildTarget, success ? "succeeded" : "failed", started);
+    if (outputStats.Overflowed()) std::cout << "[Info] Output fell behind UBT: " << OutputQueue::FormatStats(outputStats) << "\n";
+
+    events.Emit("build_summary", [&](EventFields& f) {
+        f.Bool("success", success).Int("actions", reporter.Actions()).Int("errors", reporter.Errors())
+         .Int("warnings", reporter.Warnings()).Str("record_dir", StringUtils::ToUtf8(recordDir.wstring()))
+         .Int("output_high_water", static_cast<long long>(outputStats.HighWater))
+         .Int("output_overflows", static_cast<long long>(outputStats.Overflows))
+         .Int("output_spilled_bytes", static_cast<long long>(outputStats.SpilledBytes))
+         .Int("output_dropped_lines", static_cast<long long>(outputStats.DroppedLines));
+    });
+
+    {
+        auto stage = trace.Stage("Save build records");
+        actionLog.Save(recordDir / "actions.json");
+        sampler.SaveCsv(recordDir);
+        if (replayPath.empty()) PrefetchList::Learn(projectPathStr, context.Engine.UBTPath);
     }
+    trace.Close();
+    std::wcout << L"[Info] Build records (trace.json, actions.json, output.ubtrec, resource usage) saved to: "
+               << recordDir.wstring() << std::endl;
 
-    // --- STEP 2: Project Selection ---
-    std::cout << "\nEnter path to the Unreal Project FOLDER (or the .uproject file): ";
-    std::wstring inputPathStr;
+    if (graphExported) ReportCriticalPath(context, recordDir);
 
-    std::getline(std::wcin, inputPathStr);
+    return Exit(success ? ExitCode::Success : ExitCode::BuildFailed);
+}
 
-    if (!inputPathStr.empty()) {
-        // 1. Trim leading and trailing whitespace
-        inputPathStr.erase(0, inputPathStr.find_first_not_of(L" \t\n\r"));
-        inputPathStr.erase(inputPathStr.find_last_not_of(L" \t\n\r") + 1);
+// Publish the current Binaries/ for this revision so others can skip compiling
+static int RunPublish(const CliContext& context) {
+    std::wstring location = context.Options.PublishTo;
+    if (location.empty()) location = ProcessUtils::GetEnvVar(PrebuiltCache::LocationEnvVar);
+    if (location.empty()) {
+        std::cerr << "[Error] No shared folder: pass --publish-to or set UEBUILDER_PREBUILT_SOURCE.\n";
+        return Exit(ExitCode::UsageError);
+    }
 
-        // 2. Sanitize quotes from drag-and-drop
-        if (inputPathStr.front() == L'"') inputPathStr.erase(0, 1);
-        if (inputPathStr.back() == L'"') inputPathStr.pop_back();
+    BuildRequest request = MakeRequest(context);
+    std::string revision = PrebuiltCache::ComputeRevision(context.ProjectPath, context.Association,
+        BuildCommand::GetBuildTarget(request), request.Platform, request.Config);
 
-        // 3. Path sanitization fix (for common missing drive letter issue)
-        if (inputPathStr.length() > 1 && inputPathStr[1] == L':' && inputPathStr[0] == L'/') {
-            inputPathStr.erase(0, 1);
-        }
-        else if (inputPathStr.length() > 1 && inputPathStr[1] == L'/' && (inputPathStr[0] >= L'A' && inputPathStr[0] <= L'Z')) {
-            inputPathStr.insert(1, L":");
-        }
+    if (PrebuiltCache::Publish(location, context.ProjectPath, revision, [](const std::string& line) { std::cout << line; })) {
+        std::cout << "\n--- PUBLISH SUCCESSFUL ---\n";
+        return Exit(ExitCode::Success);
+    }
+    std::cerr << "\n--- PUBLISH FAILED ---\n";
+    return Exit(ExitCode::OperationFailed);
+}
 
-        // 4. Standardize path separators (use forward slashes for filesystem consistency)
-        std::replace(inputPathStr.begin(), inputPathStr.end(), L'\\', L'/');
+// Rank headers by how many translation units they drag into a rebuild
+static int RunIncludeReport(const CliContext& context) {
+    fs::path projectRoot = fs::path(context.ProjectPath).parent_path();
+    std::cout << "\n[Info] Scanning Source/ and plugin sources...\n";
+
+    IncludeScanResult scan = IncludeScanner::Scan(projectRoot);
+    std::string report = IncludeScanner::FormatReport(scan);
+    std::cout << IncludeScanner::FormatReport(scan, 20);
+
+    fs::path reportPath = BuildCommand::GetToolDataDir(context.ProjectPath) / "IncludeReport.txt";
+    if (!IncludeScanner::WriteReport(reportPath, report)) {
+        std::wcerr << L"[Error] Could not write " << reportPath.wstring() << std::endl;
+        return Exit(ExitCode::OperationFailed);
     }
+    std::wcout << L"\n[Info] Full report written to: " << reportPath.wstring() << std::endl;
+    return Exit(ExitCode::Success);
+}
 
-    fs::path targetPath(inputPathStr);
-    std::wstring projectPathStr;
+// Simulate alternative unity groupings from the last recorded build
+static int RunUnityAdvice(const CliContext& context) {
+    fs::path lastBuild = BuildCommand::FindLatestBuildRecordDir(context.ProjectPath, "actions.json");
+    BuildActionLog actionLog;
 
-    if (targetPath.extension() == L".uproject") {
-        // Case 1: User pasted the full .uproject file path
-        projectPathStr = targetPath.wstring();
+    if (lastBuild.empty() || !actionLog.Load(lastBuild / "actions.json")) {
+        std::cerr << "[Error] No recorded build yet. Build the project once first.\n";
+        return Exit(ExitCode::OperationFailed);
     }
-    else if (fs::is_directory(targetPath)) {
-        // Case 2: User pasted the project folder path (the preferred method)
-        std::wcout << L"[Info] Searching for .uproject file in folder: " << targetPath.wstring() << std::endl;
 
-        // Iterate through the directory to find the first .uproject file
-        bool found = false;
-        for (const auto& entry : fs::directory_iterator(targetPath)) {
-            if (entry.is_regular_file() && entry.path().extension() == L".uproject") {
-                projectPathStr = entry.path().wstring();
-                std::wcout << L"[Info] Auto-detected .uproject file: " << entry.path().filename().wstring() << std::endl;
-                found = true;
-                break; // Use the first one found
-            }
-        }
+    UnityAdvice advice = UnityAdvisor::Analyze(actionLog, fs::path(context.ProjectPath).parent_path());
+    std::string report = UnityAdvisor::FormatReport(advice);
+    std::cout << "\n" << report;
 
-        if (!found) {
-            std::cerr << "[Error] No .uproject file found inside the provided directory.\n";
-            std::wcout << L"Attempted Folder: " << targetPath.wstring() << std::endl;
-            system("pause");
-            return 1;
+    std::ofstream reportFile(lastBuild / "UnityAdvice.txt", std::ios::trunc);
+    reportFile << report;
+    return Exit(ExitCode::Success);
+}
+
+// Each candidate rebuilds the module (or the whole target) from scratch, several times
+static int RunAutoTune(const CliContext& context) {
+    TuningReport report = AutoTuner::Run(context.Engine.UBTPath, MakeRequest(context), context.Options.Module,
+        AutoTuner::DefaultCandidates(SystemInfo::GetMachineProfile()), context.Options.Repetitions,
+        [](const std::string& line) { std::cout << line; }, context.Environment.Empty() ? nullptr : &context.Environment);
+    std::cout << "\n" << AutoTuner::FormatReport(report);
+
+    if (report.Best < 0) return Exit(ExitCode::OperationFailed);
+
+    if (context.Options.Apply && !report.Results[report.Best].Candidate.Settings.empty()) {
+        if (!AutoTuner::Apply(report)) {
+            std::cerr << "[Error] Could not write BuildConfiguration.xml.\n";
+            return Exit(ExitCode::OperationFailed);
         }
+        std::cout << "[Info] BuildConfiguration.xml updated.\n";
+    }
+    return Exit(ExitCode::Success);
+}
 
+// Critical path of the most recent build that exported its action graph
+static int RunCriticalPath(const CliContext& context) {
+    fs::path lastBuild = BuildCommand::FindLatestBuildRecordDir(context.ProjectPath, ActionGraph::FileName);
+    if (lastBuild.empty()) {
+        std::cerr << "[Error] No build with an action graph yet. Build once with --critical-path.\n";
+        return Exit(ExitCode::OperationFailed);
     }
-    else {
-        // Case 3: Invalid path provided (neither file nor folder exists)
-        std::cerr << "[Error] Path does not exist or is invalid. Please check the path carefully.\n";
-        std::wcout << L"Attempted Path: " << targetPath.wstring() << std::endl;
-        system("pause");
-        return 1;
-    }
-
-    // FINAL CHECK: Ensure the resolved path exists (it should if logic above worked)
-    if (!fs::exists(projectPathStr)) {
-        std::cerr << "[Fatal Error] The resolved .uproject path does not exist.\n";
-        std::wcout << L"Resolved Path: " << projectPathStr << std::endl;
-        system("pause");
-        return 1;
-    }
-
-
-    // --- STEP 3: Engine Detection ---
-    std::wstring association = EngineDetector::GetEngineAssociation(projectPathStr);
-    std::wcout << L"[Info] Project uses Engine: " << association << std::endl;
-
-    EngineInfo engine = EngineDetector::FindEngine(association);
-    if (!engine.IsValid) {
-        // NOTE: The FindEngine function now includes a manual input fallback if registry fails.
-        // This check only runs if the final result of FindEngine is still invalid (i.e., user didn't enter a valid path manually).
-        std::cerr << "[Error] Could not locate Unreal Engine installation for version "
-            << WStringToString(association) << "\n";
-        std::cerr << "Ensure the engine is registered or try generating project files manually once.\n";
-        system("pause");
-        return 1;
-    }
-    std::wcout << L"[Info] Found UBT at: " << engine.UBTPath << std::endl;
-
-    // --- STEP 4: Configuration Menu ---
-    std::string config = "Development";
-    std::string platform = "Win64"; // Default
-    std::string targetName = "Editor"; // Default suffix
-
-    // Get Project Name from filename
-    std::wstring filename = fs::path(projectPathStr).stem().wstring();
-
-    while (true) {
-        PrintHeader();
-        std::wcout << L"Project: " << filename << L"\n";
-        std::cout << "1. Configuration: " << config << "\n";
-        std::cout << "2. Target Type: " << targetName << "\n";
-        std::cout << "3. BUILD PROJECT\n";
-        std::cout << "4. Exit\n";
-        std::cout << "Select: ";
-
-        int choice;
-        std::cin >> choice;
-
-        if (choice == 1) {
-            std::cout << "Enter Config (DebugGame, Development, Shipping): ";
-            std::cin >> config;
-        }
-        else if (choice == 2) {
-            std::cout << "Enter Target (Game, Editor, Client): ";
-            std::cin >> targetName;
-        }
-        else if (choice == 3) {
-            // Construct UBT Command
-            // Format: UnrealBuildTool.exe [ProjectName][TargetType] [Platform] [Config] -project="Path"
+    return ReportCriticalPath(context, lastBuild);
+}
 
-            std::wstring buildTarget;
-            if (targetName == "Game") buildTarget = filename; // Pure game target usually matches project name
-            else buildTarget = filename + std::wstring(targetName.begin(), targetName.end());
+// Stages from a pipeline file, as a DAG: independent stages run side by side
+static int RunPipeline(const CliContext& context) {
+    PipelineDefinition definition;
+    std::string error;
+    if (!Pipeline::Load(fs::path(context.Options.PipelineFile), definition, error)) {
+        std::cerr << "[Error] Pipeline " << StringUtils::ToUtf8(context.Options.PipelineFile) << ": " << error << "\n";
+        return Exit(ExitCode::UsageError);
+    }
+    Pipeline::ApplyDefaults(definition, context.Options.Target, context.Options.Config, context.Options.Platform);
+
+    std::mutex outputMutex;
+    PipelineRunner runner(definition, context.ProjectPath, context.Engine, [&outputMutex](const std::string& line) {
+        std::lock_guard<std::mutex> lock(outputMutex);
+        std::cout << line;
+    });
+    runner.SetForce(context.Options.Force);
+    if (!context.Environment.Empty()) runner.SetEnvironment(&context.Environment);
+
+    EventStream& events = *context.Events;
+    runner.SetStageListener([&events](const PipelineStage& stage, const PipelineStageResult& result) {
+        bool started = result.Status == PipelineStageStatus::Running;
+        events.Emit(started ? "stage_start" : "stage_end", [&](EventFields& f) {
+            f.Str("stage", stage.Name);
+            if (!started) f.Str("status", Pipeline::StatusName(result.Status)).Seconds("seconds", result.Seconds);
+        }, !started);
+    });
+
+    PipelineResult result = runner.Run();
+    std::cout << "\n" << Pipeline::FormatReport(definition, result);
+    if (result.Succeeded()) {
+        std::cout << "\n--- PIPELINE SUCCESSFUL ---\n";
+        return Exit(ExitCode::Success);
+    }
+    std::cerr << "\n--- PIPELINE FAILED ---\n";
+    return Exit(ExitCode::BuildFailed);
+}
 
-            std::wstring wConfig(config.begin(), config.end());
-            std::wstring wPlatform(platform.begin(), platform.end());
+// Standalone fetch; also what the toolchain installer uses for its bootstrapper
+static int RunDownload(const CliContext& context) {
+    const CliOptions& o = context.Options;
+    EventStream& events = *context.Events;
+
+    DownloadOptions options;
+    options.Connections = o.Connections;
+    options.Sha256 = o.Sha256;
+    options.OnProgress = [&events](const DownloadProgress& progress) {
+        std::cout << "\r[Download] " << Downloader::FormatProgress(progress) << "   " << std::flush;
+        events.Emit("download_progress", [&](EventFields& f) {
+            f.Int("bytes", static_cast<long long>(progress.Bytes)).Int("total", static_cast<long long>(progress.Total))
+             .Int("resumed", static_cast<long long>(progress.ResumedBytes)).Num("bytes_per_second", progress.BytesPerSecond)
+             .Int("connections", progress.Connections);
+        });
+    };
+
+    std::cout << "[Download] " << o.Url << "\n";
+    std::string error;
+    if (!Downloader::Download(o.Url, fs::path(o.DownloadTo), options, error)) {
+        std::cerr << "\n[Error] Download failed: " << error << "\n";
+        return Exit(ExitCode::OperationFailed);
+    }
+    std::cout << "\n[Download] Saved " << StringUtils::ToUtf8(o.DownloadTo) << (o.Sha256.empty() ? "" : " (SHA-256 verified)") << "\n";
+    return Exit(ExitCode::Success);
+}
 
-            std::wstring args = buildTarget + L" " + wPlatform + L" " + wConfig +
-                L" -project=\"" + projectPathStr + L"\"" +
-                L" -waitmutex -progress";
+// Brings the workspace's project index up to date and lists it
+static int RunProjects(const CliContext& context) {
+    ProjectIndex index;
+    index.Load();
+    for (const auto& root : ProjectIndex::WorkspaceFromEnv()) index.AddRoot(root);
+    for (const auto& root : context.Options.Workspace) {
+        if (!fs::is_directory(fs::path(root))) {
+            std::cerr << "[Error] Not a folder: " << StringUtils::ToUtf8(root) << "\n";
+            return Exit(ExitCode::UsageError);
+        }
+        index.AddRoot(root);
+    }
+    if (index.Roots().empty()) {
+        std::cerr << "[Error] No workspace roots yet. Pass --workspace <folder> or set UEBUILDER_WORKSPACE.\n";
+        return Exit(ExitCode::UsageError);
+    }
 
-            std::cout << "\n--- STARTING BUILD ---\n";
+    ProjectScanStats stats = index.Refresh(context.Options.Force);
+    if (!index.Save()) std::cerr << "[Warning] Could not save the project index to " << StringUtils::PathToUtf8(ProjectIndex::DefaultPath()) << "\n";
+
+    for (const auto& project : index.Projects()) {
+        std::string targets;
+        for (const auto& target : project.Targets) targets += (targets.empty() ? "" : ", ") + target;
+        std::string name = project.Name;
+        std::string engine = project.EngineAssociation.empty() ? "?" : project.EngineAssociation;
+        name.resize((std::max)(name.size(), size_t(24)), ' ');
+        engine.resize((std::max)(engine.size(), size_t(8)), ' ');
+        std::cout << "  " << name << " " << engine << " " << project.LastBuild.Describe() << "\n";
+        std::cout << "      " << StringUtils::PathToUtf8(project.File) << (targets.empty() ? "" : "  [" + targets + "]") << "\n";
+
+        context.Events->Emit("indexed_project", [&](EventFields& f) {
+            f.Str("name", project.Name).Str("path", StringUtils::PathToUtf8(project.File)).Str("association", project.EngineAssociation)
+             .Str("targets", targets).Str("last_build", project.LastBuild.Result);
+            if (!project.LastBuild.Result.empty()) f.Int("last_build_at", project.LastBuild.FinishedAt);
+        });
+    }
+    std::cout << "[Info] " << index.Projects().size() << " projects under " << index.Roots().size() << " workspace roots ("
+              << stats.Folders << " folders, " << stats.FoldersListed << " listed, " << stats.ProjectsRead << " re-read, "
+              << static_cast<int>(stats.Seconds * 1000) << " ms)\n";
+    return Exit(ExitCode::Success);
+}
+
+// --project given as a bare name: the indexed project of that name, if there is exactly one
+static void ResolveProjectName(CliOptions& options) {
+    const std::wstring& name = options.Project;
+    if (name.find_first_of(L"/\\.") != std::wstring::npos || fs::exists(fs::path(name))) return;
+    ProjectIndex index;
+    if (!index.Load()) return;
+    std::vector<const IndexedProject*> found = index.FindByName(StringUtils::ToUtf8(name));
+    if (found.size() == 1) options.Project = found.front()->File.wstring();
+    else if (found.size() > 1) std::cerr << "[Warning] " << found.size() << " indexed projects are named " << StringUtils::ToUtf8(name)
+                                         << "; pass the path to one of them.\n";
+}
 
-            bool success = ProcessUtils::RunProcess(engine.UBTPath, args, L"", [](const std::string& line) {
-                // Colorize output simply for console
-                if (line.find("error") != std::string::npos)
-                    std::cout << "!! " << line; // Highlight error
-                else
-                    std::cout << line;
-                });
+static int RunCommand(CliContext& context) {
+    const CliCommand command = context.Options.Command;
+    const bool runsUBT = command == CliCommand::Build || command == CliCommand::AutoTune || command == CliCommand::Pipeline;
 
-            if (success) std::cout << "\n--- BUILD SUCCESSFUL ---\n";
-            else std::cout << "\n--- BUILD FAILED ---\n";
+    PrintHeader();
+    ResolveProjectName(context.Options);
+
+    // --- STEPS 1-3: Toolchain check, project selection, engine detection ---
+    // One pipeline runs them concurrently (StartupPipeline.h); reported here in the old order
+#ifdef _WIN32
+    // Other platforms build with the engine's bundled clang or Xcode
+    const bool checksMsvc = runsUBT && EngineDetector::GetUBTOverride().empty();
+    if (checksMsvc) std::cout << "[Init] Checking for MSVC Build Tools...\n";
+#endif
+
+    // Warms the page cache with what the last build read while the engine is being looked up
+    PagePrefetcher prefetcher;
+    StartupOptions startup;
+    startup.Project = context.Options.Project;
+    startup.EngineRoot = context.Options.EngineRoot;
+    startup.NeedsEngine = runsUBT;
+    startup.Prefetcher = runsUBT && PagePrefetcher::Enabled() ? &prefetcher : nullptr;
+    startup.ComputeRevision = command == CliCommand::Build && !context.Options.Clean &&
+                              !ProcessUtils::GetEnvVar(PrebuiltCache::LocationEnvVar).empty();
+    startup.Request = MakeRequest(context);
+
+    StartupResult result = StartupPipeline::RunBlocking(startup);
+    Log::Flush(); // The lookups' diagnostics before the results below
+#ifdef _WIN32
+    if (result.Error == StartupError::ToolchainMissing) {
+        if (!context.Options.InstallToolchain) {
+            std::cerr << "[Error] MSVC Build Tools not found. Install them or pass --install-toolchain.\n";
+            return Exit(ExitCode::ToolchainMissing);
+        }
+        ToolchainManager toolManager;
+        toolManager.InstallTools();
+        result = StartupPipeline::RunBlocking(startup);
+        if (result.Error == StartupError::ToolchainMissing) return Exit(ExitCode::ToolchainMissing);
+    }
+    if (checksMsvc) std::cout << "[Init] MSVC Build Tools detected.\n";
+#endif
+    if (result.Error == StartupError::Failed) {
+        std::cerr << "[Error] " << result.Problem << "\n";
+        return Exit(ExitCode::OperationFailed);
+    }
+
+    if (result.Error == StartupError::ProjectNotFound) {
+        if (result.TargetIsDirectory) std::cerr << "[Error] No .uproject file found inside the provided directory.\n";
+        else std::cerr << "[Error] Path does not exist or is invalid. Please check the path carefully.\n";
+        std::wcerr << L"Attempted Path: " << result.TargetPath.wstring() << std::endl;
+        return Exit(ExitCode::ProjectNotFound);
+    }
+    context.ProjectPath = result.ProjectPath;
+    context.Association = result.Association;
+    context.PrebuiltRevision = result.PrebuiltRevision;
+    std::wcout << L"[Info] Project: " << context.ProjectPath << std::endl;
+    if (!result.PrefetchSource.empty()) {
+        std::cout << "[Info] Prefetching " << prefetcher.FileCount() << " " << result.PrefetchSource << " in the background\n";
+    }
 
-            system("pause");
+    std::wcout << L"[Info] Project uses Engine: " << context.Association << std::endl;
+    context.Events->Emit("project", [&](EventFields& f) {
+        f.Str("path", StringUtils::ToUtf8(context.ProjectPath)).Str("association", StringUtils::ToUtf8(context.Association));
+    });
+
+    if (runsUBT) {
+        if (result.Error == StartupError::EngineNotFound) {
+            std::cerr << "[Error] Could not locate Unreal Engine installation for version "
+                      << StringUtils::ToUtf8(context.Association) << "\n";
+            std::cerr << "Register the engine, or pass --engine-root <path>.\n";
+            return Exit(ExitCode::EngineNotFound);
         }
-        else if (choice == 4) {
-            break;
+        context.Engine = result.Engine;
+        std::wcout << L"[Info] Found UBT at: " << context.Engine.UBTPath << std::endl;
+        context.Events->Emit("engine", [&](EventFields& f) {
+            f.Str("version", StringUtils::ToUtf8(context.Engine.Version)).Str("root", StringUtils::ToUtf8(context.Engine.RootPath))
+             .Str("ubt", StringUtils::ToUtf8(context.Engine.UBTPath));
+        }, true);
+
+        // The compiler this engine version wants, out of everything installed (a stand-in UBT needs none)
+        if (result.ToolchainSelected) {
+            context.Toolchain = result.Toolchain;
+            context.Events->Emit("toolchain", [&](EventFields& f) {
+                f.Bool("valid", context.Toolchain.IsValid);
+                if (context.Toolchain.HasMsvc) f.Str("msvc", context.Toolchain.Msvc.Version).Str("vs", context.Toolchain.Msvc.Product);
+                if (!context.Toolchain.Sdk.Version.empty()) f.Str("windows_sdk", context.Toolchain.Sdk.Version);
+                if (context.Toolchain.HasClang) f.Str("clang", context.Toolchain.Clang.Version).Str("clang_source", context.Toolchain.Clang.Source);
+                if (!context.Toolchain.IsValid) f.Str("problem", context.Toolchain.Problem);
+            });
+            if (context.Toolchain.IsValid) {
+                std::cout << "[Info] Toolchain: " << context.Toolchain.Describe() << "\n";
+                std::cout << result.EnvironmentLog;
+                context.Environment = result.Environment;
+            }
+            else {
+#ifdef _WIN32
+                std::cerr << "[Error] " << context.Toolchain.Problem << "\n";
+                return Exit(ExitCode::ToolchainMissing);
+#else
+                // UBT can still find one we don't know about (e.g. a toolchain under a custom UE_SDKS_ROOT layout)
+                std::cerr << "[Warning] " << context.Toolchain.Problem << "\n";
+#endif
+            }
         }
+        context.Events->Emit("startup", [&](EventFields& f) {
+            f.Seconds("seconds", result.Seconds).Str("stages", result.FormatStages());
+        });
+    }
+
+    // --- STEP 4: Command ---
+    switch (command) {
+    case CliCommand::Build: return RunBuild(context);
+    case CliCommand::Publish: return RunPublish(context);
+    case CliCommand::IncludeReport: return RunIncludeReport(context);
+    case CliCommand::UnityAdvice: return RunUnityAdvice(context);
+    case CliCommand::AutoTune: return RunAutoTune(context);
+    case CliCommand::Pipeline: return RunPipeline(context);
+    case CliCommand::CriticalPath: return RunCriticalPath(context);
+    default: return Exit(ExitCode::UsageError);
+    }
+}
+
+static int Run(const std::vector<std::wstring>& args) {
+    CliContext context;
+    EventStream events;
+    context.Events = &events;
+
+    std::wstring error;
+    bool parsed = CommandLine::Parse(args, context.Options, error);
+
+    // The tool's own diagnostics (Log.h): stderr from UEBUILDER_LOG_LEVEL up, all of them to the log file
+    Log::AddSink(Log::ConfiguredLevel(), Log::ConsoleSink(stderr));
+    Log::AddFileSink("cli");
+
+    // stdout carries nothing but events; everything meant for people goes to stderr
+    std::streambuf* coutBuffer = std::cout.rdbuf();
+    std::wstreambuf* wcoutBuffer = std::wcout.rdbuf();
+    if (context.Options.Events == EventFormat::Ndjson) {
+#ifdef _WIN32
+        _setmode(_fileno(stdout), _O_BINARY); // "\n", not "\r\n", between events
+#endif
+        std::cout.rdbuf(std::cerr.rdbuf());
+        std::wcout.rdbuf(std::wcerr.rdbuf());
+        events.Open(stdout);
     }
 
-    return 0;
-}
\ No newline at end of file
+    int code;
+    if (!parsed) {
+        std::cerr << "[Error] " << StringUtils::ToUtf8(error) << "\nRun with --help for usage.\n";
+        code = Exit(ExitCode::UsageError);
+    }
+    else if (context.Options.Command == CliCommand::Help) {
+        std::cout << CommandLine::Usage();
+        code = Exit(ExitCode::Success);
+    }
+    else {
+        const CliOptions& o = context.Options;
+        events.Emit("start", [&](EventFields& f) {
+            f.Str("command", CommandLine::CommandName(o.Command)).Str("project", StringUtils::ToUtf8(o.Project))
+             .Str("target", StringUtils::ToUtf8(o.Target)).Str("config", StringUtils::ToUtf8(o.Config))
+             .Str("platform", StringUtils::ToUtf8(o.Platform));
+        }, true);
+
+        // Scraped for as long as the command runs; most useful with pipeline and auto-tune
+        MetricsServer metricsServer;
+        std::string metricsListen = !o.Metrics.empty() ? o.Metrics : StringUtils::ToUtf8(ProcessUtils::GetEnvVar(MetricsServer::ListenEnvVar));
+        if (!metricsListen.empty()) {
+            if (metricsServer.Start(metricsListen)) std::cout << "[Info] Metrics at " << metricsServer.Url() << "\n";
+            else std::cerr << "[Warning] Cannot serve metrics on " << metricsListen << "\n";
+        }
+
+        if (o.Command == CliCommand::Download) code = RunDownload(context);
+        else if (o.Command == CliCommand::Projects) code = RunProjects(context);
+        else code = RunCommand(context);
+    }
+
+    events.Emit("result", [&](EventFields& f) {
+        f.Int("exit_code", code).Str("status", CommandLine::ExitCodeName(static_cast<ExitCode>(code)))
+         .Bool("success", code == 0).Seconds("seconds", events.Now());
+    }, true);
+
+    Log::Flush();
+    std::cout.flush();
+    std::wcout.flush();
+    std::cout.rdbuf(coutBuffer);
+    std::wcout.rdbuf(wcoutBuffer);
+    return code;
+}
+
+#ifdef _WIN32
+int wmain(int argc, wchar_t** argv) {
+    return Run(std::vector<std::wstring>(argv + 1, argv + argc));
+}
+#else
+int main(int argc, char** argv) {
+    std::vector<std::wstring> args;
+    for (int i = 1; i < argc; ++i) args.push_back(StringUtils::FromUtf8(argv[i]));
+    return Run(args);
+}
+#endif